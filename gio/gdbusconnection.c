@@ -428,7 +428,8 @@ struct _GDBusConnection
   /* Maps used for managing signal subscription, protected by @lock */
   GHashTable *map_rule_to_signal_data;                      /* match rule (gchar*)    -> SignalData */
   GHashTable *map_id_to_signal_data;                        /* id (guint)             -> SignalData */
-  GHashTable *map_sender_unique_name_to_signal_data_array;  /* unique sender (gchar*) -> GPtrArray* of SignalData */
+  GHashTable *map_sender_unique_name_to_signal_data_index;  /* unique sender (gchar*) -> GHashTable* of SignalDataBucket */
+  guint signal_data_serial;                                 /* to keep SignalData in subscription order */
 
   /* Maps used for managing exported objects and subtrees,
    * protected by @lock
@@ -674,7 +675,7 @@ g_dbus_connection_finalize (GObject *object)
 
   g_hash_table_unref (connection->map_rule_to_signal_data);
   g_hash_table_unref (connection->map_id_to_signal_data);
-  g_hash_table_unref (connection->map_sender_unique_name_to_signal_data_array);
+  g_hash_table_unref (connection->map_sender_unique_name_to_signal_data_index);
 
   g_hash_table_unref (connection->map_id_to_ei);
   g_hash_table_unref (connection->map_object_path_to_eo);
@@ -1071,10 +1072,10 @@ g_dbus_connection_init (GDBusConnection *connection)
                                                           g_str_equal);
   connection->map_id_to_signal_data = g_hash_table_new (g_direct_hash,
                                                         g_direct_equal);
-  connection->map_sender_unique_name_to_signal_data_array = g_hash_table_new_full (g_str_hash,
+  connection->map_sender_unique_name_to_signal_data_index = g_hash_table_new_full (g_str_hash,
                                                                                    g_str_equal,
                                                                                    g_free,
-                                                                                   (GDestroyNotify) g_ptr_array_unref);
+                                                                                   (GDestroyNotify) g_hash_table_unref);
 
   connection->map_object_path_to_eo = g_hash_table_new_full (g_str_hash,
                                                              g_str_equal,
@@ -3251,6 +3252,7 @@ typedef struct
   gchar *object_path;
   gchar *arg0;
   GDBusSignalFlags flags;
+  guint serial;
   GPtrArray *subscribers;  /* (owned) (element-type SignalSubscriber) */
 } SignalData;
 
@@ -3268,6 +3270,146 @@ signal_data_free (SignalData *signal_data)
   g_free (signal_data);
 }
 
+/* All SignalData from one sender with the same interface, member and
+ * object path (any of which can be %NULL for a wildcard), so that an
+ * incoming signal only needs to look at the few buckets it can match
+ * instead of at every subscription.
+ */
+typedef struct
+{
+  gchar *interface_name;
+  gchar *member;
+  gchar *object_path;
+  guint hash;  /* see signal_data_bucket_compute_hash() */
+  GPtrArray *signal_data_array;  /* (element-type SignalData), in order of SignalData.serial */
+} SignalDataBucket;
+
+/* Takes the g_str_hash() of each part (or 0 for a wildcard), so that
+ * schedule_callbacks() only has to hash the strings in a message once
+ * for all the buckets it looks up. */
+static guint
+signal_data_bucket_compute_hash (guint interface_hash,
+                                 guint member_hash,
+                                 guint path_hash)
+{
+  return ((interface_hash * 31) ^ member_hash) * 31 ^ path_hash;
+}
+
+static guint
+str_hash0 (const gchar *str)
+{
+  return str != NULL ? g_str_hash (str) : 0;
+}
+
+static guint
+signal_data_bucket_hash (gconstpointer v)
+{
+  const SignalDataBucket *bucket = v;
+
+  return bucket->hash;
+}
+
+static gboolean
+signal_data_bucket_equal (gconstpointer v1,
+                          gconstpointer v2)
+{
+  const SignalDataBucket *bucket1 = v1;
+  const SignalDataBucket *bucket2 = v2;
+
+  return g_strcmp0 (bucket1->object_path, bucket2->object_path) == 0 &&
+         g_strcmp0 (bucket1->member, bucket2->member) == 0 &&
+         g_strcmp0 (bucket1->interface_name, bucket2->interface_name) == 0;
+}
+
+static void
+signal_data_bucket_free (SignalDataBucket *bucket)
+{
+  g_free (bucket->interface_name);
+  g_free (bucket->member);
+  g_free (bucket->object_path);
+  g_ptr_array_unref (bucket->signal_data_array);
+  g_free (bucket);
+}
+
+/* must hold lock when calling this */
+static void
+add_signal_data_to_index (GDBusConnection *connection,
+                          SignalData      *signal_data)
+{
+  GHashTable *signal_data_index;
+  SignalDataBucket key;
+  SignalDataBucket *bucket;
+
+  signal_data_index = g_hash_table_lookup (connection->map_sender_unique_name_to_signal_data_index,
+                                           signal_data->sender_unique_name);
+  if (signal_data_index == NULL)
+    {
+      signal_data_index = g_hash_table_new_full (signal_data_bucket_hash,
+                                                 signal_data_bucket_equal,
+                                                 (GDestroyNotify) signal_data_bucket_free,
+                                                 NULL);
+      g_hash_table_insert (connection->map_sender_unique_name_to_signal_data_index,
+                           g_strdup (signal_data->sender_unique_name),
+                           signal_data_index);
+    }
+
+  key.interface_name = signal_data->interface_name;
+  key.member = signal_data->member;
+  key.object_path = signal_data->object_path;
+  key.hash = signal_data_bucket_compute_hash (str_hash0 (signal_data->interface_name),
+                                              str_hash0 (signal_data->member),
+                                              str_hash0 (signal_data->object_path));
+
+  bucket = g_hash_table_lookup (signal_data_index, &key);
+  if (bucket == NULL)
+    {
+      bucket = g_new0 (SignalDataBucket, 1);
+      bucket->interface_name = g_strdup (signal_data->interface_name);
+      bucket->member = g_strdup (signal_data->member);
+      bucket->object_path = g_strdup (signal_data->object_path);
+      bucket->hash = key.hash;
+      bucket->signal_data_array = g_ptr_array_new ();
+      g_hash_table_add (signal_data_index, bucket);
+    }
+
+  /* Serials only grow, so this keeps the bucket sorted */
+  g_ptr_array_add (bucket->signal_data_array, signal_data);
+}
+
+/* must hold lock when calling this */
+static void
+remove_signal_data_from_index (GDBusConnection *connection,
+                               SignalData      *signal_data)
+{
+  GHashTable *signal_data_index;
+  SignalDataBucket key;
+  SignalDataBucket *bucket;
+
+  signal_data_index = g_hash_table_lookup (connection->map_sender_unique_name_to_signal_data_index,
+                                           signal_data->sender_unique_name);
+  g_return_if_fail (signal_data_index != NULL);
+
+  key.interface_name = signal_data->interface_name;
+  key.member = signal_data->member;
+  key.object_path = signal_data->object_path;
+  key.hash = signal_data_bucket_compute_hash (str_hash0 (signal_data->interface_name),
+                                              str_hash0 (signal_data->member),
+                                              str_hash0 (signal_data->object_path));
+
+  bucket = g_hash_table_lookup (signal_data_index, &key);
+  g_return_if_fail (bucket != NULL);
+  g_warn_if_fail (g_ptr_array_remove (bucket->signal_data_array, signal_data));
+
+  if (bucket->signal_data_array->len == 0)
+    g_hash_table_remove (signal_data_index, bucket);
+
+  if (g_hash_table_size (signal_data_index) == 0)
+    {
+      g_warn_if_fail (g_hash_table_remove (connection->map_sender_unique_name_to_signal_data_index,
+                                           signal_data->sender_unique_name));
+    }
+}
+
 typedef struct
 {
   /* All fields are immutable after construction. */
@@ -3513,7 +3655,6 @@ g_dbus_connection_signal_subscribe (GDBusConnection     *connection,
   gchar *rule;
   SignalData *signal_data;
   SignalSubscriber *subscriber;
-  GPtrArray *signal_data_array;
   const gchar *sender_unique_name;
 
   /* Right now we abort if AddMatch() fails since it can only fail with the bus being in
@@ -3579,6 +3720,7 @@ g_dbus_connection_signal_subscribe (GDBusConnection     *connection,
   signal_data->object_path           = g_strdup (object_path);
   signal_data->arg0                  = g_strdup (arg0);
   signal_data->flags                 = flags;
+  signal_data->serial                = connection->signal_data_serial++;
   signal_data->subscribers           = g_ptr_array_new_with_free_func ((GDestroyNotify) signal_subscriber_unref);
   g_ptr_array_add (signal_data->subscribers, subscriber);
 
@@ -3597,16 +3739,7 @@ g_dbus_connection_signal_subscribe (GDBusConnection     *connection,
         add_match_rule (connection, signal_data->rule);
     }
 
-  signal_data_array = g_hash_table_lookup (connection->map_sender_unique_name_to_signal_data_array,
-                                           signal_data->sender_unique_name);
-  if (signal_data_array == NULL)
-    {
-      signal_data_array = g_ptr_array_new ();
-      g_hash_table_insert (connection->map_sender_unique_name_to_signal_data_array,
-                           g_strdup (signal_data->sender_unique_name),
-                           signal_data_array);
-    }
-  g_ptr_array_add (signal_data_array, signal_data);
+  add_signal_data_to_index (connection, signal_data);
 
  out:
   g_hash_table_insert (connection->map_id_to_signal_data,
@@ -3628,7 +3761,6 @@ unsubscribe_id_internal (GDBusConnection *connection,
                          guint            subscription_id)
 {
   SignalData *signal_data;
-  GPtrArray *signal_data_array;
   guint n;
   guint n_removed = 0;
 
@@ -3659,17 +3791,7 @@ unsubscribe_id_internal (GDBusConnection *connection,
       if (signal_data->subscribers->len == 0)
         {
           g_warn_if_fail (g_hash_table_remove (connection->map_rule_to_signal_data, signal_data->rule));
-
-          signal_data_array = g_hash_table_lookup (connection->map_sender_unique_name_to_signal_data_array,
-                                                   signal_data->sender_unique_name);
-          g_warn_if_fail (signal_data_array != NULL);
-          g_warn_if_fail (g_ptr_array_remove (signal_data_array, signal_data));
-
-          if (signal_data_array->len == 0)
-            {
-              g_warn_if_fail (g_hash_table_remove (connection->map_sender_unique_name_to_signal_data_array,
-                                                   signal_data->sender_unique_name));
-            }
+          remove_signal_data_from_index (connection, signal_data);
 
           /* remove the match rule from the bus unless NameLost or NameAcquired (see subscribe()) */
           if ((connection->flags & G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION) &&
@@ -3845,31 +3967,95 @@ path_rule_matches (const gchar *path_a,
   return memcmp (path_a, path_b, MIN (len_a, len_b)) == 0;
 }
 
+/* called in GDBusWorker thread WITH lock held
+ *
+ * @sender is (nullable) for peer-to-peer connections */
+static void
+schedule_callbacks_for_signal_data (GDBusConnection *connection,
+                                    SignalData      *signal_data,
+                                    GDBusMessage    *message,
+                                    const gchar     *sender,
+                                    const gchar     *interface,
+                                    const gchar     *member,
+                                    const gchar     *path,
+                                    const gchar     *arg0)
+{
+  guint m;
+
+  if (signal_data->arg0 != NULL)
+    {
+      if (arg0 == NULL)
+        return;
+
+      if (signal_data->flags & G_DBUS_SIGNAL_FLAGS_MATCH_ARG0_NAMESPACE)
+        {
+          if (!namespace_rule_matches (signal_data->arg0, arg0))
+            return;
+        }
+      else if (signal_data->flags & G_DBUS_SIGNAL_FLAGS_MATCH_ARG0_PATH)
+        {
+          if (!path_rule_matches (signal_data->arg0, arg0))
+            return;
+        }
+      else if (!g_str_equal (signal_data->arg0, arg0))
+        return;
+    }
+
+  for (m = 0; m < signal_data->subscribers->len; m++)
+    {
+      SignalSubscriber *subscriber = signal_data->subscribers->pdata[m];
+      GSource *idle_source;
+      SignalInstance *signal_instance;
+
+      signal_instance = g_new0 (SignalInstance, 1);
+      signal_instance->subscriber = signal_subscriber_ref (subscriber);
+      signal_instance->message = g_object_ref (message);
+      signal_instance->connection = g_object_ref (connection);
+      signal_instance->sender = sender;
+      signal_instance->path = path;
+      signal_instance->interface = interface;
+      signal_instance->member = member;
+
+      idle_source = g_idle_source_new ();
+      g_source_set_priority (idle_source, G_PRIORITY_DEFAULT);
+      g_source_set_callback (idle_source,
+                             emit_signal_instance_in_idle_cb,
+                             signal_instance,
+                             (GDestroyNotify) signal_instance_free);
+      g_source_set_name (idle_source, "[gio] emit_signal_instance_in_idle_cb");
+      g_source_attach (idle_source, subscriber->context);
+      g_source_unref (idle_source);
+    }
+}
+
 /* called in GDBusWorker thread WITH lock held
  *
  * @sender is (nullable) for peer-to-peer connections */
 static void
 schedule_callbacks (GDBusConnection *connection,
-                    GPtrArray       *signal_data_array,
+                    GHashTable      *signal_data_index,
                     GDBusMessage    *message,
                     const gchar     *sender)
 {
-  guint n, m;
+  GPtrArray *matches[8];
+  guint next[8];
+  guint n_matches;
+  guint n;
   const gchar *interface;
   const gchar *member;
   const gchar *path;
   const gchar *arg0;
-
-  interface = NULL;
-  member = NULL;
-  path = NULL;
-  arg0 = NULL;
+  guint interface_hash, member_hash, path_hash;
 
   interface = g_dbus_message_get_interface (message);
   member = g_dbus_message_get_member (message);
   path = g_dbus_message_get_path (message);
   arg0 = g_dbus_message_get_arg0 (message);
 
+  interface_hash = str_hash0 (interface);
+  member_hash = str_hash0 (member);
+  path_hash = str_hash0 (path);
+
 #if 0
   g_print ("In schedule_callbacks:\n"
            "  sender    = '%s'\n"
@@ -3884,66 +4070,67 @@ schedule_callbacks (GDBusConnection *connection,
            arg0);
 #endif
 
-  /* TODO: if this is slow, then we can change signal_data_array into
-   *       map_object_path_to_signal_data_array or something.
+  /* Only the buckets which have either the value from the message or a
+   * wildcard for each of interface, member and path can match.
    */
-  for (n = 0; n < signal_data_array->len; n++)
-    {
-      SignalData *signal_data = signal_data_array->pdata[n];
-
-      if (signal_data->interface_name != NULL && g_strcmp0 (signal_data->interface_name, interface) != 0)
+  n_matches = 0;
+  for (n = 0; n < G_N_ELEMENTS (matches); n++)
+    {
+      SignalDataBucket key;
+      SignalDataBucket *bucket;
+
+      key.interface_name = (n & 1) ? (gchar *) interface : NULL;
+      key.member = (n & 2) ? (gchar *) member : NULL;
+      key.object_path = (n & 4) ? (gchar *) path : NULL;
+      key.hash = signal_data_bucket_compute_hash ((n & 1) ? interface_hash : 0,
+                                                  (n & 2) ? member_hash : 0,
+                                                  (n & 4) ? path_hash : 0);
+
+      /* Would be the same as the wildcard bucket */
+      if (((n & 1) && interface == NULL) ||
+          ((n & 2) && member == NULL) ||
+          ((n & 4) && path == NULL))
         continue;
 
-      if (signal_data->member != NULL && g_strcmp0 (signal_data->member, member) != 0)
-        continue;
+      bucket = g_hash_table_lookup (signal_data_index, &key);
+      if (bucket != NULL)
+        {
+          matches[n_matches] = bucket->signal_data_array;
+          next[n_matches] = 0;
+          n_matches++;
+        }
+    }
 
-      if (signal_data->object_path != NULL && g_strcmp0 (signal_data->object_path, path) != 0)
-        continue;
+  /* Merge the buckets, so that callbacks are still scheduled in the order
+   * the subscriptions were made in.
+   */
+  while (TRUE)
+    {
+      SignalData *signal_data = NULL;
+      guint lowest = 0;
 
-      if (signal_data->arg0 != NULL)
+      for (n = 0; n < n_matches; n++)
         {
-          if (arg0 == NULL)
+          SignalData *candidate;
+
+          if (next[n] >= matches[n]->len)
             continue;
 
-          if (signal_data->flags & G_DBUS_SIGNAL_FLAGS_MATCH_ARG0_NAMESPACE)
-            {
-              if (!namespace_rule_matches (signal_data->arg0, arg0))
-                continue;
-            }
-          else if (signal_data->flags & G_DBUS_SIGNAL_FLAGS_MATCH_ARG0_PATH)
+          candidate = matches[n]->pdata[next[n]];
+          if (signal_data == NULL || candidate->serial < signal_data->serial)
             {
-              if (!path_rule_matches (signal_data->arg0, arg0))
-                continue;
+              signal_data = candidate;
+              lowest = n;
             }
-          else if (!g_str_equal (signal_data->arg0, arg0))
-            continue;
         }
 
-      for (m = 0; m < signal_data->subscribers->len; m++)
-        {
-          SignalSubscriber *subscriber = signal_data->subscribers->pdata[m];
-          GSource *idle_source;
-          SignalInstance *signal_instance;
-
-          signal_instance = g_new0 (SignalInstance, 1);
-          signal_instance->subscriber = signal_subscriber_ref (subscriber);
-          signal_instance->message = g_object_ref (message);
-          signal_instance->connection = g_object_ref (connection);
-          signal_instance->sender = sender;
-          signal_instance->path = path;
-          signal_instance->interface = interface;
-          signal_instance->member = member;
-
-          idle_source = g_idle_source_new ();
-          g_source_set_priority (idle_source, G_PRIORITY_DEFAULT);
-          g_source_set_callback (idle_source,
-                                 emit_signal_instance_in_idle_cb,
-                                 signal_instance,
-                                 (GDestroyNotify) signal_instance_free);
-          g_source_set_name (idle_source, "[gio] emit_signal_instance_in_idle_cb");
-          g_source_attach (idle_source, subscriber->context);
-          g_source_unref (idle_source);
-        }
+      if (signal_data == NULL)
+        break;
+
+      next[lowest]++;
+
+      schedule_callbacks_for_signal_data (connection, signal_data, message,
+                                          sender, interface, member, path, arg0);
     }
 }
 
@@ -3952,7 +4139,7 @@ static void
 distribute_signals (GDBusConnection *connection,
                     GDBusMessage    *message)
 {
-  GPtrArray *signal_data_array;
+  GHashTable *signal_data_index;
   const gchar *sender;
 
   sender = g_dbus_message_get_sender (message);
@@ -3975,15 +4162,15 @@ distribute_signals (GDBusConnection *connection,
   /* collect subscribers that match on sender */
   if (sender != NULL)
     {
-      signal_data_array = g_hash_table_lookup (connection->map_sender_unique_name_to_signal_data_array, sender);
-      if (signal_data_array != NULL)
-        schedule_callbacks (connection, signal_data_array, message, sender);
+      signal_data_index = g_hash_table_lookup (connection->map_sender_unique_name_to_signal_data_index, sender);
+      if (signal_data_index != NULL)
+        schedule_callbacks (connection, signal_data_index, message, sender);
     }
 
   /* collect subscribers not matching on sender */
-  signal_data_array = g_hash_table_lookup (connection->map_sender_unique_name_to_signal_data_array, "");
-  if (signal_data_array != NULL)
-    schedule_callbacks (connection, signal_data_array, message, sender);
+  signal_data_index = g_hash_table_lookup (connection->map_sender_unique_name_to_signal_data_index, "");
+  if (signal_data_index != NULL)
+    schedule_callbacks (connection, signal_data_index, message, sender);
 }
 
 /* ---------------------------------------------------------------------------------------------------- */
@@ -4069,6 +4256,10 @@ exported_object_free (ExportedObject *eo)
 
 typedef struct
 {
+  /* Held by the registration, and by each worker thread dispatching method
+   * calls with G_DBUS_REGISTRATION_FLAGS_DISPATCH_IN_THREAD, so that
+   * @user_data outlives the calls in flight. */
+  gatomicrefcount             ref_count;
   ExportedObject *eo;
 
   guint                       id;
@@ -4079,21 +4270,42 @@ typedef struct
   GMainContext               *context;
   gpointer                    user_data;
   GDestroyNotify              user_data_free_func;
+
+  GDBusRegistrationFlags      flags;
+  /* sender -> GQueue* of GDBusMethodInvocation* waiting to be dispatched in
+   * the thread handling the sender's calls, only used with
+   * G_DBUS_REGISTRATION_FLAGS_ORDER_BY_SENDER; protected by the lock
+   */
+  GHashTable                 *map_sender_to_queue;
 } ExportedInterface;
 
-/* called with lock held */
+static ExportedInterface *
+exported_interface_ref (ExportedInterface *ei)
+{
+  g_atomic_ref_count_inc (&ei->ref_count);
+  return ei;
+}
+
+/* May be called by any thread, with or without the lock held */
 static void
-exported_interface_free (ExportedInterface *ei)
+exported_interface_unref (ExportedInterface *ei)
 {
+  if (!g_atomic_ref_count_dec (&ei->ref_count))
+    return;
+
   g_dbus_interface_info_cache_release (ei->interface_info);
   g_dbus_interface_info_unref ((GDBusInterfaceInfo *) ei->interface_info);
 
+  /* always deferred to the registering thread's main context */
   call_destroy_notify (ei->context,
                        ei->user_data_free_func,
                        ei->user_data);
 
   g_main_context_unref (ei->context);
 
+  if (ei->map_sender_to_queue != NULL)
+    g_hash_table_unref (ei->map_sender_to_queue);
+
   g_free (ei->interface_name);
   _g_dbus_interface_vtable_free (ei->vtable);
   g_free (ei);
@@ -4869,7 +5081,8 @@ handle_introspect (GDBusConnection *connection,
   return TRUE;
 }
 
-/* called in thread where object was registered - no locks held */
+/* called in thread where object was registered, or in a worker thread with
+ * G_DBUS_REGISTRATION_FLAGS_DISPATCH_IN_THREAD - no locks held */
 static gboolean
 call_in_idle_cb (gpointer user_data)
 {
@@ -4912,6 +5125,148 @@ call_in_idle_cb (gpointer user_data)
   return FALSE;
 }
 
+typedef struct
+{
+  ExportedInterface     *ei;
+  GDBusMethodInvocation *invocation;
+} CallInThreadData;
+
+static void
+call_in_thread_data_free (CallInThreadData *data)
+{
+  exported_interface_unref (data->ei);
+  g_object_unref (data->invocation);
+  g_free (data);
+}
+
+/* called in worker thread - no locks held */
+static void
+call_in_thread_func (GTask        *task,
+                     gpointer      source_object,
+                     gpointer      task_data,
+                     GCancellable *cancellable)
+{
+  CallInThreadData *data = task_data;
+
+  call_in_idle_cb (data->invocation);
+}
+
+typedef struct
+{
+  GDBusConnection   *connection;
+  ExportedInterface *ei;
+  gchar             *sender;
+} SenderQueueData;
+
+static void
+sender_queue_data_free (SenderQueueData *data)
+{
+  g_object_unref (data->connection);
+  exported_interface_unref (data->ei);
+  g_free (data->sender);
+  g_free (data);
+}
+
+/* called in worker thread - no locks held
+ *
+ * Dispatches the calls queued for a sender one after another, until its queue
+ * runs empty. Calls arriving meanwhile are appended to the queue, so there is
+ * never more than one thread per sender.
+ */
+static void
+call_in_sender_queue_thread_func (GTask        *task,
+                                  gpointer      source_object,
+                                  gpointer      task_data,
+                                  GCancellable *cancellable)
+{
+  SenderQueueData *data = task_data;
+  GDBusMethodInvocation *invocation;
+
+  while (TRUE)
+    {
+      GQueue *queue;
+
+      CONNECTION_LOCK (data->connection);
+      queue = g_hash_table_lookup (data->ei->map_sender_to_queue, data->sender);
+      invocation = g_queue_pop_head (queue);
+      if (invocation == NULL)
+        g_hash_table_remove (data->ei->map_sender_to_queue, data->sender);
+      CONNECTION_UNLOCK (data->connection);
+
+      if (invocation == NULL)
+        break;
+
+      call_in_idle_cb (invocation);
+      g_object_unref (invocation);
+    }
+}
+
+/* called in GDBusWorker thread with connection's lock held */
+static void
+schedule_method_call_in_thread (GDBusConnection       *connection,
+                                ExportedInterface     *ei,
+                                GDBusMethodInvocation *invocation)
+{
+  GTask *task;
+
+  task = g_task_new (connection, NULL, NULL, NULL);
+  g_task_set_source_tag (task, schedule_method_call_in_thread);
+  g_task_set_name (task, "[gio] D-Bus method call dispatch");
+
+  if (ei->flags & G_DBUS_REGISTRATION_FLAGS_ORDER_BY_SENDER)
+    {
+      const gchar *sender;
+      GQueue *queue;
+
+      /* peer-to-peer connections have no sender */
+      sender = g_dbus_method_invocation_get_sender (invocation);
+      if (sender == NULL)
+        sender = "";
+
+      if (ei->map_sender_to_queue == NULL)
+        ei->map_sender_to_queue = g_hash_table_new_full (g_str_hash,
+                                                         g_str_equal,
+                                                         g_free,
+                                                         (GDestroyNotify) g_queue_free);
+
+      queue = g_hash_table_lookup (ei->map_sender_to_queue, sender);
+      if (queue != NULL)
+        {
+          /* the thread handling the sender's calls will pick it up */
+          g_queue_push_tail (queue, invocation);
+        }
+      else
+        {
+          SenderQueueData *data;
+
+          queue = g_queue_new ();
+          g_queue_push_tail (queue, invocation);
+          g_hash_table_insert (ei->map_sender_to_queue, g_strdup (sender), queue);
+
+          data = g_new0 (SenderQueueData, 1);
+          data->connection = g_object_ref (connection);
+          data->ei = exported_interface_ref (ei);
+          data->sender = g_strdup (sender);
+
+          g_task_set_task_data (task, data, (GDestroyNotify) sender_queue_data_free);
+          g_task_run_in_thread (task, call_in_sender_queue_thread_func);
+        }
+    }
+  else
+    {
+      CallInThreadData *data;
+
+      data = g_new0 (CallInThreadData, 1);
+      data->ei = exported_interface_ref (ei);
+      data->invocation = invocation;
+
+      g_task_set_task_data (task, data, (GDestroyNotify) call_in_thread_data_free);
+      g_task_run_in_thread (task, call_in_thread_func);
+    }
+
+  g_object_unref (task);
+}
+
 /* called in GDBusWorker thread with connection's lock held */
 static void
 schedule_method_call (GDBusConnection            *connection,
@@ -4946,6 +5301,18 @@ schedule_method_call (GDBusConnection            *connection,
   g_object_set_data (G_OBJECT (invocation), "g-dbus-registration-id", GUINT_TO_POINTER (registration_id));
   g_object_set_data (G_OBJECT (invocation), "g-dbus-subtree-registration-id", GUINT_TO_POINTER (subtree_registration_id));
 
+  if (registration_id != 0)
+    {
+      ExportedInterface *ei;
+
+      ei = g_hash_table_lookup (connection->map_id_to_ei, GUINT_TO_POINTER (registration_id));
+      if (ei != NULL && (ei->flags & G_DBUS_REGISTRATION_FLAGS_DISPATCH_IN_THREAD))
+        {
+          schedule_method_call_in_thread (connection, ei, invocation);
+          return;
+        }
+    }
+
   idle_source = g_idle_source_new ();
   g_source_set_priority (idle_source, G_PRIORITY_DEFAULT);
   g_source_set_callback (idle_source,
@@ -5180,6 +5547,59 @@ g_dbus_connection_register_object (GDBusConnection             *connection,
                                    gpointer                     user_data,
                                    GDestroyNotify               user_data_free_func,
                                    GError                     **error)
+{
+  return g_dbus_connection_register_object_with_flags (connection,
+                                                       object_path,
+                                                       interface_info,
+                                                       vtable,
+                                                       G_DBUS_REGISTRATION_FLAGS_NONE,
+                                                       user_data,
+                                                       user_data_free_func,
+                                                       error);
+}
+
+/**
+ * g_dbus_connection_register_object_with_flags:
+ * @connection: a #GDBusConnection
+ * @object_path: the object path to register at
+ * @interface_info: introspection data for the interface
+ * @vtable: (nullable): a #GDBusInterfaceVTable to call into or %NULL
+ * @flags: flags from the #GDBusRegistrationFlags enumeration
+ * @user_data: (nullable): data to pass to functions in @vtable
+ * @user_data_free_func: function to call when the object path is unregistered
+ * @error: return location for error or %NULL
+ *
+ * Like g_dbus_connection_register_object() but with @flags selecting
+ * where the method_call function of @vtable is called.
+ *
+ * With %G_DBUS_REGISTRATION_FLAGS_DISPATCH_IN_THREAD, method calls are
+ * handed to the #GTask thread pool as they arrive, so that a slow call
+ * does not hold up the others. The method_call function must then be
+ * thread-safe, and may be called concurrently for several calls. Add
+ * %G_DBUS_REGISTRATION_FLAGS_ORDER_BY_SENDER if the calls of each sender
+ * must be handled one after another, in the order they were sent.
+ *
+ * The get_property and set_property functions of @vtable, and
+ * @user_data_free_func, are still called in the
+ * [thread-default main context][g-main-context-push-thread-default]
+ * of the thread you are calling this method from. If the object is
+ * unregistered while method calls are running in worker threads,
+ * @user_data_free_func is only called once they have all returned.
+ *
+ * Returns: 0 if @error is set, otherwise a registration id (never 0)
+ *     that can be used with g_dbus_connection_unregister_object()
+ *
+ * Since: 2.68
+ */
+guint
+g_dbus_connection_register_object_with_flags (GDBusConnection             *connection,
+                                              const gchar                 *object_path,
+                                              GDBusInterfaceInfo          *interface_info,
+                                              const GDBusInterfaceVTable  *vtable,
+                                              GDBusRegistrationFlags       flags,
+                                              gpointer                     user_data,
+                                              GDestroyNotify               user_data_free_func,
+                                              GError                     **error)
 {
   ExportedObject *eo;
   ExportedInterface *ei;
@@ -5205,7 +5625,7 @@ g_dbus_connection_register_object (GDBusConnection             *connection,
       eo->map_if_name_to_ei = g_hash_table_new_full (g_str_hash,
                                                      g_str_equal,
                                                      NULL,
-                                                     (GDestroyNotify) exported_interface_free);
+                                                     (GDestroyNotify) exported_interface_unref);
       g_hash_table_insert (connection->map_object_path_to_eo, eo->object_path, eo);
     }
 
@@ -5222,6 +5642,7 @@ g_dbus_connection_register_object (GDBusConnection             *connection,
     }
 
   ei = g_new0 (ExportedInterface, 1);
+  g_atomic_ref_count_init (&ei->ref_count);
   ei->id = (guint) g_atomic_int_add (&_global_registration_id, 1); /* TODO: overflow etc. */
   ei->eo = eo;
   ei->user_data = user_data;
@@ -5231,6 +5652,7 @@ g_dbus_connection_register_object (GDBusConnection             *connection,
   g_dbus_interface_info_cache_build (ei->interface_info);
   ei->interface_name = g_strdup (interface_info->name);
   ei->context = g_main_context_ref_thread_default ();
+  ei->flags = flags;
 
   g_hash_table_insert (eo->map_if_name_to_ei,
                        (gpointer) ei->interface_name,
@@ -411,6 +411,17 @@ guint            g_dbus_connection_register_object_with_closures (GDBusConnectio
                                                                   GClosure                *get_property_closure,
                                                                   GClosure                *set_property_closure,
                                                                   GError                 **error);
+G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+GLIB_AVAILABLE_IN_2_68
+guint            g_dbus_connection_register_object_with_flags (GDBusConnection            *connection,
+                                                               const gchar                *object_path,
+                                                               GDBusInterfaceInfo         *interface_info,
+                                                               const GDBusInterfaceVTable *vtable,
+                                                               GDBusRegistrationFlags      flags,
+                                                               gpointer                    user_data,
+                                                               GDestroyNotify              user_data_free_func,
+                                                               GError                    **error);
+G_GNUC_END_IGNORE_DEPRECATIONS
 GLIB_AVAILABLE_IN_ALL
 gboolean         g_dbus_connection_unregister_object          (GDBusConnection            *connection,
                                                                guint                       registration_id);
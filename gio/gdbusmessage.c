@@ -51,6 +51,7 @@
 #include "gseekable.h"
 #include "gioerror.h"
 #include "gdbusprivate.h"
+#include "glib-private.h"
 
 #ifdef G_OS_UNIX
 #include "gunixfdlist.h"
@@ -70,8 +71,22 @@ struct _GMemoryBuffer
   gsize pos;
   gchar *data;
   GDataStreamByteOrder byte_order;
+  GBytes *bytes;  /* (nullable) (owned): a copy of @data, when reading */
 };
 
+/* Returns a #GBytes for @len bytes of the buffer at @offset. They are
+ * all backed by a single copy of the buffer, made on first use, so that
+ * values parsed from it don't need a copy (and allocation) each. */
+static GBytes *
+g_memory_buffer_slice (GMemoryBuffer  *mbuf,
+                       gsize           offset,
+                       gsize           len)
+{
+  if (mbuf->bytes == NULL)
+    mbuf->bytes = g_bytes_new (mbuf->data, mbuf->valid_len);
+  return g_bytes_new_from_bytes (mbuf->bytes, offset, len);
+}
+
 static gboolean
 g_memory_buffer_is_byteswapped (GMemoryBuffer *mbuf)
 {
@@ -1437,6 +1452,118 @@ read_bytes (GMemoryBuffer  *mbuf,
   return result;
 }
 
+/* Returns a new floating #GVariant of @type for the string @str, which
+ * was returned by read_string(). On the wire, a string is followed by a
+ * nul byte, just like in the GVariant serialisation, so the string is
+ * used where it is instead of being copied. */
+static GVariant *
+new_string_from_blob (GMemoryBuffer       *mbuf,
+                      const GVariantType  *type,
+                      const gchar         *str)
+{
+  GBytes *bytes;
+  GVariant *ret;
+
+  /* read_string() only validates up to the first nul, so cut the string
+   * there like g_variant_new_string() would */
+  bytes = g_memory_buffer_slice (mbuf, str - mbuf->data, strlen (str) + 1);
+  ret = g_variant_new_from_bytes (type, bytes, TRUE);
+  g_bytes_unref (bytes);
+
+  return ret;
+}
+
+/* Returns the size of a tuple of @type if it is made only of fixed size
+ * basic types, and laid out the same in the D-Bus wire format as in the
+ * GVariant serialisation, or 0 otherwise. */
+static gsize
+get_tuple_fixed_size (const GVariantType *type)
+{
+  const GVariantType *member_type;
+  gsize size = 0;
+  guint alignment = 1;
+
+  for (member_type = g_variant_type_first (type);
+       member_type != NULL;
+       member_type = g_variant_type_next (member_type))
+    {
+      guint member_size = get_type_fixed_size (member_type);
+
+      if (member_size == 0)
+        return 0;
+
+      size = ((size + member_size - 1) / member_size) * member_size;
+      size += member_size;
+      alignment = MAX (alignment, member_size);
+    }
+
+  /* GVariant pads the end of the tuple to its alignment, D-Bus doesn't */
+  if (size % alignment != 0)
+    return 0;
+
+  return size;
+}
+
+static GVariant *parse_value_from_blob (GMemoryBuffer       *buf,
+                                        const GVariantType  *type,
+                                        guint                max_depth,
+                                        gboolean             just_align,
+                                        guint                indent,
+                                        GError             **error);
+
+/* Reads the signature and value of a variant, and returns the value
+ * (not wrapped in a variant) as a non-floating GVariant.
+ * @max_depth is the one of the variant itself. */
+static GVariant *
+parse_variant_value_from_blob (GMemoryBuffer  *buf,
+                               guint           max_depth,
+                               guint           indent,
+                               GError        **error)
+{
+  guchar siglen;
+  const gchar *sig;
+
+  siglen = g_memory_buffer_read_byte (buf);
+  sig = read_string (buf, (gsize) siglen, error);
+  if (sig == NULL)
+    return NULL;
+  if (!g_variant_is_signature (sig) ||
+      !g_variant_type_string_is_valid (sig))
+    {
+      /* A D-Bus signature can contain zero or more complete types,
+       * but a GVariant has to be exactly one complete type. */
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_INVALID_ARGUMENT,
+                   _("Parsed value “%s” for variant is not a valid D-Bus signature"),
+                   sig);
+      return NULL;
+    }
+
+  if (max_depth <= g_variant_type_string_get_depth_ (sig))
+    {
+      /* Catch the type nesting being too deep without having to
+       * parse the data. We don’t have to check this for static
+       * container types (like arrays and tuples) because
+       * the g_variant_type_string_is_valid() check performed before
+       * the initial parse_value_from_blob() call should check the
+       * static type nesting. */
+      g_set_error_literal (error,
+                           G_IO_ERROR,
+                           G_IO_ERROR_INVALID_ARGUMENT,
+                           _("Value nested too deeply"));
+      return NULL;
+    }
+
+  /* The signature was just validated, and stays around while parsing */
+  return parse_value_from_blob (buf,
+                                G_VARIANT_TYPE (sig),
+                                max_depth - 1,
+                                FALSE,
+                                indent + 2,
+                                error);
+}
+
 /* if just_align==TRUE, don't read a value, just align the input stream wrt padding */
 
 /* returns a non-floating GVariant! */
@@ -1587,7 +1714,7 @@ parse_value_from_blob (GMemoryBuffer       *buf,
           v = read_string (buf, (gsize) len, &local_error);
           if (v == NULL)
             goto fail;
-          ret = g_variant_new_string (v);
+          ret = new_string_from_blob (buf, type, v);
         }
       break;
 
@@ -1610,7 +1737,7 @@ parse_value_from_blob (GMemoryBuffer       *buf,
                            v);
               goto fail;
             }
-          ret = g_variant_new_object_path (v);
+          ret = new_string_from_blob (buf, type, v);
         }
       break;
 
@@ -1632,7 +1759,7 @@ parse_value_from_blob (GMemoryBuffer       *buf,
                        v);
               goto fail;
             }
-          ret = g_variant_new_signature (v);
+          ret = new_string_from_blob (buf, type, v);
         }
       break;
 
@@ -1717,14 +1844,25 @@ parse_value_from_blob (GMemoryBuffer       *buf,
               if (array_data == NULL)
                 goto fail;
 
-              ret = g_variant_new_fixed_array (element_type, array_data, array_len / fixed_size, fixed_size);
-
               if (g_memory_buffer_is_byteswapped (buf))
                 {
-                  GVariant *tmp = g_variant_ref_sink (ret);
+                  GVariant *tmp;
+
+                  tmp = g_variant_new_fixed_array (element_type, array_data, array_len / fixed_size, fixed_size);
+                  g_variant_ref_sink (tmp);
                   ret = g_variant_byteswap (tmp);
                   g_variant_unref (tmp);
                 }
+              else
+                {
+                  GBytes *bytes;
+
+                  /* The elements are laid out like in the GVariant
+                   * serialisation, so use them where they are */
+                  bytes = g_memory_buffer_slice (buf, buf->pos - array_len, array_len);
+                  ret = g_variant_new_from_bytes (type, bytes, TRUE);
+                  g_bytes_unref (bytes);
+                }
             }
           else
             {
@@ -1864,51 +2002,12 @@ parse_value_from_blob (GMemoryBuffer       *buf,
 
           if (!just_align)
             {
-              guchar siglen;
-              const gchar *sig;
-              GVariantType *variant_type;
               GVariant *value;
 
-              siglen = g_memory_buffer_read_byte (buf);
-              sig = read_string (buf, (gsize) siglen, &local_error);
-              if (sig == NULL)
-                goto fail;
-              if (!g_variant_is_signature (sig) ||
-                  !g_variant_type_string_is_valid (sig))
-                {
-                  /* A D-Bus signature can contain zero or more complete types,
-                   * but a GVariant has to be exactly one complete type. */
-                  g_set_error (&local_error,
-                               G_IO_ERROR,
-                               G_IO_ERROR_INVALID_ARGUMENT,
-                               _("Parsed value “%s” for variant is not a valid D-Bus signature"),
-                               sig);
-                  goto fail;
-                }
-
-              if (max_depth <= g_variant_type_string_get_depth_ (sig))
-                {
-                  /* Catch the type nesting being too deep without having to
-                   * parse the data. We don’t have to check this for static
-                   * container types (like arrays and tuples, above) because
-                   * the g_variant_type_string_is_valid() check performed before
-                   * the initial parse_value_from_blob() call should check the
-                   * static type nesting. */
-                  g_set_error_literal (&local_error,
-                                       G_IO_ERROR,
-                                       G_IO_ERROR_INVALID_ARGUMENT,
-                                       _("Value nested too deeply"));
-                  goto fail;
-                }
-
-              variant_type = g_variant_type_new (sig);
-              value = parse_value_from_blob (buf,
-                                             variant_type,
-                                             max_depth - 1,
-                                             FALSE,
-                                             indent + 2,
-                                             &local_error);
-              g_variant_type_free (variant_type);
+              value = parse_variant_value_from_blob (buf,
+                                                     max_depth,
+                                                     indent,
+                                                     &local_error);
               if (value == NULL)
                 goto fail;
               ret = g_variant_new_variant (value);
@@ -1970,6 +2069,59 @@ parse_value_from_blob (GMemoryBuffer       *buf,
   return NULL;
 }
 
+/* Reads the header fields, an a{yv}, straight into @message without
+ * building the array and its dict entries first */
+static gboolean
+parse_headers_from_blob (GMemoryBuffer  *buf,
+                         GDBusMessage   *message,
+                         GError        **error)
+{
+  guint32 array_len;
+  gsize target;
+
+  ensure_input_padding (buf, 4);
+  array_len = g_memory_buffer_read_uint32 (buf);
+
+#ifdef DEBUG_SERIALIZER
+  g_print ("  header fields span 0x%04x bytes\n", array_len);
+#endif /* DEBUG_SERIALIZER */
+
+  if (array_len > (2<<26))
+    {
+      /* G_GUINT32_FORMAT doesn't work with gettext, so use u */
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_INVALID_ARGUMENT,
+                   g_dngettext (GETTEXT_PACKAGE,
+                                "Encountered array of length %u byte. Maximum length is 2<<26 bytes (64 MiB).",
+                                "Encountered array of length %u bytes. Maximum length is 2<<26 bytes (64 MiB).",
+                                array_len),
+                   array_len);
+      return FALSE;
+    }
+
+  ensure_input_padding (buf, 8);
+  target = buf->pos + array_len;
+  while (buf->pos < target)
+    {
+      guchar header_field;
+      GVariant *value;
+
+      ensure_input_padding (buf, 8);
+      header_field = g_memory_buffer_read_byte (buf);
+      value = parse_variant_value_from_blob (buf,
+                                             G_DBUS_MAX_TYPE_DEPTH,
+                                             4,
+                                             error);
+      if (value == NULL)
+        return FALSE;
+      g_dbus_message_set_header (message, header_field, value);
+      g_variant_unref (value);
+    }
+
+  return TRUE;
+}
+
 /* ---------------------------------------------------------------------------------------------------- */
 
 /* message_header must be at least 16 bytes */
@@ -2073,9 +2225,6 @@ g_dbus_message_new_from_blob (guchar                *blob,
   guchar endianness;
   guchar major_protocol_version;
   guint32 message_body_len;
-  GVariant *headers;
-  GVariant *item;
-  GVariantIter iter;
   GVariant *signature;
 
   /* TODO: check against @capabilities */
@@ -2140,28 +2289,8 @@ g_dbus_message_new_from_blob (guchar                *blob,
 #ifdef DEBUG_SERIALIZER
   g_print ("Parsing headers (blob_len = 0x%04x bytes)\n", (gint) blob_len);
 #endif /* DEBUG_SERIALIZER */
-  headers = parse_value_from_blob (&mbuf,
-                                   G_VARIANT_TYPE ("a{yv}"),
-                                   G_DBUS_MAX_TYPE_DEPTH + 2 /* for the a{yv} */,
-                                   FALSE,
-                                   2,
-                                   error);
-  if (headers == NULL)
+  if (!parse_headers_from_blob (&mbuf, message, error))
     goto out;
-  g_variant_iter_init (&iter, headers);
-  while ((item = g_variant_iter_next_value (&iter)) != NULL)
-    {
-      guchar header_field;
-      GVariant *value;
-      g_variant_get (item,
-                     "{yv}",
-                     &header_field,
-                     &value);
-      g_dbus_message_set_header (message, header_field, value);
-      g_variant_unref (value);
-      g_variant_unref (item);
-    }
-  g_variant_unref (headers);
 
   signature = g_dbus_message_get_header (message, G_DBUS_MESSAGE_HEADER_FIELD_SIGNATURE);
   if (signature != NULL)
@@ -2193,6 +2322,7 @@ g_dbus_message_new_from_blob (guchar                *blob,
       else if (signature_str_len > 0)
         {
           GVariantType *variant_type;
+          gsize fixed_size;
           gchar *tupled_signature_str = g_strdup_printf ("(%s)", signature_str);
 
           if (!g_variant_is_signature (signature_str) ||
@@ -2212,12 +2342,32 @@ g_dbus_message_new_from_blob (guchar                *blob,
 #ifdef DEBUG_SERIALIZER
           g_print ("Parsing body (blob_len = 0x%04x bytes)\n", (gint) blob_len);
 #endif /* DEBUG_SERIALIZER */
-          message->body = parse_value_from_blob (&mbuf,
-                                                 variant_type,
-                                                 G_DBUS_MAX_TYPE_DEPTH + 1 /* for the surrounding tuple */,
-                                                 FALSE,
-                                                 2,
-                                                 error);
+          fixed_size = get_tuple_fixed_size (variant_type);
+          ensure_input_padding (&mbuf, 8);
+
+          if (fixed_size != 0 && fixed_size == message_body_len &&
+              !g_memory_buffer_is_byteswapped (&mbuf))
+            {
+              /* The whole body is laid out like in the GVariant
+               * serialisation, so it can be used where it is */
+              if (read_bytes (&mbuf, fixed_size, error) != NULL)
+                {
+                  GBytes *bytes;
+
+                  bytes = g_memory_buffer_slice (&mbuf, mbuf.pos - fixed_size, fixed_size);
+                  message->body = g_variant_ref_sink (g_variant_new_from_bytes (variant_type, bytes, TRUE));
+                  g_bytes_unref (bytes);
+                }
+            }
+          else
+            {
+              message->body = parse_value_from_blob (&mbuf,
+                                                     variant_type,
+                                                     G_DBUS_MAX_TYPE_DEPTH + 1 /* for the surrounding tuple */,
+                                                     FALSE,
+                                                     2,
+                                                     error);
+            }
           g_variant_type_free (variant_type);
           if (message->body == NULL)
             goto out;
@@ -2250,6 +2400,8 @@ g_dbus_message_new_from_blob (guchar                *blob,
   ret = TRUE;
 
  out:
+  g_clear_pointer (&mbuf.bytes, g_bytes_unref);
+
   if (ret)
     {
       return message;
@@ -2283,6 +2435,378 @@ ensure_output_padding (GMemoryBuffer  *mbuf,
   return padding_needed;
 }
 
+/* Alignment of @type in the D-Bus wire format */
+static guint
+get_type_wire_alignment (const GVariantType *type)
+{
+  switch (*g_variant_type_peek_string (type))
+    {
+    case 'n': case 'q':
+      return 2;
+    case 'b': case 'i': case 'u': case 'h': case 's': case 'o': case 'a':
+      return 4;
+    case 'x': case 't': case 'd': case '(': case '{':
+      return 8;
+    default:
+      return 1;
+    }
+}
+
+/* Alignment and fixed size (or 0 if not fixed) of @type in the GVariant
+ * serialisation, as in gvarianttypeinfo.c */
+static void
+get_type_serialised_info (const GVariantType *type,
+                          gsize              *alignment,
+                          gsize              *fixed_size)
+{
+  const GVariantType *member_type;
+  gsize member_alignment;
+  gsize member_fixed_size;
+  gsize size;
+
+  switch (*g_variant_type_peek_string (type))
+    {
+    case 'b': case 'y':
+      *alignment = *fixed_size = 1;
+      break;
+    case 'n': case 'q':
+      *alignment = *fixed_size = 2;
+      break;
+    case 'i': case 'u': case 'h':
+      *alignment = *fixed_size = 4;
+      break;
+    case 'x': case 't': case 'd':
+      *alignment = *fixed_size = 8;
+      break;
+    case 'v':
+      *alignment = 8;
+      *fixed_size = 0;
+      break;
+    case 'a': case 'm':
+      get_type_serialised_info (g_variant_type_element (type), alignment, &member_fixed_size);
+      *fixed_size = 0;
+      break;
+    case '(': case '{':
+      *alignment = 1;
+      size = 0;
+      for (member_type = g_variant_type_first (type);
+           member_type != NULL;
+           member_type = g_variant_type_next (member_type))
+        {
+          get_type_serialised_info (member_type, &member_alignment, &member_fixed_size);
+          *alignment = MAX (*alignment, member_alignment);
+          if (member_fixed_size == 0 || size == G_MAXSIZE)
+            size = G_MAXSIZE;
+          else
+            size = ((size + member_alignment - 1) / member_alignment) * member_alignment + member_fixed_size;
+        }
+      if (size == G_MAXSIZE)
+        *fixed_size = 0;
+      else if (size == 0)
+        *fixed_size = 1;  /* the unit tuple */
+      else
+        *fixed_size = ((size + *alignment - 1) / *alignment) * *alignment;
+      break;
+    default:
+      *alignment = 1;
+      *fixed_size = 0;
+      break;
+    }
+}
+
+/* Framing offsets in a serialised container of @size bytes */
+static gsize
+get_serialised_offset_size (gsize size)
+{
+  if (size > G_MAXUINT32)
+    return 8;
+  else if (size > G_MAXUINT16)
+    return 4;
+  else if (size > G_MAXUINT8)
+    return 2;
+  else
+    return 1;
+}
+
+static gsize
+read_serialised_offset (const guchar *data,
+                        gsize         offset_size)
+{
+  guint64 offset = 0;
+
+  memcpy (&offset, data, offset_size);
+  return GUINT64_FROM_LE (offset);
+}
+
+/* Like append_value_to_blob(), but for a value of @type in the normal
+ * form of the GVariant serialisation, which it walks directly instead of
+ * through a GVariant for each part. This avoids allocating those, and
+ * lets the parts which are the same in both formats be copied as they
+ * are. */
+static gboolean
+append_serialised_to_blob (const GVariantType  *type,
+                           const guchar        *data,
+                           gsize                size,
+                           GMemoryBuffer       *mbuf,
+                           gsize               *out_padding_added,
+                           GError             **error)
+{
+  gsize padding_added;
+  const gchar *type_string;
+
+  type_string = g_variant_type_peek_string (type);
+
+  padding_added = 0;
+
+  switch (type_string[0])
+    {
+    case 'b': /* G_VARIANT_TYPE_BOOLEAN */
+      padding_added = ensure_output_padding (mbuf, 4);
+      g_memory_buffer_put_uint32 (mbuf, data[0]);
+      break;
+
+    case 'y': /* G_VARIANT_TYPE_BYTE */
+      g_memory_buffer_put_byte (mbuf, data[0]);
+      break;
+
+    case 'n': /* G_VARIANT_TYPE_INT16 */
+    case 'q': /* G_VARIANT_TYPE_UINT16 */
+      {
+        guint16 v;
+
+        padding_added = ensure_output_padding (mbuf, 2);
+        memcpy (&v, data, 2);
+        g_memory_buffer_put_uint16 (mbuf, v);
+      }
+      break;
+
+    case 'i': /* G_VARIANT_TYPE_INT32 */
+    case 'u': /* G_VARIANT_TYPE_UINT32 */
+    case 'h': /* G_VARIANT_TYPE_HANDLE */
+      {
+        guint32 v;
+
+        padding_added = ensure_output_padding (mbuf, 4);
+        memcpy (&v, data, 4);
+        g_memory_buffer_put_uint32 (mbuf, v);
+      }
+      break;
+
+    case 'x': /* G_VARIANT_TYPE_INT64 */
+    case 't': /* G_VARIANT_TYPE_UINT64 */
+    case 'd': /* G_VARIANT_TYPE_DOUBLE */
+      {
+        guint64 v;
+
+        padding_added = ensure_output_padding (mbuf, 8);
+        memcpy (&v, data, 8);
+        g_memory_buffer_put_uint64 (mbuf, v);
+      }
+      break;
+
+    case 's': /* G_VARIANT_TYPE_STRING */
+    case 'o': /* G_VARIANT_TYPE_OBJECT_PATH */
+      /* Both formats have the string followed by a nul */
+      padding_added = ensure_output_padding (mbuf, 4);
+      g_memory_buffer_put_uint32 (mbuf, size - 1);
+      g_memory_buffer_write (mbuf, data, size);
+      break;
+
+    case 'g': /* G_VARIANT_TYPE_SIGNATURE */
+      g_memory_buffer_put_byte (mbuf, size - 1);
+      g_memory_buffer_write (mbuf, data, size);
+      break;
+
+    case 'a': /* G_VARIANT_TYPE_ARRAY */
+      {
+        const GVariantType *element_type;
+        gsize element_alignment;
+        gsize element_fixed_size;
+        goffset array_len_offset;
+        goffset array_payload_begin_offset;
+        goffset cur_offset;
+        gsize i;
+
+        padding_added = ensure_output_padding (mbuf, 4);
+
+        /* array length - will be filled in later */
+        array_len_offset = mbuf->valid_len;
+        g_memory_buffer_put_uint32 (mbuf, 0xF00DFACE);
+
+        /* The array length doesn't include the padding before the first
+         * element, which is there even if there are no elements */
+        element_type = g_variant_type_element (type);
+        ensure_output_padding (mbuf, get_type_wire_alignment (element_type));
+        array_payload_begin_offset = mbuf->valid_len;
+
+        get_type_serialised_info (element_type, &element_alignment, &element_fixed_size);
+
+        if (element_fixed_size != 0)
+          {
+            gboolean same_layout = FALSE;
+
+            /* Fixed size basic types are packed the same way in both
+             * formats, and so are tuples of them if there is no padding
+             * between the elements in either one */
+            if (!g_memory_buffer_is_byteswapped (mbuf))
+              {
+                if (get_type_fixed_size (element_type) != 0)
+                  same_layout = TRUE;
+                else if (g_variant_type_is_tuple (element_type) ||
+                         g_variant_type_is_dict_entry (element_type))
+                  same_layout = element_fixed_size % 8 == 0 &&
+                                get_tuple_fixed_size (element_type) == element_fixed_size;
+              }
+
+            if (same_layout)
+              {
+                g_memory_buffer_write (mbuf, data, size);
+              }
+            else
+              {
+                for (i = 0; i < size / element_fixed_size; i++)
+                  {
+                    if (!append_serialised_to_blob (element_type,
+                                                    data + i * element_fixed_size,
+                                                    element_fixed_size,
+                                                    mbuf,
+                                                    NULL,
+                                                    error))
+                      goto fail;
+                  }
+              }
+          }
+        else if (size > 0)
+          {
+            gsize offset_size;
+            gsize offsets_start;
+            gsize start;
+
+            /* Each element is followed by its end in a table of framing
+             * offsets at the end of the array */
+            offset_size = get_serialised_offset_size (size);
+            offsets_start = read_serialised_offset (data + size - offset_size, offset_size);
+
+            start = 0;
+            for (i = offsets_start; i < size; i += offset_size)
+              {
+                gsize end = read_serialised_offset (data + i, offset_size);
+
+                if (!append_serialised_to_blob (element_type,
+                                                data + start,
+                                                end - start,
+                                                mbuf,
+                                                NULL,
+                                                error))
+                  goto fail;
+
+                start = ((end + element_alignment - 1) / element_alignment) * element_alignment;
+              }
+          }
+
+        cur_offset = mbuf->valid_len;
+        mbuf->pos = array_len_offset;
+        g_memory_buffer_put_uint32 (mbuf, cur_offset - array_payload_begin_offset);
+        mbuf->pos = cur_offset;
+      }
+      break;
+
+    default:
+      if (g_variant_type_is_dict_entry (type) || g_variant_type_is_tuple (type))
+        {
+          const GVariantType *member_type;
+          gsize offset_size;
+          gsize offsets_end;
+          gsize start;
+
+          padding_added = ensure_output_padding (mbuf, 8);
+
+          /* The ends of the variable size members, except the last one,
+           * are stored backwards from the end of the tuple */
+          offset_size = get_serialised_offset_size (size);
+          offsets_end = size;
+          start = 0;
+
+          for (member_type = g_variant_type_first (type);
+               member_type != NULL;
+               member_type = g_variant_type_next (member_type))
+            {
+              gsize member_alignment;
+              gsize member_fixed_size;
+              gsize end;
+
+              get_type_serialised_info (member_type, &member_alignment, &member_fixed_size);
+              start = ((start + member_alignment - 1) / member_alignment) * member_alignment;
+
+              if (member_fixed_size != 0)
+                {
+                  end = start + member_fixed_size;
+                }
+              else if (g_variant_type_next (member_type) == NULL)
+                {
+                  end = offsets_end;
+                }
+              else
+                {
+                  offsets_end -= offset_size;
+                  end = read_serialised_offset (data + offsets_end, offset_size);
+                }
+
+              if (!append_serialised_to_blob (member_type,
+                                              data + start,
+                                              end - start,
+                                              mbuf,
+                                              NULL,
+                                              error))
+                goto fail;
+
+              start = end;
+            }
+        }
+      else if (g_variant_type_is_variant (type))
+        {
+          gsize separator;
+
+          /* The value is followed by a nul and then its type string */
+          separator = size - 1;
+          while (data[separator] != '\0')
+            separator--;
+
+          g_memory_buffer_put_byte (mbuf, size - separator - 1);
+          g_memory_buffer_write (mbuf, data + separator + 1, size - separator - 1);
+          g_memory_buffer_put_byte (mbuf, '\0');
+          if (!append_serialised_to_blob ((const GVariantType *) (data + separator + 1),
+                                          data,
+                                          separator,
+                                          mbuf,
+                                          NULL,
+                                          error))
+            goto fail;
+        }
+      else
+        {
+          gchar *type_str = g_variant_type_dup_string (type);
+
+          g_set_error (error,
+                       G_IO_ERROR,
+                       G_IO_ERROR_INVALID_ARGUMENT,
+                       _("Error serializing GVariant with type string “%s” to the D-Bus wire format"),
+                       type_str);
+          g_free (type_str);
+          goto fail;
+        }
+      break;
+    }
+
+  if (out_padding_added != NULL)
+    *out_padding_added = padding_added;
+
+  return TRUE;
+
+ fail:
+  return FALSE;
+}
+
 /* note that value can be NULL for e.g. empty arrays - type is never NULL */
 static gboolean
 append_value_to_blob (GVariant            *value,
@@ -2294,6 +2818,20 @@ append_value_to_blob (GVariant            *value,
   gsize padding_added;
   const gchar *type_string;
 
+  /* Serialised values in normal form (which includes all trusted ones)
+   * can be walked directly, without further checks. Values in tree form
+   * are walked below instead, since serialising them first would cost
+   * more than it saves. */
+  if (value != NULL &&
+      GLIB_PRIVATE_CALL (g_variant_is_serialised) (value) &&
+      g_variant_is_normal_form (value))
+    return append_serialised_to_blob (type,
+                                      g_variant_get_data (value),
+                                      g_variant_get_size (value),
+                                      mbuf,
+                                      out_padding_added,
+                                      error);
+
   type_string = g_variant_type_peek_string (type);
 
   padding_added = 0;
@@ -2608,9 +3146,6 @@ append_body_to_blob (GVariant       *value,
                      GMemoryBuffer  *mbuf,
                      GError        **error)
 {
-  GVariant *item;
-  GVariantIter iter;
-
   if (!g_variant_is_of_type (value, G_VARIANT_TYPE_TUPLE))
     {
       g_set_error (error,
@@ -2620,24 +3155,106 @@ append_body_to_blob (GVariant       *value,
       goto fail;
     }
 
-  g_variant_iter_init (&iter, value);
-  while ((item = g_variant_iter_next_value (&iter)) != NULL)
+  /* The body starts aligned to 8 bytes, so it is written just like the
+   * tuple itself */
+  if (!append_value_to_blob (value,
+                             g_variant_get_type (value),
+                             mbuf,
+                             NULL,
+                             error))
+    goto fail;
+
+  return TRUE;
+
+ fail:
+  return FALSE;
+}
+
+/* Writes the header fields as an a{yv}, straight from the header table */
+static gboolean
+append_headers_to_blob (GDBusMessage   *message,
+                        GMemoryBuffer  *mbuf,
+                        GError        **error)
+{
+  GHashTableIter hash_iter;
+  gpointer key;
+  GVariant *header_value;
+  goffset array_len_offset;
+  goffset array_payload_begin_offset;
+  goffset cur_offset;
+
+  ensure_output_padding (mbuf, 4);
+  array_len_offset = mbuf->valid_len;
+  g_memory_buffer_put_uint32 (mbuf, 0xF00DFACE);
+  ensure_output_padding (mbuf, 8);
+  array_payload_begin_offset = mbuf->valid_len;
+
+  g_hash_table_iter_init (&hash_iter, message->headers);
+  while (g_hash_table_iter_next (&hash_iter, &key, (gpointer) &header_value))
     {
-      if (!append_value_to_blob (item,
-                                 g_variant_get_type (item),
+      const gchar *signature;
+
+      ensure_output_padding (mbuf, 8);
+      g_memory_buffer_put_byte (mbuf, (guchar) GPOINTER_TO_UINT (key));
+
+      signature = g_variant_get_type_string (header_value);
+      g_memory_buffer_put_byte (mbuf, strlen (signature));
+      g_memory_buffer_put_string (mbuf, signature);
+      g_memory_buffer_put_byte (mbuf, '\0');
+      if (!append_value_to_blob (header_value,
+                                 g_variant_get_type (header_value),
                                  mbuf,
                                  NULL,
                                  error))
-        {
-          g_variant_unref (item);
-          goto fail;
-        }
-      g_variant_unref (item);
+        return FALSE;
     }
+
+  cur_offset = mbuf->valid_len;
+  mbuf->pos = array_len_offset;
+  g_memory_buffer_put_uint32 (mbuf, cur_offset - array_payload_begin_offset);
+  mbuf->pos = cur_offset;
+
   return TRUE;
+}
 
- fail:
-  return FALSE;
+static gboolean
+append_message_to_blob (GDBusMessage   *message,
+                        GMemoryBuffer  *mbuf,
+                        GError        **error)
+{
+  goffset body_len_offset;
+  goffset body_start_offset;
+  goffset cur_offset;
+
+  /* Core header */
+  g_memory_buffer_put_byte (mbuf, (guchar) message->byte_order);
+  g_memory_buffer_put_byte (mbuf, message->type);
+  g_memory_buffer_put_byte (mbuf, message->flags);
+  g_memory_buffer_put_byte (mbuf, 1); /* major protocol version */
+  body_len_offset = mbuf->valid_len;
+  /* body length - will be filled in later */
+  g_memory_buffer_put_uint32 (mbuf, 0xF00DFACE);
+  g_memory_buffer_put_uint32 (mbuf, message->serial);
+
+  if (!append_headers_to_blob (message, mbuf, error))
+    return FALSE;
+
+  /* header size must be a multiple of 8 */
+  ensure_output_padding (mbuf, 8);
+
+  body_start_offset = mbuf->valid_len;
+
+  if (message->body != NULL &&
+      !append_body_to_blob (message->body, mbuf, error))
+    return FALSE;
+
+  /* OK, we're done writing the message - set the body length */
+  cur_offset = mbuf->valid_len;
+  mbuf->pos = body_len_offset;
+  g_memory_buffer_put_uint32 (mbuf, cur_offset - body_start_offset);
+  mbuf->pos = cur_offset;
+
+  return TRUE;
 }
 
 /* ---------------------------------------------------------------------------------------------------- */
@@ -2666,15 +3283,6 @@ g_dbus_message_to_blob (GDBusMessage          *message,
 {
   GMemoryBuffer mbuf;
   guchar *ret;
-  gsize size;
-  goffset body_len_offset;
-  goffset body_start_offset;
-  gsize body_size;
-  GVariant *header_fields;
-  GVariantBuilder builder;
-  GHashTableIter hash_iter;
-  gpointer key;
-  GVariant *header_value;
   GVariant *signature;
   const gchar *signature_str;
   gint num_fds_in_message;
@@ -2689,8 +3297,6 @@ g_dbus_message_to_blob (GDBusMessage          *message,
   g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
   memset (&mbuf, 0, sizeof (mbuf));
-  mbuf.len = MIN_ARRAY_SIZE;
-  mbuf.data = g_malloc (mbuf.len);
 
   mbuf.byte_order = G_DATA_STREAM_BYTE_ORDER_HOST_ENDIAN;
   switch (message->byte_order)
@@ -2703,16 +3309,6 @@ g_dbus_message_to_blob (GDBusMessage          *message,
       break;
     }
 
-  /* Core header */
-  g_memory_buffer_put_byte (&mbuf, (guchar) message->byte_order);
-  g_memory_buffer_put_byte (&mbuf, message->type);
-  g_memory_buffer_put_byte (&mbuf, message->flags);
-  g_memory_buffer_put_byte (&mbuf, 1); /* major protocol version */
-  body_len_offset = mbuf.valid_len;
-  /* body length - will be filled in later */
-  g_memory_buffer_put_uint32 (&mbuf, 0xF00DFACE);
-  g_memory_buffer_put_uint32 (&mbuf, message->serial);
-
   num_fds_in_message = 0;
 #ifdef G_OS_UNIX
   if (message->fd_list != NULL)
@@ -2736,33 +3332,6 @@ g_dbus_message_to_blob (GDBusMessage          *message,
       goto out;
     }
 
-  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{yv}"));
-  g_hash_table_iter_init (&hash_iter, message->headers);
-  while (g_hash_table_iter_next (&hash_iter, &key, (gpointer) &header_value))
-    {
-      g_variant_builder_add (&builder,
-                             "{yv}",
-                             (guchar) GPOINTER_TO_UINT (key),
-                             header_value);
-    }
-  header_fields = g_variant_builder_end (&builder);
-
-  if (!append_value_to_blob (header_fields,
-                             g_variant_get_type (header_fields),
-                             &mbuf,
-                             NULL,
-                             error))
-    {
-      g_variant_unref (header_fields);
-      goto out;
-    }
-  g_variant_unref (header_fields);
-
-  /* header size must be a multiple of 8 */
-  ensure_output_padding (&mbuf, 8);
-
-  body_start_offset = mbuf.valid_len;
-
   signature = g_dbus_message_get_header (message, G_DBUS_MESSAGE_HEADER_FIELD_SIGNATURE);
 
   if (signature != NULL && !g_variant_is_of_type (signature, G_VARIANT_TYPE_SIGNATURE))
@@ -2801,8 +3370,6 @@ g_dbus_message_to_blob (GDBusMessage          *message,
           goto out;
         }
       g_free (tupled_signature_str);
-      if (!append_body_to_blob (message->body, &mbuf, error))
-        goto out;
     }
   else
     {
@@ -2817,15 +3384,23 @@ g_dbus_message_to_blob (GDBusMessage          *message,
         }
     }
 
-  /* OK, we're done writing the message - set the body length */
-  size = mbuf.valid_len;
-  body_size = size - body_start_offset;
-
-  mbuf.pos = body_len_offset;
+  /* Size the blob up front so that it is rarely reallocated: the body
+   * takes about as much space on the wire as serialised by GVariant
+   * (which caches that size), plus lengths and padding instead of the
+   * framing offsets. Measuring it exactly would take another pass over
+   * the whole body, which costs more than the occasional realloc. */
+  mbuf.len = MIN_ARRAY_SIZE;
+  if (message->body != NULL)
+    {
+      gsize body_size = g_variant_get_size (message->body);
+      mbuf.len += body_size + body_size / 4;
+    }
+  mbuf.data = g_malloc (mbuf.len);
 
-  g_memory_buffer_put_uint32 (&mbuf, body_size);
+  if (!append_message_to_blob (message, &mbuf, error))
+    goto out;
 
-  *out_size = size;
+  *out_size = mbuf.valid_len;
   ret = (guchar *)mbuf.data;
 
  out:
@@ -332,6 +332,9 @@ _g_dbus_shared_thread_unref (SharedThreadData *data)
 
 /* ---------------------------------------------------------------------------------------------------- */
 
+/* Upper bound on the number of queued messages written out at once */
+#define MAX_MESSAGES_PER_WRITE 64
+
 typedef enum {
     PENDING_NONE = 0,
     PENDING_WRITE,
@@ -388,6 +391,15 @@ struct GDBusWorker
   GQueue                             *write_queue;
   /* protected by write_lock */
   guint64                             write_num_messages_written;
+  /* number of messages in the write that is in-flight, if any;
+   * protected by write_lock
+   */
+  guint                               write_num_messages_in_flight;
+  /* no lock - only used from the worker thread; together with
+   * write_num_messages_written, this tells how well messages are
+   * being batched (see G_DBUS_DEBUG=transport)
+   */
+  guint64                             write_num_writes;
   /* number of messages we'd written out last time we flushed;
    * protected by write_lock
    */
@@ -416,13 +428,16 @@ typedef struct
 struct _MessageToWriteData ;
 typedef struct _MessageToWriteData MessageToWriteData;
 
+struct _WriteBatchData ;
+typedef struct _WriteBatchData WriteBatchData;
+
 static void message_to_write_data_free (MessageToWriteData *data);
 
 static void read_message_print_transport_debug (gssize bytes_read,
                                                 GDBusWorker *worker);
 
 static void write_message_print_transport_debug (gssize bytes_written,
-                                                 MessageToWriteData *data);
+                                                 WriteBatchData *batch);
 
 typedef struct {
     GDBusWorker *worker;
@@ -890,7 +905,6 @@ struct _MessageToWriteData
   gsize         blob_size;
 
   gsize         total_written;
-  GTask        *task;
 };
 
 static void
@@ -903,9 +917,106 @@ message_to_write_data_free (MessageToWriteData *data)
   g_slice_free (MessageToWriteData, data);
 }
 
+/* Messages taken off the write queue together, so that a burst of them
+ * can be written out with a single vectored write.
+ */
+struct _WriteBatchData
+{
+  GDBusWorker   *worker;
+  GPtrArray     *messages;  /* (element-type MessageToWriteData) (owned) */
+  guint          n_done;    /* number of @messages written out completely */
+  GOutputVector *vectors;   /* one per message, filled before each write */
+  guint          n_vectors; /* number of @vectors in the current write */
+  GTask         *task;
+};
+
+static WriteBatchData *
+write_batch_data_new (GDBusWorker *worker)
+{
+  WriteBatchData *batch;
+
+  batch = g_slice_new0 (WriteBatchData);
+  batch->worker = _g_dbus_worker_ref (worker);
+  batch->messages = g_ptr_array_new_full (MAX_MESSAGES_PER_WRITE,
+                                          (GDestroyNotify) message_to_write_data_free);
+
+  return batch;
+}
+
+static void
+write_batch_data_free (WriteBatchData *batch)
+{
+  _g_dbus_worker_unref (batch->worker);
+  g_ptr_array_unref (batch->messages);
+  g_free (batch->vectors);
+  g_slice_free (WriteBatchData, batch);
+}
+
+/* Fills @batch->vectors with what remains to be written, stopping before
+ * the next message that carries file descriptors. On a socket, those have
+ * to be sent along with the first byte of that message; other streams
+ * can't send them at all, which only fails once that message gets to the
+ * front, after the ones before it have been written.
+ *
+ * Returns: the number of vectors filled
+ */
+static guint
+write_batch_fill_vectors (WriteBatchData *batch,
+                          gboolean        is_socket)
+{
+  guint n;
+
+  for (n = batch->n_done; n < batch->messages->len; n++)
+    {
+      MessageToWriteData *data = batch->messages->pdata[n];
+      GOutputVector *vector = &batch->vectors[n - batch->n_done];
+
+#ifdef G_OS_UNIX
+      if (n > batch->n_done)
+        {
+          GUnixFDList *fd_list = g_dbus_message_get_unix_fd_list (data->message);
+
+          if (fd_list != NULL && (!is_socket || g_unix_fd_list_get_length (fd_list) > 0))
+            break;
+        }
+#endif
+
+      vector->buffer = data->blob + data->total_written;
+      vector->size = data->blob_size - data->total_written;
+    }
+
+  batch->n_vectors = n - batch->n_done;
+
+  return batch->n_vectors;
+}
+
+/* Returns: %TRUE if all of @batch has been written now */
+static gboolean
+write_batch_advance (WriteBatchData *batch,
+                     gsize           bytes_written)
+{
+  batch->worker->write_num_writes += 1;
+  write_message_print_transport_debug (bytes_written, batch);
+
+  while (bytes_written > 0)
+    {
+      MessageToWriteData *data = batch->messages->pdata[batch->n_done];
+      gsize n;
+
+      n = MIN (bytes_written, data->blob_size - data->total_written);
+      data->total_written += n;
+      bytes_written -= n;
+
+      if (data->total_written == data->blob_size)
+        batch->n_done++;
+    }
+
+  return batch->n_done == batch->messages->len;
+}
+
 /* ---------------------------------------------------------------------------------------------------- */
 
-static void write_message_continue_writing (MessageToWriteData *data);
+static void write_batch_continue_writing (WriteBatchData *batch);
 
 /* called in private thread shared by all GDBusConnection instances
  *
@@ -913,44 +1024,40 @@ static void write_message_continue_writing (MessageToWriteData *data);
  * output_pending is PENDING_WRITE on entry
  */
 static void
-write_message_async_cb (GObject      *source_object,
-                        GAsyncResult *res,
-                        gpointer      user_data)
+write_batch_async_cb (GObject      *source_object,
+                      GAsyncResult *res,
+                      gpointer      user_data)
 {
-  MessageToWriteData *data = user_data;
+  WriteBatchData *batch = user_data;
   GTask *task;
-  gssize bytes_written;
+  gsize bytes_written;
   GError *error;
 
-  /* Note: we can't access data->task after calling g_task_return_* () because the
-   * callback can free @data and we're not completing in idle. So use a copy of the pointer.
+  /* Note: we can't access batch->task after calling g_task_return_* () because the
+   * callback can free @batch and we're not completing in idle. So use a copy of the pointer.
    */
-  task = data->task;
+  task = batch->task;
 
   error = NULL;
-  bytes_written = g_output_stream_write_finish (G_OUTPUT_STREAM (source_object),
-                                                res,
-                                                &error);
-  if (bytes_written == -1)
+  if (!g_output_stream_writev_all_finish (G_OUTPUT_STREAM (source_object),
+                                          res,
+                                          &bytes_written,
+                                          &error))
     {
       g_task_return_error (task, error);
       g_object_unref (task);
       goto out;
     }
-  g_assert (bytes_written > 0); /* zero is never returned */
-
-  write_message_print_transport_debug (bytes_written, data);
+  g_assert (bytes_written > 0);
 
-  data->total_written += bytes_written;
-  g_assert (data->total_written <= data->blob_size);
-  if (data->total_written == data->blob_size)
+  if (write_batch_advance (batch, bytes_written))
     {
       g_task_return_boolean (task, TRUE);
       g_object_unref (task);
       goto out;
     }
 
-  write_message_continue_writing (data);
+  write_batch_continue_writing (batch);
 
  out:
   ;
@@ -967,8 +1074,8 @@ on_socket_ready (GSocket      *socket,
                  GIOCondition  condition,
                  gpointer      user_data)
 {
-  MessageToWriteData *data = user_data;
-  write_message_continue_writing (data);
+  WriteBatchData *batch = user_data;
+  write_batch_continue_writing (batch);
   return FALSE; /* remove source */
 }
 #endif
@@ -979,28 +1086,35 @@ on_socket_ready (GSocket      *socket,
  * output_pending is PENDING_WRITE on entry
  */
 static void
-write_message_continue_writing (MessageToWriteData *data)
+write_batch_continue_writing (WriteBatchData *batch)
 {
   GOutputStream *ostream;
+  MessageToWriteData *data;
+  guint n_vectors;
 #ifdef G_OS_UNIX
   GTask *task;
   GUnixFDList *fd_list;
 #endif
 
 #ifdef G_OS_UNIX
-  /* Note: we can't access data->task after calling g_task_return_* () because the
-   * callback can free @data and we're not completing in idle. So use a copy of the pointer.
+  /* Note: we can't access batch->task after calling g_task_return_* () because the
+   * callback can free @batch and we're not completing in idle. So use a copy of the pointer.
    */
-  task = data->task;
+  task = batch->task;
 #endif
 
-  ostream = g_io_stream_get_output_stream (data->worker->stream);
+  ostream = g_io_stream_get_output_stream (batch->worker->stream);
+
 #ifdef G_OS_UNIX
-  fd_list = g_dbus_message_get_unix_fd_list (data->message);
+ write_next:
 #endif
-
   g_assert (!g_output_stream_has_pending (ostream));
-  g_assert_cmpint (data->total_written, <, data->blob_size);
+  g_assert_cmpuint (batch->n_done, <, batch->messages->len);
+
+  data = batch->messages->pdata[batch->n_done];
+#ifdef G_OS_UNIX
+  fd_list = g_dbus_message_get_unix_fd_list (data->message);
+#endif
 
   if (FALSE)
     {
@@ -1008,18 +1122,14 @@ write_message_continue_writing (MessageToWriteData *data)
 #ifdef G_OS_UNIX
   else if (G_IS_SOCKET_OUTPUT_STREAM (ostream) && data->total_written == 0)
     {
-      GOutputVector vector;
       GSocketControlMessage *control_message;
       gssize bytes_written;
       GError *error;
 
-      vector.buffer = data->blob;
-      vector.size = data->blob_size;
-
       control_message = NULL;
       if (fd_list != NULL && g_unix_fd_list_get_length (fd_list) > 0)
         {
-          if (!(data->worker->capabilities & G_DBUS_CAPABILITY_FLAGS_UNIX_FD_PASSING))
+          if (!(batch->worker->capabilities & G_DBUS_CAPABILITY_FLAGS_UNIX_FD_PASSING))
             {
               g_task_return_new_error (task,
                                        G_IO_ERROR,
@@ -1031,15 +1141,17 @@ write_message_continue_writing (MessageToWriteData *data)
           control_message = g_unix_fd_message_new_with_fd_list (fd_list);
         }
 
+      n_vectors = write_batch_fill_vectors (batch, TRUE);
+
       error = NULL;
-      bytes_written = g_socket_send_message (data->worker->socket,
+      bytes_written = g_socket_send_message (batch->worker->socket,
                                              NULL, /* address */
-                                             &vector,
-                                             1,
+                                             batch->vectors,
+                                             n_vectors,
                                              control_message != NULL ? &control_message : NULL,
                                              control_message != NULL ? 1 : 0,
                                              G_SOCKET_MSG_NONE,
-                                             data->worker->cancellable,
+                                             batch->worker->cancellable,
                                              &error);
       if (control_message != NULL)
         g_object_unref (control_message);
@@ -1050,12 +1162,12 @@ write_message_continue_writing (MessageToWriteData *data)
           if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
             {
               GSource *source;
-              source = g_socket_create_source (data->worker->socket,
+              source = g_socket_create_source (batch->worker->socket,
                                                G_IO_OUT | G_IO_HUP | G_IO_ERR,
-                                               data->worker->cancellable);
+                                               batch->worker->cancellable);
               g_source_set_callback (source,
                                      (GSourceFunc) on_socket_ready,
-                                     data,
+                                     batch,
                                      NULL); /* GDestroyNotify */
               g_source_attach (source, g_main_context_get_thread_default ());
               g_source_unref (source);
@@ -1068,24 +1180,23 @@ write_message_continue_writing (MessageToWriteData *data)
         }
       g_assert (bytes_written > 0); /* zero is never returned */
 
-      write_message_print_transport_debug (bytes_written, data);
-
-      data->total_written += bytes_written;
-      g_assert (data->total_written <= data->blob_size);
-      if (data->total_written == data->blob_size)
+      if (write_batch_advance (batch, bytes_written))
         {
           g_task_return_boolean (task, TRUE);
           g_object_unref (task);
           goto out;
         }
 
-      write_message_continue_writing (data);
+      goto write_next;
     }
 #endif
   else
     {
 #ifdef G_OS_UNIX
-      if (data->total_written == 0 && fd_list != NULL)
+      /* Messages that carry file descriptors are only ever at the front of
+       * a write, see write_batch_fill_vectors(). */
+      if (!G_IS_SOCKET_OUTPUT_STREAM (ostream) &&
+          data->total_written == 0 && fd_list != NULL)
         {
           /* We were trying to write byte 0 of the message, which needs
            * the fd list to be attached to it, but this connection doesn't
@@ -1100,13 +1211,17 @@ write_message_continue_writing (MessageToWriteData *data)
         }
 #endif
 
-      g_output_stream_write_async (ostream,
-                                   (const gchar *) data->blob + data->total_written,
-                                   data->blob_size - data->total_written,
-                                   G_PRIORITY_DEFAULT,
-                                   data->worker->cancellable,
-                                   write_message_async_cb,
-                                   data);
+      /* Either the stream isn't a socket, or the socket was full when we
+       * were in the middle of a message; write the rest asynchronously so
+       * that the worker thread isn't blocked in the meantime. */
+      n_vectors = write_batch_fill_vectors (batch, G_IS_SOCKET_OUTPUT_STREAM (ostream));
+      g_output_stream_writev_all_async (ostream,
+                                        batch->vectors,
+                                        n_vectors,
+                                        G_PRIORITY_DEFAULT,
+                                        batch->worker->cancellable,
+                                        write_batch_async_cb,
+                                        batch);
     }
 #ifdef G_OS_UNIX
  out:
@@ -1120,22 +1235,21 @@ write_message_continue_writing (MessageToWriteData *data)
  * output_pending is PENDING_WRITE on entry
  */
 static void
-write_message_async (GDBusWorker         *worker,
-                     MessageToWriteData  *data,
-                     GAsyncReadyCallback  callback,
-                     gpointer             user_data)
+write_batch_async (WriteBatchData      *batch,
+                   GAsyncReadyCallback  callback,
+                   gpointer             user_data)
 {
-  data->task = g_task_new (NULL, NULL, callback, user_data);
-  g_task_set_source_tag (data->task, write_message_async);
-  g_task_set_name (data->task, "[gio] D-Bus write message");
-  data->total_written = 0;
-  write_message_continue_writing (data);
+  batch->task = g_task_new (NULL, NULL, callback, user_data);
+  g_task_set_source_tag (batch->task, write_batch_async);
+  g_task_set_name (batch->task, "[gio] D-Bus write message");
+  batch->vectors = g_new (GOutputVector, batch->messages->len);
+  write_batch_continue_writing (batch);
 }
 
 /* called in private thread shared by all GDBusConnection instances (with write-lock held) */
 static gboolean
-write_message_finish (GAsyncResult   *res,
-                      GError        **error)
+write_batch_finish (GAsyncResult   *res,
+                    GError        **error)
 {
   g_return_val_if_fail (g_task_is_valid (res, NULL), FALSE);
 
@@ -1320,36 +1434,39 @@ prepare_flush_unlocked (GDBusWorker *worker)
  * output_pending is PENDING_WRITE on entry
  */
 static void
-write_message_cb (GObject       *source_object,
-                  GAsyncResult  *res,
-                  gpointer       user_data)
+write_batch_cb (GObject       *source_object,
+                GAsyncResult  *res,
+                gpointer       user_data)
 {
-  MessageToWriteData *data = user_data;
+  WriteBatchData *batch = user_data;
   GError *error;
+  guint n;
 
-  g_mutex_lock (&data->worker->write_lock);
-  g_assert (data->worker->output_pending == PENDING_WRITE);
-  data->worker->output_pending = PENDING_NONE;
+  g_mutex_lock (&batch->worker->write_lock);
+  g_assert (batch->worker->output_pending == PENDING_WRITE);
+  batch->worker->output_pending = PENDING_NONE;
+  batch->worker->write_num_messages_in_flight = 0;
 
   error = NULL;
-  if (!write_message_finish (res, &error))
+  if (!write_batch_finish (res, &error))
     {
-      g_mutex_unlock (&data->worker->write_lock);
+      g_mutex_unlock (&batch->worker->write_lock);
 
       /* TODO: handle */
-      _g_dbus_worker_emit_disconnected (data->worker, TRUE, error);
+      _g_dbus_worker_emit_disconnected (batch->worker, TRUE, error);
       g_error_free (error);
 
-      g_mutex_lock (&data->worker->write_lock);
+      g_mutex_lock (&batch->worker->write_lock);
     }
 
-  message_written_unlocked (data->worker, data);
+  for (n = 0; n < batch->messages->len; n++)
+    message_written_unlocked (batch->worker, batch->messages->pdata[n]);
 
-  g_mutex_unlock (&data->worker->write_lock);
+  g_mutex_unlock (&batch->worker->write_lock);
 
-  continue_writing (data->worker);
+  continue_writing (batch->worker);
 
-  message_to_write_data_free (data);
+  write_batch_data_free (batch);
 }
 
 /* called in private thread shared by all GDBusConnection instances
@@ -1429,8 +1546,9 @@ iostream_close_cb (GObject      *source_object,
 static void
 continue_writing (GDBusWorker *worker)
 {
-  MessageToWriteData *data;
+  WriteBatchData *batch;
   FlushAsyncData *flush_async_data;
+  guint n;
 
  write_next:
   /* we mustn't try to write two things at once */
@@ -1438,7 +1556,7 @@ continue_writing (GDBusWorker *worker)
 
   g_mutex_lock (&worker->write_lock);
 
-  data = NULL;
+  batch = NULL;
   flush_async_data = NULL;
 
   /* if we want to close the connection, that takes precedence */
@@ -1460,12 +1578,28 @@ continue_writing (GDBusWorker *worker)
     {
       flush_async_data = prepare_flush_unlocked (worker);
 
-      if (flush_async_data == NULL)
+      if (flush_async_data == NULL && !g_queue_is_empty (worker->write_queue))
         {
-          data = g_queue_pop_head (worker->write_queue);
+          guint max_messages;
+          GList *l;
+
+          /* Don't write past the point where a flush is waiting, so that
+           * prepare_flush_unlocked() sees it after this write */
+          max_messages = MAX_MESSAGES_PER_WRITE;
+          for (l = worker->write_pending_flushes; l != NULL; l = l->next)
+            {
+              FlushData *f = l->data;
+
+              if (f->number_to_wait_for > worker->write_num_messages_written)
+                max_messages = MIN (max_messages, f->number_to_wait_for - worker->write_num_messages_written);
+            }
 
-          if (data != NULL)
-            worker->output_pending = PENDING_WRITE;
+          batch = write_batch_data_new (worker);
+          while (batch->messages->len < max_messages && !g_queue_is_empty (worker->write_queue))
+            g_ptr_array_add (batch->messages, g_queue_pop_head (worker->write_queue));
+
+          worker->output_pending = PENDING_WRITE;
+          worker->write_num_messages_in_flight = batch->messages->len;
         }
     }
 
@@ -1483,60 +1617,73 @@ continue_writing (GDBusWorker *worker)
   if (flush_async_data != NULL)
     {
       start_flush (flush_async_data);
-      g_assert (data == NULL);
+      g_assert (batch == NULL);
     }
-  else if (data != NULL)
+  else if (batch != NULL)
     {
-      GDBusMessage *old_message;
-      guchar *new_blob;
-      gsize new_blob_size;
-      GError *error;
-
-      old_message = data->message;
-      data->message = _g_dbus_worker_emit_message_about_to_be_sent (worker, data->message);
-      if (data->message == old_message)
+      for (n = 0; n < batch->messages->len; )
         {
-          /* filters had no effect - do nothing */
+          MessageToWriteData *data = batch->messages->pdata[n];
+          GDBusMessage *old_message;
+          guchar *new_blob;
+          gsize new_blob_size;
+          GError *error;
+
+          old_message = data->message;
+          data->message = _g_dbus_worker_emit_message_about_to_be_sent (worker, data->message);
+          if (data->message == old_message)
+            {
+              /* filters had no effect - do nothing */
+            }
+          else if (data->message == NULL)
+            {
+              /* filters dropped message */
+              g_ptr_array_remove_index (batch->messages, n);
+              continue;
+            }
+          else
+            {
+              /* filters altered the message -> re-encode */
+              error = NULL;
+              new_blob = g_dbus_message_to_blob (data->message,
+                                                 &new_blob_size,
+                                                 worker->capabilities,
+                                                 &error);
+              if (new_blob == NULL)
+                {
+                  /* if filter make the GDBusMessage unencodeable, just complain on stderr and send
+                   * the old message instead
+                   */
+                  g_warning ("Error encoding GDBusMessage with serial %d altered by filter function: %s",
+                             g_dbus_message_get_serial (data->message),
+                             error->message);
+                  g_error_free (error);
+                }
+              else
+                {
+                  g_free (data->blob);
+                  data->blob = (gchar *) new_blob;
+                  data->blob_size = new_blob_size;
+                }
+            }
+
+          n++;
         }
-      else if (data->message == NULL)
+
+      if (batch->messages->len == 0)
         {
-          /* filters dropped message */
+          /* filters dropped all messages */
           g_mutex_lock (&worker->write_lock);
           worker->output_pending = PENDING_NONE;
+          worker->write_num_messages_in_flight = 0;
           g_mutex_unlock (&worker->write_lock);
-          message_to_write_data_free (data);
+          write_batch_data_free (batch);
           goto write_next;
         }
-      else
-        {
-          /* filters altered the message -> re-encode */
-          error = NULL;
-          new_blob = g_dbus_message_to_blob (data->message,
-                                             &new_blob_size,
-                                             worker->capabilities,
-                                             &error);
-          if (new_blob == NULL)
-            {
-              /* if filter make the GDBusMessage unencodeable, just complain on stderr and send
-               * the old message instead
-               */
-              g_warning ("Error encoding GDBusMessage with serial %d altered by filter function: %s",
-                         g_dbus_message_get_serial (data->message),
-                         error->message);
-              g_error_free (error);
-            }
-          else
-            {
-              g_free (data->blob);
-              data->blob = (gchar *) new_blob;
-              data->blob_size = new_blob_size;
-            }
-        }
 
-      write_message_async (worker,
-                           data,
-                           write_message_cb,
-                           data);
+      write_batch_async (batch,
+                         write_batch_cb,
+                         batch);
     }
 }
 
@@ -1782,10 +1929,10 @@ _g_dbus_worker_flush_sync (GDBusWorker    *worker,
   pending_writes = g_queue_get_length (worker->write_queue);
 
   /* if a write is in-flight, we shouldn't be satisfied until the first
-   * flush operation that follows it
+   * flush operation that follows all of the messages in it
    */
   if (worker->output_pending == PENDING_WRITE)
-    pending_writes += 1;
+    pending_writes += worker->write_num_messages_in_flight;
 
   if (pending_writes > 0 ||
       worker->write_num_messages_written != worker->write_num_messages_flushed)
@@ -2522,21 +2669,29 @@ _g_dbus_enum_to_string (GType enum_type, gint value)
 
 static void
 write_message_print_transport_debug (gssize bytes_written,
-                                     MessageToWriteData *data)
+                                     WriteBatchData *batch)
 {
+  MessageToWriteData *data;
+
   if (G_LIKELY (!_g_dbus_debug_transport ()))
     goto out;
 
+  data = batch->messages->pdata[batch->n_done];
+
   _g_dbus_debug_print_lock ();
   g_print ("========================================================================\n"
            "GDBus-debug:Transport:\n"
-           "  >>>> WROTE %" G_GSSIZE_FORMAT " bytes of message with serial %d and\n"
-           "       size %" G_GSIZE_FORMAT " from offset %" G_GSIZE_FORMAT " on a %s\n",
+           "  >>>> WROTE %" G_GSSIZE_FORMAT " bytes of %u messages, starting with serial %d and\n"
+           "       size %" G_GSIZE_FORMAT " from offset %" G_GSIZE_FORMAT " on a %s\n"
+           "       (%" G_GUINT64_FORMAT " messages in %" G_GUINT64_FORMAT " writes so far)\n",
            bytes_written,
+           batch->n_vectors,
            g_dbus_message_get_serial (data->message),
            data->blob_size,
            data->total_written,
-           g_type_name (G_TYPE_FROM_INSTANCE (g_io_stream_get_output_stream (data->worker->stream))));
+           g_type_name (G_TYPE_FROM_INSTANCE (g_io_stream_get_output_stream (batch->worker->stream))),
+           batch->worker->write_num_messages_written,
+           batch->worker->write_num_writes);
   _g_dbus_debug_print_unlock ();
  out:
   ;
@@ -1360,6 +1360,31 @@ typedef enum
   G_DBUS_SUBTREE_FLAGS_DISPATCH_TO_UNENUMERATED_NODES = (1<<0)
 } GDBusSubtreeFlags;
 
+/**
+ * GDBusRegistrationFlags:
+ * @G_DBUS_REGISTRATION_FLAGS_NONE: No flags set.
+ * @G_DBUS_REGISTRATION_FLAGS_DISPATCH_IN_THREAD: Call the method_call
+ *   function of the #GDBusInterfaceVTable in a worker thread of the #GTask
+ *   thread pool instead of in the thread-default main context, so that
+ *   method calls can be handled concurrently.
+ * @G_DBUS_REGISTRATION_FLAGS_ORDER_BY_SENDER: Together with
+ *   %G_DBUS_REGISTRATION_FLAGS_DISPATCH_IN_THREAD, call the method_call
+ *   function for the method calls from each sender one after another, in
+ *   the order they were received. Method calls from different senders are
+ *   still handled concurrently.
+ *
+ * Flags passed to g_dbus_connection_register_object_with_flags().
+ *
+ * Since: 2.68
+ */
+GLIB_AVAILABLE_TYPE_IN_2_68
+typedef enum
+{
+  G_DBUS_REGISTRATION_FLAGS_NONE = 0,
+  G_DBUS_REGISTRATION_FLAGS_DISPATCH_IN_THREAD = (1<<0),
+  G_DBUS_REGISTRATION_FLAGS_ORDER_BY_SENDER = (1<<1)
+} GDBusRegistrationFlags;
+
 /**
  * GDBusServerFlags:
  * @G_DBUS_SERVER_FLAGS_NONE: No flags set.
@@ -2052,6 +2077,35 @@ typedef enum {
   G_MEMORY_MONITOR_WARNING_LEVEL_CRITICAL = 255
 } GMemoryMonitorWarningLevel;
 
+/**
+ * GTaskPoolType:
+ * @G_TASK_POOL_TYPE_BLOCKING: The pool for tasks which spend most of their
+ *   time blocked, typically on I/O. This is where tasks run by default. When
+ *   all of its threads have been busy for a while, it slowly adds more, in
+ *   case the running tasks are waiting for tasks queued behind them.
+ * @G_TASK_POOL_TYPE_CPU: The pool for CPU-bound tasks. By default it has one
+ *   thread per processor and never grows beyond that, as more threads would
+ *   only compete for the processors. Tasks in this pool must not wait for
+ *   other tasks of the pool.
+ * @G_TASK_POOL_TYPE_HIGH_PRIORITY: A pool for the blocking tasks with a
+ *   priority higher than %G_PRIORITY_DEFAULT, so that they don't wait behind
+ *   lower priority tasks occupying all threads of the blocking pool. It has
+ *   no threads by default, in which case these tasks run in the blocking
+ *   pool, ahead of the lower priority tasks queued there.
+ *
+ * The thread pools in which #GTask runs the functions passed to
+ * g_task_run_in_thread() and g_task_run_in_thread_sync(). See
+ * g_task_set_pool_type() and g_task_set_pool_limits().
+ *
+ * Since: 2.68
+ */
+GLIB_AVAILABLE_TYPE_IN_2_68
+typedef enum {
+  G_TASK_POOL_TYPE_BLOCKING,
+  G_TASK_POOL_TYPE_CPU,
+  G_TASK_POOL_TYPE_HIGH_PRIORITY
+} GTaskPoolType;
+
 G_END_DECLS
 
 #endif /* __GIO_ENUMS_H__ */
@@ -540,6 +540,8 @@
  * and its result.
  */
 
+typedef struct _GTaskThreadPool GTaskThreadPool;
+
 struct _GTask {
   GObject parent_instance;
 
@@ -559,6 +561,9 @@ struct _GTask {
   gpointer callback_data;
 
   GTaskThreadFunc task_func;
+  GTaskPoolType pool_type;
+  GTaskThreadPool *thread_pool;  /* set when task_func is */
+  gint64 queued_time;
   GMutex lock;
   GCond cond;
 
@@ -611,12 +616,26 @@ G_DEFINE_TYPE_WITH_CODE (GTask, g_task, G_TYPE_OBJECT,
                                                 g_task_async_result_iface_init);
                          g_task_thread_pool_init ();)
 
-static GThreadPool *task_pool;
-static GMutex task_pool_mutex;
+/* One per #GTaskPoolType */
+struct _GTaskThreadPool
+{
+  GThreadPool *pool;
+  GSource *manager;
+  GMutex mutex;
+
+  /* Protected by the mutex: */
+  gint min_threads;
+  gint max_threads;
+  guint64 wait_time;
+  gint tasks_running;
+
+  guint64 tasks_completed;
+  guint64 queue_time;
+  guint64 max_queue_time;
+};
+
+static GTaskThreadPool task_pools[G_TASK_POOL_TYPE_HIGH_PRIORITY + 1];
 static GPrivate task_private = G_PRIVATE_INIT (NULL);
-static GSource *task_pool_manager;
-static guint64 task_wait_time;
-static gint tasks_running;
 
 /* When the task pool fills up and blocks, and the program keeps
  * queueing more tasks, we will slowly add more threads to the pool
@@ -631,6 +650,10 @@ static gint tasks_running;
  *
  * We specify maximum pool size of 330 to increase the waiting time up
  * to around 30 minutes.
+ *
+ * G_TASK_POOL_SIZE is the default base size of the blocking pool; the
+ * base and maximum sizes of each pool can be changed with
+ * g_task_set_pool_limits().
  */
 #define G_TASK_POOL_SIZE 10
 #define G_TASK_WAIT_TIME_BASE 100000
@@ -1356,53 +1379,72 @@ g_task_thread_complete (GTask *task)
     g_task_return (task, G_TASK_RETURN_FROM_THREAD);
 }
 
+/* The number of threads a pool runs tasks with before it is considered
+ * blocked and starts adding more. The high priority pool is disabled
+ * with a minimum of 0, but still needs a thread to finish its queue.
+ */
+#define BASE_THREADS(pool) (MAX ((pool)->min_threads, 1))
+
 static gboolean
 task_pool_manager_timeout (gpointer user_data)
 {
-  g_mutex_lock (&task_pool_mutex);
-  g_thread_pool_set_max_threads (task_pool, tasks_running + 1, NULL);
-  g_source_set_ready_time (task_pool_manager, -1);
-  g_mutex_unlock (&task_pool_mutex);
+  GTaskThreadPool *pool = user_data;
+
+  g_mutex_lock (&pool->mutex);
+  if (pool->max_threads < 0 || pool->tasks_running < pool->max_threads)
+    g_thread_pool_set_max_threads (pool->pool,
+                                   MAX (pool->tasks_running + 1, BASE_THREADS (pool)),
+                                   NULL);
+  g_source_set_ready_time (pool->manager, -1);
+  g_mutex_unlock (&pool->mutex);
 
   return TRUE;
 }
 
 static void
-g_task_thread_setup (void)
+g_task_thread_setup (GTaskThreadPool *pool,
+                     GTask           *task)
 {
+  guint64 queue_time = g_get_monotonic_time () - task->queued_time;
+
   g_private_set (&task_private, GUINT_TO_POINTER (TRUE));
-  g_mutex_lock (&task_pool_mutex);
-  tasks_running++;
+  g_mutex_lock (&pool->mutex);
+  pool->tasks_running++;
 
-  if (tasks_running == G_TASK_POOL_SIZE)
-    task_wait_time = G_TASK_WAIT_TIME_BASE;
-  else if (tasks_running > G_TASK_POOL_SIZE && tasks_running < G_TASK_WAIT_TIME_MAX_POOL_SIZE)
-    task_wait_time *= G_TASK_WAIT_TIME_MULTIPLIER;
+  pool->queue_time += queue_time;
+  pool->max_queue_time = MAX (pool->max_queue_time, queue_time);
 
-  if (tasks_running >= G_TASK_POOL_SIZE)
-    g_source_set_ready_time (task_pool_manager, g_get_monotonic_time () + task_wait_time);
+  if (pool->tasks_running == BASE_THREADS (pool))
+    pool->wait_time = G_TASK_WAIT_TIME_BASE;
+  else if (pool->tasks_running > BASE_THREADS (pool) && pool->tasks_running < G_TASK_WAIT_TIME_MAX_POOL_SIZE)
+    pool->wait_time *= G_TASK_WAIT_TIME_MULTIPLIER;
 
-  g_mutex_unlock (&task_pool_mutex);
+  if (pool->tasks_running >= BASE_THREADS (pool) &&
+      (pool->max_threads < 0 || pool->tasks_running < pool->max_threads))
+    g_source_set_ready_time (pool->manager, g_get_monotonic_time () + pool->wait_time);
+
+  g_mutex_unlock (&pool->mutex);
 }
 
 static void
-g_task_thread_cleanup (void)
+g_task_thread_cleanup (GTaskThreadPool *pool)
 {
   gint tasks_pending;
 
-  g_mutex_lock (&task_pool_mutex);
-  tasks_pending = g_thread_pool_unprocessed (task_pool);
+  g_mutex_lock (&pool->mutex);
+  tasks_pending = g_thread_pool_unprocessed (pool->pool);
 
-  if (tasks_running > G_TASK_POOL_SIZE)
-    g_thread_pool_set_max_threads (task_pool, tasks_running - 1, NULL);
-  else if (tasks_running + tasks_pending < G_TASK_POOL_SIZE)
-    g_source_set_ready_time (task_pool_manager, -1);
+  if (pool->tasks_running > BASE_THREADS (pool))
+    g_thread_pool_set_max_threads (pool->pool, pool->tasks_running - 1, NULL);
+  else if (pool->tasks_running + tasks_pending < BASE_THREADS (pool))
+    g_source_set_ready_time (pool->manager, -1);
 
-  if (tasks_running > G_TASK_POOL_SIZE && tasks_running < G_TASK_WAIT_TIME_MAX_POOL_SIZE)
-    task_wait_time /= G_TASK_WAIT_TIME_MULTIPLIER;
+  if (pool->tasks_running > BASE_THREADS (pool) && pool->tasks_running < G_TASK_WAIT_TIME_MAX_POOL_SIZE)
+    pool->wait_time /= G_TASK_WAIT_TIME_MULTIPLIER;
 
-  tasks_running--;
-  g_mutex_unlock (&task_pool_mutex);
+  pool->tasks_running--;
+  pool->tasks_completed++;
+  g_mutex_unlock (&pool->mutex);
   g_private_set (&task_private, GUINT_TO_POINTER (FALSE));
 }
 
@@ -1411,15 +1453,16 @@ g_task_thread_pool_thread (gpointer thread_data,
                            gpointer pool_data)
 {
   GTask *task = thread_data;
+  GTaskThreadPool *pool = pool_data;
 
-  g_task_thread_setup ();
+  g_task_thread_setup (pool, task);
 
   task->task_func (task, task->source_object, task->task_data,
                    task->cancellable);
   g_task_thread_complete (task);
   g_object_unref (task);
 
-  g_task_thread_cleanup ();
+  g_task_thread_cleanup (pool);
 }
 
 static void
@@ -1431,7 +1474,7 @@ task_thread_cancelled (GCancellable *cancellable,
   /* Move this task to the front of the queue - no need for
    * a complete resorting of the queue.
    */
-  g_thread_pool_move_to_front (task_pool, task);
+  g_thread_pool_move_to_front (task->thread_pool->pool, task);
 
   g_mutex_lock (&task->lock);
   task->thread_cancelled = TRUE;
@@ -1457,6 +1500,31 @@ task_thread_cancelled_disconnect_notify (gpointer  task,
   g_object_unref (task);
 }
 
+/* Blocking tasks with a high priority go to their own pool, if it has
+ * been given threads.
+ */
+static GTaskThreadPool *
+g_task_get_thread_pool (GTask *task)
+{
+  GTaskPoolType pool_type = task->pool_type;
+  GTaskThreadPool *pool;
+  gboolean enabled;
+
+  if (pool_type == G_TASK_POOL_TYPE_BLOCKING &&
+      task->priority < G_PRIORITY_DEFAULT)
+    pool_type = G_TASK_POOL_TYPE_HIGH_PRIORITY;
+
+  pool = &task_pools[pool_type];
+  if (pool_type != G_TASK_POOL_TYPE_HIGH_PRIORITY)
+    return pool;
+
+  g_mutex_lock (&pool->mutex);
+  enabled = pool->min_threads > 0;
+  g_mutex_unlock (&pool->mutex);
+
+  return enabled ? pool : &task_pools[G_TASK_POOL_TYPE_BLOCKING];
+}
+
 static void
 g_task_start_task_thread (GTask           *task,
                           GTaskThreadFunc  task_func)
@@ -1469,6 +1537,8 @@ g_task_start_task_thread (GTask           *task,
   TRACE (GIO_TASK_BEFORE_RUN_IN_THREAD (task, task_func));
 
   task->task_func = task_func;
+  task->thread_pool = g_task_get_thread_pool (task);
+  task->queued_time = g_get_monotonic_time ();
 
   if (task->cancellable)
     {
@@ -1478,7 +1548,7 @@ g_task_start_task_thread (GTask           *task,
         {
           task->thread_cancelled = task->thread_complete = TRUE;
           TRACE (GIO_TASK_AFTER_RUN_IN_THREAD (task, task->thread_cancelled));
-          g_thread_pool_push (task_pool, g_object_ref (task), NULL);
+          g_thread_pool_push (task->thread_pool->pool, g_object_ref (task), NULL);
           return;
         }
 
@@ -1498,7 +1568,7 @@ g_task_start_task_thread (GTask           *task,
 
   if (g_private_get (&task_private))
     task->blocking_other_task = TRUE;
-  g_thread_pool_push (task_pool, g_object_ref (task), NULL);
+  g_thread_pool_push (task->thread_pool->pool, g_object_ref (task), NULL);
 }
 
 /**
@@ -1595,6 +1665,215 @@ g_task_run_in_thread_sync (GTask           *task,
   g_object_unref (task);
 }
 
+/**
+ * g_task_set_pool_type:
+ * @task: a #GTask
+ * @pool_type: the #GTaskPoolType of the pool to run @task in
+ *
+ * Sets the thread pool in which g_task_run_in_thread() and
+ * g_task_run_in_thread_sync() run @task. This defaults to
+ * %G_TASK_POOL_TYPE_BLOCKING, which suits tasks doing blocking I/O;
+ * use %G_TASK_POOL_TYPE_CPU for tasks which keep a processor busy.
+ *
+ * Tasks set to %G_TASK_POOL_TYPE_HIGH_PRIORITY, and tasks of the blocking
+ * pool with a priority higher than %G_PRIORITY_DEFAULT, run in the high
+ * priority pool when it has been given threads with
+ * g_task_set_pool_limits(), and in the blocking pool otherwise.
+ *
+ * This function must be called before @task is run in a thread.
+ *
+ * Since: 2.68
+ */
+void
+g_task_set_pool_type (GTask         *task,
+                      GTaskPoolType  pool_type)
+{
+  g_return_if_fail (G_IS_TASK (task));
+  g_return_if_fail ((guint) pool_type <= G_TASK_POOL_TYPE_HIGH_PRIORITY);
+  g_return_if_fail (!G_TASK_IS_THREADED (task));
+
+  task->pool_type = pool_type;
+}
+
+/**
+ * g_task_get_pool_type:
+ * @task: a #GTask
+ *
+ * Gets the thread pool type of @task. See g_task_set_pool_type().
+ *
+ * Returns: the #GTaskPoolType of @task
+ *
+ * Since: 2.68
+ */
+GTaskPoolType
+g_task_get_pool_type (GTask *task)
+{
+  g_return_val_if_fail (G_IS_TASK (task), G_TASK_POOL_TYPE_BLOCKING);
+
+  return task->pool_type;
+}
+
+/**
+ * g_task_set_pool_limits:
+ * @pool_type: a #GTaskPoolType
+ * @min_threads: the number of threads the pool runs tasks with before
+ *   it considers itself blocked
+ * @max_threads: the maximum number of threads of the pool, or -1 for
+ *   no limit
+ *
+ * Sets how many threads the pool of type @pool_type uses to run tasks.
+ *
+ * A pool runs up to @min_threads tasks at once. Once they are all
+ * busy, it slowly adds threads for as long as none of the tasks
+ * finishes, in case they are waiting for tasks queued behind them,
+ * and then goes back to @min_threads as tasks finish. It never has
+ * more than @max_threads threads, so with @max_threads equal to
+ * @min_threads, tasks queue up instead.
+ *
+ * The defaults are 10 threads for %G_TASK_POOL_TYPE_BLOCKING, without
+ * a maximum, and the number of processors for %G_TASK_POOL_TYPE_CPU,
+ * which is also its maximum. %G_TASK_POOL_TYPE_HIGH_PRIORITY has no
+ * threads by default: setting @min_threads to a non-zero value for it
+ * enables it, and setting it back to 0 disables it again.
+ *
+ * Threads are shared with the other thread pools of the process and
+ * only started when there are tasks to run. The statistics returned by
+ * g_task_get_pool_statistics() can help choosing these limits.
+ *
+ * This function is safe to call from any thread.
+ *
+ * Since: 2.68
+ */
+void
+g_task_set_pool_limits (GTaskPoolType pool_type,
+                        guint         min_threads,
+                        gint          max_threads)
+{
+  GTaskThreadPool *pool;
+  gint n_threads;
+
+  g_return_if_fail ((guint) pool_type <= G_TASK_POOL_TYPE_HIGH_PRIORITY);
+  g_return_if_fail (min_threads > 0 || pool_type == G_TASK_POOL_TYPE_HIGH_PRIORITY);
+  g_return_if_fail (min_threads <= G_MAXINT);
+  g_return_if_fail (max_threads == -1 || max_threads >= (gint) min_threads);
+
+  /* The pools are created along with the type */
+  g_type_ensure (G_TYPE_TASK);
+
+  pool = &task_pools[pool_type];
+
+  g_mutex_lock (&pool->mutex);
+
+  pool->min_threads = min_threads;
+  pool->max_threads = max_threads;
+
+  n_threads = MAX (pool->tasks_running, BASE_THREADS (pool));
+  if (max_threads >= 0)
+    n_threads = MIN (n_threads, MAX (max_threads, 1));
+  g_thread_pool_set_max_threads (pool->pool, n_threads, NULL);
+
+  if (max_threads >= 0 && pool->tasks_running >= max_threads)
+    g_source_set_ready_time (pool->manager, -1);
+
+  g_mutex_unlock (&pool->mutex);
+}
+
+/**
+ * g_task_get_pool_limits:
+ * @pool_type: a #GTaskPoolType
+ * @min_threads: (out) (optional): return location for the base number
+ *   of threads of the pool
+ * @max_threads: (out) (optional): return location for the maximum
+ *   number of threads of the pool, or -1 if there is no limit
+ *
+ * Gets the limits set with g_task_set_pool_limits() for the pool of
+ * type @pool_type.
+ *
+ * Since: 2.68
+ */
+void
+g_task_get_pool_limits (GTaskPoolType  pool_type,
+                        guint         *min_threads,
+                        gint          *max_threads)
+{
+  GTaskThreadPool *pool;
+
+  g_return_if_fail ((guint) pool_type <= G_TASK_POOL_TYPE_HIGH_PRIORITY);
+
+  g_type_ensure (G_TYPE_TASK);
+
+  pool = &task_pools[pool_type];
+
+  g_mutex_lock (&pool->mutex);
+  if (min_threads != NULL)
+    *min_threads = pool->min_threads;
+  if (max_threads != NULL)
+    *max_threads = pool->max_threads;
+  g_mutex_unlock (&pool->mutex);
+}
+
+/**
+ * g_task_get_pool_statistics:
+ * @pool_type: a #GTaskPoolType
+ *
+ * Gets the current state of the pool of type @pool_type and the
+ * statistics it collected since the start of the process.
+ *
+ * These are returned as a dictionary of type `a{sv}`, with the
+ * following entries. All times are in microseconds.
+ *
+ * - `min-threads` (`u`) and `max-threads` (`i`): the limits of the pool,
+ *   see g_task_set_pool_limits()
+ * - `threads` (`u`): the number of threads the pool may currently use,
+ *   including those added while it was blocked
+ * - `running` (`u`): the number of tasks currently running
+ * - `queued` (`u`): the number of tasks waiting for a thread
+ * - `completed` (`t`): the number of tasks run so far
+ * - `queue-time` (`t`): the total time tasks waited for a thread
+ * - `max-queue-time` (`t`): the longest time a task waited for a thread
+ *
+ * This function is safe to call from any thread.
+ *
+ * Returns: (transfer full): a new #GVariant of type `a{sv}`
+ *
+ * Since: 2.68
+ */
+GVariant *
+g_task_get_pool_statistics (GTaskPoolType pool_type)
+{
+  GTaskThreadPool *pool;
+  GVariantBuilder builder;
+
+  g_return_val_if_fail ((guint) pool_type <= G_TASK_POOL_TYPE_HIGH_PRIORITY, NULL);
+
+  g_type_ensure (G_TYPE_TASK);
+
+  pool = &task_pools[pool_type];
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+
+  g_mutex_lock (&pool->mutex);
+  g_variant_builder_add (&builder, "{sv}", "min-threads",
+                         g_variant_new_uint32 (pool->min_threads));
+  g_variant_builder_add (&builder, "{sv}", "max-threads",
+                         g_variant_new_int32 (pool->max_threads));
+  g_variant_builder_add (&builder, "{sv}", "threads",
+                         g_variant_new_uint32 (g_thread_pool_get_max_threads (pool->pool)));
+  g_variant_builder_add (&builder, "{sv}", "running",
+                         g_variant_new_uint32 (pool->tasks_running));
+  g_variant_builder_add (&builder, "{sv}", "queued",
+                         g_variant_new_uint32 (g_thread_pool_unprocessed (pool->pool)));
+  g_variant_builder_add (&builder, "{sv}", "completed",
+                         g_variant_new_uint64 (pool->tasks_completed));
+  g_variant_builder_add (&builder, "{sv}", "queue-time",
+                         g_variant_new_uint64 (pool->queue_time));
+  g_variant_builder_add (&builder, "{sv}", "max-queue-time",
+                         g_variant_new_uint64 (pool->max_queue_time));
+  g_mutex_unlock (&pool->mutex);
+
+  return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
 /**
  * g_task_attach_source:
  * @task: a #GTask
@@ -2153,21 +2432,47 @@ GSourceFuncs trivial_source_funcs = {
 };
 
 static void
-g_task_thread_pool_init (void)
+g_task_thread_pool_init_one (GTaskPoolType  pool_type,
+                             const gchar   *manager_name,
+                             gint           min_threads,
+                             gint           max_threads)
 {
-  task_pool = g_thread_pool_new (g_task_thread_pool_thread, NULL,
-                                 G_TASK_POOL_SIZE, FALSE, NULL);
-  g_assert (task_pool != NULL);
+  GTaskThreadPool *pool = &task_pools[pool_type];
+
+  g_mutex_init (&pool->mutex);
+  pool->min_threads = min_threads;
+  pool->max_threads = max_threads;
+  pool->wait_time = G_TASK_WAIT_TIME_BASE;
+
+  pool->pool = g_thread_pool_new (g_task_thread_pool_thread, pool,
+                                  BASE_THREADS (pool), FALSE, NULL);
+  g_assert (pool->pool != NULL);
 
-  g_thread_pool_set_sort_function (task_pool, g_task_compare_priority, NULL);
+  g_thread_pool_set_sort_function (pool->pool, g_task_compare_priority, NULL);
 
-  task_pool_manager = g_source_new (&trivial_source_funcs, sizeof (GSource));
-  g_source_set_name (task_pool_manager, "GTask thread pool manager");
-  g_source_set_callback (task_pool_manager, task_pool_manager_timeout, NULL, NULL);
-  g_source_set_ready_time (task_pool_manager, -1);
-  g_source_attach (task_pool_manager,
+  pool->manager = g_source_new (&trivial_source_funcs, sizeof (GSource));
+  g_source_set_name (pool->manager, manager_name);
+  g_source_set_callback (pool->manager, task_pool_manager_timeout, pool, NULL);
+  g_source_set_ready_time (pool->manager, -1);
+  g_source_attach (pool->manager,
                    GLIB_PRIVATE_CALL (g_get_worker_context ()));
-  g_source_unref (task_pool_manager);
+  g_source_unref (pool->manager);
+}
+
+static void
+g_task_thread_pool_init (void)
+{
+  gint n_processors = g_get_num_processors ();
+
+  g_task_thread_pool_init_one (G_TASK_POOL_TYPE_BLOCKING,
+                               "GTask thread pool manager",
+                               G_TASK_POOL_SIZE, -1);
+  g_task_thread_pool_init_one (G_TASK_POOL_TYPE_CPU,
+                               "GTask CPU thread pool manager",
+                               n_processors, n_processors);
+  g_task_thread_pool_init_one (G_TASK_POOL_TYPE_HIGH_PRIORITY,
+                               "GTask high priority thread pool manager",
+                               0, -1);
 }
 
 static void
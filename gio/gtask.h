@@ -125,6 +125,24 @@ gboolean      g_task_set_return_on_cancel (GTask           *task,
                                            gboolean         return_on_cancel);
 GLIB_AVAILABLE_IN_2_36
 gboolean      g_task_get_return_on_cancel (GTask           *task);
+G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+GLIB_AVAILABLE_IN_2_68
+void          g_task_set_pool_type        (GTask           *task,
+                                           GTaskPoolType    pool_type);
+GLIB_AVAILABLE_IN_2_68
+GTaskPoolType g_task_get_pool_type        (GTask           *task);
+
+GLIB_AVAILABLE_IN_2_68
+void          g_task_set_pool_limits      (GTaskPoolType    pool_type,
+                                           guint            min_threads,
+                                           gint             max_threads);
+GLIB_AVAILABLE_IN_2_68
+void          g_task_get_pool_limits      (GTaskPoolType    pool_type,
+                                           guint           *min_threads,
+                                           gint            *max_threads);
+GLIB_AVAILABLE_IN_2_68
+GVariant     *g_task_get_pool_statistics  (GTaskPoolType    pool_type);
+G_GNUC_END_IGNORE_DEPRECATIONS
 
 GLIB_AVAILABLE_IN_2_36
 void          g_task_attach_source        (GTask           *task,
@@ -811,6 +811,124 @@ test_connection_signal_match_rules (void)
   session_bus_down ();
 }
 
+typedef struct
+{
+  GString *log;
+  gchar id;
+} SignalOrderData;
+
+static void
+test_connection_signal_order_handler (GDBusConnection  *connection,
+                                      const gchar      *sender_name,
+                                      const gchar      *object_path,
+                                      const gchar      *interface_name,
+                                      const gchar      *signal_name,
+                                      GVariant         *parameters,
+                                      gpointer         user_data)
+{
+  SignalOrderData *data = user_data;
+
+  /* The catch-all subscription also gets NameAcquired from the bus */
+  if (g_strcmp0 (signal_name, "Foo") == 0)
+    g_string_append_c (data->log, data->id);
+}
+
+static void
+test_connection_signal_order (void)
+{
+  const struct
+    {
+      const gchar *interface_name;
+      const gchar *member;
+      const gchar *object_path;
+    }
+  subscriptions[] =
+    {
+      { NULL, NULL, "/" },
+      { "org.gtk.ExampleInterface", "Foo", "/" },
+      { "org.gtk.ExampleInterface", NULL, NULL },
+      { "org.gtk.ExampleInterface", "Bar", "/" },
+      { NULL, "Foo", NULL },
+      { NULL, NULL, "/org/gtk/Example" },
+      { NULL, NULL, NULL },
+      { "org.gtk.ExampleInterface", "Foo", "/" },
+    };
+  SignalOrderData data[G_N_ELEMENTS (subscriptions)];
+  guint subscription_ids[G_N_ELEMENTS (subscriptions)];
+  GDBusConnection *con;
+  GString *log;
+  GError *error = NULL;
+  gsize i;
+
+  session_bus_up ();
+  con = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, NULL);
+
+  /* Subscriptions with different wildcards are kept apart internally, but
+   * the callbacks must still be invoked in the order of subscription. The
+   * last one has the same match rule as the second, so it is invoked along
+   * with it. */
+  log = g_string_new (NULL);
+  for (i = 0; i < G_N_ELEMENTS (subscriptions); i++)
+    {
+      data[i].log = log;
+      data[i].id = 'a' + i;
+      subscription_ids[i] = g_dbus_connection_signal_subscribe (con,
+                                                                NULL,
+                                                                subscriptions[i].interface_name,
+                                                                subscriptions[i].member,
+                                                                subscriptions[i].object_path,
+                                                                NULL,
+                                                                G_DBUS_SIGNAL_FLAGS_NONE,
+                                                                test_connection_signal_order_handler,
+                                                                &data[i], NULL);
+    }
+
+  g_dbus_connection_emit_signal (con,
+                                 NULL, "/", "org.gtk.ExampleInterface",
+                                 "Foo", NULL,
+                                 &error);
+  g_assert_no_error (error);
+
+  /* synchronously ping a non-existent method to make sure the signals are dispatched */
+  g_dbus_connection_call_sync (con, "org.gtk.ExampleInterface", "/", "org.gtk.ExampleInterface",
+                               "Bar", g_variant_new ("()"), G_VARIANT_TYPE_UNIT, G_DBUS_CALL_FLAGS_NONE,
+                               -1, NULL, NULL);
+
+  while (g_main_context_iteration (NULL, FALSE))
+    ;
+
+  g_assert_cmpstr (log->str, ==, "abhceg");
+
+  /* And after removing some of them */
+  g_string_truncate (log, 0);
+  g_dbus_connection_signal_unsubscribe (con, subscription_ids[1]);
+  g_dbus_connection_signal_unsubscribe (con, subscription_ids[4]);
+
+  g_dbus_connection_emit_signal (con,
+                                 NULL, "/", "org.gtk.ExampleInterface",
+                                 "Foo", NULL,
+                                 &error);
+  g_assert_no_error (error);
+  g_dbus_connection_call_sync (con, "org.gtk.ExampleInterface", "/", "org.gtk.ExampleInterface",
+                               "Bar", g_variant_new ("()"), G_VARIANT_TYPE_UNIT, G_DBUS_CALL_FLAGS_NONE,
+                               -1, NULL, NULL);
+
+  while (g_main_context_iteration (NULL, FALSE))
+    ;
+
+  g_assert_cmpstr (log->str, ==, "ahcg");
+
+  for (i = 0; i < G_N_ELEMENTS (subscriptions); i++)
+    {
+      if (i != 1 && i != 4)
+        g_dbus_connection_signal_unsubscribe (con, subscription_ids[i]);
+    }
+
+  g_string_free (log, TRUE);
+  g_object_unref (con);
+  session_bus_down ();
+}
+
 /* ---------------------------------------------------------------------------------------------------- */
 
 /* Accessed both from the test code and the filter function (in a worker thread)
@@ -1286,6 +1404,7 @@ main (int   argc,
   g_test_add_func ("/gdbus/connection/send", test_connection_send);
   g_test_add_func ("/gdbus/connection/signals", test_connection_signals);
   g_test_add_func ("/gdbus/connection/signal-match-rules", test_connection_signal_match_rules);
+  g_test_add_func ("/gdbus/connection/signal-order", test_connection_signal_order);
   g_test_add_func ("/gdbus/connection/filter", test_connection_filter);
   g_test_add_func ("/gdbus/connection/serials", test_connection_serials);
   ret = g_test_run();
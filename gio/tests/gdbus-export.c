@@ -1455,6 +1455,329 @@ test_object_registration_with_closures (void)
   g_object_unref (c);
 }
 
+/* ---------------------------------------------------------------------------------------------------- */
+
+#define N_THREADED_CALLS 20
+
+static const gchar threaded_xml[] =
+  "<node>"
+  "  <interface name='org.example.Threaded'>"
+  "    <method name='Sleep'>"
+  "      <arg type='u' name='seq' direction='in'/>"
+  "    </method>"
+  "  </interface>"
+  "</node>";
+
+typedef struct
+{
+  GMutex mutex;
+  GThread *main_thread;
+  GHashTable *sender_to_last_seq;  /* sender -> highest seq received so far */
+  GHashTable *sender_to_n_running; /* sender -> number of running calls */
+  guint n_running;
+  guint max_running;
+  guint max_running_per_sender;
+  gboolean out_of_order;
+} ThreadedData;
+
+static void
+threaded_method_call (GDBusConnection       *connection,
+                      const gchar           *sender,
+                      const gchar           *object_path,
+                      const gchar           *interface_name,
+                      const gchar           *method_name,
+                      GVariant              *parameters,
+                      GDBusMethodInvocation *invocation,
+                      gpointer               user_data)
+{
+  ThreadedData *data = user_data;
+  guint seq, last_seq, n_running;
+
+  g_assert_true (g_thread_self () != data->main_thread);
+  g_assert_cmpstr (method_name, ==, "Sleep");
+  g_variant_get (parameters, "(u)", &seq);
+
+  g_mutex_lock (&data->mutex);
+  last_seq = GPOINTER_TO_UINT (g_hash_table_lookup (data->sender_to_last_seq, sender));
+  if (seq < last_seq)
+    data->out_of_order = TRUE;
+  g_hash_table_insert (data->sender_to_last_seq, g_strdup (sender), GUINT_TO_POINTER (seq));
+  n_running = GPOINTER_TO_UINT (g_hash_table_lookup (data->sender_to_n_running, sender)) + 1;
+  g_hash_table_insert (data->sender_to_n_running, g_strdup (sender), GUINT_TO_POINTER (n_running));
+  data->max_running_per_sender = MAX (data->max_running_per_sender, n_running);
+  data->n_running++;
+  data->max_running = MAX (data->max_running, data->n_running);
+  g_mutex_unlock (&data->mutex);
+
+  /* give the other calls a chance to overlap with this one */
+  g_usleep (10 * 1000);
+
+  g_mutex_lock (&data->mutex);
+  n_running = GPOINTER_TO_UINT (g_hash_table_lookup (data->sender_to_n_running, sender)) - 1;
+  g_hash_table_insert (data->sender_to_n_running, g_strdup (sender), GUINT_TO_POINTER (n_running));
+  data->n_running--;
+  g_mutex_unlock (&data->mutex);
+
+  g_dbus_method_invocation_return_value (invocation, NULL);
+}
+
+static const GDBusInterfaceVTable threaded_vtable =
+{
+  threaded_method_call,
+  NULL,
+  NULL,
+  { 0 }
+};
+
+static void
+threaded_call_cb (GObject      *source_object,
+                  GAsyncResult *res,
+                  gpointer      user_data)
+{
+  guint *n_replies = user_data;
+  GVariant *result;
+  GError *error = NULL;
+
+  result = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source_object), res, &error);
+  g_assert_no_error (error);
+  g_variant_unref (result);
+
+  (*n_replies)++;
+  g_main_context_wakeup (NULL);
+}
+
+static void
+test_object_registration_in_thread (gconstpointer test_data)
+{
+  GDBusRegistrationFlags flags = GPOINTER_TO_UINT (test_data);
+  GDBusConnection *clients[2];
+  GDBusNodeInfo *node_info;
+  ThreadedData data;
+  guint registration_id;
+  guint n_replies = 0;
+  guint i, j;
+  GError *error = NULL;
+
+  c = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, &error);
+  g_assert_no_error (error);
+
+  /* separate connections, so that the calls come from two senders */
+  for (i = 0; i < G_N_ELEMENTS (clients); i++)
+    {
+      gchar *address = g_dbus_address_get_for_bus_sync (G_BUS_TYPE_SESSION, NULL, &error);
+
+      g_assert_no_error (error);
+      clients[i] = g_dbus_connection_new_for_address_sync (address,
+                                                           G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+                                                           G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+                                                           NULL, NULL, &error);
+      g_assert_no_error (error);
+      g_free (address);
+    }
+
+  node_info = g_dbus_node_info_new_for_xml (threaded_xml, &error);
+  g_assert_no_error (error);
+
+  g_mutex_init (&data.mutex);
+  data.main_thread = g_thread_self ();
+  data.sender_to_last_seq = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  data.sender_to_n_running = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  data.n_running = 0;
+  data.max_running = 0;
+  data.max_running_per_sender = 0;
+  data.out_of_order = FALSE;
+
+  registration_id = g_dbus_connection_register_object_with_flags (c,
+                                                                  "/foo/threaded",
+                                                                  node_info->interfaces[0],
+                                                                  &threaded_vtable,
+                                                                  flags,
+                                                                  &data,
+                                                                  NULL,
+                                                                  &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (registration_id, >, 0);
+
+  for (i = 1; i <= N_THREADED_CALLS; i++)
+    for (j = 0; j < G_N_ELEMENTS (clients); j++)
+      g_dbus_connection_call (clients[j],
+                              g_dbus_connection_get_unique_name (c),
+                              "/foo/threaded",
+                              "org.example.Threaded",
+                              "Sleep",
+                              g_variant_new ("(u)", i),
+                              NULL,
+                              G_DBUS_CALL_FLAGS_NONE,
+                              -1,
+                              NULL,
+                              threaded_call_cb,
+                              &n_replies);
+
+  while (n_replies < N_THREADED_CALLS * G_N_ELEMENTS (clients))
+    g_main_context_iteration (NULL, TRUE);
+
+  /* the calls of both senders always overlap; those of a single sender
+   * only when they are not ordered */
+  g_assert_cmpuint (data.max_running, >, 1);
+  if (flags & G_DBUS_REGISTRATION_FLAGS_ORDER_BY_SENDER)
+    {
+      g_assert_cmpuint (data.max_running_per_sender, ==, 1);
+      g_assert_false (data.out_of_order);
+    }
+  else
+    {
+      g_assert_cmpuint (data.max_running_per_sender, >, 1);
+    }
+
+  g_assert_true (g_dbus_connection_unregister_object (c, registration_id));
+
+  g_hash_table_unref (data.sender_to_n_running);
+  g_hash_table_unref (data.sender_to_last_seq);
+  g_mutex_clear (&data.mutex);
+  g_dbus_node_info_unref (node_info);
+  for (i = 0; i < G_N_ELEMENTS (clients); i++)
+    g_object_unref (clients[i]);
+  g_object_unref (c);
+}
+
+typedef struct
+{
+  GMutex mutex;
+  GCond cond;
+  GThread *main_thread;
+  gboolean running;
+  gboolean released;
+  gboolean freed_while_running;
+  gboolean freed;
+} BlockingData;
+
+static void
+blocking_method_call (GDBusConnection       *connection,
+                      const gchar           *sender,
+                      const gchar           *object_path,
+                      const gchar           *interface_name,
+                      const gchar           *method_name,
+                      GVariant              *parameters,
+                      GDBusMethodInvocation *invocation,
+                      gpointer               user_data)
+{
+  BlockingData *data = user_data;
+
+  g_mutex_lock (&data->mutex);
+  data->running = TRUE;
+  g_cond_broadcast (&data->cond);
+  while (!data->released)
+    g_cond_wait (&data->cond, &data->mutex);
+  data->running = FALSE;
+  g_mutex_unlock (&data->mutex);
+
+  g_dbus_method_invocation_return_value (invocation, NULL);
+}
+
+static void
+blocking_data_free_func (gpointer user_data)
+{
+  BlockingData *data = user_data;
+
+  g_assert_true (g_thread_self () == data->main_thread);
+
+  g_mutex_lock (&data->mutex);
+  if (data->running)
+    data->freed_while_running = TRUE;
+  data->freed = TRUE;
+  g_mutex_unlock (&data->mutex);
+
+  g_main_context_wakeup (NULL);
+}
+
+static const GDBusInterfaceVTable blocking_vtable =
+{
+  blocking_method_call,
+  NULL,
+  NULL,
+  { 0 }
+};
+
+/* The user data of an object is not freed while a method call of it is
+ * still running in a worker thread, even once it has been unregistered */
+static void
+test_object_registration_in_thread_unregister (gconstpointer test_data)
+{
+  GDBusRegistrationFlags flags = GPOINTER_TO_UINT (test_data);
+  GDBusNodeInfo *node_info;
+  BlockingData data;
+  guint registration_id;
+  guint n_replies = 0;
+  gint64 end_time;
+  GError *error = NULL;
+
+  c = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, &error);
+  g_assert_no_error (error);
+
+  node_info = g_dbus_node_info_new_for_xml (threaded_xml, &error);
+  g_assert_no_error (error);
+
+  g_mutex_init (&data.mutex);
+  g_cond_init (&data.cond);
+  data.main_thread = g_thread_self ();
+  data.running = FALSE;
+  data.released = FALSE;
+  data.freed_while_running = FALSE;
+  data.freed = FALSE;
+
+  registration_id = g_dbus_connection_register_object_with_flags (c,
+                                                                  "/foo/threaded",
+                                                                  node_info->interfaces[0],
+                                                                  &blocking_vtable,
+                                                                  flags,
+                                                                  &data,
+                                                                  blocking_data_free_func,
+                                                                  &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (registration_id, >, 0);
+
+  g_dbus_connection_call (c,
+                          g_dbus_connection_get_unique_name (c),
+                          "/foo/threaded",
+                          "org.example.Threaded",
+                          "Sleep",
+                          g_variant_new ("(u)", 1),
+                          NULL,
+                          G_DBUS_CALL_FLAGS_NONE,
+                          -1,
+                          NULL,
+                          threaded_call_cb,
+                          &n_replies);
+
+  g_mutex_lock (&data.mutex);
+  while (!data.running)
+    g_cond_wait (&data.cond, &data.mutex);
+  g_mutex_unlock (&data.mutex);
+
+  g_assert_true (g_dbus_connection_unregister_object (c, registration_id));
+
+  /* give the user data a chance to be freed, which it mustn't be yet */
+  end_time = g_get_monotonic_time () + 100 * G_TIME_SPAN_MILLISECOND;
+  while (g_get_monotonic_time () < end_time)
+    g_main_context_iteration (NULL, FALSE);
+
+  g_mutex_lock (&data.mutex);
+  g_assert_false (data.freed);
+  data.released = TRUE;
+  g_cond_broadcast (&data.cond);
+  g_mutex_unlock (&data.mutex);
+
+  while (n_replies < 1 || !data.freed)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_false (data.freed_while_running);
+
+  g_cond_clear (&data.cond);
+  g_mutex_clear (&data.mutex);
+  g_dbus_node_info_unref (node_info);
+  g_object_unref (c);
+}
+
 static const GDBusInterfaceInfo test_interface_info1 =
 {
   -1,
@@ -1802,6 +2125,20 @@ main (int   argc,
 
   g_test_add_func ("/gdbus/object-registration", test_object_registration);
   g_test_add_func ("/gdbus/object-registration-with-closures", test_object_registration_with_closures);
+  g_test_add_data_func ("/gdbus/object-registration-in-thread",
+                        GUINT_TO_POINTER (G_DBUS_REGISTRATION_FLAGS_DISPATCH_IN_THREAD),
+                        test_object_registration_in_thread);
+  g_test_add_data_func ("/gdbus/object-registration-in-thread-by-sender",
+                        GUINT_TO_POINTER (G_DBUS_REGISTRATION_FLAGS_DISPATCH_IN_THREAD |
+                                          G_DBUS_REGISTRATION_FLAGS_ORDER_BY_SENDER),
+                        test_object_registration_in_thread);
+  g_test_add_data_func ("/gdbus/object-registration-in-thread-unregister",
+                        GUINT_TO_POINTER (G_DBUS_REGISTRATION_FLAGS_DISPATCH_IN_THREAD),
+                        test_object_registration_in_thread_unregister);
+  g_test_add_data_func ("/gdbus/object-registration-in-thread-by-sender-unregister",
+                        GUINT_TO_POINTER (G_DBUS_REGISTRATION_FLAGS_DISPATCH_IN_THREAD |
+                                          G_DBUS_REGISTRATION_FLAGS_ORDER_BY_SENDER),
+                        test_object_registration_in_thread_unregister);
   g_test_add_func ("/gdbus/registered-interfaces", test_registered_interfaces);
   g_test_add_func ("/gdbus/async-properties", test_async_properties);
 
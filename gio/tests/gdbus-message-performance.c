@@ -0,0 +1,196 @@
+/* GLib testing framework examples and tests
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gio/gio.h>
+
+/* Bytes converted in each case, whatever the size of the message */
+#define NUM_BYTES (64 * 1024 * 1024)
+
+typedef enum {
+  PAYLOAD_ASV,
+  PAYLOAD_AY
+} PayloadType;
+
+typedef enum {
+  DIRECTION_TO_BLOB,
+  DIRECTION_FROM_BLOB
+} Direction;
+
+typedef struct {
+  PayloadType payload;
+  gsize payload_size;
+  gboolean serialised;
+  Direction direction;
+} PerfData;
+
+/* Like the properties of a D-Bus object: strings, numbers and structs */
+static GVariant *
+make_asv (gsize n_entries)
+{
+  GVariantBuilder builder;
+  gsize i;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+  for (i = 0; i < n_entries; i++)
+    {
+      gchar *key = g_strdup_printf ("Property%" G_GSIZE_FORMAT, i);
+
+      switch (i % 3)
+        {
+        case 0:
+          g_variant_builder_add (&builder, "{sv}", key, g_variant_new_string ("a string value"));
+          break;
+        case 1:
+          g_variant_builder_add (&builder, "{sv}", key, g_variant_new_uint32 (i));
+          break;
+        default:
+          g_variant_builder_add (&builder, "{sv}", key, g_variant_new ("(bx)", TRUE, (gint64) i));
+          break;
+        }
+
+      g_free (key);
+    }
+
+  return g_variant_new ("(a{sv})", &builder);
+}
+
+static GVariant *
+make_ay (gsize size)
+{
+  guint8 *data = g_malloc0 (size);
+
+  return g_variant_new ("(@ay)",
+                        g_variant_new_from_data (G_VARIANT_TYPE_BYTESTRING,
+                                                 data, size, TRUE, g_free, data));
+}
+
+static void
+perform (gconstpointer data)
+{
+  const PerfData *perf = data;
+  GDBusMessage *message;
+  GVariant *body;
+  guchar *blob;
+  gsize blob_size;
+  gdouble time_elapsed;
+  gdouble result;
+  guint n_messages;
+  guint i;
+  GError *error = NULL;
+
+  if (perf->payload == PAYLOAD_ASV)
+    body = make_asv (perf->payload_size);
+  else
+    body = make_ay (perf->payload_size);
+
+  /* As received from the bus, rather than built by the application */
+  if (perf->serialised)
+    {
+      GVariant *tree = g_variant_ref_sink (body);
+
+      body = g_variant_new_from_bytes (g_variant_get_type (tree),
+                                       g_variant_get_data_as_bytes (tree),
+                                       TRUE);
+      g_variant_unref (tree);
+    }
+
+  message = g_dbus_message_new_signal ("/org/gtk/GDBus/Perf",
+                                       "org.gtk.GDBus.Perf",
+                                       "Payload");
+  g_dbus_message_set_body (message, body);
+
+  blob = g_dbus_message_to_blob (message, &blob_size,
+                                 G_DBUS_CAPABILITY_FLAGS_NONE, &error);
+  g_assert_no_error (error);
+
+  n_messages = MAX (NUM_BYTES / blob_size, 10);
+
+  g_test_timer_start ();
+
+  for (i = 0; i < n_messages; i++)
+    {
+      if (perf->direction == DIRECTION_TO_BLOB)
+        {
+          guchar *new_blob;
+          gsize new_blob_size;
+
+          new_blob = g_dbus_message_to_blob (message, &new_blob_size,
+                                             G_DBUS_CAPABILITY_FLAGS_NONE,
+                                             NULL);
+          g_free (new_blob);
+        }
+      else
+        {
+          GDBusMessage *new_message;
+
+          new_message = g_dbus_message_new_from_blob (blob, blob_size,
+                                                      G_DBUS_CAPABILITY_FLAGS_NONE,
+                                                      NULL);
+          g_object_unref (new_message);
+        }
+    }
+
+  time_elapsed = g_test_timer_elapsed ();
+
+  g_free (blob);
+  g_object_unref (message);
+
+  result = n_messages / time_elapsed;
+
+  g_test_maximized_result (result, "%9.0f messages/s, %6.1f MB/s (%" G_GSIZE_FORMAT " bytes each)",
+                           result, result * blob_size / 1e6, blob_size);
+}
+
+static void
+add_case (const gchar *path,
+          PayloadType  payload,
+          gsize        payload_size,
+          gboolean     serialised,
+          Direction    direction)
+{
+  PerfData *perf = g_new0 (PerfData, 1);
+
+  perf->payload = payload;
+  perf->payload_size = payload_size;
+  perf->serialised = serialised;
+  perf->direction = direction;
+
+  g_test_add_data_func_full (path, perf, perform, g_free);
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  if (g_test_perf ())
+    {
+      add_case ("/gdbus/message/perf/to-blob/asv/10", PAYLOAD_ASV, 10, FALSE, DIRECTION_TO_BLOB);
+      add_case ("/gdbus/message/perf/to-blob/asv/1000", PAYLOAD_ASV, 1000, FALSE, DIRECTION_TO_BLOB);
+      add_case ("/gdbus/message/perf/to-blob/asv-serialised/10", PAYLOAD_ASV, 10, TRUE, DIRECTION_TO_BLOB);
+      add_case ("/gdbus/message/perf/to-blob/asv-serialised/1000", PAYLOAD_ASV, 1000, TRUE, DIRECTION_TO_BLOB);
+      add_case ("/gdbus/message/perf/to-blob/ay/64", PAYLOAD_AY, 64, FALSE, DIRECTION_TO_BLOB);
+      add_case ("/gdbus/message/perf/to-blob/ay/1048576", PAYLOAD_AY, 1 << 20, FALSE, DIRECTION_TO_BLOB);
+      add_case ("/gdbus/message/perf/from-blob/asv/10", PAYLOAD_ASV, 10, FALSE, DIRECTION_FROM_BLOB);
+      add_case ("/gdbus/message/perf/from-blob/asv/1000", PAYLOAD_ASV, 1000, FALSE, DIRECTION_FROM_BLOB);
+      add_case ("/gdbus/message/perf/from-blob/ay/64", PAYLOAD_AY, 64, FALSE, DIRECTION_FROM_BLOB);
+      add_case ("/gdbus/message/perf/from-blob/ay/1048576", PAYLOAD_AY, 1 << 20, FALSE, DIRECTION_FROM_BLOB);
+    }
+
+  return g_test_run ();
+}
@@ -28,6 +28,7 @@
 #include <gio/gunixinputstream.h>
 #include <gio/gunixoutputstream.h>
 #include <gio/gunixconnection.h>
+#include <gio/gunixfdlist.h>
 #endif
 
 #include "gdbus-tests.h"
@@ -275,6 +276,160 @@ test_non_socket (void)
   exit (0);
 }
 
+/* ---------------------------------------------------------------------------------------------------- */
+
+typedef struct
+{
+  GMutex mutex;
+  GCond cond;
+  gboolean holding;
+  gboolean released;
+  gint plain_received;  /* (atomic) */
+} FdAfterMessageData;
+
+/* Holds the client's worker thread after it has taken the "Hold" signal
+ * off the write queue, so the messages sent meanwhile are written
+ * together. */
+static GDBusMessage *
+hold_filter (GDBusConnection *connection,
+             GDBusMessage    *message,
+             gboolean         incoming,
+             gpointer         user_data)
+{
+  FdAfterMessageData *data = user_data;
+
+  if (!incoming && g_strcmp0 (g_dbus_message_get_member (message), "Hold") == 0)
+    {
+      g_mutex_lock (&data->mutex);
+      data->holding = TRUE;
+      g_cond_broadcast (&data->cond);
+      while (!data->released)
+        g_cond_wait (&data->cond, &data->mutex);
+      g_mutex_unlock (&data->mutex);
+    }
+
+  return message;
+}
+
+static GDBusMessage *
+plain_filter (GDBusConnection *connection,
+              GDBusMessage    *message,
+              gboolean         incoming,
+              gpointer         user_data)
+{
+  FdAfterMessageData *data = user_data;
+
+  if (incoming && g_strcmp0 (g_dbus_message_get_member (message), "Plain") == 0)
+    g_atomic_int_set (&data->plain_received, TRUE);
+
+  return message;
+}
+
+static void
+server_new_cb (GObject      *source_object,
+               GAsyncResult *res,
+               gpointer      user_data)
+{
+  GDBusConnection **server = user_data;
+  GError *error = NULL;
+
+  *server = g_dbus_connection_new_finish (res, &error);
+  g_assert_no_error (error);
+}
+
+/* A message queued ahead of one carrying file descriptors is still
+ * written out on a stream which can't send those, even when both are
+ * written at the same time; only the latter fails. */
+static void
+test_non_socket_fd_after_message (void)
+{
+  GIOStream *streams[2];
+  GDBusConnection *server = NULL;
+  GDBusConnection *client;
+  GDBusMessage *message;
+  GUnixFDList *fd_list;
+  FdAfterMessageData data = { 0, };
+  GError *error = NULL;
+  gchar *guid;
+  gint64 deadline;
+  gboolean ok;
+
+  ok = test_bidi_pipe (&streams[0], &streams[1], &error);
+  g_assert_no_error (error);
+  g_assert_true (ok);
+
+  guid = g_dbus_generate_guid ();
+  g_dbus_connection_new (streams[0],
+                         guid,
+                         G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_SERVER,
+                         NULL, /* GDBusAuthObserver */
+                         NULL, /* cancellable */
+                         server_new_cb,
+                         &server);
+  g_free (guid);
+
+  client = g_dbus_connection_new_sync (streams[1],
+                                       NULL, /* guid */
+                                       G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT,
+                                       NULL, /* GDBusAuthObserver */
+                                       NULL, /* cancellable */
+                                       &error);
+  g_assert_no_error (error);
+
+  while (server == NULL)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_dbus_connection_add_filter (server, plain_filter, &data, NULL);
+  g_dbus_connection_add_filter (client, hold_filter, &data, NULL);
+
+  g_dbus_connection_emit_signal (client, NULL, "/", "org.gtk.GDBus.Test", "Hold",
+                                 NULL, &error);
+  g_assert_no_error (error);
+
+  g_mutex_lock (&data.mutex);
+  while (!data.holding)
+    g_cond_wait (&data.cond, &data.mutex);
+  g_mutex_unlock (&data.mutex);
+
+  g_dbus_connection_emit_signal (client, NULL, "/", "org.gtk.GDBus.Test", "Plain",
+                                 NULL, &error);
+  g_assert_no_error (error);
+
+  message = g_dbus_message_new_signal ("/", "org.gtk.GDBus.Test", "Fd");
+  fd_list = g_unix_fd_list_new ();
+  g_unix_fd_list_append (fd_list, 0, &error);
+  g_assert_no_error (error);
+  g_dbus_message_set_body (message, g_variant_new ("(h)", 0));
+  g_dbus_message_set_unix_fd_list (message, fd_list);
+  g_dbus_connection_send_message (client, message, G_DBUS_SEND_MESSAGE_FLAGS_NONE,
+                                  NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (fd_list);
+  g_object_unref (message);
+
+  g_mutex_lock (&data.mutex);
+  data.released = TRUE;
+  g_cond_broadcast (&data.cond);
+  g_mutex_unlock (&data.mutex);
+
+  /* The plain message arrives, then the client fails on the other one */
+  deadline = g_get_monotonic_time () + 10 * G_USEC_PER_SEC;
+  while ((!g_atomic_int_get (&data.plain_received) ||
+          !g_dbus_connection_is_closed (client)) &&
+         g_get_monotonic_time () < deadline)
+    g_main_context_iteration (NULL, FALSE);
+
+  g_assert_true (g_atomic_int_get (&data.plain_received));
+  g_assert_true (g_dbus_connection_is_closed (client));
+
+  g_object_unref (client);
+  g_object_unref (server);
+  g_object_unref (streams[0]);
+  g_object_unref (streams[1]);
+  g_mutex_clear (&data.mutex);
+  g_cond_clear (&data.cond);
+}
+
 #else /* G_OS_UNIX */
 
 static void
@@ -295,6 +450,9 @@ main (int   argc,
   g_test_init (&argc, &argv, NULL);
 
   g_test_add_func ("/gdbus/non-socket", test_non_socket);
+#ifdef G_OS_UNIX
+  g_test_add_func ("/gdbus/non-socket/fd-after-message", test_non_socket_fd_after_message);
+#endif
 
   ret = g_test_run();
 
@@ -1392,6 +1392,161 @@ test_peer_signals (void)
 
 /* ---------------------------------------------------------------------------------------------------- */
 
+#ifdef G_OS_UNIX
+
+#define BURST_NUM_MESSAGES 500
+
+/* Runs in the worker thread of the server side connection */
+static GDBusMessage *
+burst_filter_func (GDBusConnection *connection,
+                   GDBusMessage    *message,
+                   gboolean         incoming,
+                   gpointer         user_data)
+{
+  GAsyncQueue *queue = user_data;
+
+  if (incoming &&
+      g_dbus_message_get_message_type (message) == G_DBUS_MESSAGE_TYPE_SIGNAL &&
+      g_strcmp0 (g_dbus_message_get_member (message), "Burst") == 0)
+    g_async_queue_push (queue, g_object_ref (message));
+
+  return message;
+}
+
+/* Queued messages are written out several at a time; the ones carrying
+ * file descriptors must still have them attached to the right message. */
+static void
+test_peer_burst_with_fds (void)
+{
+  GDBusConnection *c;
+  GDBusConnection *server_connection;
+  GAsyncQueue *queue;
+  GError *error = NULL;
+  PeerData data;
+  GThread *service_thread;
+  guint filter_id;
+  guint i;
+
+  test_guid = g_dbus_generate_guid ();
+  loop = g_main_loop_new (NULL, FALSE);
+
+  setup_test_address ();
+  memset (&data, '\0', sizeof (PeerData));
+  data.current_connections = g_ptr_array_new_with_free_func (g_object_unref);
+
+  /* bring up a server - we run the server in a different thread to avoid deadlocks */
+  service_thread = g_thread_new ("test_peer",
+                                 service_thread_func,
+                                 &data);
+  await_service_loop ();
+  g_assert_nonnull (server);
+
+  /* bring up a connection and accept it */
+  data.accept_connection = TRUE;
+  c = g_dbus_connection_new_for_address_sync (g_dbus_server_get_client_address (server),
+                                              G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT,
+                                              NULL, /* GDBusAuthObserver */
+                                              NULL, /* cancellable */
+                                              &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (c);
+  while (data.current_connections->len < 1)
+    g_main_loop_run (loop);
+  g_assert_cmpint (data.current_connections->len, ==, 1);
+
+  if (!(g_dbus_connection_get_capabilities (c) & G_DBUS_CAPABILITY_FLAGS_UNIX_FD_PASSING))
+    {
+      g_test_skip ("File descriptor passing not supported on this connection");
+      goto out;
+    }
+
+  server_connection = data.current_connections->pdata[0];
+  queue = g_async_queue_new_full (g_object_unref);
+  filter_id = g_dbus_connection_add_filter (server_connection,
+                                            burst_filter_func,
+                                            queue,
+                                            NULL);
+
+  /* Every seventh message carries a file descriptor */
+  for (i = 0; i < BURST_NUM_MESSAGES; i++)
+    {
+      GDBusMessage *message;
+
+      message = g_dbus_message_new_signal ("/org/gtk/GDBus/PeerTestObject",
+                                           "org.gtk.GDBus.PeerTestInterface",
+                                           "Burst");
+      if (i % 7 == 0)
+        {
+          GUnixFDList *fd_list;
+          gint fd;
+
+          fd = g_open ("/dev/null", O_RDONLY, 0);
+          g_assert_cmpint (fd, !=, -1);
+          fd_list = g_unix_fd_list_new_from_array (&fd, 1);
+          g_dbus_message_set_unix_fd_list (message, fd_list);
+          g_dbus_message_set_body (message, g_variant_new ("(uh)", i, 0));
+          g_object_unref (fd_list);
+        }
+      else
+        {
+          g_dbus_message_set_body (message, g_variant_new ("(u)", i));
+        }
+
+      g_dbus_connection_send_message (c, message, G_DBUS_SEND_MESSAGE_FLAGS_NONE, NULL, &error);
+      g_assert_no_error (error);
+      g_object_unref (message);
+    }
+
+  for (i = 0; i < BURST_NUM_MESSAGES; i++)
+    {
+      GDBusMessage *message;
+      GUnixFDList *fd_list;
+      guint32 n;
+
+      message = g_async_queue_timeout_pop (queue, 10 * G_USEC_PER_SEC);
+      g_assert_nonnull (message);
+
+      g_variant_get_child (g_dbus_message_get_body (message), 0, "u", &n);
+      g_assert_cmpuint (n, ==, i);
+
+      fd_list = g_dbus_message_get_unix_fd_list (message);
+      if (i % 7 == 0)
+        {
+          g_assert_nonnull (fd_list);
+          g_assert_cmpint (g_unix_fd_list_get_length (fd_list), ==, 1);
+        }
+      else
+        {
+          g_assert_null (fd_list);
+        }
+
+      g_object_unref (message);
+    }
+
+  g_dbus_connection_remove_filter (server_connection, filter_id);
+  g_async_queue_unref (queue);
+
+ out:
+  /* unref the server and stop listening for new connections */
+  g_dbus_server_stop (server);
+  g_clear_object (&server);
+
+  g_object_unref (c);
+  g_ptr_array_unref (data.current_connections);
+
+  g_main_loop_quit (service_loop);
+  g_thread_join (service_thread);
+
+  teardown_test_address ();
+
+  g_main_loop_unref (loop);
+  g_free (test_guid);
+}
+
+#endif /* G_OS_UNIX */
+
+/* ---------------------------------------------------------------------------------------------------- */
+
 typedef struct
 {
   GDBusServer *server;
@@ -2198,6 +2353,9 @@ main (int   argc,
   g_test_add_func ("/gdbus/peer-to-peer/invalid/conn/addr/sync",
                    test_peer_invalid_conn_addr_sync);
   g_test_add_func ("/gdbus/peer-to-peer/signals", test_peer_signals);
+#ifdef G_OS_UNIX
+  g_test_add_func ("/gdbus/peer-to-peer/burst-with-fds", test_peer_burst_with_fds);
+#endif
   g_test_add_func ("/gdbus/delayed-message-processing", delayed_message_processing);
   g_test_add_func ("/gdbus/nonce-tcp", test_nonce_tcp);
 
@@ -1116,6 +1116,86 @@ test_message_serialize_double_array (void)
 
 /* ---------------------------------------------------------------------------------------------------- */
 
+/* Bodies in serialised form are converted to the wire format directly from
+ * their data, the ones in tree form one GVariant at a time. Check both give
+ * the same blob. */
+static void
+test_message_serialize_serialised_body (void)
+{
+  const gchar *bodies[] = {
+    "(true, false, byte 0xff, int16 -2, uint16 3, -4, uint32 5, int64 -6, uint64 7, 8.5, handle 9)",
+    "('a string', objectpath '/an/object/path', signature 'a{sv}', '')",
+    "(@ay [1, 2, 3], @an [-1, 2], @au [], @at [1, 2], @ad [0.5], @ab [true, false, true])",
+    "(@a(ii) [(1, 2), (3, 4)], @a(xi) [(1, 2), (3, 4)], @a(yu) [(1, 2)], @a(uy) [(1, 2), (3, 4)])",
+    "(@as ['one', 'two', ''], @aas [['a'], [], ['b', 'c']], @aay [[1], [], [2, 3]], @aaax [[], [], []])",
+    "(@a{sv} {'one': <'1'>, 'two': <(byte 2, 'two')>, 'three': <@ai [3]>, 'four': <<true>>}, @a{us} {})",
+    "(@a(sa{sv}as) [('a', {'b': <'c'>}, ['d']), ('', {}, [])], byte 1)",
+    "(byte 1, (byte 2, uint64 3), 'x', (int16 4, 'y', (true, 'z')))",
+  };
+  const GDBusMessageByteOrder byte_orders[] = {
+    G_DBUS_MESSAGE_BYTE_ORDER_LITTLE_ENDIAN,
+    G_DBUS_MESSAGE_BYTE_ORDER_BIG_ENDIAN,
+  };
+  gsize i, j;
+
+  for (i = 0; i < G_N_ELEMENTS (bodies); i++)
+    for (j = 0; j < G_N_ELEMENTS (byte_orders); j++)
+      {
+        GDBusMessage *message;
+        GDBusMessage *recovered_message;
+        GVariant *body;
+        GVariant *serialised_body;
+        guchar *blob;
+        gsize blob_size;
+        guchar *serialised_blob;
+        gsize serialised_blob_size;
+        GError *error = NULL;
+
+        g_test_message ("Body %s, byte order %c", bodies[i], byte_orders[j]);
+
+        body = g_variant_parse (NULL, bodies[i], NULL, NULL, &error);
+        g_assert_no_error (error);
+        g_variant_ref_sink (body);
+
+        message = g_dbus_message_new_signal ("/the/path", "the.Interface", "Member");
+        g_dbus_message_set_byte_order (message, byte_orders[j]);
+        g_dbus_message_set_body (message, body);
+        blob = g_dbus_message_to_blob (message, &blob_size,
+                                       G_DBUS_CAPABILITY_FLAGS_NONE, &error);
+        g_assert_no_error (error);
+        g_object_unref (message);
+
+        /* Untrusted, so that it is checked for normal form first */
+        serialised_body = g_variant_new_from_data (g_variant_get_type (body),
+                                                   g_variant_get_data (body),
+                                                   g_variant_get_size (body),
+                                                   FALSE, NULL, NULL);
+
+        message = g_dbus_message_new_signal ("/the/path", "the.Interface", "Member");
+        g_dbus_message_set_byte_order (message, byte_orders[j]);
+        g_dbus_message_set_body (message, serialised_body);
+        serialised_blob = g_dbus_message_to_blob (message, &serialised_blob_size,
+                                                  G_DBUS_CAPABILITY_FLAGS_NONE, &error);
+        g_assert_no_error (error);
+        g_object_unref (message);
+
+        g_assert_cmpmem (serialised_blob, serialised_blob_size, blob, blob_size);
+
+        recovered_message = g_dbus_message_new_from_blob (blob, blob_size,
+                                                          G_DBUS_CAPABILITY_FLAGS_NONE,
+                                                          &error);
+        g_assert_no_error (error);
+        g_assert_true (g_variant_equal (g_dbus_message_get_body (recovered_message), body));
+        g_object_unref (recovered_message);
+
+        g_free (serialised_blob);
+        g_free (blob);
+        g_variant_unref (body);
+      }
+}
+
+/* ---------------------------------------------------------------------------------------------------- */
+
 /* Test that an invalid header in a D-Bus message (specifically, with a type
  * which doesn’t match what’s expected for the given header) is gracefully
  * handled with an error rather than a crash.
@@ -1413,6 +1493,78 @@ test_message_parse_deep_body_nesting (void)
 
 /* ---------------------------------------------------------------------------------------------------- */
 
+/* Messages in the native byte order share the data of their strings,
+ * fixed size arrays and (some) fixed size bodies with a copy of the blob
+ * instead of copying each of them. Check they are parsed right either
+ * way, and don't use the blob passed in once parsing is done. */
+static void
+test_message_parse_shared_data (void)
+{
+  const gchar *bodies[] = {
+    "(uint32 1, uint32 2, uint64 3)",
+    "(byte 1, uint32 2)",
+    "(uint32 1, byte 2)",
+    "(int16 -1, uint16 2, int32 -3, int64 4, 5.0)",
+    "(true, uint32 2)",
+    "(@ay [1, 2, 3, 4, 5],)",
+    "(@at [1, 2, 3], @an [], @ad [0.5, 1.5])",
+    "('a string', objectpath '/an/object/path', signature 'a{sv}')",
+    "('', @as ['one', 'two', ''])",
+    "(@a{sv} {'one': <'1'>, 'two': <[byte 0x32, 0x32]>}, @as ['invalidated'])",
+    "(<(uint32 1, 'inside a variant', [1, 2])>,)",
+  };
+  const GDBusMessageByteOrder byte_orders[] = {
+    G_DBUS_MESSAGE_BYTE_ORDER_LITTLE_ENDIAN,
+    G_DBUS_MESSAGE_BYTE_ORDER_BIG_ENDIAN,
+  };
+  gsize i, j;
+
+  for (i = 0; i < G_N_ELEMENTS (bodies); i++)
+    for (j = 0; j < G_N_ELEMENTS (byte_orders); j++)
+      {
+        GDBusMessage *message;
+        GDBusMessage *recovered_message;
+        GVariant *body;
+        guchar *blob;
+        gsize blob_size;
+        GError *error = NULL;
+
+        g_test_message ("Body %s, byte order %c", bodies[i], byte_orders[j]);
+
+        body = g_variant_parse (NULL, bodies[i], NULL, NULL, &error);
+        g_assert_no_error (error);
+
+        message = g_dbus_message_new_signal ("/the/path", "the.Interface", "Member");
+        g_dbus_message_set_sender (message, ":1.42");
+        g_dbus_message_set_byte_order (message, byte_orders[j]);
+        g_dbus_message_set_body (message, body);
+
+        blob = g_dbus_message_to_blob (message, &blob_size,
+                                       G_DBUS_CAPABILITY_FLAGS_NONE, &error);
+        g_assert_no_error (error);
+
+        recovered_message = g_dbus_message_new_from_blob (blob, blob_size,
+                                                          G_DBUS_CAPABILITY_FLAGS_NONE,
+                                                          &error);
+        g_assert_no_error (error);
+
+        memset (blob, 0xaa, blob_size);
+        g_free (blob);
+
+        g_assert_cmpstr (g_dbus_message_get_path (recovered_message), ==, "/the/path");
+        g_assert_cmpstr (g_dbus_message_get_interface (recovered_message), ==, "the.Interface");
+        g_assert_cmpstr (g_dbus_message_get_member (recovered_message), ==, "Member");
+        g_assert_cmpstr (g_dbus_message_get_sender (recovered_message), ==, ":1.42");
+        g_assert_true (g_variant_equal (g_dbus_message_get_body (recovered_message), body));
+        g_assert_true (g_variant_is_normal_form (g_dbus_message_get_body (recovered_message)));
+
+        g_object_unref (recovered_message);
+        g_object_unref (message);
+      }
+}
+
+/* ---------------------------------------------------------------------------------------------------- */
+
 int
 main (int   argc,
       char *argv[])
@@ -1433,6 +1585,8 @@ main (int   argc,
                    test_message_serialize_header_checks);
   g_test_add_func ("/gdbus/message-serialize/double-array",
                    test_message_serialize_double_array);
+  g_test_add_func ("/gdbus/message-serialize/serialised-body",
+                   test_message_serialize_serialised_body);
 
   g_test_add_func ("/gdbus/message-parse/empty-arrays-of-arrays",
                    test_message_parse_empty_arrays_of_arrays);
@@ -1448,6 +1602,8 @@ main (int   argc,
                    test_message_parse_deep_header_nesting);
   g_test_add_func ("/gdbus/message-parse/deep-body-nesting",
                    test_message_parse_deep_body_nesting);
+  g_test_add_func ("/gdbus/message-parse/shared-data",
+                   test_message_parse_shared_data);
 
   return g_test_run();
 }
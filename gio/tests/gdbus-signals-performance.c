@@ -0,0 +1,176 @@
+/* GLib testing framework examples and tests
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gio/gio.h>
+
+#include <sys/socket.h>
+
+#define NUM_SIGNALS 20000
+
+typedef struct {
+  guint n_subscriptions;
+} PerfData;
+
+static void
+on_signal (GDBusConnection *connection,
+           const gchar     *sender_name,
+           const gchar     *object_path,
+           const gchar     *interface_name,
+           const gchar     *signal_name,
+           GVariant        *parameters,
+           gpointer         user_data)
+{
+  guint *n_received = user_data;
+
+  (*n_received)++;
+}
+
+static GDBusConnection *
+connection_new_for_fd (gint fd)
+{
+  GSocket *socket;
+  GSocketConnection *socket_connection;
+  GDBusConnection *connection;
+  GError *error = NULL;
+
+  socket = g_socket_new_from_fd (fd, &error);
+  g_assert_no_error (error);
+  socket_connection = g_socket_connection_factory_create_connection (socket);
+  g_object_unref (socket);
+
+  connection = g_dbus_connection_new_sync (G_IO_STREAM (socket_connection),
+                                           NULL,
+                                           G_DBUS_CONNECTION_FLAGS_NONE,
+                                           NULL, NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (socket_connection);
+
+  return connection;
+}
+
+/* Like a client of a service with many objects: one PropertiesChanged
+ * subscription per object, and the service emitting on all of them.
+ */
+static void
+perform (gconstpointer data)
+{
+  const PerfData *perf = data;
+  GDBusConnection *emitter, *receiver;
+  guint *subscription_ids;
+  gchar **paths;
+  gint sv[2];
+  guint n_received = 0;
+  gdouble time_elapsed;
+  gdouble result;
+  guint i;
+
+  g_assert_cmpint (socketpair (AF_UNIX, SOCK_STREAM, 0, sv), ==, 0);
+  emitter = connection_new_for_fd (sv[0]);
+  receiver = connection_new_for_fd (sv[1]);
+
+  subscription_ids = g_new (guint, perf->n_subscriptions);
+  paths = g_new (gchar *, perf->n_subscriptions);
+
+  for (i = 0; i < perf->n_subscriptions; i++)
+    {
+      paths[i] = g_strdup_printf ("/org/gtk/GDBus/Perf/Object%u", i);
+      subscription_ids[i] = g_dbus_connection_signal_subscribe (receiver,
+                                                                NULL,
+                                                                "org.freedesktop.DBus.Properties",
+                                                                "PropertiesChanged",
+                                                                paths[i],
+                                                                "org.gtk.GDBus.Perf",
+                                                                G_DBUS_SIGNAL_FLAGS_NONE,
+                                                                on_signal,
+                                                                &n_received,
+                                                                NULL);
+    }
+
+  g_test_timer_start ();
+
+  for (i = 0; i < NUM_SIGNALS; i++)
+    {
+      GError *error = NULL;
+
+      g_dbus_connection_emit_signal (emitter,
+                                     NULL,
+                                     paths[(i * 7919) % perf->n_subscriptions],
+                                     "org.freedesktop.DBus.Properties",
+                                     "PropertiesChanged",
+                                     g_variant_new ("(sa{sv}as)", "org.gtk.GDBus.Perf", NULL, NULL),
+                                     &error);
+      g_assert_no_error (error);
+
+      /* Don't let the emitter get too far ahead */
+      if (i % 100 == 0)
+        while (n_received + 1000 < i)
+          g_main_context_iteration (NULL, TRUE);
+    }
+
+  while (n_received < NUM_SIGNALS)
+    g_main_context_iteration (NULL, TRUE);
+
+  time_elapsed = g_test_timer_elapsed ();
+
+  for (i = 0; i < perf->n_subscriptions; i++)
+    {
+      g_dbus_connection_signal_unsubscribe (receiver, subscription_ids[i]);
+      g_free (paths[i]);
+    }
+
+  g_free (subscription_ids);
+  g_free (paths);
+  g_object_unref (receiver);
+  g_object_unref (emitter);
+
+  /* Let the destroy notifies run */
+  while (g_main_context_iteration (NULL, FALSE));
+
+  result = NUM_SIGNALS / time_elapsed;
+
+  g_test_maximized_result (result, "%8.0f signals/s with %u subscriptions",
+                           result, perf->n_subscriptions);
+}
+
+static void
+add_case (guint n_subscriptions)
+{
+  PerfData *perf = g_new0 (PerfData, 1);
+  gchar *path;
+
+  perf->n_subscriptions = n_subscriptions;
+
+  path = g_strdup_printf ("/gdbus/signals/perf/fan-in/%u", n_subscriptions);
+  g_test_add_data_func_full (path, perf, perform, g_free);
+  g_free (path);
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  if (g_test_perf ())
+    {
+      add_case (1);
+      add_case (100);
+      add_case (10000);
+    }
+
+  return g_test_run ();
+}
@@ -1408,6 +1408,157 @@ test_run_in_thread_overflow (void)
   g_assert_cmpint (i + strspn (buf + i, "X"), ==, NUM_OVERFLOW_TASKS);
 }
 
+/* test_pool_limits: tasks of a pool don't run on more threads than its
+ * maximum, and its statistics show the others waiting.
+ */
+static GMutex pool_limits_mutex;
+static gint pool_limits_completed;
+
+static void
+pool_limits_task_thread (GTask        *task,
+                         gpointer      source_object,
+                         gpointer      task_data,
+                         GCancellable *cancellable)
+{
+  g_mutex_lock (&pool_limits_mutex);
+  g_mutex_unlock (&pool_limits_mutex);
+
+  g_task_return_boolean (task, TRUE);
+  g_atomic_int_inc (&pool_limits_completed);
+}
+
+static guint64
+pool_statistic (GTaskPoolType  pool_type,
+                const gchar   *key)
+{
+  GVariant *statistics;
+  GVariant *value;
+  guint64 result;
+
+  statistics = g_task_get_pool_statistics (pool_type);
+  value = g_variant_lookup_value (statistics, key, NULL);
+  g_assert_nonnull (value);
+
+  if (g_variant_is_of_type (value, G_VARIANT_TYPE_UINT64))
+    result = g_variant_get_uint64 (value);
+  else
+    result = g_variant_get_uint32 (value);
+
+  g_variant_unref (value);
+  g_variant_unref (statistics);
+
+  return result;
+}
+
+#define NUM_POOL_LIMITS_TASKS 8
+
+static void
+test_pool_limits (void)
+{
+  guint min_threads, old_min_threads;
+  gint max_threads, old_max_threads;
+  guint64 completed;
+  gint i;
+
+  g_task_get_pool_limits (G_TASK_POOL_TYPE_CPU, &old_min_threads, &old_max_threads);
+  g_assert_cmpuint (old_min_threads, ==, g_get_num_processors ());
+  g_assert_cmpint (old_max_threads, ==, g_get_num_processors ());
+
+  g_task_set_pool_limits (G_TASK_POOL_TYPE_CPU, 2, 2);
+  g_task_get_pool_limits (G_TASK_POOL_TYPE_CPU, &min_threads, &max_threads);
+  g_assert_cmpuint (min_threads, ==, 2);
+  g_assert_cmpint (max_threads, ==, 2);
+
+  completed = pool_statistic (G_TASK_POOL_TYPE_CPU, "completed");
+
+  g_mutex_lock (&pool_limits_mutex);
+
+  for (i = 0; i < NUM_POOL_LIMITS_TASKS; i++)
+    {
+      GTask *task = g_task_new (NULL, NULL, NULL, NULL);
+
+      g_task_set_pool_type (task, G_TASK_POOL_TYPE_CPU);
+      g_assert_cmpint (g_task_get_pool_type (task), ==, G_TASK_POOL_TYPE_CPU);
+      g_task_run_in_thread (task, pool_limits_task_thread);
+      g_object_unref (task);
+    }
+
+  /* Two tasks block, and the pool doesn't grow however long they do */
+  while (pool_statistic (G_TASK_POOL_TYPE_CPU, "running") < 2)
+    g_usleep (1000);
+  g_usleep (200000);
+
+  g_assert_cmpuint (pool_statistic (G_TASK_POOL_TYPE_CPU, "running"), ==, 2);
+  g_assert_cmpuint (pool_statistic (G_TASK_POOL_TYPE_CPU, "threads"), ==, 2);
+  g_assert_cmpuint (pool_statistic (G_TASK_POOL_TYPE_CPU, "queued"), ==, NUM_POOL_LIMITS_TASKS - 2);
+
+  g_mutex_unlock (&pool_limits_mutex);
+
+  while (g_atomic_int_get (&pool_limits_completed) != NUM_POOL_LIMITS_TASKS)
+    g_usleep (1000);
+  while (pool_statistic (G_TASK_POOL_TYPE_CPU, "completed") != completed + NUM_POOL_LIMITS_TASKS)
+    g_usleep (1000);
+
+  /* The queued tasks waited for the blocked ones */
+  g_assert_cmpuint (pool_statistic (G_TASK_POOL_TYPE_CPU, "max-queue-time"), >=, 200000);
+  g_assert_cmpuint (pool_statistic (G_TASK_POOL_TYPE_CPU, "queued"), ==, 0);
+
+  g_task_set_pool_limits (G_TASK_POOL_TYPE_CPU, old_min_threads, old_max_threads);
+}
+
+/* test_pool_high_priority: high priority tasks only get their own pool
+ * once it is given threads.
+ */
+static void
+run_pool_task_thread (GTask        *task,
+                      gpointer      source_object,
+                      gpointer      task_data,
+                      GCancellable *cancellable)
+{
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+run_pool_task (gint priority)
+{
+  GTask *task;
+
+  task = g_task_new (NULL, NULL, NULL, NULL);
+  g_task_set_priority (task, priority);
+  g_task_run_in_thread_sync (task, run_pool_task_thread);
+  g_assert_true (g_task_propagate_boolean (task, NULL));
+  g_object_unref (task);
+}
+
+static void
+test_pool_high_priority (void)
+{
+  guint64 completed;
+  guint min_threads;
+
+  g_task_get_pool_limits (G_TASK_POOL_TYPE_HIGH_PRIORITY, &min_threads, NULL);
+  g_assert_cmpuint (min_threads, ==, 0);
+
+  completed = pool_statistic (G_TASK_POOL_TYPE_HIGH_PRIORITY, "completed");
+  run_pool_task (G_PRIORITY_HIGH);
+  g_assert_cmpuint (pool_statistic (G_TASK_POOL_TYPE_HIGH_PRIORITY, "completed"), ==, completed);
+
+  g_task_set_pool_limits (G_TASK_POOL_TYPE_HIGH_PRIORITY, 1, -1);
+
+  /* Only tasks with a higher priority than the default go there */
+  run_pool_task (G_PRIORITY_DEFAULT);
+  g_assert_cmpuint (pool_statistic (G_TASK_POOL_TYPE_HIGH_PRIORITY, "completed"), ==, completed);
+
+  run_pool_task (G_PRIORITY_HIGH);
+  while (pool_statistic (G_TASK_POOL_TYPE_HIGH_PRIORITY, "completed") != completed + 1)
+    g_usleep (1000);
+
+  g_task_set_pool_limits (G_TASK_POOL_TYPE_HIGH_PRIORITY, 0, -1);
+
+  run_pool_task (G_PRIORITY_HIGH);
+  g_assert_cmpuint (pool_statistic (G_TASK_POOL_TYPE_HIGH_PRIORITY, "completed"), ==, completed + 1);
+}
+
 /* test_return_on_cancel */
 
 GMutex roc_init_mutex, roc_finish_mutex;
@@ -2385,6 +2536,8 @@ main (int argc, char **argv)
   g_test_add_func ("/gtask/run-in-thread-priority", test_run_in_thread_priority);
   g_test_add_func ("/gtask/run-in-thread-nested", test_run_in_thread_nested);
   g_test_add_func ("/gtask/run-in-thread-overflow", test_run_in_thread_overflow);
+  g_test_add_func ("/gtask/pool-limits", test_pool_limits);
+  g_test_add_func ("/gtask/pool-high-priority", test_pool_high_priority);
   g_test_add_func ("/gtask/return-on-cancel", test_return_on_cancel);
   g_test_add_func ("/gtask/return-on-cancel-sync", test_return_on_cancel_sync);
   g_test_add_func ("/gtask/return-on-cancel-atomic", test_return_on_cancel_atomic);
@@ -0,0 +1,654 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MT safe
+ */
+
+#include "config.h"
+
+#include "gboundedqueue.h"
+
+#include "gatomic.h"
+#include "gmain.h"
+#include "gmem.h"
+#include "gmessages.h"
+#include "gthread.h"
+#include "gtimer.h"
+
+#ifdef HAVE_FUTEX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef FUTEX_WAIT_PRIVATE
+#define FUTEX_WAIT_PRIVATE FUTEX_WAIT
+#define FUTEX_WAKE_PRIVATE FUTEX_WAKE
+#endif
+#endif
+
+/**
+ * SECTION:bounded_queues
+ * @title: Bounded Queues
+ * @short_description: lock-free bounded queues for passing data
+ *     between threads
+ * @see_also: #GAsyncQueue
+ *
+ * A #GBoundedQueue is a first-in first-out queue with a fixed capacity
+ * which can be used from any number of producer and consumer threads
+ * at the same time, like #GAsyncQueue.
+ *
+ * Unlike #GAsyncQueue, pushing to and popping from a #GBoundedQueue
+ * does not take a lock: as long as the queue is neither empty nor full,
+ * threads only synchronise on the slots of a ring buffer, which makes
+ * it scale much better when many threads hammer the same queue. Threads
+ * are only put to sleep when they have to wait for the queue to become
+ * non-empty (g_bounded_queue_pop()) or non-full (g_bounded_queue_push()).
+ *
+ * In return, a #GBoundedQueue can't be locked, sorted or searched, and
+ * pushing to it blocks (or fails, for g_bounded_queue_try_push()) when
+ * it already holds as many items as its capacity. As with #GAsyncQueue,
+ * %NULL can't be pushed to a #GBoundedQueue, so that the pop functions
+ * can return %NULL to signal that no item was available.
+ *
+ * Since: 2.68
+ */
+
+/**
+ * GBoundedQueue:
+ *
+ * The GBoundedQueue struct is an opaque data structure which represents
+ * a bounded, lock-free queue. It should only be accessed through the
+ * g_bounded_queue_* functions.
+ *
+ * Since: 2.68
+ */
+
+/* The queue is a ring of cells which are claimed by moving @enqueue_pos
+ * or @dequeue_pos forward. Each cell carries a sequence number telling
+ * which side may use it next: it is equal to the position of the next
+ * push for the cell once it is free, and to that position + 1 once the
+ * push has stored its data, at which point the pop for that position
+ * can take it and hand the cell to the next round by setting the
+ * sequence number to the position + capacity.
+ */
+typedef struct
+{
+  gsize sequence;  /* (atomic) */
+  gpointer data;
+} GBoundedQueueCell;
+
+#define CACHE_LINE_SIZE 64
+
+struct _GBoundedQueue
+{
+  GBoundedQueueCell *cells;
+  gsize mask;
+  GDestroyNotify item_free_func;
+  gint ref_count;  /* (atomic) */
+
+  /* Producers and consumers each update their own position, keep them
+   * on separate cache lines so they don't slow each other down. */
+  gchar padding1[CACHE_LINE_SIZE];
+  gsize enqueue_pos;  /* (atomic) */
+  gchar padding2[CACHE_LINE_SIZE];
+  gsize dequeue_pos;  /* (atomic) */
+  gchar padding3[CACHE_LINE_SIZE];
+
+  /* Threads waiting for the queue to become non-empty or non-full,
+   * sleeping until the corresponding counter changes. */
+  gint n_waiting_consumers;  /* (atomic) */
+  gint n_waiting_producers;  /* (atomic) */
+  gint not_empty;  /* (atomic) */
+  gint not_full;  /* (atomic) */
+
+#ifndef HAVE_FUTEX
+  GMutex mutex;
+  GCond cond;
+#endif
+};
+
+/**
+ * g_bounded_queue_new:
+ * @capacity: the maximum number of items in the queue
+ *
+ * Creates a new bounded queue.
+ *
+ * @capacity is rounded up to the next power of two, and to at least 2;
+ * use g_bounded_queue_get_capacity() to find out the actual value.
+ *
+ * Returns: a new #GBoundedQueue. Free with g_bounded_queue_unref()
+ *
+ * Since: 2.68
+ */
+GBoundedQueue *
+g_bounded_queue_new (guint capacity)
+{
+  return g_bounded_queue_new_full (capacity, NULL);
+}
+
+/**
+ * g_bounded_queue_new_full:
+ * @capacity: the maximum number of items in the queue
+ * @item_free_func: (nullable): function to free queue elements
+ *
+ * Creates a new bounded queue and sets up a destroy notify function
+ * that is used to free any remaining queue items when the queue is
+ * destroyed after the final unref.
+ *
+ * @capacity is rounded up to the next power of two, and to at least 2;
+ * use g_bounded_queue_get_capacity() to find out the actual value.
+ *
+ * Returns: a new #GBoundedQueue. Free with g_bounded_queue_unref()
+ *
+ * Since: 2.68
+ */
+GBoundedQueue *
+g_bounded_queue_new_full (guint          capacity,
+                          GDestroyNotify item_free_func)
+{
+  GBoundedQueue *queue;
+  gsize n_cells = 2;
+  gsize i;
+
+  g_return_val_if_fail (capacity > 0, NULL);
+  g_return_val_if_fail (capacity <= (G_MAXUINT >> 1) + 1, NULL);
+
+  /* With a single cell, a full cell would look free for the next round */
+  while (n_cells < capacity)
+    n_cells <<= 1;
+
+  queue = g_new0 (GBoundedQueue, 1);
+  queue->cells = g_new (GBoundedQueueCell, n_cells);
+  queue->mask = n_cells - 1;
+  queue->item_free_func = item_free_func;
+  queue->ref_count = 1;
+
+  for (i = 0; i < n_cells; i++)
+    {
+      queue->cells[i].sequence = i;
+      queue->cells[i].data = NULL;
+    }
+
+#ifndef HAVE_FUTEX
+  g_mutex_init (&queue->mutex);
+  g_cond_init (&queue->cond);
+#endif
+
+  return queue;
+}
+
+/**
+ * g_bounded_queue_ref:
+ * @queue: a #GBoundedQueue
+ *
+ * Increases the reference count of @queue by 1.
+ *
+ * Returns: the @queue that was passed in
+ *
+ * Since: 2.68
+ */
+GBoundedQueue *
+g_bounded_queue_ref (GBoundedQueue *queue)
+{
+  g_return_val_if_fail (queue != NULL, NULL);
+
+  g_atomic_int_inc (&queue->ref_count);
+
+  return queue;
+}
+
+static gpointer g_bounded_queue_dequeue (GBoundedQueue *queue);
+
+/**
+ * g_bounded_queue_unref:
+ * @queue: a #GBoundedQueue
+ *
+ * Decreases the reference count of @queue by 1. If the reference
+ * count went to 0, @queue is destroyed and the memory allocated
+ * for it is freed, after the remaining items are freed with the
+ * destroy notify function passed to g_bounded_queue_new_full(), if
+ * any.
+ *
+ * No thread may be blocked in a push or pop on @queue when the last
+ * reference is dropped.
+ *
+ * Since: 2.68
+ */
+void
+g_bounded_queue_unref (GBoundedQueue *queue)
+{
+  g_return_if_fail (queue != NULL);
+
+  if (g_atomic_int_dec_and_test (&queue->ref_count))
+    {
+      gpointer data;
+
+      g_return_if_fail (queue->n_waiting_consumers == 0);
+      g_return_if_fail (queue->n_waiting_producers == 0);
+
+      while ((data = g_bounded_queue_dequeue (queue)) != NULL)
+        if (queue->item_free_func)
+          queue->item_free_func (data);
+
+#ifndef HAVE_FUTEX
+      g_mutex_clear (&queue->mutex);
+      g_cond_clear (&queue->cond);
+#endif
+      g_free (queue->cells);
+      g_free (queue);
+    }
+}
+
+/* Stores @data in the next free cell, returns %FALSE if the queue is full */
+static gboolean
+g_bounded_queue_enqueue (GBoundedQueue *queue,
+                         gpointer       data)
+{
+  gsize pos = g_atomic_pointer_get (&queue->enqueue_pos);
+
+  while (TRUE)
+    {
+      GBoundedQueueCell *cell = &queue->cells[pos & queue->mask];
+      gssize diff = (gssize) (g_atomic_pointer_get (&cell->sequence) - pos);
+
+      if (diff == 0)
+        {
+          if (g_atomic_pointer_compare_and_exchange (&queue->enqueue_pos, pos, pos + 1))
+            {
+              cell->data = data;
+              g_atomic_pointer_set (&cell->sequence, pos + 1);
+              return TRUE;
+            }
+        }
+      else if (diff < 0)
+        {
+          /* The pop for the previous round of this cell hasn't happened */
+          return FALSE;
+        }
+
+      /* Another producer got there first */
+      pos = g_atomic_pointer_get (&queue->enqueue_pos);
+    }
+}
+
+/* Takes the data out of the oldest full cell, returns %NULL if the queue
+ * is empty */
+static gpointer
+g_bounded_queue_dequeue (GBoundedQueue *queue)
+{
+  gsize pos = g_atomic_pointer_get (&queue->dequeue_pos);
+
+  while (TRUE)
+    {
+      GBoundedQueueCell *cell = &queue->cells[pos & queue->mask];
+      gssize diff = (gssize) (g_atomic_pointer_get (&cell->sequence) - (pos + 1));
+
+      if (diff == 0)
+        {
+          if (g_atomic_pointer_compare_and_exchange (&queue->dequeue_pos, pos, pos + 1))
+            {
+              gpointer data = cell->data;
+
+              cell->data = NULL;
+              g_atomic_pointer_set (&cell->sequence, pos + queue->mask + 1);
+              return data;
+            }
+        }
+      else if (diff < 0)
+        {
+          /* The push for this position hasn't happened */
+          return NULL;
+        }
+
+      /* Another consumer got there first */
+      pos = g_atomic_pointer_get (&queue->dequeue_pos);
+    }
+}
+
+/* Waits until @counter no longer contains @sampled, or until @end_time
+ * has passed if it is not -1. May return early. */
+static void
+g_bounded_queue_park (GBoundedQueue *queue,
+                      gint          *counter,
+                      gint           sampled,
+                      gint64         end_time)
+{
+#ifdef HAVE_FUTEX
+  struct timespec span;
+  struct timespec *timeout = NULL;
+
+  if (end_time >= 0)
+    {
+      gint64 remaining = end_time - g_get_monotonic_time ();
+
+      if (remaining <= 0)
+        return;
+
+      span.tv_sec = remaining / G_USEC_PER_SEC;
+      span.tv_nsec = (remaining % G_USEC_PER_SEC) * 1000;
+      timeout = &span;
+    }
+
+  syscall (__NR_futex, counter, (gsize) FUTEX_WAIT_PRIVATE, (gsize) sampled, timeout);
+#else
+  g_mutex_lock (&queue->mutex);
+
+  if (g_atomic_int_get (counter) == sampled)
+    {
+      if (end_time >= 0)
+        g_cond_wait_until (&queue->cond, &queue->mutex, end_time);
+      else
+        g_cond_wait (&queue->cond, &queue->mutex);
+    }
+
+  g_mutex_unlock (&queue->mutex);
+#endif
+}
+
+/* Wakes up a thread sleeping on @counter in g_bounded_queue_park() */
+static void
+g_bounded_queue_unpark (GBoundedQueue *queue,
+                        gint          *counter)
+{
+#ifdef HAVE_FUTEX
+  g_atomic_int_inc (counter);
+  syscall (__NR_futex, counter, (gsize) FUTEX_WAKE_PRIVATE, (gsize) 1, NULL);
+#else
+  g_mutex_lock (&queue->mutex);
+  g_atomic_int_inc (counter);
+  g_cond_broadcast (&queue->cond);
+  g_mutex_unlock (&queue->mutex);
+#endif
+}
+
+/* Both the counter of waiting threads and the cells are only accessed
+ * with sequentially consistent atomics: either a waiter sees the change
+ * to the cells after announcing itself, or the thread making that change
+ * sees the waiter and wakes it up. The waiter samples @not_empty or
+ * @not_full before that, so it doesn't go to sleep if it is woken up in
+ * between.
+ */
+static gboolean
+g_bounded_queue_push_internal (GBoundedQueue *queue,
+                               gpointer       data,
+                               gint64         end_time)
+{
+  gboolean pushed;
+
+  while (!(pushed = g_bounded_queue_enqueue (queue, data)))
+    {
+      gint sampled;
+
+      if (end_time >= 0 && g_get_monotonic_time () >= end_time)
+        break;
+
+      sampled = g_atomic_int_get (&queue->not_full);
+      g_atomic_int_inc (&queue->n_waiting_producers);
+
+      pushed = g_bounded_queue_enqueue (queue, data);
+      if (!pushed)
+        g_bounded_queue_park (queue, &queue->not_full, sampled, end_time);
+
+      g_atomic_int_add (&queue->n_waiting_producers, -1);
+
+      if (pushed)
+        break;
+    }
+
+  if (pushed && g_atomic_int_get (&queue->n_waiting_consumers) > 0)
+    g_bounded_queue_unpark (queue, &queue->not_empty);
+
+  return pushed;
+}
+
+static gpointer
+g_bounded_queue_pop_internal (GBoundedQueue *queue,
+                              gint64         end_time)
+{
+  gpointer data;
+
+  while ((data = g_bounded_queue_dequeue (queue)) == NULL)
+    {
+      gint sampled;
+
+      if (end_time >= 0 && g_get_monotonic_time () >= end_time)
+        break;
+
+      sampled = g_atomic_int_get (&queue->not_empty);
+      g_atomic_int_inc (&queue->n_waiting_consumers);
+
+      data = g_bounded_queue_dequeue (queue);
+      if (data == NULL)
+        g_bounded_queue_park (queue, &queue->not_empty, sampled, end_time);
+
+      g_atomic_int_add (&queue->n_waiting_consumers, -1);
+
+      if (data != NULL)
+        break;
+    }
+
+  if (data != NULL && g_atomic_int_get (&queue->n_waiting_producers) > 0)
+    g_bounded_queue_unpark (queue, &queue->not_full);
+
+  return data;
+}
+
+/**
+ * g_bounded_queue_push:
+ * @queue: a #GBoundedQueue
+ * @data: @data to push into the @queue
+ *
+ * Pushes the @data into the @queue. @data must not be %NULL.
+ *
+ * If the queue is full, this function blocks until an item is popped
+ * from it.
+ *
+ * Since: 2.68
+ */
+void
+g_bounded_queue_push (GBoundedQueue *queue,
+                      gpointer       data)
+{
+  g_return_if_fail (queue != NULL);
+  g_return_if_fail (data != NULL);
+
+  g_bounded_queue_push_internal (queue, data, -1);
+}
+
+/**
+ * g_bounded_queue_try_push:
+ * @queue: a #GBoundedQueue
+ * @data: @data to push into the @queue
+ *
+ * Tries to push the @data into the @queue. @data must not be %NULL.
+ *
+ * If the queue is full, %FALSE is returned and the @queue is left
+ * unchanged.
+ *
+ * Returns: %TRUE if @data was pushed into the queue
+ *
+ * Since: 2.68
+ */
+gboolean
+g_bounded_queue_try_push (GBoundedQueue *queue,
+                          gpointer       data)
+{
+  gboolean pushed;
+
+  g_return_val_if_fail (queue != NULL, FALSE);
+  g_return_val_if_fail (data != NULL, FALSE);
+
+  pushed = g_bounded_queue_enqueue (queue, data);
+
+  if (pushed && g_atomic_int_get (&queue->n_waiting_consumers) > 0)
+    g_bounded_queue_unpark (queue, &queue->not_empty);
+
+  return pushed;
+}
+
+/**
+ * g_bounded_queue_timeout_push:
+ * @queue: a #GBoundedQueue
+ * @data: @data to push into the @queue
+ * @timeout: the number of microseconds to wait
+ *
+ * Pushes the @data into the @queue. @data must not be %NULL.
+ *
+ * If the queue is full, this function blocks until an item is popped
+ * from it or until @timeout has passed.
+ *
+ * Returns: %TRUE if @data was pushed into the queue, %FALSE if
+ *     @timeout passed while the queue stayed full
+ *
+ * Since: 2.68
+ */
+gboolean
+g_bounded_queue_timeout_push (GBoundedQueue *queue,
+                              gpointer       data,
+                              guint64        timeout)
+{
+  gint64 end_time = g_get_monotonic_time () + timeout;
+
+  g_return_val_if_fail (queue != NULL, FALSE);
+  g_return_val_if_fail (data != NULL, FALSE);
+
+  return g_bounded_queue_push_internal (queue, data, end_time);
+}
+
+/**
+ * g_bounded_queue_pop:
+ * @queue: a #GBoundedQueue
+ *
+ * Pops data from the @queue. If @queue is empty, this function
+ * blocks until data becomes available.
+ *
+ * Returns: data from the queue
+ *
+ * Since: 2.68
+ */
+gpointer
+g_bounded_queue_pop (GBoundedQueue *queue)
+{
+  g_return_val_if_fail (queue != NULL, NULL);
+
+  return g_bounded_queue_pop_internal (queue, -1);
+}
+
+/**
+ * g_bounded_queue_try_pop:
+ * @queue: a #GBoundedQueue
+ *
+ * Tries to pop data from the @queue. If no data is available,
+ * %NULL is returned.
+ *
+ * Returns: (nullable): data from the queue or %NULL, when no data is
+ *     available immediately.
+ *
+ * Since: 2.68
+ */
+gpointer
+g_bounded_queue_try_pop (GBoundedQueue *queue)
+{
+  gpointer data;
+
+  g_return_val_if_fail (queue != NULL, NULL);
+
+  data = g_bounded_queue_dequeue (queue);
+
+  if (data != NULL && g_atomic_int_get (&queue->n_waiting_producers) > 0)
+    g_bounded_queue_unpark (queue, &queue->not_full);
+
+  return data;
+}
+
+/**
+ * g_bounded_queue_timeout_pop:
+ * @queue: a #GBoundedQueue
+ * @timeout: the number of microseconds to wait
+ *
+ * Pops data from the @queue. If the queue is empty, blocks for
+ * @timeout microseconds, or until data becomes available.
+ *
+ * If no data is received before the timeout, %NULL is returned.
+ *
+ * Returns: (nullable): data from the queue or %NULL, when no data is
+ *     received before the timeout.
+ *
+ * Since: 2.68
+ */
+gpointer
+g_bounded_queue_timeout_pop (GBoundedQueue *queue,
+                             guint64        timeout)
+{
+  gint64 end_time = g_get_monotonic_time () + timeout;
+
+  g_return_val_if_fail (queue != NULL, NULL);
+
+  return g_bounded_queue_pop_internal (queue, end_time);
+}
+
+/**
+ * g_bounded_queue_length:
+ * @queue: a #GBoundedQueue
+ *
+ * Returns the number of items in the queue.
+ *
+ * If other threads are pushing to or popping from @queue at the same
+ * time, the result is only a snapshot, which may already be out of
+ * date when this function returns.
+ *
+ * Returns: the number of items in the @queue
+ *
+ * Since: 2.68
+ */
+guint
+g_bounded_queue_length (GBoundedQueue *queue)
+{
+  gsize dequeue_pos, enqueue_pos;
+  gssize length;
+
+  g_return_val_if_fail (queue != NULL, 0);
+
+  dequeue_pos = g_atomic_pointer_get (&queue->dequeue_pos);
+  enqueue_pos = g_atomic_pointer_get (&queue->enqueue_pos);
+  length = (gssize) (enqueue_pos - dequeue_pos);
+
+  /* The positions aren't read at the same time */
+  return CLAMP (length, 0, (gssize) queue->mask + 1);
+}
+
+/**
+ * g_bounded_queue_get_capacity:
+ * @queue: a #GBoundedQueue
+ *
+ * Returns the maximum number of items @queue can hold, which is the
+ * capacity passed to g_bounded_queue_new() rounded up to the next power
+ * of two, and to at least 2.
+ *
+ * Returns: the capacity of @queue
+ *
+ * Since: 2.68
+ */
+guint
+g_bounded_queue_get_capacity (GBoundedQueue *queue)
+{
+  g_return_val_if_fail (queue != NULL, 0);
+
+  return queue->mask + 1;
+}
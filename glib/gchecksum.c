@@ -20,8 +20,20 @@
 
 #include <string.h>
 
+#if defined (HAVE_SHA_NI_TARGET)
+#define USE_SHA_NI 1
+#include <immintrin.h>
+#elif defined (HAVE_ARM_CRYPTO_TARGET) && defined (__aarch64__)
+#define USE_ARM_CRYPTO 1
+#include <arm_neon.h>
+#if defined (HAVE_GETAUXVAL) && defined (HAVE_SYS_AUXV_H)
+#include <sys/auxv.h>
+#endif
+#endif
+
 #include "gchecksum.h"
 
+#include "gatomic.h"
 #include "gslice.h"
 #include "gmem.h"
 #include "gstrfuncs.h"
@@ -47,7 +59,8 @@
  * as a string in hexadecimal form, or as a raw sequence of bytes. To
  * compute the checksum for binary blobs and NUL-terminated strings in
  * one go, use the convenience functions g_compute_checksum_for_data()
- * and g_compute_checksum_for_string(), respectively.
+ * and g_compute_checksum_for_string(), respectively. Many small blobs
+ * can be hashed in one call with g_compute_digests_for_data().
  *
  * Support for checksums has been added in GLib 2.16
  **/
@@ -173,6 +186,355 @@ sha_byte_reverse (guint32 *buffer,
 }
 #endif /* G_BYTE_ORDER == G_BIG_ENDIAN */
 
+#if defined (USE_SHA_NI) || defined (USE_ARM_CRYPTO)
+
+/* SHA-1 and SHA-256 blocks are compressed with the x86 SHA extensions or
+ * the ARMv8 cryptography extensions where the CPU has them. The kernels
+ * are built into functions of their own with the right target attribute,
+ * and picked at runtime, so the library still runs on older CPUs.
+ */
+#define SHA_HW_SHA1   (1 << 0)
+#define SHA_HW_SHA256 (1 << 1)
+
+static gint
+sha_hw_features (void)
+{
+  static gint features = -1;  /* (atomic) */
+  gint result = g_atomic_int_get (&features);
+
+  if (G_UNLIKELY (result < 0))
+    {
+      result = 0;
+
+#if defined (USE_SHA_NI)
+      __builtin_cpu_init ();
+      if (__builtin_cpu_supports ("sha") && __builtin_cpu_supports ("sse4.1"))
+        result = SHA_HW_SHA1 | SHA_HW_SHA256;
+#elif defined (__APPLE__)
+      /* All 64-bit ARM Macs have them */
+      result = SHA_HW_SHA1 | SHA_HW_SHA256;
+#elif defined (HAVE_GETAUXVAL) && defined (HWCAP_SHA1) && defined (HWCAP_SHA2)
+      {
+        unsigned long hwcap = getauxval (AT_HWCAP);
+
+        if (hwcap & HWCAP_SHA1)
+          result |= SHA_HW_SHA1;
+        if (hwcap & HWCAP_SHA2)
+          result |= SHA_HW_SHA256;
+      }
+#endif
+
+      g_atomic_int_set (&features, result);
+    }
+
+  return result;
+}
+
+/* The SHA-256 round constants, four at a time for the vector kernels */
+static const guint32 sha256_k[64] =
+{
+  0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5,
+  0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+  0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3,
+  0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+  0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC,
+  0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+  0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7,
+  0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+  0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13,
+  0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+  0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3,
+  0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+  0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5,
+  0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+  0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208,
+  0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+};
+
+#endif /* USE_SHA_NI || USE_ARM_CRYPTO */
+
+#if defined (USE_SHA_NI)
+
+/* In both kernels, the message schedule lives in four registers of four
+ * words each, m0 to m3, and round group i (four rounds) works on
+ * m[i % 4] while computing the schedule words needed a few groups later.
+ * The conditions on i are constant for each expansion of the macros, so
+ * they disappear at compile time.
+ */
+
+/* Runs @n_blocks SHA-1 blocks from @data through the state in @buf */
+__attribute__ ((target ("sha,sse4.1")))
+static void
+sha1_transform_sha_ni (guint32       buf[5],
+                       const guchar *data,
+                       gsize         n_blocks)
+{
+  const __m128i byte_swap = _mm_set_epi64x (0x0001020304050607ULL,
+                                            0x08090a0b0c0d0e0fULL);
+  __m128i abcd, abcd_save, e0, e1, e_save, m0, m1, m2, m3;
+
+  abcd = _mm_shuffle_epi32 (_mm_loadu_si128 ((const __m128i *) buf), 0x1B);
+  e0 = _mm_set_epi32 (buf[4], 0, 0, 0);
+
+#define SHA1_ROUNDS4(i, cur, next, prev2, prev, e_cur, e_next)          \
+  G_STMT_START {                                                        \
+    if ((i) == 0)                                                       \
+      e_cur = _mm_add_epi32 (e_cur, cur);                               \
+    else                                                                \
+      e_cur = _mm_sha1nexte_epu32 (e_cur, cur);                         \
+    e_next = abcd;                                                      \
+    if ((i) >= 3 && (i) < 19)                                           \
+      next = _mm_sha1msg2_epu32 (next, cur);                            \
+    abcd = _mm_sha1rnds4_epu32 (abcd, e_cur, (i) / 5);                  \
+    if ((i) >= 1 && (i) < 17)                                           \
+      prev = _mm_sha1msg1_epu32 (prev, cur);                            \
+    if ((i) >= 2 && (i) < 18)                                           \
+      prev2 = _mm_xor_si128 (prev2, cur);                               \
+  } G_STMT_END
+
+  for (; n_blocks > 0; n_blocks--, data += SHA1_DATASIZE)
+    {
+      abcd_save = abcd;
+      e_save = e0;
+
+      m0 = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) (data +  0)), byte_swap);
+      m1 = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) (data + 16)), byte_swap);
+      m2 = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) (data + 32)), byte_swap);
+      m3 = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) (data + 48)), byte_swap);
+
+      SHA1_ROUNDS4 ( 0, m0, m1, m2, m3, e0, e1);
+      SHA1_ROUNDS4 ( 1, m1, m2, m3, m0, e1, e0);
+      SHA1_ROUNDS4 ( 2, m2, m3, m0, m1, e0, e1);
+      SHA1_ROUNDS4 ( 3, m3, m0, m1, m2, e1, e0);
+      SHA1_ROUNDS4 ( 4, m0, m1, m2, m3, e0, e1);
+      SHA1_ROUNDS4 ( 5, m1, m2, m3, m0, e1, e0);
+      SHA1_ROUNDS4 ( 6, m2, m3, m0, m1, e0, e1);
+      SHA1_ROUNDS4 ( 7, m3, m0, m1, m2, e1, e0);
+      SHA1_ROUNDS4 ( 8, m0, m1, m2, m3, e0, e1);
+      SHA1_ROUNDS4 ( 9, m1, m2, m3, m0, e1, e0);
+      SHA1_ROUNDS4 (10, m2, m3, m0, m1, e0, e1);
+      SHA1_ROUNDS4 (11, m3, m0, m1, m2, e1, e0);
+      SHA1_ROUNDS4 (12, m0, m1, m2, m3, e0, e1);
+      SHA1_ROUNDS4 (13, m1, m2, m3, m0, e1, e0);
+      SHA1_ROUNDS4 (14, m2, m3, m0, m1, e0, e1);
+      SHA1_ROUNDS4 (15, m3, m0, m1, m2, e1, e0);
+      SHA1_ROUNDS4 (16, m0, m1, m2, m3, e0, e1);
+      SHA1_ROUNDS4 (17, m1, m2, m3, m0, e1, e0);
+      SHA1_ROUNDS4 (18, m2, m3, m0, m1, e0, e1);
+      SHA1_ROUNDS4 (19, m3, m0, m1, m2, e1, e0);
+
+      e0 = _mm_sha1nexte_epu32 (e0, e_save);
+      abcd = _mm_add_epi32 (abcd, abcd_save);
+    }
+
+#undef SHA1_ROUNDS4
+
+  _mm_storeu_si128 ((__m128i *) buf, _mm_shuffle_epi32 (abcd, 0x1B));
+  buf[4] = _mm_extract_epi32 (e0, 3);
+}
+
+/* Runs @n_blocks SHA-256 blocks from @data through the state in @buf */
+__attribute__ ((target ("sha,sse4.1")))
+static void
+sha256_transform_sha_ni (guint32       buf[8],
+                         const guchar *data,
+                         gsize         n_blocks)
+{
+  const __m128i byte_swap = _mm_set_epi64x (0x0c0d0e0f08090a0bULL,
+                                            0x0405060700010203ULL);
+  __m128i state0, state1, abef_save, cdgh_save, tmp, msg, m0, m1, m2, m3;
+
+  /* The rounds instruction wants the state as ABEF and CDGH */
+  tmp = _mm_shuffle_epi32 (_mm_loadu_si128 ((const __m128i *) &buf[0]), 0xB1);
+  state1 = _mm_shuffle_epi32 (_mm_loadu_si128 ((const __m128i *) &buf[4]), 0x1B);
+  state0 = _mm_alignr_epi8 (tmp, state1, 8);
+  state1 = _mm_blend_epi16 (state1, tmp, 0xF0);
+
+#define SHA256_ROUNDS4(i, cur, next, prev)                              \
+  G_STMT_START {                                                        \
+    msg = _mm_add_epi32 (cur, _mm_loadu_si128 ((const __m128i *) &sha256_k[4 * (i)])); \
+    state1 = _mm_sha256rnds2_epu32 (state1, state0, msg);               \
+    if ((i) >= 3 && (i) < 15)                                           \
+      next = _mm_sha256msg2_epu32 (_mm_add_epi32 (next, _mm_alignr_epi8 (cur, prev, 4)), cur); \
+    msg = _mm_shuffle_epi32 (msg, 0x0E);                                \
+    state0 = _mm_sha256rnds2_epu32 (state0, state1, msg);               \
+    if ((i) >= 1 && (i) < 13)                                           \
+      prev = _mm_sha256msg1_epu32 (prev, cur);                          \
+  } G_STMT_END
+
+  for (; n_blocks > 0; n_blocks--, data += SHA256_DATASIZE)
+    {
+      abef_save = state0;
+      cdgh_save = state1;
+
+      m0 = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) (data +  0)), byte_swap);
+      m1 = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) (data + 16)), byte_swap);
+      m2 = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) (data + 32)), byte_swap);
+      m3 = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) (data + 48)), byte_swap);
+
+      SHA256_ROUNDS4 ( 0, m0, m1, m3);
+      SHA256_ROUNDS4 ( 1, m1, m2, m0);
+      SHA256_ROUNDS4 ( 2, m2, m3, m1);
+      SHA256_ROUNDS4 ( 3, m3, m0, m2);
+      SHA256_ROUNDS4 ( 4, m0, m1, m3);
+      SHA256_ROUNDS4 ( 5, m1, m2, m0);
+      SHA256_ROUNDS4 ( 6, m2, m3, m1);
+      SHA256_ROUNDS4 ( 7, m3, m0, m2);
+      SHA256_ROUNDS4 ( 8, m0, m1, m3);
+      SHA256_ROUNDS4 ( 9, m1, m2, m0);
+      SHA256_ROUNDS4 (10, m2, m3, m1);
+      SHA256_ROUNDS4 (11, m3, m0, m2);
+      SHA256_ROUNDS4 (12, m0, m1, m3);
+      SHA256_ROUNDS4 (13, m1, m2, m0);
+      SHA256_ROUNDS4 (14, m2, m3, m1);
+      SHA256_ROUNDS4 (15, m3, m0, m2);
+
+      state0 = _mm_add_epi32 (state0, abef_save);
+      state1 = _mm_add_epi32 (state1, cdgh_save);
+    }
+
+#undef SHA256_ROUNDS4
+
+  /* Back to ABCD and EFGH */
+  tmp = _mm_shuffle_epi32 (state0, 0x1B);
+  state1 = _mm_shuffle_epi32 (state1, 0xB1);
+  _mm_storeu_si128 ((__m128i *) &buf[0], _mm_blend_epi16 (tmp, state1, 0xF0));
+  _mm_storeu_si128 ((__m128i *) &buf[4], _mm_alignr_epi8 (state1, tmp, 8));
+}
+
+#elif defined (USE_ARM_CRYPTO)
+
+/* As above, the message schedule lives in m0 to m3, and round group i
+ * replaces m[i % 4] with the schedule words for group i + 4 once it has
+ * used them.
+ */
+
+/* Runs @n_blocks SHA-1 blocks from @data through the state in @buf */
+__attribute__ ((target ("+crypto")))
+static void
+sha1_transform_arm (guint32       buf[5],
+                    const guchar *data,
+                    gsize         n_blocks)
+{
+  static const guint32 k[4] = { 0x5A827999, 0x6ED9EBA1, 0x8F1BBCDC, 0xCA62C1D6 };
+  uint32x4_t abcd, abcd_save, wk, m0, m1, m2, m3;
+  guint32 e0, e1, e_save;
+
+  abcd = vld1q_u32 (buf);
+  e0 = buf[4];
+
+#define SHA1_ROUNDS4(i, cur, next, next2, next3, hash)                  \
+  G_STMT_START {                                                        \
+    wk = vaddq_u32 (cur, vdupq_n_u32 (k[(i) / 5]));                     \
+    e1 = vsha1h_u32 (vgetq_lane_u32 (abcd, 0));                         \
+    abcd = hash (abcd, e0, wk);                                         \
+    e0 = e1;                                                            \
+    if ((i) < 16)                                                       \
+      cur = vsha1su1q_u32 (vsha1su0q_u32 (cur, next, next2), next3);    \
+  } G_STMT_END
+
+  for (; n_blocks > 0; n_blocks--, data += SHA1_DATASIZE)
+    {
+      abcd_save = abcd;
+      e_save = e0;
+
+      m0 = vreinterpretq_u32_u8 (vrev32q_u8 (vld1q_u8 (data +  0)));
+      m1 = vreinterpretq_u32_u8 (vrev32q_u8 (vld1q_u8 (data + 16)));
+      m2 = vreinterpretq_u32_u8 (vrev32q_u8 (vld1q_u8 (data + 32)));
+      m3 = vreinterpretq_u32_u8 (vrev32q_u8 (vld1q_u8 (data + 48)));
+
+      SHA1_ROUNDS4 ( 0, m0, m1, m2, m3, vsha1cq_u32);
+      SHA1_ROUNDS4 ( 1, m1, m2, m3, m0, vsha1cq_u32);
+      SHA1_ROUNDS4 ( 2, m2, m3, m0, m1, vsha1cq_u32);
+      SHA1_ROUNDS4 ( 3, m3, m0, m1, m2, vsha1cq_u32);
+      SHA1_ROUNDS4 ( 4, m0, m1, m2, m3, vsha1cq_u32);
+      SHA1_ROUNDS4 ( 5, m1, m2, m3, m0, vsha1pq_u32);
+      SHA1_ROUNDS4 ( 6, m2, m3, m0, m1, vsha1pq_u32);
+      SHA1_ROUNDS4 ( 7, m3, m0, m1, m2, vsha1pq_u32);
+      SHA1_ROUNDS4 ( 8, m0, m1, m2, m3, vsha1pq_u32);
+      SHA1_ROUNDS4 ( 9, m1, m2, m3, m0, vsha1pq_u32);
+      SHA1_ROUNDS4 (10, m2, m3, m0, m1, vsha1mq_u32);
+      SHA1_ROUNDS4 (11, m3, m0, m1, m2, vsha1mq_u32);
+      SHA1_ROUNDS4 (12, m0, m1, m2, m3, vsha1mq_u32);
+      SHA1_ROUNDS4 (13, m1, m2, m3, m0, vsha1mq_u32);
+      SHA1_ROUNDS4 (14, m2, m3, m0, m1, vsha1mq_u32);
+      SHA1_ROUNDS4 (15, m3, m0, m1, m2, vsha1pq_u32);
+      SHA1_ROUNDS4 (16, m0, m1, m2, m3, vsha1pq_u32);
+      SHA1_ROUNDS4 (17, m1, m2, m3, m0, vsha1pq_u32);
+      SHA1_ROUNDS4 (18, m2, m3, m0, m1, vsha1pq_u32);
+      SHA1_ROUNDS4 (19, m3, m0, m1, m2, vsha1pq_u32);
+
+      abcd = vaddq_u32 (abcd, abcd_save);
+      e0 += e_save;
+    }
+
+#undef SHA1_ROUNDS4
+
+  vst1q_u32 (buf, abcd);
+  buf[4] = e0;
+}
+
+/* Runs @n_blocks SHA-256 blocks from @data through the state in @buf */
+__attribute__ ((target ("+crypto")))
+static void
+sha256_transform_arm (guint32       buf[8],
+                      const guchar *data,
+                      gsize         n_blocks)
+{
+  uint32x4_t state0, state1, abcd_save, efgh_save, tmp, wk, m0, m1, m2, m3;
+
+  state0 = vld1q_u32 (&buf[0]);
+  state1 = vld1q_u32 (&buf[4]);
+
+#define SHA256_ROUNDS4(i, cur, next, next2, next3)                      \
+  G_STMT_START {                                                        \
+    wk = vaddq_u32 (cur, vld1q_u32 (&sha256_k[4 * (i)]));               \
+    tmp = state0;                                                       \
+    state0 = vsha256hq_u32 (state0, state1, wk);                        \
+    state1 = vsha256h2q_u32 (state1, tmp, wk);                          \
+    if ((i) < 12)                                                       \
+      cur = vsha256su1q_u32 (vsha256su0q_u32 (cur, next), next2, next3); \
+  } G_STMT_END
+
+  for (; n_blocks > 0; n_blocks--, data += SHA256_DATASIZE)
+    {
+      abcd_save = state0;
+      efgh_save = state1;
+
+      m0 = vreinterpretq_u32_u8 (vrev32q_u8 (vld1q_u8 (data +  0)));
+      m1 = vreinterpretq_u32_u8 (vrev32q_u8 (vld1q_u8 (data + 16)));
+      m2 = vreinterpretq_u32_u8 (vrev32q_u8 (vld1q_u8 (data + 32)));
+      m3 = vreinterpretq_u32_u8 (vrev32q_u8 (vld1q_u8 (data + 48)));
+
+      SHA256_ROUNDS4 ( 0, m0, m1, m2, m3);
+      SHA256_ROUNDS4 ( 1, m1, m2, m3, m0);
+      SHA256_ROUNDS4 ( 2, m2, m3, m0, m1);
+      SHA256_ROUNDS4 ( 3, m3, m0, m1, m2);
+      SHA256_ROUNDS4 ( 4, m0, m1, m2, m3);
+      SHA256_ROUNDS4 ( 5, m1, m2, m3, m0);
+      SHA256_ROUNDS4 ( 6, m2, m3, m0, m1);
+      SHA256_ROUNDS4 ( 7, m3, m0, m1, m2);
+      SHA256_ROUNDS4 ( 8, m0, m1, m2, m3);
+      SHA256_ROUNDS4 ( 9, m1, m2, m3, m0);
+      SHA256_ROUNDS4 (10, m2, m3, m0, m1);
+      SHA256_ROUNDS4 (11, m3, m0, m1, m2);
+      SHA256_ROUNDS4 (12, m0, m1, m2, m3);
+      SHA256_ROUNDS4 (13, m1, m2, m3, m0);
+      SHA256_ROUNDS4 (14, m2, m3, m0, m1);
+      SHA256_ROUNDS4 (15, m3, m0, m1, m2);
+
+      state0 = vaddq_u32 (state0, abcd_save);
+      state1 = vaddq_u32 (state1, efgh_save);
+    }
+
+#undef SHA256_ROUNDS4
+
+  vst1q_u32 (&buf[0], state0);
+  vst1q_u32 (&buf[4], state1);
+}
+
+#endif /* USE_ARM_CRYPTO */
+
 static gchar *
 digest_to_string (guint8 *digest,
                   gsize   digest_len)
@@ -687,6 +1049,37 @@ sha1_transform (guint32  buf[5],
 #undef expand
 #undef subRound
 
+/* Runs @n_blocks blocks of message bytes from @data through the state */
+static void
+sha1_transform_blocks (guint32       buf[5],
+                       const guchar *data,
+                       gsize         n_blocks)
+{
+  guint32 in[16];
+
+#if defined (USE_SHA_NI)
+  if (sha_hw_features () & SHA_HW_SHA1)
+    {
+      sha1_transform_sha_ni (buf, data, n_blocks);
+      return;
+    }
+#elif defined (USE_ARM_CRYPTO)
+  if (sha_hw_features () & SHA_HW_SHA1)
+    {
+      sha1_transform_arm (buf, data, n_blocks);
+      return;
+    }
+#endif
+
+  for (; n_blocks > 0; n_blocks--, data += SHA1_DATASIZE)
+    {
+      memcpy (in, data, SHA1_DATASIZE);
+
+      sha_byte_reverse (in, SHA1_DATASIZE);
+      sha1_transform (buf, in);
+    }
+}
+
 static void
 sha1_sum_update (Sha1sum      *sha1,
                  const guchar *buffer,
@@ -718,23 +1111,19 @@ sha1_sum_update (Sha1sum      *sha1,
 
       memcpy (p, buffer, dataCount);
 
-      sha_byte_reverse (sha1->data, SHA1_DATASIZE);
-      sha1_transform (sha1->buf, sha1->data);
+      sha1_transform_blocks (sha1->buf, (guchar *) sha1->data, 1);
 
       buffer += dataCount;
       count -= dataCount;
     }
 
   /* Process data in SHA1_DATASIZE chunks */
-  while (count >= SHA1_DATASIZE)
+  if (count >= SHA1_DATASIZE)
     {
-      memcpy (sha1->data, buffer, SHA1_DATASIZE);
+      sha1_transform_blocks (sha1->buf, buffer, count / SHA1_DATASIZE);
 
-      sha_byte_reverse (sha1->data, SHA1_DATASIZE);
-      sha1_transform (sha1->buf, sha1->data);
-
-      buffer += SHA1_DATASIZE;
-      count -= SHA1_DATASIZE;
+      buffer += count & ~(gsize) (SHA1_DATASIZE - 1);
+      count &= SHA1_DATASIZE - 1;
     }
 
   /* Handle any remaining bytes of data. */
@@ -766,8 +1155,7 @@ sha1_sum_close (Sha1sum *sha1)
       /* Two lots of padding:  Pad the first block to 64 bytes */
       memset (data_p, 0, count);
 
-      sha_byte_reverse (sha1->data, SHA1_DATASIZE);
-      sha1_transform (sha1->buf, sha1->data);
+      sha1_transform_blocks (sha1->buf, (guchar *) sha1->data, 1);
 
       /* Now fill the next block with 56 bytes */
       memset (sha1->data, 0, SHA1_DATASIZE - 8);
@@ -779,11 +1167,10 @@ sha1_sum_close (Sha1sum *sha1)
     }
 
   /* Append length in bits and transform */
-  sha1->data[14] = sha1->bits[1];
-  sha1->data[15] = sha1->bits[0];
+  sha1->data[14] = GUINT32_TO_BE (sha1->bits[1]);
+  sha1->data[15] = GUINT32_TO_BE (sha1->bits[0]);
 
-  sha_byte_reverse (sha1->data, SHA1_DATASIZE - 8);
-  sha1_transform (sha1->buf, sha1->data);
+  sha1_transform_blocks (sha1->buf, (guchar *) sha1->data, 1);
   sha_byte_reverse (sha1->buf, SHA1_DIGEST_LEN);
 
   memcpy (sha1->digest, sha1->buf, SHA1_DIGEST_LEN);
@@ -984,6 +1371,30 @@ sha256_transform (guint32      buf[8],
   buf[7] += H;
 }
 
+/* Runs @n_blocks blocks of message bytes from @data through the state */
+static void
+sha256_transform_blocks (guint32       buf[8],
+                         const guchar *data,
+                         gsize         n_blocks)
+{
+#if defined (USE_SHA_NI)
+  if (sha_hw_features () & SHA_HW_SHA256)
+    {
+      sha256_transform_sha_ni (buf, data, n_blocks);
+      return;
+    }
+#elif defined (USE_ARM_CRYPTO)
+  if (sha_hw_features () & SHA_HW_SHA256)
+    {
+      sha256_transform_arm (buf, data, n_blocks);
+      return;
+    }
+#endif
+
+  for (; n_blocks > 0; n_blocks--, data += SHA256_DATASIZE)
+    sha256_transform (buf, data);
+}
+
 static void
 sha256_sum_update (Sha256sum    *sha256,
                    const guchar *buffer,
@@ -1008,19 +1419,19 @@ sha256_sum_update (Sha256sum    *sha256,
     {
       memcpy ((sha256->data + left), input, fill);
 
-      sha256_transform (sha256->buf, sha256->data);
+      sha256_transform_blocks (sha256->buf, sha256->data, 1);
       length -= fill;
       input += fill;
 
       left = 0;
     }
 
-  while (length >= SHA256_DATASIZE)
+  if (length >= SHA256_DATASIZE)
     {
-      sha256_transform (sha256->buf, input);
+      sha256_transform_blocks (sha256->buf, input, length / SHA256_DATASIZE);
 
-      length -= 64;
-      input += 64;
+      input += length & ~(gsize) (SHA256_DATASIZE - 1);
+      length &= SHA256_DATASIZE - 1;
     }
 
   if (length)
@@ -1860,3 +2271,81 @@ g_compute_checksum_for_bytes (GChecksumType  checksum_type,
   byte_data = g_bytes_get_data (data, &length);
   return g_compute_checksum_for_data (checksum_type, byte_data, length);
 }
+
+/**
+ * g_compute_digests_for_data:
+ * @checksum_type: a #GChecksumType
+ * @data: (array length=n_items): the binary blobs to compute the digests of
+ * @lengths: (array length=n_items): the length of each blob in @data
+ * @n_items: the number of blobs
+ * @digests: (out caller-allocates): return location for the digests
+ *
+ * Computes the checksum of each of the @n_items binary blobs in @data,
+ * and stores them as raw binary vectors one after the other in @digests,
+ * which must have room for @n_items times g_checksum_type_get_length()
+ * bytes.
+ *
+ * This gives the same results as calling g_checksum_get_digest() on a
+ * #GChecksum for each blob, but without allocating anything, so it is
+ * much cheaper when there are many small blobs, such as keys or records.
+ *
+ * Since: 2.68
+ */
+void
+g_compute_digests_for_data (GChecksumType         checksum_type,
+                            const guchar * const *data,
+                            const gsize          *lengths,
+                            gsize                 n_items,
+                            guint8               *digests)
+{
+  GChecksum checksum;
+  gsize digest_len;
+  gsize i;
+
+  g_return_if_fail (IS_VALID_TYPE (checksum_type));
+  g_return_if_fail (n_items == 0 || (data != NULL && lengths != NULL && digests != NULL));
+
+  digest_len = g_checksum_type_get_length (checksum_type);
+
+  for (i = 0; i < n_items; i++, digests += digest_len)
+    {
+      g_return_if_fail (lengths[i] == 0 || data[i] != NULL);
+
+      switch (checksum_type)
+        {
+        case G_CHECKSUM_MD5:
+          md5_sum_init (&checksum.sum.md5);
+          md5_sum_update (&checksum.sum.md5, data[i], lengths[i]);
+          md5_sum_close (&checksum.sum.md5);
+          md5_sum_digest (&checksum.sum.md5, digests);
+          break;
+        case G_CHECKSUM_SHA1:
+          sha1_sum_init (&checksum.sum.sha1);
+          sha1_sum_update (&checksum.sum.sha1, data[i], lengths[i]);
+          sha1_sum_close (&checksum.sum.sha1);
+          sha1_sum_digest (&checksum.sum.sha1, digests);
+          break;
+        case G_CHECKSUM_SHA256:
+          sha256_sum_init (&checksum.sum.sha256);
+          sha256_sum_update (&checksum.sum.sha256, data[i], lengths[i]);
+          sha256_sum_close (&checksum.sum.sha256);
+          sha256_sum_digest (&checksum.sum.sha256, digests);
+          break;
+        case G_CHECKSUM_SHA384:
+          sha384_sum_init (&checksum.sum.sha512);
+          sha512_sum_update (&checksum.sum.sha512, data[i], lengths[i]);
+          sha512_sum_close (&checksum.sum.sha512);
+          sha384_sum_digest (&checksum.sum.sha512, digests);
+          break;
+        case G_CHECKSUM_SHA512:
+          sha512_sum_init (&checksum.sum.sha512);
+          sha512_sum_update (&checksum.sum.sha512, data[i], lengths[i]);
+          sha512_sum_close (&checksum.sum.sha512);
+          sha512_sum_digest (&checksum.sum.sha512, digests);
+          break;
+        default:
+          g_assert_not_reached ();
+          break;
+        }
+    }
+}
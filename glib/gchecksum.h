@@ -98,6 +98,13 @@ GLIB_AVAILABLE_IN_2_34
 gchar                *g_compute_checksum_for_bytes  (GChecksumType    checksum_type,
                                                      GBytes          *data);
 
+GLIB_AVAILABLE_IN_2_68
+void                  g_compute_digests_for_data    (GChecksumType         checksum_type,
+                                                     const guchar * const *data,
+                                                     const gsize          *lengths,
+                                                     gsize                 n_items,
+                                                     guint8               *digests);
+
 G_END_DECLS
 
 #endif /* __G_CHECKSUM_H__ */
@@ -0,0 +1,771 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MT safe
+ */
+
+#include "config.h"
+
+#include "gconcurrenthashtable.h"
+
+#include "gatomic.h"
+#include "gmem.h"
+#include "gmessages.h"
+#include "gslist.h"
+#include "gthread.h"
+#include "gutils.h"
+
+/**
+ * SECTION:concurrent_hash_tables
+ * @title: Concurrent Hash Tables
+ * @short_description: hash tables which can be used from many threads
+ *     at once
+ * @see_also: #GHashTable
+ *
+ * A #GConcurrentHashTable associates keys with values like a
+ * #GHashTable, and takes the same hash, equality and destroy functions,
+ * but all of its functions can be called from any number of threads at
+ * the same time without any locking by the caller.
+ *
+ * The entries are spread over a number of shards, each of which is a
+ * #GHashTable behind its own #GMutex, so threads only contend when
+ * they use keys in the same shard. There are several shards for each
+ * processor, and each is held only for a single hash table operation,
+ * which is cheaper than a #GRWLock for such short sections. This scales
+ * much better than a single #GHashTable with a #GMutex or a #GRWLock
+ * around it when many threads use the same table.
+ *
+ * Since the entries can be removed by another thread at any time,
+ * looking up a value and using it afterwards is only safe if values are
+ * never removed or replaced while they are being used. Otherwise, use
+ * g_concurrent_hash_table_lookup_copy() to get a copy of (or a new
+ * reference to) the value while the entry is locked. To change an
+ * existing value based on its current one, such as to increment a
+ * counter, use g_concurrent_hash_table_compute_if_present(); to add an
+ * entry only if there is none for its key yet, use
+ * g_concurrent_hash_table_insert_if_absent().
+ *
+ * g_concurrent_hash_table_foreach() and
+ * g_concurrent_hash_table_snapshot() see every entry exactly once, even
+ * while other threads change the table. The destroy functions are never
+ * called with any lock held, so they may use the table again.
+ *
+ * Since: 2.68
+ */
+
+/**
+ * GConcurrentHashTable:
+ *
+ * The GConcurrentHashTable struct is an opaque data structure which
+ * represents a thread-safe hash table. It should only be accessed
+ * through the g_concurrent_hash_table_* functions.
+ *
+ * Since: 2.68
+ */
+
+#define CACHE_LINE_SIZE 64
+
+/* Shards are at least this many, and at least four per processor, so
+ * that threads rarely want the same one at the same time */
+#define MIN_SHARDS 16
+#define MAX_SHARDS 1024
+
+typedef struct
+{
+  GMutex lock;
+  GHashTable *table;  /* (owned) (locked-by lock) */
+} GConcurrentHashTableShard;
+
+/* Each shard on its own cache line, so that taking one lock doesn't
+ * slow down threads using the shards next to it */
+typedef union
+{
+  GConcurrentHashTableShard shard;
+  gchar padding[CACHE_LINE_SIZE];
+} GConcurrentHashTablePaddedShard;
+
+G_STATIC_ASSERT (sizeof (GConcurrentHashTableShard) <= CACHE_LINE_SIZE);
+
+struct _GConcurrentHashTable
+{
+  GConcurrentHashTablePaddedShard *shards;  /* aligned to a cache line */
+  gpointer shards_allocation;
+  guint shard_shift;
+  GHashFunc hash_func;
+  GEqualFunc key_equal_func;
+  GDestroyNotify key_destroy_func;
+  GDestroyNotify value_destroy_func;
+  gint ref_count;  /* (atomic) */
+};
+
+/* Keys and values to hand to the destroy functions once the shard they
+ * came from is unlocked */
+typedef struct
+{
+  gpointer key;
+  gpointer value;
+  gboolean destroy_key;
+  gboolean destroy_value;
+} GConcurrentHashTableGarbage;
+
+static inline GConcurrentHashTableShard *
+get_shard (GConcurrentHashTable *hash_table,
+           gconstpointer         key)
+{
+  guint hash = hash_table->hash_func (key);
+
+  /* The shard comes from the top bits, after spreading them out, since
+   * the table in the shard uses the bottom ones */
+  if (hash_table->shard_shift == 0)
+    return &hash_table->shards[0].shard;
+
+  return &hash_table->shards[(hash * 2654435761u) >> (32 - hash_table->shard_shift)].shard;
+}
+
+static void
+dispose_garbage (GConcurrentHashTable        *hash_table,
+                 GConcurrentHashTableGarbage *garbage)
+{
+  if (garbage->destroy_key && hash_table->key_destroy_func)
+    hash_table->key_destroy_func (garbage->key);
+  if (garbage->destroy_value && hash_table->value_destroy_func)
+    hash_table->value_destroy_func (garbage->value);
+}
+
+/**
+ * g_concurrent_hash_table_new:
+ * @hash_func: a function to create a hash value from a key
+ * @key_equal_func: a function to check two keys for equality
+ *
+ * Creates a new #GConcurrentHashTable with a reference count of 1.
+ *
+ * @hash_func and @key_equal_func are used like the ones passed to
+ * g_hash_table_new(), and may be %NULL in the same way. They are called
+ * from whichever threads use the table, so they must be thread-safe.
+ *
+ * Returns: a new #GConcurrentHashTable
+ *
+ * Since: 2.68
+ */
+GConcurrentHashTable *
+g_concurrent_hash_table_new (GHashFunc  hash_func,
+                             GEqualFunc key_equal_func)
+{
+  return g_concurrent_hash_table_new_full (hash_func, key_equal_func, NULL, NULL);
+}
+
+/**
+ * g_concurrent_hash_table_new_full:
+ * @hash_func: a function to create a hash value from a key
+ * @key_equal_func: a function to check two keys for equality
+ * @key_destroy_func: (nullable): a function to free the memory allocated
+ *     for the key used when removing the entry from the table, or %NULL
+ * @value_destroy_func: (nullable): a function to free the memory allocated
+ *     for the value used when removing the entry from the table, or %NULL
+ *
+ * Creates a new #GConcurrentHashTable like g_concurrent_hash_table_new()
+ * with a reference count of 1 and allows to specify functions to free
+ * the memory allocated for the key and value that get called when
+ * removing the entry from the table, as with g_hash_table_new_full().
+ *
+ * The destroy functions are called without any lock held, from the
+ * thread which removed the entry.
+ *
+ * Returns: a new #GConcurrentHashTable
+ *
+ * Since: 2.68
+ */
+GConcurrentHashTable *
+g_concurrent_hash_table_new_full (GHashFunc      hash_func,
+                                  GEqualFunc     key_equal_func,
+                                  GDestroyNotify key_destroy_func,
+                                  GDestroyNotify value_destroy_func)
+{
+  GConcurrentHashTable *hash_table;
+  guint n_shards = MIN_SHARDS;
+  guint shift = 0;
+  guint i;
+
+  while (n_shards < 4 * g_get_num_processors () && n_shards < MAX_SHARDS)
+    n_shards <<= 1;
+  while ((1u << shift) < n_shards)
+    shift++;
+
+  hash_table = g_new0 (GConcurrentHashTable, 1);
+  hash_table->hash_func = hash_func ? hash_func : g_direct_hash;
+  hash_table->key_equal_func = key_equal_func;
+  hash_table->key_destroy_func = key_destroy_func;
+  hash_table->value_destroy_func = value_destroy_func;
+  hash_table->ref_count = 1;
+  hash_table->shard_shift = shift;
+
+  hash_table->shards_allocation = g_malloc ((n_shards + 1) * sizeof (GConcurrentHashTablePaddedShard));
+  hash_table->shards = (GConcurrentHashTablePaddedShard *)
+    (((guintptr) hash_table->shards_allocation + CACHE_LINE_SIZE - 1) & ~((guintptr) CACHE_LINE_SIZE - 1));
+
+  for (i = 0; i < n_shards; i++)
+    {
+      GConcurrentHashTableShard *shard = &hash_table->shards[i].shard;
+
+      g_mutex_init (&shard->lock);
+      shard->table = g_hash_table_new (hash_table->hash_func, key_equal_func);
+    }
+
+  return hash_table;
+}
+
+/**
+ * g_concurrent_hash_table_ref:
+ * @hash_table: a #GConcurrentHashTable
+ *
+ * Atomically increments the reference count of @hash_table by one.
+ *
+ * Returns: the passed in #GConcurrentHashTable
+ *
+ * Since: 2.68
+ */
+GConcurrentHashTable *
+g_concurrent_hash_table_ref (GConcurrentHashTable *hash_table)
+{
+  g_return_val_if_fail (hash_table != NULL, NULL);
+
+  g_atomic_int_inc (&hash_table->ref_count);
+
+  return hash_table;
+}
+
+/**
+ * g_concurrent_hash_table_unref:
+ * @hash_table: a #GConcurrentHashTable
+ *
+ * Atomically decrements the reference count of @hash_table by one.
+ * If the reference count drops to 0, all keys and values will be
+ * destroyed, and all memory allocated by the hash table is released.
+ *
+ * Since: 2.68
+ */
+void
+g_concurrent_hash_table_unref (GConcurrentHashTable *hash_table)
+{
+  guint i;
+
+  g_return_if_fail (hash_table != NULL);
+
+  if (!g_atomic_int_dec_and_test (&hash_table->ref_count))
+    return;
+
+  g_concurrent_hash_table_remove_all (hash_table);
+
+  for (i = 0; i < (1u << hash_table->shard_shift); i++)
+    {
+      GConcurrentHashTableShard *shard = &hash_table->shards[i].shard;
+
+      g_hash_table_unref (shard->table);
+      g_mutex_clear (&shard->lock);
+    }
+
+  g_free (hash_table->shards_allocation);
+  g_free (hash_table);
+}
+
+/**
+ * g_concurrent_hash_table_insert:
+ * @hash_table: a #GConcurrentHashTable
+ * @key: a key to insert
+ * @value: the value to associate with the key
+ *
+ * Inserts a new key and value into a #GConcurrentHashTable, like
+ * g_hash_table_insert().
+ *
+ * If the key already exists in the table its current value is replaced
+ * with the new value, and @key is freed with the key destroy function
+ * while the old key stays in the table.
+ *
+ * Returns: %TRUE if the key did not exist yet
+ *
+ * Since: 2.68
+ */
+gboolean
+g_concurrent_hash_table_insert (GConcurrentHashTable *hash_table,
+                                gpointer              key,
+                                gpointer              value)
+{
+  GConcurrentHashTableShard *shard;
+  GConcurrentHashTableGarbage garbage = { key, NULL, FALSE, FALSE };
+  gpointer old_key, old_value;
+
+  g_return_val_if_fail (hash_table != NULL, FALSE);
+
+  shard = get_shard (hash_table, key);
+
+  g_mutex_lock (&shard->lock);
+  if (g_hash_table_lookup_extended (shard->table, key, &old_key, &old_value))
+    {
+      g_hash_table_insert (shard->table, old_key, value);
+      garbage.destroy_key = TRUE;
+      garbage.value = old_value;
+      garbage.destroy_value = TRUE;
+    }
+  else
+    g_hash_table_insert (shard->table, key, value);
+  g_mutex_unlock (&shard->lock);
+
+  dispose_garbage (hash_table, &garbage);
+
+  return !garbage.destroy_key;
+}
+
+/**
+ * g_concurrent_hash_table_insert_if_absent:
+ * @hash_table: a #GConcurrentHashTable
+ * @key: a key to insert
+ * @value: the value to associate with the key
+ *
+ * Inserts a new key and value into a #GConcurrentHashTable, unless the
+ * key exists in the table already, in one step: when several threads
+ * try to insert the same key at the same time, exactly one of them
+ * succeeds.
+ *
+ * If the key exists already, the table is not changed and doesn't take
+ * @key and @value, which are left for the caller to free.
+ *
+ * Returns: %TRUE if @key and @value were inserted
+ *
+ * Since: 2.68
+ */
+gboolean
+g_concurrent_hash_table_insert_if_absent (GConcurrentHashTable *hash_table,
+                                          gpointer              key,
+                                          gpointer              value)
+{
+  GConcurrentHashTableShard *shard;
+  gboolean inserted;
+
+  g_return_val_if_fail (hash_table != NULL, FALSE);
+
+  shard = get_shard (hash_table, key);
+
+  g_mutex_lock (&shard->lock);
+  inserted = !g_hash_table_contains (shard->table, key);
+  if (inserted)
+    g_hash_table_insert (shard->table, key, value);
+  g_mutex_unlock (&shard->lock);
+
+  return inserted;
+}
+
+/**
+ * g_concurrent_hash_table_compute_if_present:
+ * @hash_table: a #GConcurrentHashTable
+ * @key: the key to update
+ * @func: (scope call): the function to call on the entry
+ * @user_data: user data to pass to @func
+ *
+ * If @key is in @hash_table, calls @func with its key and a pointer to
+ * its value, while no other thread can use the entry. @func can store a
+ * new value, which replaces the old one, and the old one is then freed
+ * with the value destroy function. If @func returns %FALSE, the entry is
+ * removed, and its key and (new) value are freed, too.
+ *
+ * @func is called with a lock held, so it must not use @hash_table, and
+ * should return quickly.
+ *
+ * Returns: %TRUE if @key was found and @func was called
+ *
+ * Since: 2.68
+ */
+gboolean
+g_concurrent_hash_table_compute_if_present (GConcurrentHashTable            *hash_table,
+                                            gconstpointer                    key,
+                                            GConcurrentHashTableComputeFunc  func,
+                                            gpointer                         user_data)
+{
+  GConcurrentHashTableShard *shard;
+  GConcurrentHashTableGarbage removed = { NULL, NULL, FALSE, FALSE };
+  GConcurrentHashTableGarbage replaced = { NULL, NULL, FALSE, FALSE };
+  gpointer old_key, old_value, value;
+  gboolean found;
+
+  g_return_val_if_fail (hash_table != NULL, FALSE);
+  g_return_val_if_fail (func != NULL, FALSE);
+
+  shard = get_shard (hash_table, key);
+
+  g_mutex_lock (&shard->lock);
+  found = g_hash_table_lookup_extended (shard->table, key, &old_key, &old_value);
+  if (found)
+    {
+      value = old_value;
+
+      if (!func (old_key, &value, user_data))
+        {
+          g_hash_table_remove (shard->table, old_key);
+          removed.key = old_key;
+          removed.value = value;
+          removed.destroy_key = removed.destroy_value = TRUE;
+        }
+      else if (value != old_value)
+        {
+          g_hash_table_insert (shard->table, old_key, value);
+        }
+
+      replaced.value = old_value;
+      replaced.destroy_value = value != old_value;
+    }
+  g_mutex_unlock (&shard->lock);
+
+  dispose_garbage (hash_table, &replaced);
+  dispose_garbage (hash_table, &removed);
+
+  return found;
+}
+
+/**
+ * g_concurrent_hash_table_remove:
+ * @hash_table: a #GConcurrentHashTable
+ * @key: the key to remove
+ *
+ * Removes a key and its associated value from a #GConcurrentHashTable,
+ * freeing them with the destroy functions, if any.
+ *
+ * Returns: %TRUE if the key was found and removed
+ *
+ * Since: 2.68
+ */
+gboolean
+g_concurrent_hash_table_remove (GConcurrentHashTable *hash_table,
+                                gconstpointer         key)
+{
+  GConcurrentHashTableShard *shard;
+  GConcurrentHashTableGarbage garbage = { NULL, NULL, FALSE, FALSE };
+
+  g_return_val_if_fail (hash_table != NULL, FALSE);
+
+  shard = get_shard (hash_table, key);
+
+  g_mutex_lock (&shard->lock);
+  if (g_hash_table_steal_extended (shard->table, key, &garbage.key, &garbage.value))
+    garbage.destroy_key = garbage.destroy_value = TRUE;
+  g_mutex_unlock (&shard->lock);
+
+  dispose_garbage (hash_table, &garbage);
+
+  return garbage.destroy_key;
+}
+
+/**
+ * g_concurrent_hash_table_remove_all:
+ * @hash_table: a #GConcurrentHashTable
+ *
+ * Removes all keys and their associated values from a
+ * #GConcurrentHashTable, freeing them with the destroy functions, if
+ * any.
+ *
+ * The shards are emptied one after the other, so entries which other
+ * threads insert at the same time may or may not be removed.
+ *
+ * Since: 2.68
+ */
+void
+g_concurrent_hash_table_remove_all (GConcurrentHashTable *hash_table)
+{
+  guint i;
+
+  g_return_if_fail (hash_table != NULL);
+
+  for (i = 0; i < (1u << hash_table->shard_shift); i++)
+    {
+      GConcurrentHashTableShard *shard = &hash_table->shards[i].shard;
+      GHashTable *old_table, *new_table;
+      GHashTableIter iter;
+      gpointer key, value;
+
+      /* Swap in an empty table, so the old one can be freed without
+       * holding the lock */
+      new_table = g_hash_table_new (hash_table->hash_func, hash_table->key_equal_func);
+
+      g_mutex_lock (&shard->lock);
+      old_table = shard->table;
+      shard->table = new_table;
+      g_mutex_unlock (&shard->lock);
+
+      if (hash_table->key_destroy_func || hash_table->value_destroy_func)
+        {
+          g_hash_table_iter_init (&iter, old_table);
+          while (g_hash_table_iter_next (&iter, &key, &value))
+            {
+              GConcurrentHashTableGarbage garbage = { key, value, TRUE, TRUE };
+
+              dispose_garbage (hash_table, &garbage);
+            }
+        }
+
+      g_hash_table_unref (old_table);
+    }
+}
+
+/**
+ * g_concurrent_hash_table_lookup:
+ * @hash_table: a #GConcurrentHashTable
+ * @key: the key to look up
+ *
+ * Looks up a key in a #GConcurrentHashTable. Note that this function
+ * cannot distinguish between a key that is not present and one which
+ * is present and has the value %NULL; use
+ * g_concurrent_hash_table_contains() for that.
+ *
+ * Another thread can remove or replace the entry, and free its value,
+ * at any time after this function returned. Only use it when this can't
+ * happen, for example because values are never freed or never removed;
+ * otherwise, use g_concurrent_hash_table_lookup_copy().
+ *
+ * Returns: (nullable) (transfer none): the associated value, or %NULL
+ *     if the key is not found
+ *
+ * Since: 2.68
+ */
+gpointer
+g_concurrent_hash_table_lookup (GConcurrentHashTable *hash_table,
+                                gconstpointer         key)
+{
+  GConcurrentHashTableShard *shard;
+  gpointer value;
+
+  g_return_val_if_fail (hash_table != NULL, NULL);
+
+  shard = get_shard (hash_table, key);
+
+  g_mutex_lock (&shard->lock);
+  value = g_hash_table_lookup (shard->table, key);
+  g_mutex_unlock (&shard->lock);
+
+  return value;
+}
+
+/**
+ * g_concurrent_hash_table_lookup_copy:
+ * @hash_table: a #GConcurrentHashTable
+ * @key: the key to look up
+ * @value_copy_func: (scope call): a function to copy the value
+ * @user_data: user data to pass to @value_copy_func
+ *
+ * Looks up a key in a #GConcurrentHashTable and returns a copy of its
+ * value made by @value_copy_func, which is called while no other thread
+ * can remove the entry. For example, pass g_object_ref() for values
+ * which are objects, or g_strdup() for strings.
+ *
+ * @value_copy_func is called with a lock held, so it must not use
+ * @hash_table.
+ *
+ * Returns: (nullable) (transfer full): the copy of the associated value,
+ *     or %NULL if the key is not found
+ *
+ * Since: 2.68
+ */
+gpointer
+g_concurrent_hash_table_lookup_copy (GConcurrentHashTable *hash_table,
+                                     gconstpointer         key,
+                                     GCopyFunc             value_copy_func,
+                                     gpointer              user_data)
+{
+  GConcurrentHashTableShard *shard;
+  gpointer value, copy = NULL;
+
+  g_return_val_if_fail (hash_table != NULL, NULL);
+  g_return_val_if_fail (value_copy_func != NULL, NULL);
+
+  shard = get_shard (hash_table, key);
+
+  g_mutex_lock (&shard->lock);
+  if (g_hash_table_lookup_extended (shard->table, key, NULL, &value))
+    copy = value_copy_func (value, user_data);
+  g_mutex_unlock (&shard->lock);
+
+  return copy;
+}
+
+/**
+ * g_concurrent_hash_table_contains:
+ * @hash_table: a #GConcurrentHashTable
+ * @key: the key to check
+ *
+ * Checks if @key is in @hash_table.
+ *
+ * Returns: %TRUE if @key is in @hash_table, %FALSE otherwise
+ *
+ * Since: 2.68
+ */
+gboolean
+g_concurrent_hash_table_contains (GConcurrentHashTable *hash_table,
+                                  gconstpointer         key)
+{
+  GConcurrentHashTableShard *shard;
+  gboolean found;
+
+  g_return_val_if_fail (hash_table != NULL, FALSE);
+
+  shard = get_shard (hash_table, key);
+
+  g_mutex_lock (&shard->lock);
+  found = g_hash_table_contains (shard->table, key);
+  g_mutex_unlock (&shard->lock);
+
+  return found;
+}
+
+/**
+ * g_concurrent_hash_table_size:
+ * @hash_table: a #GConcurrentHashTable
+ *
+ * Returns the number of elements contained in the #GConcurrentHashTable.
+ *
+ * While other threads change the table, this is only an estimate: the
+ * shards are counted one after the other.
+ *
+ * Returns: the number of key/value pairs in the #GConcurrentHashTable
+ *
+ * Since: 2.68
+ */
+guint
+g_concurrent_hash_table_size (GConcurrentHashTable *hash_table)
+{
+  guint size = 0;
+  guint i;
+
+  g_return_val_if_fail (hash_table != NULL, 0);
+
+  for (i = 0; i < (1u << hash_table->shard_shift); i++)
+    {
+      GConcurrentHashTableShard *shard = &hash_table->shards[i].shard;
+
+      g_mutex_lock (&shard->lock);
+      size += g_hash_table_size (shard->table);
+      g_mutex_unlock (&shard->lock);
+    }
+
+  return size;
+}
+
+/**
+ * g_concurrent_hash_table_foreach:
+ * @hash_table: a #GConcurrentHashTable
+ * @func: (scope call): the function to call for each key/value pair
+ * @user_data: user data to pass to the function
+ *
+ * Calls the given function for each of the key/value pairs in the
+ * #GConcurrentHashTable, one shard after the other, with the shard
+ * locked. Entries which other threads add or remove at the
+ * same time may or may not be seen, but no entry is seen twice.
+ *
+ * @func must not use @hash_table, and while it runs, other threads
+ * can't use the entries in the same shard, so it should return
+ * quickly. To go through the entries at leisure, use
+ * g_concurrent_hash_table_snapshot().
+ *
+ * Since: 2.68
+ */
+void
+g_concurrent_hash_table_foreach (GConcurrentHashTable *hash_table,
+                                 GHFunc                func,
+                                 gpointer              user_data)
+{
+  guint i;
+
+  g_return_if_fail (hash_table != NULL);
+  g_return_if_fail (func != NULL);
+
+  for (i = 0; i < (1u << hash_table->shard_shift); i++)
+    {
+      GConcurrentHashTableShard *shard = &hash_table->shards[i].shard;
+
+      g_mutex_lock (&shard->lock);
+      g_hash_table_foreach (shard->table, func, user_data);
+      g_mutex_unlock (&shard->lock);
+    }
+}
+
+/**
+ * g_concurrent_hash_table_snapshot:
+ * @hash_table: a #GConcurrentHashTable
+ * @key_copy_func: (nullable) (scope call): a function to copy each key,
+ *     or %NULL to use the keys as they are
+ * @value_copy_func: (nullable) (scope call): a function to copy each
+ *     value, or %NULL to use the values as they are
+ * @user_data: user data to pass to the copy functions
+ *
+ * Copies the entries of @hash_table into a new #GHashTable, as they all
+ * were at a single point in time: all shards are locked while the
+ * entries are copied, so none of them can change meanwhile.
+ *
+ * The new table uses the same hash and equality functions as
+ * @hash_table. When a copy function is given, the new table owns the
+ * copies it made, and frees them with the destroy function of
+ * @hash_table for keys or values. Without a copy function, the new
+ * table doesn't free the keys or values, which stay owned by
+ * @hash_table and are only safe to use while they can't be removed.
+ *
+ * The copy functions are called with locks held, so they must not use
+ * @hash_table.
+ *
+ * Returns: (transfer full): a new #GHashTable with the entries of
+ *     @hash_table
+ *
+ * Since: 2.68
+ */
+GHashTable *
+g_concurrent_hash_table_snapshot (GConcurrentHashTable *hash_table,
+                                  GCopyFunc             key_copy_func,
+                                  GCopyFunc             value_copy_func,
+                                  gpointer              user_data)
+{
+  GHashTable *snapshot;
+  guint n_shards;
+  guint i;
+
+  g_return_val_if_fail (hash_table != NULL, NULL);
+
+  snapshot = g_hash_table_new_full (hash_table->hash_func,
+                                    hash_table->key_equal_func,
+                                    key_copy_func ? hash_table->key_destroy_func : NULL,
+                                    value_copy_func ? hash_table->value_destroy_func : NULL);
+
+  n_shards = 1u << hash_table->shard_shift;
+
+  /* Always in the same order, so that snapshots can't deadlock with
+   * each other */
+  for (i = 0; i < n_shards; i++)
+    g_mutex_lock (&hash_table->shards[i].shard.lock);
+
+  for (i = 0; i < n_shards; i++)
+    {
+      GHashTableIter iter;
+      gpointer key, value;
+
+      g_hash_table_iter_init (&iter, hash_table->shards[i].shard.table);
+      while (g_hash_table_iter_next (&iter, &key, &value))
+        g_hash_table_insert (snapshot,
+                             key_copy_func ? key_copy_func (key, user_data) : key,
+                             value_copy_func ? value_copy_func (value, user_data) : value);
+    }
+
+  for (i = 0; i < n_shards; i++)
+    g_mutex_unlock (&hash_table->shards[i].shard.lock);
+
+  return snapshot;
+}
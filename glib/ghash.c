@@ -30,12 +30,18 @@
 
 #include <string.h>  /* memset */
 
+#if defined (__SSE2__) && defined (__GNUC__)
+#include <emmintrin.h>
+#endif
+
 #include "ghash.h"
 #include "gmacros.h"
 #include "glib-private.h"
 #include "gstrfuncs.h"
 #include "gstrfuncsprivate.h"
 #include "gatomic.h"
+#include "grand.h"
+#include "gthread.h"
 #include "gtestutils.h"
 #include "gslice.h"
 #include "grefcount.h"
@@ -235,6 +241,7 @@
  */
 
 #define HASH_TABLE_MIN_SHIFT 3  /* 1 << 3 == 8 buckets */
+#define GROUP_TABLE_MIN_SHIFT 4  /* at least one group of buckets */
 
 #define UNUSED_HASH_VALUE 0
 #define TOMBSTONE_HASH_VALUE 1
@@ -264,10 +271,12 @@ struct _GHashTable
 
   guint            have_big_keys : 1;
   guint            have_big_values : 1;
+  guint            group_probing : 1;
 
   gpointer         keys;
   guint           *hashes;
   gpointer         values;
+  guint8          *ctrl;  /* with group probing only */
 
   GHashFunc        hash_func;
   GEqualFunc       key_equal_func;
@@ -363,13 +372,19 @@ g_hash_table_find_closest_shift (gint n)
   return i;
 }
 
+static inline gint
+g_hash_table_min_shift (GHashTable *hash_table)
+{
+  return hash_table->group_probing ? GROUP_TABLE_MIN_SHIFT : HASH_TABLE_MIN_SHIFT;
+}
+
 static void
 g_hash_table_set_shift_from_size (GHashTable *hash_table, gint size)
 {
   gint shift;
 
   shift = g_hash_table_find_closest_shift (size);
-  shift = MAX (shift, HASH_TABLE_MIN_SHIFT);
+  shift = MAX (shift, g_hash_table_min_shift (hash_table));
 
   g_hash_table_set_shift (hash_table, shift);
 }
@@ -435,6 +450,253 @@ g_hash_table_hash_to_index (GHashTable *hash_table, guint hash)
   return (hash * 11) % hash_table->mod;
 }
 
+/* With %G_HASH_TABLE_FLAGS_GROUP_PROBING, the table also has a control
+ * byte for each bucket, like the "Swiss tables" of Abseil: it tells
+ * whether the bucket is empty, a tombstone, or in use, and then holds 7
+ * bits of the hash value of its key. A lookup loads a whole group of
+ * control bytes at once, compares them all with the bits of the hash it
+ * is looking for, and only looks at the hashes and keys of the buckets
+ * which match. Probing then goes on a group at a time, quadratically.
+ *
+ * A group can start at any bucket, so the control bytes of the first
+ * group are repeated after the last bucket. The hashes array is still
+ * what tells which buckets are in use, so iterating and the other code
+ * going through all the buckets is the same with and without groups.
+ */
+#define CTRL_EMPTY   0x80
+#define CTRL_DELETED 0xfe
+
+#if defined (__SSE2__) && defined (__GNUC__)
+
+#define GROUP_WIDTH 16
+
+/* A bit for each control byte of the group which matches */
+typedef guint GroupMask;
+
+#define GROUP_MASK_INDEX(m) ((guint) __builtin_ctz (m))
+
+static inline GroupMask
+group_match (const guint8 *ctrl, guint8 h2)
+{
+  __m128i group = _mm_loadu_si128 ((const __m128i *) ctrl);
+
+  return _mm_movemask_epi8 (_mm_cmpeq_epi8 (group, _mm_set1_epi8 ((gchar) h2)));
+}
+
+static inline GroupMask
+group_match_empty (const guint8 *ctrl)
+{
+  return group_match (ctrl, CTRL_EMPTY);
+}
+
+/* Empty buckets and tombstones, which are the control bytes with the top
+ * bit set */
+static inline GroupMask
+group_match_free (const guint8 *ctrl)
+{
+  return _mm_movemask_epi8 (_mm_loadu_si128 ((const __m128i *) ctrl));
+}
+
+#else /* !(__SSE2__ && __GNUC__) */
+
+/* Eight control bytes at a time in a 64-bit word, where the top bit of
+ * each byte in the mask tells whether it matches */
+#define GROUP_WIDTH 8
+
+typedef guint64 GroupMask;
+
+#define GROUP_LSBS G_GUINT64_CONSTANT (0x0101010101010101)
+#define GROUP_MSBS G_GUINT64_CONSTANT (0x8080808080808080)
+
+static inline guint
+group_mask_index (GroupMask m)
+{
+#if defined (__GNUC__)
+  return __builtin_ctzll (m) / 8;
+#else
+  guint i = 0;
+
+  while (!(m & 0x80))
+    {
+      m >>= 8;
+      i++;
+    }
+
+  return i;
+#endif
+}
+
+#define GROUP_MASK_INDEX(m) group_mask_index (m)
+
+static inline guint64
+group_load (const guint8 *ctrl)
+{
+  guint64 group;
+
+  memcpy (&group, ctrl, sizeof (group));
+  return GUINT64_FROM_LE (group);
+}
+
+/* This can report false positives next to real matches, which are then
+ * weeded out by comparing the full hash values */
+static inline GroupMask
+group_match (const guint8 *ctrl, guint8 h2)
+{
+  guint64 x = group_load (ctrl) ^ (GROUP_LSBS * h2);
+
+  return (x - GROUP_LSBS) & ~x & GROUP_MSBS;
+}
+
+static inline GroupMask
+group_match_empty (const guint8 *ctrl)
+{
+  guint64 group = group_load (ctrl);
+
+  /* CTRL_EMPTY is the only byte with the top bit set and bit 1 clear */
+  return group & ~(group << 6) & GROUP_MSBS;
+}
+
+static inline GroupMask
+group_match_free (const guint8 *ctrl)
+{
+  return group_load (ctrl) & GROUP_MSBS;
+}
+
+#endif /* !(__SSE2__ && __GNUC__) */
+
+G_STATIC_ASSERT ((1 << GROUP_TABLE_MIN_SHIFT) >= GROUP_WIDTH);
+
+/* The hash value is mixed so that the bucket and the control byte come
+ * from different bits, both of which depend on all bits of the hash. */
+static inline guint64
+group_mix_hash (guint hash)
+{
+  return (guint64) hash * G_GUINT64_CONSTANT (0x9e3779b97f4a7c15);
+}
+
+#define GROUP_H1(mixed) ((guint) ((mixed) >> 32))
+#define GROUP_H2(mixed) ((guint8) (((mixed) >> 25) & 0x7f))
+
+static inline void
+g_hash_table_set_ctrl (GHashTable *hash_table, guint index, guint8 value)
+{
+  hash_table->ctrl[index] = value;
+  /* Also sets the copy at the end for the first group, or the same
+   * byte again otherwise */
+  hash_table->ctrl[((index - GROUP_WIDTH) & hash_table->mask) + GROUP_WIDTH] = value;
+}
+
+static guint8 *
+g_hash_table_new_ctrl (gsize size)
+{
+  guint8 *ctrl = g_malloc (size + GROUP_WIDTH);
+
+  memset (ctrl, CTRL_EMPTY, size + GROUP_WIDTH);
+  return ctrl;
+}
+
+/* Like g_hash_table_lookup_node(), with the hash value already worked out */
+static inline guint
+g_hash_table_lookup_node_grouped (GHashTable    *hash_table,
+                                  gconstpointer  key,
+                                  guint          hash_value)
+{
+  guint64 mixed = group_mix_hash (hash_value);
+  guint8 h2 = GROUP_H2 (mixed);
+  guint pos = GROUP_H1 (mixed) & hash_table->mask;
+  guint first_free = 0;
+  gboolean have_free = FALSE;
+  guint stride = 0;
+
+  for (;;)
+    {
+      const guint8 *group = hash_table->ctrl + pos;
+      GroupMask match = group_match (group, h2);
+
+      while (match)
+        {
+          guint node_index = (pos + GROUP_MASK_INDEX (match)) & hash_table->mask;
+          gpointer node_key;
+
+          /* Equal keys have equal hashes, so with pointer comparison
+           * there's no need to load the hash first */
+          if (hash_table->key_equal_func)
+            {
+              if (hash_table->hashes[node_index] == hash_value)
+                {
+                  node_key = g_hash_table_fetch_key_or_value (hash_table->keys, node_index, hash_table->have_big_keys);
+                  if (hash_table->key_equal_func (node_key, key))
+                    return node_index;
+                }
+            }
+          else
+            {
+              node_key = g_hash_table_fetch_key_or_value (hash_table->keys, node_index, hash_table->have_big_keys);
+              if (node_key == key)
+                return node_index;
+            }
+
+          match &= match - 1;
+        }
+
+      /* The key would have gone into the empty bucket, so it isn't in a
+       * later group. The table is never full, so this is reached. */
+      if (group_match_empty (group))
+        {
+          if (!have_free)
+            first_free = (pos + GROUP_MASK_INDEX (group_match_free (group))) & hash_table->mask;
+
+          return first_free;
+        }
+
+      if (!have_free)
+        {
+          GroupMask free_mask = group_match_free (group);
+
+          if (free_mask)
+            {
+              first_free = (pos + GROUP_MASK_INDEX (free_mask)) & hash_table->mask;
+              have_free = TRUE;
+            }
+        }
+
+      stride += GROUP_WIDTH;
+      pos = (pos + stride) & hash_table->mask;
+    }
+}
+
+/* Whether the bucket returned by g_hash_table_lookup_node() holds the key.
+ * With group probing, the control byte is in the cache already. */
+static inline gboolean
+g_hash_table_node_is_real (GHashTable *hash_table,
+                           guint       node_index)
+{
+  if (hash_table->group_probing)
+    return hash_table->ctrl[node_index] < CTRL_EMPTY;
+
+  return HASH_IS_REAL (hash_table->hashes[node_index]);
+}
+
+/* Finds a bucket for @hash_value in a table without tombstones */
+static inline guint
+g_hash_table_find_empty_grouped (GHashTable *hash_table,
+                                 guint       hash_value)
+{
+  guint pos = GROUP_H1 (group_mix_hash (hash_value)) & hash_table->mask;
+  guint stride = 0;
+
+  for (;;)
+    {
+      GroupMask empty = group_match_empty (hash_table->ctrl + pos);
+
+      if (empty)
+        return (pos + GROUP_MASK_INDEX (empty)) & hash_table->mask;
+
+      stride += GROUP_WIDTH;
+      pos = (pos + stride) & hash_table->mask;
+    }
+}
+
 /*
  * g_hash_table_lookup_node:
  * @hash_table: our #GHashTable
@@ -476,6 +738,9 @@ g_hash_table_lookup_node (GHashTable    *hash_table,
 
   *hash_return = hash_value;
 
+  if (hash_table->group_probing)
+    return g_hash_table_lookup_node_grouped (hash_table, key, hash_value);
+
   node_index = g_hash_table_hash_to_index (hash_table, hash_value);
   node_hash = hash_table->hashes[node_index];
 
@@ -542,6 +807,8 @@ g_hash_table_remove_node (GHashTable   *hash_table,
 
   /* Erect tombstone */
   hash_table->hashes[i] = TOMBSTONE_HASH_VALUE;
+  if (hash_table->group_probing)
+    g_hash_table_set_ctrl (hash_table, i, CTRL_DELETED);
 
   /* Be GC friendly */
   g_hash_table_assign_key_or_value (hash_table->keys, i, hash_table->have_big_keys, NULL);
@@ -583,7 +850,7 @@ g_hash_table_setup_storage (GHashTable *hash_table)
 # endif
 #endif
 
-  g_hash_table_set_shift (hash_table, HASH_TABLE_MIN_SHIFT);
+  g_hash_table_set_shift (hash_table, g_hash_table_min_shift (hash_table));
 
   hash_table->have_big_keys = !small;
   hash_table->have_big_values = !small;
@@ -591,6 +858,7 @@ g_hash_table_setup_storage (GHashTable *hash_table)
   hash_table->keys   = g_hash_table_realloc_key_or_value_array (NULL, hash_table->size, hash_table->have_big_keys);
   hash_table->values = hash_table->keys;
   hash_table->hashes = g_new0 (guint, hash_table->size);
+  hash_table->ctrl   = hash_table->group_probing ? g_hash_table_new_ctrl (hash_table->size) : NULL;
 }
 
 /*
@@ -623,6 +891,7 @@ g_hash_table_remove_all_nodes (GHashTable *hash_table,
   gpointer *old_keys;
   gpointer *old_values;
   guint    *old_hashes;
+  guint8   *old_ctrl;
   gboolean  old_have_big_keys;
   gboolean  old_have_big_values;
 
@@ -641,6 +910,8 @@ g_hash_table_remove_all_nodes (GHashTable *hash_table,
       if (!destruction)
         {
           memset (hash_table->hashes, 0, hash_table->size * sizeof (guint));
+          if (hash_table->group_probing)
+            memset (hash_table->ctrl, CTRL_EMPTY, hash_table->size + GROUP_WIDTH);
 
 #ifdef USE_SMALL_ARRAYS
           memset (hash_table->keys, 0, hash_table->size * (hash_table->have_big_keys ? BIG_ENTRY_SIZE : SMALL_ENTRY_SIZE));
@@ -680,6 +951,7 @@ g_hash_table_remove_all_nodes (GHashTable *hash_table,
   old_keys   = g_steal_pointer (&hash_table->keys);
   old_values = g_steal_pointer (&hash_table->values);
   old_hashes = g_steal_pointer (&hash_table->hashes);
+  old_ctrl   = g_steal_pointer (&hash_table->ctrl);
 
   if (!destruction)
     /* Any accesses will see an empty table */
@@ -715,6 +987,7 @@ g_hash_table_remove_all_nodes (GHashTable *hash_table,
 
   g_free (old_keys);
   g_free (old_hashes);
+  g_free (old_ctrl);
 }
 
 static void
@@ -849,6 +1122,57 @@ DEFINE_RESIZE_FUNC (resize_set)
  * the side effect of cleaning up tombstones and otherwise optimizing
  * the probe sequences.
  */
+/* With group probing, the entries are moved to new arrays instead, since
+ * putting them in place would need tracking at the level of groups. */
+static void
+g_hash_table_resize_grouped (GHashTable *hash_table)
+{
+  gsize old_size = hash_table->size;
+  gboolean is_a_set = hash_table->keys == hash_table->values;
+  gpointer old_keys = hash_table->keys;
+  gpointer old_values = hash_table->values;
+  guint *old_hashes = hash_table->hashes;
+  guint8 *old_ctrl = hash_table->ctrl;
+  gsize i;
+
+  g_hash_table_set_shift_from_size (hash_table, hash_table->nnodes * 1.333);
+
+  hash_table->hashes = g_new0 (guint, hash_table->size);
+  hash_table->ctrl = g_hash_table_new_ctrl (hash_table->size);
+  hash_table->keys = g_hash_table_realloc_key_or_value_array (NULL, hash_table->size, hash_table->have_big_keys);
+  if (is_a_set)
+    hash_table->values = hash_table->keys;
+  else
+    hash_table->values = g_hash_table_realloc_key_or_value_array (NULL, hash_table->size, hash_table->have_big_values);
+
+  for (i = 0; i < old_size; i++)
+    {
+      guint node_hash = old_hashes[i];
+      guint node_index;
+
+      if (!HASH_IS_REAL (node_hash))
+        continue;
+
+      node_index = g_hash_table_find_empty_grouped (hash_table, node_hash);
+
+      hash_table->hashes[node_index] = node_hash;
+      g_hash_table_set_ctrl (hash_table, node_index, GROUP_H2 (group_mix_hash (node_hash)));
+      g_hash_table_assign_key_or_value (hash_table->keys, node_index, hash_table->have_big_keys,
+                                        g_hash_table_fetch_key_or_value (old_keys, i, hash_table->have_big_keys));
+      if (!is_a_set)
+        g_hash_table_assign_key_or_value (hash_table->values, node_index, hash_table->have_big_values,
+                                          g_hash_table_fetch_key_or_value (old_values, i, hash_table->have_big_values));
+    }
+
+  if (old_keys != old_values)
+    g_free (old_values);
+  g_free (old_keys);
+  g_free (old_hashes);
+  g_free (old_ctrl);
+
+  hash_table->noccupied = hash_table->nnodes;
+}
+
 static void
 g_hash_table_resize (GHashTable *hash_table)
 {
@@ -856,6 +1180,12 @@ g_hash_table_resize (GHashTable *hash_table)
   gsize old_size;
   gboolean is_a_set;
 
+  if (hash_table->group_probing)
+    {
+      g_hash_table_resize_grouped (hash_table);
+      return;
+    }
+
   old_size = hash_table->size;
   is_a_set = hash_table->keys == hash_table->values;
 
@@ -912,7 +1242,7 @@ g_hash_table_maybe_resize (GHashTable *hash_table)
   gint noccupied = hash_table->noccupied;
   gint size = hash_table->size;
 
-  if ((size > hash_table->nnodes * 4 && size > 1 << HASH_TABLE_MIN_SHIFT) ||
+  if ((size > hash_table->nnodes * 4 && size > 1 << g_hash_table_min_shift (hash_table)) ||
       (size <= noccupied + (noccupied / 16)))
     g_hash_table_resize (hash_table);
 }
@@ -1067,9 +1397,63 @@ g_hash_table_new_full (GHashFunc      hash_func,
                        GEqualFunc     key_equal_func,
                        GDestroyNotify key_destroy_func,
                        GDestroyNotify value_destroy_func)
+{
+  return g_hash_table_new_with_flags (hash_func, key_equal_func,
+                                      key_destroy_func, value_destroy_func,
+                                      G_HASH_TABLE_FLAGS_NONE);
+}
+
+/**
+ * g_hash_table_new_with_flags:
+ * @hash_func: a function to create a hash value from a key
+ * @key_equal_func: a function to check two keys for equality
+ * @key_destroy_func: (nullable): a function to free the memory allocated for the key
+ *     used when removing the entry from the #GHashTable, or %NULL
+ *     if you don't want to supply such a function.
+ * @value_destroy_func: (nullable): a function to free the memory allocated for the
+ *     value used when removing the entry from the #GHashTable, or %NULL
+ *     if you don't want to supply such a function.
+ * @flags: flags that affect the behaviour of the table
+ *
+ * Creates a new #GHashTable like g_hash_table_new_full(), with @flags
+ * affecting its behaviour.
+ *
+ * With %G_HASH_TABLE_FLAGS_SEEDED_STR_HASH, a table created for string
+ * keys with g_str_hash() hashes them with g_str_hash_seeded() instead.
+ * This is a good idea for tables whose keys come from outside the
+ * process, such as D-Bus names, HTTP headers or paths: the keys of
+ * g_str_hash() can be chosen so that they all collide, which makes every
+ * operation on the table take O(n) time. Code which gets its hash
+ * function from elsewhere can opt in without knowing what it is; other
+ * hash functions are used as they are.
+ *
+ * With %G_HASH_TABLE_FLAGS_GROUP_PROBING, the table keeps a byte with a
+ * few bits of the hash value of each key next to its buckets, and
+ * compares a whole group of these at once (with SIMD instructions where
+ * available) when looking for a key. Only the buckets whose byte matches
+ * are looked at further, which makes looking up keys which aren't in the
+ * table cheaper, as well as tables with many tombstones. On the other
+ * hand, which bucket holds a key is only known once its group has been
+ * loaded, which can make other lookups in tables too big for the CPU
+ * caches slower; measure before using this. The behaviour of the table is
+ * otherwise the same, including the order of iteration being arbitrary.
+ *
+ * Returns: a new #GHashTable
+ *
+ * Since: 2.68
+ */
+GHashTable *
+g_hash_table_new_with_flags (GHashFunc       hash_func,
+                             GEqualFunc      key_equal_func,
+                             GDestroyNotify  key_destroy_func,
+                             GDestroyNotify  value_destroy_func,
+                             GHashTableFlags flags)
 {
   GHashTable *hash_table;
 
+  if ((flags & G_HASH_TABLE_FLAGS_SEEDED_STR_HASH) && hash_func == g_str_hash)
+    hash_func = g_str_hash_seeded;
+
   hash_table = g_slice_new (GHashTable);
   g_atomic_ref_count_init (&hash_table->ref_count);
   hash_table->nnodes             = 0;
@@ -1081,6 +1465,7 @@ g_hash_table_new_full (GHashFunc      hash_func,
 #endif
   hash_table->key_destroy_func   = key_destroy_func;
   hash_table->value_destroy_func = value_destroy_func;
+  hash_table->group_probing      = (flags & G_HASH_TABLE_FLAGS_GROUP_PROBING) != 0;
 
   g_hash_table_setup_storage (hash_table);
 
@@ -1321,6 +1706,8 @@ g_hash_table_insert_node (GHashTable *hash_table,
   else
     {
       hash_table->hashes[node_index] = key_hash;
+      if (hash_table->group_probing)
+        g_hash_table_set_ctrl (hash_table, node_index, GROUP_H2 (group_mix_hash (key_hash)));
       key_to_keep = new_key;
     }
 
@@ -1465,6 +1852,7 @@ g_hash_table_unref (GHashTable *hash_table)
         g_free (hash_table->values);
       g_free (hash_table->keys);
       g_free (hash_table->hashes);
+      g_free (hash_table->ctrl);
       g_slice_free (GHashTable, hash_table);
     }
 }
@@ -1512,7 +1900,7 @@ g_hash_table_lookup (GHashTable    *hash_table,
 
   node_index = g_hash_table_lookup_node (hash_table, key, &node_hash);
 
-  return HASH_IS_REAL (hash_table->hashes[node_index])
+  return g_hash_table_node_is_real (hash_table, node_index)
     ? g_hash_table_fetch_key_or_value (hash_table->values, node_index, hash_table->have_big_values)
     : NULL;
 }
@@ -1549,7 +1937,7 @@ g_hash_table_lookup_extended (GHashTable    *hash_table,
 
   node_index = g_hash_table_lookup_node (hash_table, lookup_key, &node_hash);
 
-  if (!HASH_IS_REAL (hash_table->hashes[node_index]))
+  if (!g_hash_table_node_is_real (hash_table, node_index))
     {
       if (orig_key != NULL)
         *orig_key = NULL;
@@ -1713,7 +2101,7 @@ g_hash_table_contains (GHashTable    *hash_table,
 
   node_index = g_hash_table_lookup_node (hash_table, key, &node_hash);
 
-  return HASH_IS_REAL (hash_table->hashes[node_index]);
+  return g_hash_table_node_is_real (hash_table, node_index);
 }
 
 /*
@@ -1741,7 +2129,7 @@ g_hash_table_remove_internal (GHashTable    *hash_table,
 
   node_index = g_hash_table_lookup_node (hash_table, key, &node_hash);
 
-  if (!HASH_IS_REAL (hash_table->hashes[node_index]))
+  if (!g_hash_table_node_is_real (hash_table, node_index))
     return FALSE;
 
   g_hash_table_remove_node (hash_table, node_index, notify);
@@ -1828,7 +2216,7 @@ g_hash_table_steal_extended (GHashTable    *hash_table,
 
   node_index = g_hash_table_lookup_node (hash_table, lookup_key, &node_hash);
 
-  if (!HASH_IS_REAL (hash_table->hashes[node_index]))
+  if (!g_hash_table_node_is_real (hash_table, node_index))
     {
       if (stolen_key != NULL)
         *stolen_key = NULL;
@@ -2322,7 +2710,8 @@ g_str_equal (gconstpointer v1,
  *
  * Note that this function may not be a perfect fit for all use cases.
  * For example, it produces some hash collisions with strings as short
- * as 2.
+ * as 2. Use g_str_hash_seeded() for keys that come from an untrusted
+ * source.
  *
  * Returns: a hash value corresponding to the key
  */
@@ -2338,6 +2727,167 @@ g_str_hash (gconstpointer v)
   return h;
 }
 
+/* The string hash below follows the construction of wyhash by Wang Yi:
+ * the key is read eight bytes at a time and folded into the state with
+ * 64×64→128-bit multiplications, mixed with a random per-process seed.
+ * As in its ‘condom’ variant, the product is XORed back into the inputs,
+ * so that input words which cancel the secrets (and make the product
+ * zero) cannot erase the seed from the state.
+ */
+static const guint64 str_hash_secret[] =
+{
+  G_GUINT64_CONSTANT (0xa0761d6478bd642f),
+  G_GUINT64_CONSTANT (0xe7037ed1a0b428db),
+};
+
+static guint64 str_hash_seed;
+
+/* Multiplies @a and @b, and XORs the halves of the 128-bit result into
+ * them */
+static inline void
+str_hash_mum (guint64 *a,
+              guint64 *b)
+{
+#ifdef HAVE_UINT128_T
+  __uint128_t r = (__uint128_t) *a * *b;
+
+  *a ^= (guint64) r;
+  *b ^= (guint64) (r >> 64);
+#else
+  guint64 ha = *a >> 32, hb = *b >> 32;
+  guint64 la = (guint32) *a, lb = (guint32) *b;
+  guint64 rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+  guint64 t = rl + (rm0 << 32);
+  guint64 carry = t < rl;
+  guint64 lo = t + (rm1 << 32);
+
+  carry += lo < t;
+  *a ^= lo;
+  *b ^= rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+}
+
+static inline guint64
+str_hash_mix (guint64 a,
+              guint64 b)
+{
+  str_hash_mum (&a, &b);
+  return a ^ b;
+}
+
+static inline guint64
+str_hash_read64 (const guchar *p)
+{
+  guint64 v;
+
+  memcpy (&v, p, sizeof (v));
+  return v;
+}
+
+static inline guint64
+str_hash_read32 (const guchar *p)
+{
+  guint32 v;
+
+  memcpy (&v, p, sizeof (v));
+  return v;
+}
+
+static guint64
+str_hash_get_seed (void)
+{
+  static gsize initialised = 0;
+
+  if (g_once_init_enter (&initialised))
+    {
+      GRand *rand = g_rand_new ();
+
+      str_hash_seed = ((guint64) g_rand_int (rand) << 32) | g_rand_int (rand);
+      str_hash_seed ^= str_hash_mix (str_hash_seed ^ str_hash_secret[0], str_hash_secret[1]);
+      g_rand_free (rand);
+
+      g_once_init_leave (&initialised, 1);
+    }
+
+  return str_hash_seed;
+}
+
+/**
+ * g_str_hash_seeded:
+ * @v: (not nullable): a string key
+ *
+ * Converts a string to a hash value, like g_str_hash(), but with a hash
+ * function that mixes in a random value picked once per process.
+ *
+ * This makes it impractical to choose keys which collide in a
+ * #GHashTable, so it should be used for tables whose keys come from an
+ * untrusted source, such as the network or another process. It is also
+ * faster than g_str_hash() on keys longer than a few bytes, and spreads
+ * similar keys better.
+ *
+ * Since hash values differ between processes, they must not be stored
+ * or sent anywhere.
+ *
+ * It can be passed to g_hash_table_new() as the @hash_func parameter,
+ * when using non-%NULL strings as keys in a #GHashTable. See also
+ * %G_HASH_TABLE_FLAGS_SEEDED_STR_HASH.
+ *
+ * Returns: a hash value corresponding to the key
+ *
+ * Since: 2.68
+ */
+guint
+g_str_hash_seeded (gconstpointer v)
+{
+  const guchar *p = v;
+  gsize len = strlen (v);
+  guint64 seed = str_hash_get_seed ();
+  guint64 a, b, h;
+
+  if (G_LIKELY (len <= 16))
+    {
+      if (len >= 4)
+        {
+          gsize middle = (len >> 3) << 2;
+
+          a = (str_hash_read32 (p) << 32) | str_hash_read32 (p + middle);
+          b = (str_hash_read32 (p + len - 4) << 32) | str_hash_read32 (p + len - 4 - middle);
+        }
+      else if (len > 0)
+        {
+          a = ((guint64) p[0] << 16) | ((guint64) p[len >> 1] << 8) | p[len - 1];
+          b = 0;
+        }
+      else
+        {
+          a = b = 0;
+        }
+    }
+  else
+    {
+      gsize i = len;
+
+      while (i > 16)
+        {
+          seed = str_hash_mix (str_hash_read64 (p) ^ str_hash_secret[1],
+                               str_hash_read64 (p + 8) ^ seed);
+          p += 16;
+          i -= 16;
+        }
+
+      /* The last 16 bytes, overlapping with the ones before if needed */
+      a = str_hash_read64 (p + i - 16);
+      b = str_hash_read64 (p + i - 8);
+    }
+
+  a ^= str_hash_secret[1];
+  b ^= seed;
+  str_hash_mum (&a, &b);
+  h = str_hash_mix (a ^ str_hash_secret[0] ^ len, b ^ str_hash_secret[1]);
+
+  return (guint) (h ^ (h >> 32));
+}
+
 /**
  * g_direct_hash:
  * @v: (nullable): a #gpointer key
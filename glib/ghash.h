@@ -42,6 +42,30 @@ typedef gboolean  (*GHRFunc)  (gpointer  key,
 
 typedef struct _GHashTableIter GHashTableIter;
 
+/**
+ * GHashTableFlags:
+ * @G_HASH_TABLE_FLAGS_NONE: Default behaviour.
+ * @G_HASH_TABLE_FLAGS_SEEDED_STR_HASH: Hash keys with g_str_hash_seeded()
+ *     where the table was given g_str_hash() as its hash function, so that
+ *     string keys from an untrusted source can't be picked to collide.
+ * @G_HASH_TABLE_FLAGS_GROUP_PROBING: Keep a control byte for each bucket
+ *     and probe the buckets a group at a time, which mostly makes looking
+ *     up keys which aren't in the table cheaper, for one more byte per
+ *     bucket.
+ *
+ * Flags to pass to g_hash_table_new_with_flags() which affect the
+ * behaviour of a #GHashTable.
+ *
+ * Since: 2.68
+ */
+GLIB_AVAILABLE_TYPE_IN_2_68
+typedef enum
+{
+  G_HASH_TABLE_FLAGS_NONE = 0,
+  G_HASH_TABLE_FLAGS_SEEDED_STR_HASH = 1 << 0,
+  G_HASH_TABLE_FLAGS_GROUP_PROBING   = 1 << 1
+} GHashTableFlags;
+
 struct _GHashTableIter
 {
   /*< private >*/
@@ -61,6 +85,14 @@ GHashTable* g_hash_table_new_full          (GHashFunc       hash_func,
                                             GEqualFunc      key_equal_func,
                                             GDestroyNotify  key_destroy_func,
                                             GDestroyNotify  value_destroy_func);
+G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+GLIB_AVAILABLE_IN_2_68
+GHashTable* g_hash_table_new_with_flags    (GHashFunc       hash_func,
+                                            GEqualFunc      key_equal_func,
+                                            GDestroyNotify  key_destroy_func,
+                                            GDestroyNotify  value_destroy_func,
+                                            GHashTableFlags flags);
+G_GNUC_END_IGNORE_DEPRECATIONS
 GLIB_AVAILABLE_IN_ALL
 void        g_hash_table_destroy           (GHashTable     *hash_table);
 GLIB_AVAILABLE_IN_ALL
@@ -158,6 +190,8 @@ gboolean g_str_equal    (gconstpointer  v1,
                          gconstpointer  v2);
 GLIB_AVAILABLE_IN_ALL
 guint    g_str_hash     (gconstpointer  v);
+GLIB_AVAILABLE_IN_2_68
+guint    g_str_hash_seeded (gconstpointer  v);
 
 GLIB_AVAILABLE_IN_ALL
 gboolean g_int_equal    (gconstpointer  v1,
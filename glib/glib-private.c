@@ -21,6 +21,7 @@
 
 #include "glib-private.h"
 #include "glib-init.h"
+#include "gvariant-core.h"
 
 /**
  * glib__private__:
@@ -55,6 +56,8 @@ glib__private__ (void)
     g_win32_readlink_utf8,
     g_win32_fstat,
 #endif
+
+    g_variant_is_serialised,
   };
 
   return &table;
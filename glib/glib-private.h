@@ -77,6 +77,8 @@ typedef struct {
                                                          GWin32PrivateStat  *buf);
 #endif
 
+  /* See gvariant-core.c */
+  gboolean              (* g_variant_is_serialised)     (GVariant *value);
 
   /* Add other private functions here, initialize them in glib-private.c */
 } GLibPrivateVTable;
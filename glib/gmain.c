@@ -52,6 +52,9 @@
 #ifdef HAVE_EVENTFD
 #include <sys/eventfd.h>
 #endif
+#ifdef HAVE_EPOLL
+#include <sys/epoll.h>
+#endif
 #endif
 
 #include <signal.h>
@@ -224,6 +227,7 @@ typedef struct _GTimeoutSource GTimeoutSource;
 typedef struct _GChildWatchSource GChildWatchSource;
 typedef struct _GUnixSignalWatchSource GUnixSignalWatchSource;
 typedef struct _GPollRec GPollRec;
+typedef struct _GEPollFd GEPollFd;
 typedef struct _GSourceCallback GSourceCallback;
 
 typedef enum
@@ -239,6 +243,41 @@ struct _GSourceList
 {
   GSource *head, *tail;
   gint priority;
+  GQueue active;        /* sources that need prepare(), check() or fds */
+  GQueue ready;         /* sources flagged with G_SOURCE_READY */
+};
+
+/* Latencies are counted in buckets of powers of two microseconds; the
+ * last bucket takes everything from about four seconds on.
+ */
+#define N_LATENCY_BUCKETS 24
+
+typedef struct _GSourceStats GSourceStats;
+
+struct _GSourceStats
+{
+  guint64 n_dispatches;
+  guint64 dispatch_time;
+  guint64 max_dispatch_time;
+  guint64 latency[N_LATENCY_BUCKETS];
+};
+
+typedef struct _GMainContextStats GMainContextStats;
+
+/* All times are in microseconds */
+struct _GMainContextStats
+{
+  GHashTable *sources;          /* source name -> GSourceStats */
+  guint64 n_polls;
+  guint64 poll_time;
+  gint64 wakeup_time;           /* when the context last woke up, or 0 */
+  gboolean polled;              /* wakeup_time was set by a poll */
+
+  /* Timer wakeups that slack allowed to merge into one */
+  guint64 saved_wakeups;
+  gint64 batch_deadline;        /* the merged wakeup to come, or 0 */
+  guint64 batch_saved_wakeups;
+  GArray *batch_ready_times;    /* scratch space, of gint64 */
 };
 
 typedef struct _GMainWaiter GMainWaiter;
@@ -283,6 +322,14 @@ struct _GMainContext
   GList *source_lists;
   gint in_check_or_prepare;
 
+  /* Sources with a ready time, as a binary min-heap on ready_time. This
+   * is what makes timeouts cheap: unlike the sources in the active lists
+   * they are never visited until they expire.
+   */
+  GPtrArray *timer_heap;
+  guint64 next_source_order;
+  GPtrArray *active_sources;    /* scratch space for prepare and check */
+
   GPollRec *poll_records;
   guint n_poll_records;
   GPollFD *cached_poll_array;
@@ -299,6 +346,23 @@ struct _GMainContext
 
   gint64   time;
   gboolean time_is_fresh;
+
+  GMainContextStats *stats;     /* NULL unless statistics are enabled */
+
+#ifdef HAVE_EPOLL
+  /* Only used if the context was created with G_MAIN_CONTEXT_FLAGS_EPOLL,
+   * epoll_fd is -1 otherwise. The poll records above are still kept up to
+   * date, so that g_main_context_query() and g_main_context_check() keep
+   * working for people integrating the context with other main loops.
+   */
+  gint epoll_fd;
+  GHashTable *epoll_fds;                /* gint fd -> GEPollFd */
+  GSList *epoll_unpollable;             /* GEPollFd with unpollable set */
+  GSList *untracked_poll_records;       /* GPollRec with tracked unset */
+  struct epoll_event *epoll_events;
+  gint epoll_events_size;
+  GArray *epoll_ready_fds;              /* fds given revents last iteration */
+#endif
 };
 
 struct _GSourceCallback
@@ -349,6 +413,28 @@ struct _GPollRec
   GPollRec *prev;
   GPollRec *next;
   gint priority;
+  /* Whether every change to fd->events goes through the context, as is
+   * the case for g_source_add_unix_fd(). The GPollFDs passed to
+   * g_source_add_poll() belong to the caller and may change at any time.
+   */
+  gboolean tracked;
+};
+
+/* A file descriptor registered with the epoll instance of a context. All
+ * the GPollRecs for the same fd are consecutive in context->poll_records,
+ * starting at @first.
+ */
+struct _GEPollFd
+{
+  gint fd;
+  GPollRec *first;
+  guint n_records;
+  guint32 events;               /* as last registered with the kernel */
+  gboolean registered;
+  /* epoll refuses regular files and invalid fds, which poll() reports as
+   * ready straight away; those get polled separately with a zero timeout.
+   */
+  gboolean unpollable;
 };
 
 struct _GSourcePrivate
@@ -357,6 +443,7 @@ struct _GSourcePrivate
   GSource *parent_source;
 
   gint64 ready_time;
+  gint64 slack;
 
   /* This is currently only used on UNIX, but we always declare it (and
    * let it remain empty on Windows) to avoid #ifdef all over the place.
@@ -364,6 +451,13 @@ struct _GSourcePrivate
   GSList *fds;
 
   GSourceDisposeFunc dispose;
+
+  /* The following are protected by the context's lock */
+  GSourceList *source_list;     /* NULL if not in the context's lists */
+  GList active_link;            /* in source_list->active, if data is set */
+  GList ready_link;             /* in source_list->ready, if data is set */
+  gint heap_index;              /* in context->timer_heap, or -1 */
+  guint64 order;                /* position within source_list */
 };
 
 typedef struct _GSourceIter
@@ -402,9 +496,24 @@ static void g_main_context_poll                 (GMainContext *context,
 						 gint          n_fds);
 static void g_main_context_add_poll_unlocked    (GMainContext *context,
 						 gint          priority,
-						 GPollFD      *fd);
+						 GPollFD      *fd,
+						 gboolean      tracked);
 static void g_main_context_remove_poll_unlocked (GMainContext *context,
 						 GPollFD      *fd);
+#ifdef HAVE_EPOLL
+static void epoll_fd_update_unlocked            (GMainContext *context,
+                                                 GEPollFd     *epoll_fd,
+                                                 gboolean      force);
+static void g_main_context_epoll_wait           (GMainContext *context,
+                                                 gboolean      block,
+                                                 gint          max_priority);
+#endif
+static void g_main_context_stats_free           (GMainContextStats *stats);
+static void g_main_context_stats_poll_unlocked  (GMainContext      *context,
+                                                 gint64             start_time);
+static void g_main_context_stats_dispatch_unlocked (GMainContext   *context,
+                                                    GSource        *source,
+                                                    gint64          start_time);
 
 static void     g_source_iter_init  (GSourceIter   *iter,
 				     GMainContext  *context,
@@ -613,7 +722,22 @@ g_main_context_unref (GMainContext *context)
   g_mutex_clear (&context->mutex);
 
   g_ptr_array_free (context->pending_dispatches, TRUE);
+  g_ptr_array_free (context->timer_heap, TRUE);
+  g_ptr_array_free (context->active_sources, TRUE);
   g_free (context->cached_poll_array);
+  g_main_context_stats_free (context->stats);
+
+#ifdef HAVE_EPOLL
+  if (context->epoll_fd >= 0)
+    {
+      close (context->epoll_fd);
+      g_hash_table_destroy (context->epoll_fds);
+      g_slist_free (context->epoll_unpollable);
+      g_slist_free (context->untracked_poll_records);
+      g_free (context->epoll_events);
+      g_array_unref (context->epoll_ready_fds);
+    }
+#endif
 
   poll_rec_list_free (context, context->poll_records);
 
@@ -656,6 +780,41 @@ g_main_context_new_with_next_id (guint next_id)
  **/
 GMainContext *
 g_main_context_new (void)
+{
+  return g_main_context_new_with_flags (G_MAIN_CONTEXT_FLAGS_NONE);
+}
+
+#ifdef HAVE_EPOLL
+static void
+epoll_fd_free (gpointer data)
+{
+  g_slice_free (GEPollFd, data);
+}
+#endif
+
+/**
+ * g_main_context_new_with_flags:
+ * @flags: a bitwise-OR combination of #GMainContextFlags flags that can only be
+ *         set at creation time.
+ *
+ * Creates a new #GMainContext structure.
+ *
+ * With %G_MAIN_CONTEXT_FLAGS_EPOLL, the file descriptors of the sources
+ * attached to the context are registered with the kernel as they are
+ * added, modified and removed, so that an iteration only has to look at
+ * the ones which are ready. This only pays off for contexts watching
+ * many file descriptors, which should be added with
+ * g_source_add_unix_fd(): descriptors added with g_source_add_poll()
+ * still need to be checked for changes on every iteration. As with
+ * epoll itself, a file descriptor must be removed from its source
+ * before it is closed.
+ *
+ * Returns: (transfer full): the new #GMainContext
+ *
+ * Since: 2.68
+ */
+GMainContext *
+g_main_context_new_with_flags (GMainContextFlags flags)
 {
   static gsize initialised;
   GMainContext *context;
@@ -693,12 +852,34 @@ g_main_context_new (void)
   context->cached_poll_array_size = 0;
   
   context->pending_dispatches = g_ptr_array_new ();
+
+  context->timer_heap = g_ptr_array_new ();
+  context->active_sources = g_ptr_array_new ();
   
   context->time_is_fresh = FALSE;
   
+#ifdef HAVE_EPOLL
+  context->epoll_fd = -1;
+
+  if (flags & G_MAIN_CONTEXT_FLAGS_EPOLL)
+    {
+      context->epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+
+      if (context->epoll_fd >= 0)
+        {
+          context->epoll_fds = g_hash_table_new_full (NULL, NULL, NULL, epoll_fd_free);
+          context->epoll_events_size = 64;
+          context->epoll_events = g_new (struct epoll_event, context->epoll_events_size);
+          context->epoll_ready_fds = g_array_new (FALSE, FALSE, sizeof (gint));
+        }
+      else
+        g_warning ("epoll_create1(2) failed due to: %s.", g_strerror (errno));
+    }
+#endif
+
   context->wakeup = g_wakeup_new ();
   g_wakeup_get_pollfd (context->wakeup, &context->wake_up_rec);
-  g_main_context_add_poll_unlocked (context, 0, &context->wake_up_rec);
+  g_main_context_add_poll_unlocked (context, 0, &context->wake_up_rec, TRUE);
 
   G_LOCK (main_context_list);
   main_context_list = g_slist_append (main_context_list, context);
@@ -965,6 +1146,7 @@ g_source_new (GSourceFuncs *source_funcs,
   source->flags = G_HOOK_FLAG_ACTIVE;
 
   source->priv->ready_time = -1;
+  source->priv->heap_index = -1;
 
   /* NULL/0 initialization for all other fields */
 
@@ -1131,182 +1313,697 @@ find_source_list_for_priority (GMainContext *context,
   return source_list;
 }
 
-/* Holds context's lock
+/* Holds context's lock. Unlike walking context->source_lists, this is
+ * safe to use after the lock was dropped, as the list that was visited
+ * before may have been freed since.
  */
+static GSourceList *
+find_next_source_list (GMainContext *context,
+                       gboolean      first,
+                       gint          priority)
+{
+  GList *iter;
+
+  for (iter = context->source_lists; iter != NULL; iter = iter->next)
+    {
+      GSourceList *source_list = iter->data;
+
+      if (first || source_list->priority > priority)
+        return source_list;
+    }
+
+  return NULL;
+}
+
 static void
-source_add_to_context (GSource      *source,
-		       GMainContext *context)
+timer_heap_set (GPtrArray *heap,
+                guint      index,
+                GSource   *source)
 {
-  GSourceList *source_list;
-  GSource *prev, *next;
+  heap->pdata[index] = source;
+  source->priv->heap_index = index;
+}
 
-  source_list = find_source_list_for_priority (context, source->priority, TRUE);
+static void
+timer_heap_sift_up (GPtrArray *heap,
+                    guint      index)
+{
+  GSource *source = heap->pdata[index];
 
-  if (source->priv->parent_source)
+  while (index > 0)
     {
-      g_assert (source_list->head != NULL);
+      guint parent_index = (index - 1) / 2;
+      GSource *parent = heap->pdata[parent_index];
 
-      /* Put the source immediately before its parent */
-      prev = source->priv->parent_source->prev;
-      next = source->priv->parent_source;
+      if (parent->priv->ready_time <= source->priv->ready_time)
+        break;
+
+      timer_heap_set (heap, index, parent);
+      index = parent_index;
     }
-  else
+
+  timer_heap_set (heap, index, source);
+}
+
+static void
+timer_heap_sift_down (GPtrArray *heap,
+                      guint      index)
+{
+  GSource *source = heap->pdata[index];
+
+  while (2 * index + 1 < heap->len)
     {
-      prev = source_list->tail;
-      next = NULL;
+      guint child_index = 2 * index + 1;
+      GSource *child = heap->pdata[child_index];
+
+      if (child_index + 1 < heap->len)
+        {
+          GSource *sibling = heap->pdata[child_index + 1];
+
+          if (sibling->priv->ready_time < child->priv->ready_time)
+            {
+              child_index++;
+              child = sibling;
+            }
+        }
+
+      if (source->priv->ready_time <= child->priv->ready_time)
+        break;
+
+      timer_heap_set (heap, index, child);
+      index = child_index;
     }
 
-  source->next = next;
-  if (next)
-    next->prev = source;
-  else
-    source_list->tail = source;
-  
-  source->prev = prev;
-  if (prev)
-    prev->next = source;
-  else
-    source_list->head = source;
+  timer_heap_set (heap, index, source);
 }
 
 /* Holds context's lock
+ *
+ * Puts @source into the timer heap, takes it out or moves it around,
+ * according to its current ready time and state. Needs to be called
+ * whenever any of those change.
  */
 static void
-source_remove_from_context (GSource      *source,
-			    GMainContext *context)
+source_update_timer (GMainContext *context,
+                     GSource      *source)
 {
-  GSourceList *source_list;
+  GPtrArray *heap = context->timer_heap;
+  gint index = source->priv->heap_index;
+  gboolean want;
 
-  source_list = find_source_list_for_priority (context, source->priority, FALSE);
-  g_return_if_fail (source_list != NULL);
+  want = source->priv->source_list != NULL &&
+         source->priv->ready_time != -1 &&
+         !SOURCE_DESTROYED (source) &&
+         !SOURCE_BLOCKED (source);
 
-  if (source->prev)
-    source->prev->next = source->next;
-  else
-    source_list->head = source->next;
+  if (index < 0)
+    {
+      if (want)
+        {
+          g_ptr_array_add (heap, source);
+          timer_heap_sift_up (heap, heap->len - 1);
+        }
+    }
+  else if (!want)
+    {
+      source->priv->heap_index = -1;
+      g_ptr_array_remove_index_fast (heap, index);
 
-  if (source->next)
-    source->next->prev = source->prev;
+      if ((guint) index < heap->len)
+        {
+          timer_heap_sift_up (heap, index);
+          timer_heap_sift_down (heap, ((GSource *) heap->pdata[index])->priv->heap_index);
+        }
+    }
   else
-    source_list->tail = source->prev;
-
-  source->prev = NULL;
-  source->next = NULL;
-
-  if (source_list->head == NULL)
     {
-      context->source_lists = g_list_remove (context->source_lists, source_list);
-      g_slice_free (GSourceList, source_list);
+      timer_heap_sift_up (heap, index);
+      timer_heap_sift_down (heap, source->priv->heap_index);
     }
 }
 
-static guint
-g_source_attach_unlocked (GSource      *source,
-                          GMainContext *context,
-                          gboolean      do_wakeup)
+/* Holds context's lock
+ *
+ * Sources that have neither prepare() nor check() nor any unix fds can
+ * only become ready through their ready time, so they are left to the
+ * timer heap and never walked.
+ */
+static void
+source_update_active (GSource *source)
 {
-  GSList *tmp_list;
-  guint id;
+  GSourcePrivate *priv = source->priv;
+  gboolean active;
 
-  /* The counter may have wrapped, so we must ensure that we do not
-   * reuse the source id of an existing source.
-   */
-  do
-    id = context->next_id++;
-  while (id == 0 || g_hash_table_contains (context->sources, GUINT_TO_POINTER (id)));
+  active = priv->source_list != NULL &&
+           !SOURCE_DESTROYED (source) &&
+           (source->source_funcs->prepare != NULL ||
+            source->source_funcs->check != NULL ||
+            priv->fds != NULL);
 
-  source->context = context;
-  source->source_id = id;
-  g_source_ref (source);
+  if (active == (priv->active_link.data != NULL))
+    return;
 
-  g_hash_table_insert (context->sources, GUINT_TO_POINTER (id), source);
+  if (active)
+    {
+      GSource *parent = priv->parent_source;
 
-  source_add_to_context (source, context);
+      priv->active_link.data = source;
 
-  if (!SOURCE_BLOCKED (source))
+      /* Keep children in front of their parent, as in the source list */
+      if (parent != NULL &&
+          parent->priv->active_link.data != NULL &&
+          parent->priv->source_list == priv->source_list)
+        g_queue_insert_before_link (&priv->source_list->active,
+                                    &parent->priv->active_link,
+                                    &priv->active_link);
+      else
+        g_queue_push_tail_link (&priv->source_list->active, &priv->active_link);
+    }
+  else
     {
-      tmp_list = source->poll_fds;
-      while (tmp_list)
-        {
-          g_main_context_add_poll_unlocked (context, source->priority, tmp_list->data);
-          tmp_list = tmp_list->next;
-        }
-
-      for (tmp_list = source->priv->fds; tmp_list; tmp_list = tmp_list->next)
-        g_main_context_add_poll_unlocked (context, source->priority, tmp_list->data);
+      g_queue_unlink (&priv->source_list->active, &priv->active_link);
+      priv->active_link.data = NULL;
     }
+}
 
-  tmp_list = source->priv->child_sources;
-  while (tmp_list)
+/* Holds context's lock */
+static void
+source_mark_ready (GSource *source)
+{
+  GSource *ready_source;
+
+  for (ready_source = source; ready_source; ready_source = ready_source->priv->parent_source)
     {
-      g_source_attach_unlocked (tmp_list->data, context, FALSE);
-      tmp_list = tmp_list->next;
+      GSourcePrivate *priv = ready_source->priv;
+
+      ready_source->flags |= G_SOURCE_READY;
+
+      if (priv->ready_link.data == NULL &&
+          priv->source_list != NULL &&
+          !SOURCE_DESTROYED (ready_source))
+        {
+          priv->ready_link.data = ready_source;
+          g_queue_push_tail_link (&priv->source_list->ready, &priv->ready_link);
+        }
     }
+}
 
-  /* If another thread has acquired the context, wake it up since it
-   * might be in poll() right now.
-   */
-  if (do_wakeup && context->owner && context->owner != G_THREAD_SELF)
-    g_wakeup_signal (context->wakeup);
+/* Holds context's lock */
+static void
+source_unlink_ready (GSource *source)
+{
+  GSourcePrivate *priv = source->priv;
 
-  g_trace_mark (G_TRACE_CURRENT_TIME, 0,
-                "GLib", "g_source_attach",
-                "%s to context %p",
-                (g_source_get_name (source) != NULL) ? g_source_get_name (source) : "(unnamed)",
-                context);
+  if (priv->ready_link.data != NULL)
+    {
+      g_queue_unlink (&priv->source_list->ready, &priv->ready_link);
+      priv->ready_link.data = NULL;
+    }
+}
 
-  return source->source_id;
+/* Holds context's lock */
+static void
+source_clear_ready (GSource *source)
+{
+  source->flags &= ~G_SOURCE_READY;
+  source_unlink_ready (source);
 }
 
-/**
- * g_source_attach:
- * @source: a #GSource
- * @context: (nullable): a #GMainContext (if %NULL, the default context will be used)
- * 
- * Adds a #GSource to a @context so that it will be executed within
- * that context. Remove it by calling g_source_destroy().
- *
- * This function is safe to call from any thread, regardless of which thread
- * the @context is running in.
+/* Holds context's lock
  *
- * Returns: the ID (greater than 0) for the source within the 
- *   #GMainContext. 
- **/
-guint
-g_source_attach (GSource      *source,
-		 GMainContext *context)
+ * Flags all the sources in the timer heap whose ready time is not
+ * after context->time as ready, visiting only those.
+ */
+static void
+timer_heap_mark_expired (GMainContext *context,
+                         guint         index)
 {
-  guint result = 0;
+  GSource *source;
 
-  g_return_val_if_fail (source != NULL, 0);
-  g_return_val_if_fail (g_atomic_int_get (&source->ref_count) > 0, 0);
-  g_return_val_if_fail (source->context == NULL, 0);
-  g_return_val_if_fail (!SOURCE_DESTROYED (source), 0);
-  
-  if (!context)
-    context = g_main_context_default ();
+  if (index >= context->timer_heap->len)
+    return;
 
-  LOCK_CONTEXT (context);
+  source = context->timer_heap->pdata[index];
+  if (source->priv->ready_time > context->time)
+    return;
 
-  result = g_source_attach_unlocked (source, context, TRUE);
+  if (!(source->flags & G_SOURCE_READY))
+    source_mark_ready (source);
 
-  TRACE (GLIB_MAIN_SOURCE_ATTACH (g_source_get_name (source), source, context,
-                                  result));
+  timer_heap_mark_expired (context, 2 * index + 1);
+  timer_heap_mark_expired (context, 2 * index + 2);
+}
 
-  UNLOCK_CONTEXT (context);
+static gint64
+source_get_deadline (GSource *source)
+{
+  GSourcePrivate *priv = source->priv;
 
-  return result;
+  if (priv->ready_time > G_MAXINT64 - priv->slack)
+    return G_MAXINT64;
+
+  return priv->ready_time + priv->slack;
 }
 
-static void
-g_source_destroy_internal (GSource      *source,
-			   GMainContext *context,
-			   gboolean      have_lock)
+/* Holds context's lock
+ *
+ * Returns the latest time the context can wake up without dispatching
+ * any source after its ready time plus slack. Only the sources which
+ * become ready before that are visited; without any slack, that is
+ * just the first one.
+ */
+static gint64
+timer_heap_get_deadline (GPtrArray *heap,
+                         guint      index,
+                         gint64     deadline)
 {
-  TRACE (GLIB_MAIN_SOURCE_DESTROY (g_source_get_name (source), source,
-                                   context));
+  GSource *source;
 
-  if (!have_lock)
+  if (index >= heap->len)
+    return deadline;
+
+  source = heap->pdata[index];
+  if (source->priv->ready_time >= deadline)
+    return deadline;
+
+  deadline = MIN (deadline, source_get_deadline (source));
+  deadline = timer_heap_get_deadline (heap, 2 * index + 1, deadline);
+  deadline = timer_heap_get_deadline (heap, 2 * index + 2, deadline);
+
+  return deadline;
+}
+
+static void
+timer_heap_get_ready_times (GPtrArray *heap,
+                            guint      index,
+                            gint64     deadline,
+                            GArray    *ready_times)
+{
+  GSource *source;
+
+  if (index >= heap->len)
+    return;
+
+  source = heap->pdata[index];
+  if (source->priv->ready_time > deadline)
+    return;
+
+  g_array_append_val (ready_times, source->priv->ready_time);
+  timer_heap_get_ready_times (heap, 2 * index + 1, deadline, ready_times);
+  timer_heap_get_ready_times (heap, 2 * index + 2, deadline, ready_times);
+}
+
+static gint
+compare_ready_times (gconstpointer a,
+                     gconstpointer b)
+{
+  gint64 ready_time_a = *(const gint64 *) a;
+  gint64 ready_time_b = *(const gint64 *) b;
+
+  return ready_time_a < ready_time_b ? -1 : ready_time_a > ready_time_b;
+}
+
+/* Holds context's lock
+ *
+ * Works out how many wakeups the sources becoming ready until @deadline
+ * would have taken without their slack. Polls have a resolution of a
+ * millisecond, so sources becoming ready within a millisecond of the
+ * one that caused a wakeup would have shared it anyway.
+ */
+static guint64
+timer_heap_count_wakeups (GMainContext *context,
+                          gint64        deadline)
+{
+  GArray *ready_times = context->stats->batch_ready_times;
+  gint64 wakeup_time = 0;
+  guint64 n_wakeups = 0;
+  guint i;
+
+  g_array_set_size (ready_times, 0);
+  timer_heap_get_ready_times (context->timer_heap, 0, deadline, ready_times);
+  g_array_sort (ready_times, compare_ready_times);
+
+  for (i = 0; i < ready_times->len; i++)
+    {
+      gint64 ready_time = g_array_index (ready_times, gint64, i);
+
+      if (n_wakeups == 0 || ready_time > wakeup_time)
+        {
+          n_wakeups++;
+          wakeup_time = ready_time + 1000;
+        }
+    }
+
+  return n_wakeups;
+}
+
+/* Holds context's lock
+ *
+ * Flags the sources whose ready time has passed as ready. If @timeout
+ * is not %NULL, it is set to the time in milliseconds until the next
+ * wakeup needed for the other sources, or -1 if there are none.
+ */
+static void
+timer_heap_expire (GMainContext *context,
+                   gint         *timeout)
+{
+  GPtrArray *heap = context->timer_heap;
+  GMainContextStats *stats = context->stats;
+  GSource *first;
+  gint64 deadline;
+
+  if (timeout)
+    *timeout = -1;
+
+  if (heap->len == 0)
+    return;
+
+  if (!context->time_is_fresh)
+    {
+      context->time = g_get_monotonic_time ();
+      context->time_is_fresh = TRUE;
+    }
+
+  timer_heap_mark_expired (context, 0);
+
+  if (stats != NULL && stats->batch_deadline != 0 &&
+      stats->batch_deadline <= context->time)
+    {
+      stats->saved_wakeups += stats->batch_saved_wakeups;
+      stats->batch_deadline = 0;
+    }
+
+  first = heap->pdata[0];
+  if (timeout == NULL || first->priv->ready_time <= context->time)
+    return;
+
+  deadline = timer_heap_get_deadline (heap, 0, source_get_deadline (first));
+
+  if (stats != NULL)
+    {
+      stats->batch_deadline = 0;
+
+      if (deadline > first->priv->ready_time)
+        {
+          guint64 n_wakeups = timer_heap_count_wakeups (context, deadline);
+
+          if (n_wakeups > 1)
+            {
+              stats->batch_deadline = deadline;
+              stats->batch_saved_wakeups = n_wakeups - 1;
+            }
+        }
+    }
+
+  /* rounding down will lead to spinning, so always round up */
+  *timeout = MIN ((deadline - context->time + 999) / 1000, G_MAXINT);
+}
+
+/* Holds context's lock
+ *
+ * Counts the sources in @source_list that can be dispatched, adding a
+ * reference to each of them to @pending if that is not %NULL.
+ */
+static guint
+source_list_collect_ready (GSourceList *source_list,
+                           GPtrArray   *pending)
+{
+  GList *link;
+  guint n_ready = 0;
+
+  for (link = source_list->ready.head; link != NULL; link = link->next)
+    {
+      GSource *source = link->data;
+
+      if (SOURCE_DESTROYED (source) || SOURCE_BLOCKED (source))
+        continue;
+
+      if (pending)
+        g_ptr_array_add (pending, g_source_ref (source));
+      n_ready++;
+    }
+
+  return n_ready;
+}
+
+/* Holds context's lock. Takes a reference on each of the sources to
+ * walk, as their prepare() and check() are called without the lock.
+ */
+static void
+source_list_get_active (GMainContext *context,
+                        GSourceList  *source_list)
+{
+  GList *link;
+
+  g_ptr_array_set_size (context->active_sources, 0);
+
+  for (link = source_list->active.head; link != NULL; link = link->next)
+    g_ptr_array_add (context->active_sources, g_source_ref (link->data));
+}
+
+static guint
+source_get_depth (GSource *source)
+{
+  guint depth = 0;
+
+  while ((source = source->priv->parent_source) != NULL)
+    depth++;
+
+  return depth;
+}
+
+/* Sorts sources the way they are linked in their source list: in the
+ * order they were added, but with child sources in front of their
+ * parent. This is the order in which ready sources get dispatched.
+ */
+static gint
+source_compare_position (gconstpointer a,
+                         gconstpointer b)
+{
+  GSource *source_a = *(GSource **) a;
+  GSource *source_b = *(GSource **) b;
+  guint depth_a = source_get_depth (source_a);
+  guint depth_b = source_get_depth (source_b);
+  gint descendant_first = 0;
+
+  for (; depth_a > depth_b; depth_a--)
+    {
+      source_a = source_a->priv->parent_source;
+      descendant_first = -1;
+    }
+
+  for (; depth_b > depth_a; depth_b--)
+    {
+      source_b = source_b->priv->parent_source;
+      descendant_first = 1;
+    }
+
+  if (source_a == source_b)
+    return descendant_first;
+
+  while (source_a->priv->parent_source != source_b->priv->parent_source)
+    {
+      source_a = source_a->priv->parent_source;
+      source_b = source_b->priv->parent_source;
+    }
+
+  return source_a->priv->order < source_b->priv->order ? -1 : 1;
+}
+
+/* Holds context's lock
+ */
+static void
+source_add_to_context (GSource      *source,
+		       GMainContext *context)
+{
+  GSourceList *source_list;
+  GSource *prev, *next;
+
+  source_list = find_source_list_for_priority (context, source->priority, TRUE);
+
+  if (source->priv->parent_source)
+    {
+      g_assert (source_list->head != NULL);
+
+      /* Put the source immediately before its parent */
+      prev = source->priv->parent_source->prev;
+      next = source->priv->parent_source;
+    }
+  else
+    {
+      prev = source_list->tail;
+      next = NULL;
+    }
+
+  source->next = next;
+  if (next)
+    next->prev = source;
+  else
+    source_list->tail = source;
+  
+  source->prev = prev;
+  if (prev)
+    prev->next = source;
+  else
+    source_list->head = source;
+
+  source->priv->source_list = source_list;
+  source->priv->order = context->next_source_order++;
+
+  source_update_active (source);
+  if (source->flags & G_SOURCE_READY)
+    source_mark_ready (source);
+  source_update_timer (context, source);
+}
+
+/* Holds context's lock
+ */
+static void
+source_remove_from_context (GSource      *source,
+			    GMainContext *context)
+{
+  GSourceList *source_list;
+
+  source_list = find_source_list_for_priority (context, source->priority, FALSE);
+  g_return_if_fail (source_list != NULL);
+
+  /* Stays flagged ready, if it was, but is requeued on being added back */
+  source_unlink_ready (source);
+  if (source->priv->active_link.data != NULL)
+    {
+      g_queue_unlink (&source_list->active, &source->priv->active_link);
+      source->priv->active_link.data = NULL;
+    }
+  source->priv->source_list = NULL;
+  source_update_timer (context, source);
+
+  if (source->prev)
+    source->prev->next = source->next;
+  else
+    source_list->head = source->next;
+
+  if (source->next)
+    source->next->prev = source->prev;
+  else
+    source_list->tail = source->prev;
+
+  source->prev = NULL;
+  source->next = NULL;
+
+  if (source_list->head == NULL)
+    {
+      context->source_lists = g_list_remove (context->source_lists, source_list);
+      g_slice_free (GSourceList, source_list);
+    }
+}
+
+static guint
+g_source_attach_unlocked (GSource      *source,
+                          GMainContext *context,
+                          gboolean      do_wakeup)
+{
+  GSList *tmp_list;
+  guint id;
+
+  /* The counter may have wrapped, so we must ensure that we do not
+   * reuse the source id of an existing source.
+   */
+  do
+    id = context->next_id++;
+  while (id == 0 || g_hash_table_contains (context->sources, GUINT_TO_POINTER (id)));
+
+  source->context = context;
+  source->source_id = id;
+  g_source_ref (source);
+
+  g_hash_table_insert (context->sources, GUINT_TO_POINTER (id), source);
+
+  source_add_to_context (source, context);
+
+  if (!SOURCE_BLOCKED (source))
+    {
+      tmp_list = source->poll_fds;
+      while (tmp_list)
+        {
+          g_main_context_add_poll_unlocked (context, source->priority, tmp_list->data, FALSE);
+          tmp_list = tmp_list->next;
+        }
+
+      for (tmp_list = source->priv->fds; tmp_list; tmp_list = tmp_list->next)
+        g_main_context_add_poll_unlocked (context, source->priority, tmp_list->data, TRUE);
+    }
+
+  tmp_list = source->priv->child_sources;
+  while (tmp_list)
+    {
+      g_source_attach_unlocked (tmp_list->data, context, FALSE);
+      tmp_list = tmp_list->next;
+    }
+
+  /* If another thread has acquired the context, wake it up since it
+   * might be in poll() right now.
+   */
+  if (do_wakeup && context->owner && context->owner != G_THREAD_SELF)
+    g_wakeup_signal (context->wakeup);
+
+  g_trace_mark (G_TRACE_CURRENT_TIME, 0,
+                "GLib", "g_source_attach",
+                "%s to context %p",
+                (g_source_get_name (source) != NULL) ? g_source_get_name (source) : "(unnamed)",
+                context);
+
+  return source->source_id;
+}
+
+/**
+ * g_source_attach:
+ * @source: a #GSource
+ * @context: (nullable): a #GMainContext (if %NULL, the default context will be used)
+ * 
+ * Adds a #GSource to a @context so that it will be executed within
+ * that context. Remove it by calling g_source_destroy().
+ *
+ * This function is safe to call from any thread, regardless of which thread
+ * the @context is running in.
+ *
+ * Returns: the ID (greater than 0) for the source within the 
+ *   #GMainContext. 
+ **/
+guint
+g_source_attach (GSource      *source,
+		 GMainContext *context)
+{
+  guint result = 0;
+
+  g_return_val_if_fail (source != NULL, 0);
+  g_return_val_if_fail (g_atomic_int_get (&source->ref_count) > 0, 0);
+  g_return_val_if_fail (source->context == NULL, 0);
+  g_return_val_if_fail (!SOURCE_DESTROYED (source), 0);
+  
+  if (!context)
+    context = g_main_context_default ();
+
+  LOCK_CONTEXT (context);
+
+  result = g_source_attach_unlocked (source, context, TRUE);
+
+  TRACE (GLIB_MAIN_SOURCE_ATTACH (g_source_get_name (source), source, context,
+                                  result));
+
+  UNLOCK_CONTEXT (context);
+
+  return result;
+}
+
+static void
+g_source_destroy_internal (GSource      *source,
+			   GMainContext *context,
+			   gboolean      have_lock)
+{
+  TRACE (GLIB_MAIN_SOURCE_DESTROY (g_source_get_name (source), source,
+                                   context));
+
+  if (!have_lock)
     LOCK_CONTEXT (context);
   
   if (!SOURCE_DESTROYED (source))
@@ -1317,6 +2014,10 @@ g_source_destroy_internal (GSource      *source,
       
       source->flags &= ~G_HOOK_FLAG_ACTIVE;
 
+      source_update_active (source);
+      source_unlink_ready (source);
+      source_update_timer (context, source);
+
       old_cb_data = source->callback_data;
       old_cb_funcs = source->callback_funcs;
 
@@ -1486,7 +2187,7 @@ g_source_add_poll (GSource *source,
   if (context)
     {
       if (!SOURCE_BLOCKED (source))
-	g_main_context_add_poll_unlocked (context, source->priority, fd);
+	g_main_context_add_poll_unlocked (context, source->priority, fd, FALSE);
       UNLOCK_CONTEXT (context);
     }
 }
@@ -1840,7 +2541,7 @@ g_source_set_priority_unlocked (GSource      *source,
 	  while (tmp_list)
 	    {
 	      g_main_context_remove_poll_unlocked (context, tmp_list->data);
-	      g_main_context_add_poll_unlocked (context, priority, tmp_list->data);
+	      g_main_context_add_poll_unlocked (context, priority, tmp_list->data, FALSE);
 	      
 	      tmp_list = tmp_list->next;
 	    }
@@ -1848,7 +2549,7 @@ g_source_set_priority_unlocked (GSource      *source,
           for (tmp_list = source->priv->fds; tmp_list; tmp_list = tmp_list->next)
             {
               g_main_context_remove_poll_unlocked (context, tmp_list->data);
-              g_main_context_add_poll_unlocked (context, priority, tmp_list->data);
+              g_main_context_add_poll_unlocked (context, priority, tmp_list->data, TRUE);
             }
 	}
     }
@@ -1973,6 +2674,8 @@ g_source_set_ready_time (GSource *source,
 
   if (context)
     {
+      source_update_timer (context, source);
+
       /* Quite likely that we need to change the timeout on the poll */
       if (!SOURCE_BLOCKED (source))
         g_wakeup_signal (context->wakeup);
@@ -2001,6 +2704,75 @@ g_source_get_ready_time (GSource *source)
   return source->priv->ready_time;
 }
 
+/**
+ * g_source_set_slack:
+ * @source: a #GSource
+ * @slack: the time in microseconds by which @source may be late
+ *
+ * Allows @source to be dispatched up to @slack microseconds after its
+ * ready time, as set with g_source_set_ready_time() or implied by the
+ * interval of a timeout source.
+ *
+ * The #GMainContext uses the slack to reduce the number of times it
+ * wakes up: rather than waking up for each source as soon as it becomes
+ * ready, it waits as long as the slack of all the sources allows, and
+ * then dispatches all the ready ones together. This is useful for the
+ * many timeouts of a server, such as per-connection keepalives, whose
+ * exact timing does not matter.
+ *
+ * Sources still become ready at their ready time: one that is ready
+ * when the context wakes up for another reason is dispatched right
+ * away.
+ *
+ * The slack of a new source is 0.
+ *
+ * Since: 2.68
+ **/
+void
+g_source_set_slack (GSource *source,
+                    gint64   slack)
+{
+  GMainContext *context;
+
+  g_return_if_fail (source != NULL);
+  g_return_if_fail (g_atomic_int_get (&source->ref_count) > 0);
+  g_return_if_fail (slack >= 0);
+
+  context = source->context;
+
+  if (context)
+    LOCK_CONTEXT (context);
+
+  source->priv->slack = slack;
+
+  if (context)
+    {
+      /* The timeout on the poll may have to be shortened */
+      if (source->priv->ready_time != -1 && !SOURCE_BLOCKED (source))
+        g_wakeup_signal (context->wakeup);
+      UNLOCK_CONTEXT (context);
+    }
+}
+
+/**
+ * g_source_get_slack:
+ * @source: a #GSource
+ *
+ * Gets the slack of @source, as set by g_source_set_slack().
+ *
+ * Returns: the slack in microseconds
+ *
+ * Since: 2.68
+ **/
+gint64
+g_source_get_slack (GSource *source)
+{
+  g_return_val_if_fail (source != NULL, 0);
+  g_return_val_if_fail (g_atomic_int_get (&source->ref_count) > 0, 0);
+
+  return source->priv->slack;
+}
+
 /**
  * g_source_set_can_recurse:
  * @source: a #GSource
@@ -2639,8 +3411,9 @@ g_source_add_unix_fd (GSource      *source,
 
   if (context)
     {
+      source_update_active (source);
       if (!SOURCE_BLOCKED (source))
-        g_main_context_add_poll_unlocked (context, source->priority, poll_fd);
+        g_main_context_add_poll_unlocked (context, source->priority, poll_fd, TRUE);
       UNLOCK_CONTEXT (context);
     }
 
@@ -2682,6 +3455,35 @@ g_source_modify_unix_fd (GSource      *source,
   context = source->context;
   poll_fd = tag;
 
+#ifdef HAVE_EPOLL
+  if (context && context->epoll_fd >= 0)
+    {
+      GEPollFd *epoll_fd;
+      gboolean need_wakeup;
+
+      LOCK_CONTEXT (context);
+
+      poll_fd->events = new_events;
+
+      /* Blocked sources have no poll records */
+      epoll_fd = g_hash_table_lookup (context->epoll_fds, GINT_TO_POINTER (poll_fd->fd));
+      if (epoll_fd != NULL && !SOURCE_BLOCKED (source))
+        epoll_fd_update_unlocked (context, epoll_fd, FALSE);
+
+      /* The kernel applies the change to a running epoll_wait(), so the
+       * context only needs a wakeup if it is polled with a poll function.
+       */
+      need_wakeup = context->poll_func != g_poll;
+
+      UNLOCK_CONTEXT (context);
+
+      if (need_wakeup)
+        g_main_context_wakeup (context);
+
+      return;
+    }
+#endif
+
   poll_fd->events = new_events;
 
   if (context)
@@ -2727,6 +3529,8 @@ g_source_remove_unix_fd (GSource  *source,
 
   if (context)
     {
+      source_update_active (source);
+
       if (!SOURCE_BLOCKED (source))
         g_main_context_remove_poll_unlocked (context, poll_fd);
 
@@ -3208,6 +4012,8 @@ block_source (GSource *source)
 
   if (source->context)
     {
+      source_update_timer (source->context, source);
+
       tmp_list = source->poll_fds;
       while (tmp_list)
         {
@@ -3241,15 +4047,17 @@ unblock_source (GSource *source)
   
   source->flags &= ~G_SOURCE_BLOCKED;
 
+  source_update_timer (source->context, source);
+
   tmp_list = source->poll_fds;
   while (tmp_list)
     {
-      g_main_context_add_poll_unlocked (source->context, source->priority, tmp_list->data);
+      g_main_context_add_poll_unlocked (source->context, source->priority, tmp_list->data, FALSE);
       tmp_list = tmp_list->next;
     }
 
   for (tmp_list = source->priv->fds; tmp_list; tmp_list = tmp_list->next)
-    g_main_context_add_poll_unlocked (source->context, source->priority, tmp_list->data);
+    g_main_context_add_poll_unlocked (source->context, source->priority, tmp_list->data, TRUE);
 
   if (source->priv && source->priv->child_sources)
     {
@@ -3276,7 +4084,7 @@ g_main_dispatch (GMainContext *context)
       context->pending_dispatches->pdata[i] = NULL;
       g_assert (source);
 
-      source->flags &= ~G_SOURCE_READY;
+      source_clear_ready (source);
 
       if (!SOURCE_DESTROYED (source))
 	{
@@ -3292,6 +4100,7 @@ g_main_dispatch (GMainContext *context)
 				gpointer);
           GSource *prev_source;
           gint64 begin_time_nsec G_GNUC_UNUSED;
+          gint64 stats_begin_time = 0;
 
 	  dispatch = source->source_funcs->dispatch;
 	  cb_funcs = source->callback_funcs;
@@ -3309,6 +4118,9 @@ g_main_dispatch (GMainContext *context)
 	  if (cb_funcs)
 	    cb_funcs->get (cb_data, source, &callback, &user_data);
 
+          if (context->stats != NULL)
+            stats_begin_time = g_get_monotonic_time ();
+
 	  UNLOCK_CONTEXT (context);
 
           /* These operations are safe because 'current' is thread-local
@@ -3339,6 +4151,9 @@ g_main_dispatch (GMainContext *context)
 	    cb_funcs->unref (cb_data);
 
  	  LOCK_CONTEXT (context);
+
+          if (stats_begin_time != 0 && context->stats != NULL)
+            g_main_context_stats_dispatch_unlocked (context, source, stats_begin_time);
 	  
 	  if (!was_in_call)
 	    source->flags &= ~G_HOOK_FLAG_IN_CALL;
@@ -3570,8 +4385,8 @@ g_main_context_prepare (GMainContext *context,
   guint i;
   gint n_ready = 0;
   gint current_priority = G_MAXINT;
-  GSource *source;
-  GSourceIter iter;
+  GSourceList *source_list;
+  gint list_priority = 0;
 
   if (context == NULL)
     context = g_main_context_default ();
@@ -3614,105 +4429,92 @@ g_main_context_prepare (GMainContext *context,
   /* Prepare all sources */
 
   context->timeout = -1;
-  
-  g_source_iter_init (&iter, context, TRUE);
-  while (g_source_iter_next (&iter, &source))
+
+  /* Sources with a ready time are only looked at once they expire, and
+   * the earliest ones bound the timeout.
+   */
+  timer_heap_expire (context, &context->timeout);
+
+  for (source_list = find_next_source_list (context, TRUE, 0);
+       source_list != NULL;
+       source_list = find_next_source_list (context, FALSE, list_priority))
     {
-      gint source_timeout = -1;
+      guint n_list_ready;
 
-      if (SOURCE_DESTROYED (source) || SOURCE_BLOCKED (source))
-	continue;
-      if ((n_ready > 0) && (source->priority > current_priority))
-	break;
+      list_priority = source_list->priority;
+      if ((n_ready > 0) && (list_priority > current_priority))
+        break;
 
-      if (!(source->flags & G_SOURCE_READY))
-	{
-	  gboolean result;
-	  gboolean (* prepare) (GSource  *source,
-                                gint     *timeout);
+      source_list_get_active (context, source_list);
 
-          prepare = source->source_funcs->prepare;
+      for (i = 0; i < context->active_sources->len; i++)
+        {
+          GSource *source = context->active_sources->pdata[i];
+          gint source_timeout = -1;
 
-          if (prepare)
+          if (!SOURCE_DESTROYED (source) && !SOURCE_BLOCKED (source) &&
+              !(source->flags & G_SOURCE_READY))
             {
-              gint64 begin_time_nsec G_GNUC_UNUSED;
+              gboolean result;
+              gboolean (* prepare) (GSource  *source,
+                                    gint     *timeout);
 
-              context->in_check_or_prepare++;
-              UNLOCK_CONTEXT (context);
+              prepare = source->source_funcs->prepare;
 
-              begin_time_nsec = G_TRACE_CURRENT_TIME;
+              if (prepare)
+                {
+                  gint64 begin_time_nsec G_GNUC_UNUSED;
 
-              result = (* prepare) (source, &source_timeout);
-              TRACE (GLIB_MAIN_AFTER_PREPARE (source, prepare, source_timeout));
+                  context->in_check_or_prepare++;
+                  UNLOCK_CONTEXT (context);
 
-              g_trace_mark (begin_time_nsec, G_TRACE_CURRENT_TIME - begin_time_nsec,
-                            "GLib", "GSource.prepare",
-                            "%s ⇒ %s",
-                            (g_source_get_name (source) != NULL) ? g_source_get_name (source) : "(unnamed)",
-                            result ? "ready" : "unready");
+                  begin_time_nsec = G_TRACE_CURRENT_TIME;
 
-              LOCK_CONTEXT (context);
-              context->in_check_or_prepare--;
-            }
-          else
-            {
-              source_timeout = -1;
-              result = FALSE;
-            }
+                  result = (* prepare) (source, &source_timeout);
+                  TRACE (GLIB_MAIN_AFTER_PREPARE (source, prepare, source_timeout));
 
-          if (result == FALSE && source->priv->ready_time != -1)
-            {
-              if (!context->time_is_fresh)
-                {
-                  context->time = g_get_monotonic_time ();
-                  context->time_is_fresh = TRUE;
-                }
+                  g_trace_mark (begin_time_nsec, G_TRACE_CURRENT_TIME - begin_time_nsec,
+                                "GLib", "GSource.prepare",
+                                "%s ⇒ %s",
+                                (g_source_get_name (source) != NULL) ? g_source_get_name (source) : "(unnamed)",
+                                result ? "ready" : "unready");
 
-              if (source->priv->ready_time <= context->time)
-                {
-                  source_timeout = 0;
-                  result = TRUE;
+                  LOCK_CONTEXT (context);
+                  context->in_check_or_prepare--;
                 }
               else
                 {
-                  gint64 timeout;
+                  source_timeout = -1;
+                  result = FALSE;
+                }
 
-                  /* rounding down will lead to spinning, so always round up */
-                  timeout = (source->priv->ready_time - context->time + 999) / 1000;
+              if (result)
+                source_mark_ready (source);
+            }
 
-                  if (source_timeout < 0 || timeout < source_timeout)
-                    source_timeout = MIN (timeout, G_MAXINT);
-                }
+          if (source_timeout >= 0)
+            {
+              if (context->timeout < 0)
+                context->timeout = source_timeout;
+              else
+                context->timeout = MIN (context->timeout, source_timeout);
             }
 
-	  if (result)
-	    {
-	      GSource *ready_source = source;
+          g_source_unref_internal (source, context, TRUE);
+        }
+      g_ptr_array_set_size (context->active_sources, 0);
 
-	      while (ready_source)
-		{
-		  ready_source->flags |= G_SOURCE_READY;
-		  ready_source = ready_source->priv->parent_source;
-		}
-	    }
-	}
+      /* Sources may have been removed while the lock was released */
+      source_list = find_source_list_for_priority (context, list_priority, FALSE);
+      n_list_ready = source_list ? source_list_collect_ready (source_list, NULL) : 0;
 
-      if (source->flags & G_SOURCE_READY)
-	{
-	  n_ready++;
-	  current_priority = source->priority;
-	  context->timeout = 0;
-	}
-      
-      if (source_timeout >= 0)
-	{
-	  if (context->timeout < 0)
-	    context->timeout = source_timeout;
-	  else
-	    context->timeout = MIN (context->timeout, source_timeout);
-	}
+      if (n_list_ready > 0)
+        {
+          n_ready += n_list_ready;
+          current_priority = list_priority;
+          context->timeout = 0;
+        }
     }
-  g_source_iter_clear (&iter);
 
   TRACE (GLIB_MAIN_CONTEXT_AFTER_PREPARE (context, current_priority, n_ready));
 
@@ -3843,8 +4645,8 @@ g_main_context_check (GMainContext *context,
 		      GPollFD      *fds,
 		      gint          n_fds)
 {
-  GSource *source;
-  GSourceIter iter;
+  GSourceList *source_list;
+  gint list_priority = 0;
   GPollRec *pollrec;
   gint n_ready = 0;
   gint i;
@@ -3861,6 +4663,16 @@ g_main_context_check (GMainContext *context,
 
   TRACE (GLIB_MAIN_CONTEXT_BEFORE_CHECK (context, max_priority, fds, n_fds));
 
+  /* If the context was polled by someone else, this is the earliest we
+   * know about it having woken up.
+   */
+  if (context->stats != NULL)
+    {
+      if (!context->stats->polled)
+        context->stats->wakeup_time = g_get_monotonic_time ();
+      context->stats->polled = FALSE;
+    }
+
   for (i = 0; i < n_fds; i++)
     {
       if (fds[i].fd == context->wake_up_rec.fd)
@@ -3915,105 +4727,104 @@ g_main_context_check (GMainContext *context,
       i++;
     }
 
-  g_source_iter_init (&iter, context, TRUE);
-  while (g_source_iter_next (&iter, &source))
+  timer_heap_expire (context, NULL);
+
+  for (source_list = find_next_source_list (context, TRUE, 0);
+       source_list != NULL;
+       source_list = find_next_source_list (context, FALSE, list_priority))
     {
-      if (SOURCE_DESTROYED (source) || SOURCE_BLOCKED (source))
-	continue;
-      if ((n_ready > 0) && (source->priority > max_priority))
-	break;
+      guint n_list_ready;
+      guint j;
 
-      if (!(source->flags & G_SOURCE_READY))
-	{
-          gboolean result;
-          gboolean (* check) (GSource *source);
+      list_priority = source_list->priority;
+      if ((n_ready > 0) && (list_priority > max_priority))
+        break;
 
-          check = source->source_funcs->check;
+      source_list_get_active (context, source_list);
 
-          if (check)
+      for (j = 0; j < context->active_sources->len; j++)
+        {
+          GSource *source = context->active_sources->pdata[j];
+
+          if (!SOURCE_DESTROYED (source) && !SOURCE_BLOCKED (source) &&
+              !(source->flags & G_SOURCE_READY))
             {
-              gint64 begin_time_nsec G_GNUC_UNUSED;
+              gboolean result;
+              gboolean (* check) (GSource *source);
 
-              /* If the check function is set, call it. */
-              context->in_check_or_prepare++;
-              UNLOCK_CONTEXT (context);
+              check = source->source_funcs->check;
 
-              begin_time_nsec = G_TRACE_CURRENT_TIME;
+              if (check)
+                {
+                  gint64 begin_time_nsec G_GNUC_UNUSED;
 
-              result = (* check) (source);
+                  /* If the check function is set, call it. */
+                  context->in_check_or_prepare++;
+                  UNLOCK_CONTEXT (context);
 
-              TRACE (GLIB_MAIN_AFTER_CHECK (source, check, result));
+                  begin_time_nsec = G_TRACE_CURRENT_TIME;
 
-              g_trace_mark (begin_time_nsec, G_TRACE_CURRENT_TIME - begin_time_nsec,
-                            "GLib", "GSource.check",
-                            "%s ⇒ %s",
-                            (g_source_get_name (source) != NULL) ? g_source_get_name (source) : "(unnamed)",
-                            result ? "dispatch" : "ignore");
+                  result = (* check) (source);
 
-              LOCK_CONTEXT (context);
-              context->in_check_or_prepare--;
-            }
-          else
-            result = FALSE;
+                  TRACE (GLIB_MAIN_AFTER_CHECK (source, check, result));
 
-          if (result == FALSE)
-            {
-              GSList *tmp_list;
+                  g_trace_mark (begin_time_nsec, G_TRACE_CURRENT_TIME - begin_time_nsec,
+                                "GLib", "GSource.check",
+                                "%s ⇒ %s",
+                                (g_source_get_name (source) != NULL) ? g_source_get_name (source) : "(unnamed)",
+                                result ? "dispatch" : "ignore");
+
+                  LOCK_CONTEXT (context);
+                  context->in_check_or_prepare--;
+                }
+              else
+                result = FALSE;
 
-              /* If not already explicitly flagged ready by ->check()
-               * (or if we have no check) then we can still be ready if
-               * any of our fds poll as ready.
-               */
-              for (tmp_list = source->priv->fds; tmp_list; tmp_list = tmp_list->next)
+              if (result == FALSE)
                 {
-                  GPollFD *pollfd = tmp_list->data;
+                  GSList *tmp_list;
 
-                  if (pollfd->revents)
+                  /* If not already explicitly flagged ready by ->check()
+                   * (or if we have no check) then we can still be ready if
+                   * any of our fds poll as ready.
+                   */
+                  for (tmp_list = source->priv->fds; tmp_list; tmp_list = tmp_list->next)
                     {
-                      result = TRUE;
-                      break;
-                    }
-                }
-            }
+                      GPollFD *pollfd = tmp_list->data;
 
-          if (result == FALSE && source->priv->ready_time != -1)
-            {
-              if (!context->time_is_fresh)
-                {
-                  context->time = g_get_monotonic_time ();
-                  context->time_is_fresh = TRUE;
+                      if (pollfd->revents)
+                        {
+                          result = TRUE;
+                          break;
+                        }
+                    }
                 }
 
-              if (source->priv->ready_time <= context->time)
-                result = TRUE;
+              if (result)
+                source_mark_ready (source);
             }
 
-	  if (result)
-	    {
-	      GSource *ready_source = source;
-
-	      while (ready_source)
-		{
-		  ready_source->flags |= G_SOURCE_READY;
-		  ready_source = ready_source->priv->parent_source;
-		}
-	    }
-	}
+          g_source_unref_internal (source, context, TRUE);
+        }
+      g_ptr_array_set_size (context->active_sources, 0);
 
-      if (source->flags & G_SOURCE_READY)
-	{
-          g_source_ref (source);
-	  g_ptr_array_add (context->pending_dispatches, source);
+      /* Sources may have been removed while the lock was released */
+      source_list = find_source_list_for_priority (context, list_priority, FALSE);
+      n_list_ready = source_list ? source_list_collect_ready (source_list, context->pending_dispatches) : 0;
 
-	  n_ready++;
+      if (n_list_ready > 0)
+        {
+          n_ready += n_list_ready;
 
           /* never dispatch sources with less priority than the first
            * one we choose to dispatch
            */
-          max_priority = source->priority;
-	}
+          max_priority = list_priority;
+        }
     }
-  g_source_iter_clear (&iter);
+
+  if (context->pending_dispatches->len > 1)
+    g_ptr_array_sort (context->pending_dispatches, source_compare_position);
 
   TRACE (GLIB_MAIN_CONTEXT_AFTER_CHECK (context, n_ready));
 
@@ -4060,6 +4871,9 @@ g_main_context_iterate (GMainContext *context,
   gboolean some_ready;
   gint nfds, allocated_nfds;
   GPollFD *fds = NULL;
+#ifdef HAVE_EPOLL
+  gboolean use_epoll;
+#endif
   gint64 begin_time_nsec G_GNUC_UNUSED;
 
   UNLOCK_CONTEXT (context);
@@ -4084,6 +4898,11 @@ g_main_context_iterate (GMainContext *context,
     }
   else
     LOCK_CONTEXT (context);
+
+#ifdef HAVE_EPOLL
+  /* A custom poll function needs to be given the full set of fds */
+  use_epoll = context->epoll_fd >= 0 && context->poll_func == g_poll;
+#endif
   
   if (!context->cached_poll_array)
     {
@@ -4097,21 +4916,31 @@ g_main_context_iterate (GMainContext *context,
   UNLOCK_CONTEXT (context);
 
   g_main_context_prepare (context, &max_priority); 
-  
-  while ((nfds = g_main_context_query (context, max_priority, &timeout, fds, 
-				       allocated_nfds)) > allocated_nfds)
+
+#ifdef HAVE_EPOLL
+  if (use_epoll)
     {
-      LOCK_CONTEXT (context);
-      g_free (fds);
-      context->cached_poll_array_size = allocated_nfds = nfds;
-      context->cached_poll_array = fds = g_new (GPollFD, nfds);
-      UNLOCK_CONTEXT (context);
+      g_main_context_epoll_wait (context, block, max_priority);
+      nfds = 0;
     }
+  else
+#endif
+    {
+      while ((nfds = g_main_context_query (context, max_priority, &timeout, fds,
+                                           allocated_nfds)) > allocated_nfds)
+        {
+          LOCK_CONTEXT (context);
+          g_free (fds);
+          context->cached_poll_array_size = allocated_nfds = nfds;
+          context->cached_poll_array = fds = g_new (GPollFD, nfds);
+          UNLOCK_CONTEXT (context);
+        }
 
-  if (!block)
-    timeout = 0;
-  
-  g_main_context_poll (context, timeout, max_priority, fds, nfds);
+      if (!block)
+        timeout = 0;
+
+      g_main_context_poll (context, timeout, max_priority, fds, nfds);
+    }
   
   some_ready = g_main_context_check (context, max_priority, fds, nfds);
   
@@ -4403,6 +5232,7 @@ g_main_context_poll (GMainContext *context,
   if (n_fds || timeout != 0)
     {
       int ret, errsv;
+      gint64 poll_start_time;
 
 #ifdef	G_MAIN_POLL_DEBUG
       poll_timer = NULL;
@@ -4417,6 +5247,7 @@ g_main_context_poll (GMainContext *context,
       LOCK_CONTEXT (context);
 
       poll_func = context->poll_func;
+      poll_start_time = context->stats != NULL ? g_get_monotonic_time () : 0;
 
       UNLOCK_CONTEXT (context);
       ret = (*poll_func) (fds, n_fds, timeout);
@@ -4430,6 +5261,13 @@ g_main_context_poll (GMainContext *context,
 	  /* If g_poll () returns -1, it has already called g_warning() */
 #endif
 	}
+
+      if (poll_start_time != 0)
+        {
+          LOCK_CONTEXT (context);
+          g_main_context_stats_poll_unlocked (context, poll_start_time);
+          UNLOCK_CONTEXT (context);
+        }
       
 #ifdef	G_MAIN_POLL_DEBUG
       if (_g_main_poll_debug)
@@ -4479,6 +5317,258 @@ g_main_context_poll (GMainContext *context,
     } /* if (n_fds || timeout != 0) */
 }
 
+static void
+g_main_context_stats_free (GMainContextStats *stats)
+{
+  if (stats == NULL)
+    return;
+
+  g_hash_table_unref (stats->sources);
+  g_array_unref (stats->batch_ready_times);
+  g_free (stats);
+}
+
+/* HOLDS: context's lock */
+static void
+g_main_context_stats_poll_unlocked (GMainContext *context,
+                                    gint64        start_time)
+{
+  GMainContextStats *stats = context->stats;
+  gint64 end_time;
+
+  /* Statistics may have been disabled while polling */
+  if (stats == NULL)
+    return;
+
+  end_time = g_get_monotonic_time ();
+
+  stats->n_polls++;
+  stats->poll_time += end_time - start_time;
+  stats->wakeup_time = end_time;
+  stats->polled = TRUE;
+}
+
+/* HOLDS: context's lock */
+static void
+g_main_context_stats_dispatch_unlocked (GMainContext *context,
+                                        GSource      *source,
+                                        gint64        start_time)
+{
+  GMainContextStats *stats = context->stats;
+  GSourceStats *source_stats;
+  const gchar *name;
+  guint64 dispatch_time;
+
+  name = source->name != NULL ? source->name : "(unnamed)";
+  source_stats = g_hash_table_lookup (stats->sources, name);
+  if (source_stats == NULL)
+    {
+      source_stats = g_new0 (GSourceStats, 1);
+      g_hash_table_insert (stats->sources, g_strdup (name), source_stats);
+    }
+
+  dispatch_time = g_get_monotonic_time () - start_time;
+
+  source_stats->n_dispatches++;
+  source_stats->dispatch_time += dispatch_time;
+  source_stats->max_dispatch_time = MAX (source_stats->max_dispatch_time, dispatch_time);
+
+  if (stats->wakeup_time != 0)
+    {
+      gint64 latency = start_time - stats->wakeup_time;
+      guint bucket = latency > 0 ? g_bit_storage (latency) : 0;
+
+      source_stats->latency[MIN (bucket, N_LATENCY_BUCKETS - 1)]++;
+    }
+}
+
+/**
+ * g_main_context_set_statistics_enabled:
+ * @context: (nullable): a #GMainContext (if %NULL, the default context will be used)
+ * @enabled: whether to collect statistics
+ *
+ * Sets whether @context keeps statistics about its main loop
+ * iterations, to be retrieved with g_main_context_get_statistics().
+ *
+ * Collecting statistics costs a few clock reads and a hash table lookup
+ * per dispatched source, so it is disabled by default. Enabling it
+ * starts from empty statistics; disabling it throws the collected ones
+ * away.
+ *
+ * This function is safe to call from any thread.
+ *
+ * Since: 2.68
+ **/
+void
+g_main_context_set_statistics_enabled (GMainContext *context,
+                                       gboolean      enabled)
+{
+  if (!context)
+    context = g_main_context_default ();
+
+  g_return_if_fail (g_atomic_int_get (&context->ref_count) > 0);
+
+  LOCK_CONTEXT (context);
+
+  if (enabled && context->stats == NULL)
+    {
+      context->stats = g_new0 (GMainContextStats, 1);
+      context->stats->sources = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                       g_free, g_free);
+      context->stats->batch_ready_times = g_array_new (FALSE, FALSE, sizeof (gint64));
+    }
+  else if (!enabled && context->stats != NULL)
+    {
+      g_main_context_stats_free (context->stats);
+      context->stats = NULL;
+    }
+
+  UNLOCK_CONTEXT (context);
+}
+
+/**
+ * g_main_context_get_statistics_enabled:
+ * @context: (nullable): a #GMainContext (if %NULL, the default context will be used)
+ *
+ * Gets whether @context keeps statistics. See
+ * g_main_context_set_statistics_enabled().
+ *
+ * Returns: %TRUE if statistics are being collected
+ *
+ * Since: 2.68
+ **/
+gboolean
+g_main_context_get_statistics_enabled (GMainContext *context)
+{
+  gboolean enabled;
+
+  if (!context)
+    context = g_main_context_default ();
+
+  g_return_val_if_fail (g_atomic_int_get (&context->ref_count) > 0, FALSE);
+
+  LOCK_CONTEXT (context);
+  enabled = context->stats != NULL;
+  UNLOCK_CONTEXT (context);
+
+  return enabled;
+}
+
+static gint
+compare_source_names (gconstpointer a,
+                      gconstpointer b)
+{
+  return strcmp (*(const gchar **) a, *(const gchar **) b);
+}
+
+/**
+ * g_main_context_get_statistics:
+ * @context: (nullable): a #GMainContext (if %NULL, the default context will be used)
+ *
+ * Gets the statistics collected by @context since they were enabled
+ * with g_main_context_set_statistics_enabled().
+ *
+ * The statistics are returned as a dictionary of type `a{sv}`, with
+ * the following entries. All times are in microseconds.
+ *
+ * - `poll-count` (`t`): the number of times the context polled its
+ *   file descriptors
+ * - `poll-time` (`t`): the total time spent waiting in those polls
+ * - `saved-wakeups` (`t`): the number of wakeups avoided by dispatching
+ *   sources with a slack (see g_source_set_slack()) together with others
+ * - `latency-buckets` (`at`): the upper bounds of the buckets of the
+ *   latency histograms below; a latency is counted in the first bucket
+ *   it is smaller than, the last bound being %G_MAXUINT64
+ * - `sources` (`a{s(tttat)}`): the dispatch statistics of the sources,
+ *   grouped by their name as given by g_source_get_name(), with
+ *   unnamed sources grouped as `(unnamed)`. For each name, the tuple
+ *   holds the number of dispatches, their total and maximum duration,
+ *   and the histogram of the latency between the context waking up
+ *   and the dispatch starting.
+ *
+ * The context wakes up when its poll returns or, for contexts that are
+ * polled by the application, when g_main_context_check() is called.
+ * Poll times are only known if the context polls itself, as when it is
+ * run with g_main_loop_run() or g_main_context_iteration().
+ *
+ * This function is safe to call from any thread.
+ *
+ * Returns: (transfer full) (nullable): a new #GVariant of type `a{sv}`,
+ *   or %NULL if statistics are not enabled
+ *
+ * Since: 2.68
+ **/
+GVariant *
+g_main_context_get_statistics (GMainContext *context)
+{
+  GMainContextStats *stats;
+  GVariantBuilder builder, buckets, sources;
+  const gchar **names;
+  guint n_names;
+  guint i, j;
+
+  if (!context)
+    context = g_main_context_default ();
+
+  g_return_val_if_fail (g_atomic_int_get (&context->ref_count) > 0, NULL);
+
+  LOCK_CONTEXT (context);
+
+  stats = context->stats;
+  if (stats == NULL)
+    {
+      UNLOCK_CONTEXT (context);
+      return NULL;
+    }
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+  g_variant_builder_add (&builder, "{sv}", "poll-count",
+                         g_variant_new_uint64 (stats->n_polls));
+  g_variant_builder_add (&builder, "{sv}", "poll-time",
+                         g_variant_new_uint64 (stats->poll_time));
+  g_variant_builder_add (&builder, "{sv}", "saved-wakeups",
+                         g_variant_new_uint64 (stats->saved_wakeups));
+
+  g_variant_builder_init (&buckets, G_VARIANT_TYPE ("at"));
+  for (i = 0; i < N_LATENCY_BUCKETS - 1; i++)
+    g_variant_builder_add (&buckets, "t", G_GUINT64_CONSTANT (1) << i);
+  g_variant_builder_add (&buckets, "t", G_MAXUINT64);
+  g_variant_builder_add (&builder, "{sv}", "latency-buckets",
+                         g_variant_builder_end (&buckets));
+
+  /* Sorted, so that the output does not depend on the hash table */
+  names = (const gchar **) g_hash_table_get_keys_as_array (stats->sources, &n_names);
+  qsort (names, n_names, sizeof (const gchar *), compare_source_names);
+
+  g_variant_builder_init (&sources, G_VARIANT_TYPE ("a{s(tttat)}"));
+  for (i = 0; i < n_names; i++)
+    {
+      const gchar *name = names[i];
+      GSourceStats *source_stats = g_hash_table_lookup (stats->sources, name);
+
+      g_variant_builder_open (&sources, G_VARIANT_TYPE ("{s(tttat)}"));
+      g_variant_builder_add (&sources, "s", name);
+      g_variant_builder_open (&sources, G_VARIANT_TYPE ("(tttat)"));
+      g_variant_builder_add (&sources, "t", source_stats->n_dispatches);
+      g_variant_builder_add (&sources, "t", source_stats->dispatch_time);
+      g_variant_builder_add (&sources, "t", source_stats->max_dispatch_time);
+      g_variant_builder_open (&sources, G_VARIANT_TYPE ("at"));
+      for (j = 0; j < N_LATENCY_BUCKETS; j++)
+        g_variant_builder_add (&sources, "t", source_stats->latency[j]);
+      g_variant_builder_close (&sources);
+      g_variant_builder_close (&sources);
+      g_variant_builder_close (&sources);
+    }
+  g_free (names);
+
+  UNLOCK_CONTEXT (context);
+
+  g_variant_builder_add (&builder, "{sv}", "sources",
+                         g_variant_builder_end (&sources));
+
+  return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
 /**
  * g_main_context_add_poll:
  * @context: (nullable): a #GMainContext (or %NULL for the default context)
@@ -4504,7 +5594,7 @@ g_main_context_add_poll (GMainContext *context,
   g_return_if_fail (fd);
 
   LOCK_CONTEXT (context);
-  g_main_context_add_poll_unlocked (context, priority, fd);
+  g_main_context_add_poll_unlocked (context, priority, fd, FALSE);
   UNLOCK_CONTEXT (context);
 }
 
@@ -4512,7 +5602,8 @@ g_main_context_add_poll (GMainContext *context,
 static void 
 g_main_context_add_poll_unlocked (GMainContext *context,
 				  gint          priority,
-				  GPollFD      *fd)
+				  GPollFD      *fd,
+				  gboolean      tracked)
 {
   GPollRec *prevrec, *nextrec;
   GPollRec *newrec = g_slice_new (GPollRec);
@@ -4521,6 +5612,7 @@ g_main_context_add_poll_unlocked (GMainContext *context,
   fd->revents = 0;
   newrec->fd = fd;
   newrec->priority = priority;
+  newrec->tracked = tracked;
 
   /* Poll records are incrementally sorted by file descriptor identifier. */
   prevrec = NULL;
@@ -4548,6 +5640,36 @@ g_main_context_add_poll_unlocked (GMainContext *context,
 
   context->poll_changed = TRUE;
 
+#ifdef HAVE_EPOLL
+  if (context->epoll_fd >= 0)
+    {
+      GEPollFd *epoll_fd;
+
+      /* Records for the same fd are inserted after the existing ones, so
+       * the first one stays the same.
+       */
+      epoll_fd = g_hash_table_lookup (context->epoll_fds, GINT_TO_POINTER (fd->fd));
+      if (epoll_fd == NULL)
+        {
+          epoll_fd = g_slice_new0 (GEPollFd);
+          epoll_fd->fd = fd->fd;
+          epoll_fd->first = newrec;
+          g_hash_table_insert (context->epoll_fds, GINT_TO_POINTER (fd->fd), epoll_fd);
+        }
+      epoll_fd->n_records++;
+
+      if (!tracked)
+        context->untracked_poll_records = g_slist_prepend (context->untracked_poll_records, newrec);
+
+      /* Always re-register: the fd may have been closed and reused */
+      epoll_fd_update_unlocked (context, epoll_fd, TRUE);
+
+      /* A running epoll_wait() picks up the change by itself */
+      if (context->poll_func == g_poll)
+        return;
+    }
+#endif
+
   /* Now wake up the main loop if it is waiting in the poll() */
   g_wakeup_signal (context->wakeup);
 }
@@ -4597,6 +5719,25 @@ g_main_context_remove_poll_unlocked (GMainContext *context,
 	  if (nextrec != NULL)
 	    nextrec->prev = prevrec;
 
+#ifdef HAVE_EPOLL
+          if (context->epoll_fd >= 0)
+            {
+              GEPollFd *epoll_fd;
+
+              epoll_fd = g_hash_table_lookup (context->epoll_fds, GINT_TO_POINTER (fd->fd));
+              g_assert (epoll_fd != NULL);
+
+              if (epoll_fd->first == pollrec)
+                epoll_fd->first = nextrec;
+              epoll_fd->n_records--;
+
+              if (!pollrec->tracked)
+                context->untracked_poll_records = g_slist_remove (context->untracked_poll_records, pollrec);
+
+              epoll_fd_update_unlocked (context, epoll_fd, FALSE);
+            }
+#endif
+
 	  g_slice_free (GPollRec, pollrec);
 
 	  context->n_poll_records--;
@@ -4608,10 +5749,277 @@ g_main_context_remove_poll_unlocked (GMainContext *context,
 
   context->poll_changed = TRUE;
 
+#ifdef HAVE_EPOLL
+  if (context->epoll_fd >= 0 && context->poll_func == g_poll)
+    return;
+#endif
+
   /* Now wake up the main loop if it is waiting in the poll() */
   g_wakeup_signal (context->wakeup);
 }
 
+#ifdef HAVE_EPOLL
+static inline guint32
+g_io_condition_to_epoll_events (gushort condition)
+{
+  guint32 events = 0;
+
+  if (condition & G_IO_IN)
+    events |= EPOLLIN;
+  if (condition & G_IO_OUT)
+    events |= EPOLLOUT;
+  if (condition & G_IO_PRI)
+    events |= EPOLLPRI;
+
+  return events;
+}
+
+static inline gushort
+epoll_events_to_g_io_condition (guint32 events)
+{
+  gushort condition = 0;
+
+  if (events & EPOLLIN)
+    condition |= G_IO_IN;
+  if (events & EPOLLOUT)
+    condition |= G_IO_OUT;
+  if (events & EPOLLPRI)
+    condition |= G_IO_PRI;
+  if (events & EPOLLERR)
+    condition |= G_IO_ERR;
+  if (events & EPOLLHUP)
+    condition |= G_IO_HUP;
+
+  return condition;
+}
+
+/* HOLDS: context's lock
+ *
+ * Brings the kernel's idea of @epoll_fd in line with its poll records,
+ * freeing it once there are none left. If @force is set the fd is
+ * registered again even if its events did not change.
+ */
+static void
+epoll_fd_update_unlocked (GMainContext *context,
+                          GEPollFd     *epoll_fd,
+                          gboolean      force)
+{
+  struct epoll_event event;
+  GPollRec *pollrec;
+  guint32 events = 0;
+  guint i;
+  int errsv;
+
+  if (epoll_fd->n_records == 0)
+    {
+      /* This fails if the fd was already closed, which is fine */
+      if (epoll_fd->registered)
+        epoll_ctl (context->epoll_fd, EPOLL_CTL_DEL, epoll_fd->fd, NULL);
+
+      if (epoll_fd->unpollable)
+        context->epoll_unpollable = g_slist_remove (context->epoll_unpollable, epoll_fd);
+
+      g_hash_table_remove (context->epoll_fds, GINT_TO_POINTER (epoll_fd->fd));
+      return;
+    }
+
+  for (pollrec = epoll_fd->first, i = 0; i < epoll_fd->n_records; pollrec = pollrec->next, i++)
+    events |= g_io_condition_to_epoll_events (pollrec->fd->events);
+
+  if (!force && events == epoll_fd->events)
+    return;
+
+  epoll_fd->events = events;
+
+  if (epoll_fd->unpollable && !force)
+    return;
+
+  memset (&event, 0, sizeof event);
+  event.events = events;
+  event.data.fd = epoll_fd->fd;
+
+  if (epoll_fd->registered &&
+      epoll_ctl (context->epoll_fd, EPOLL_CTL_MOD, epoll_fd->fd, &event) == 0)
+    return;
+
+  if (epoll_ctl (context->epoll_fd, EPOLL_CTL_ADD, epoll_fd->fd, &event) == 0 ||
+      (errno == EEXIST &&
+       epoll_ctl (context->epoll_fd, EPOLL_CTL_MOD, epoll_fd->fd, &event) == 0))
+    {
+      epoll_fd->registered = TRUE;
+      if (epoll_fd->unpollable)
+        {
+          epoll_fd->unpollable = FALSE;
+          context->epoll_unpollable = g_slist_remove (context->epoll_unpollable, epoll_fd);
+        }
+      return;
+    }
+
+  errsv = errno;
+
+  /* Regular files (EPERM) and invalid fds (EBADF) are always ready as far
+   * as poll() is concerned; anything else is unexpected, but we can still
+   * fall back to polling the fd along with the epoll fd.
+   */
+  if (errsv != EPERM && errsv != EBADF)
+    g_warning ("epoll_ctl(2) failed due to: %s.", g_strerror (errsv));
+
+  epoll_fd->registered = FALSE;
+  if (!epoll_fd->unpollable)
+    {
+      epoll_fd->unpollable = TRUE;
+      context->epoll_unpollable = g_slist_prepend (context->epoll_unpollable, epoll_fd);
+    }
+}
+
+/* HOLDS: context's lock */
+static void
+epoll_fd_set_revents_unlocked (GMainContext *context,
+                               gint          fd,
+                               gushort       revents,
+                               gint          max_priority)
+{
+  GEPollFd *epoll_fd;
+  GPollRec *pollrec;
+  guint i;
+
+  /* The fd may have been removed while we were waiting */
+  epoll_fd = g_hash_table_lookup (context->epoll_fds, GINT_TO_POINTER (fd));
+  if (epoll_fd == NULL)
+    return;
+
+  for (pollrec = epoll_fd->first, i = 0; i < epoll_fd->n_records; pollrec = pollrec->next, i++)
+    {
+      if (revents == 0)
+        pollrec->fd->revents = 0;
+      else if (pollrec->priority <= max_priority)
+        pollrec->fd->revents =
+          revents & (pollrec->fd->events | G_IO_ERR | G_IO_HUP | G_IO_NVAL);
+    }
+
+  if (revents != 0)
+    g_array_append_val (context->epoll_ready_fds, fd);
+}
+
+/* Takes the place of g_main_context_query(), g_main_context_poll() and
+ * the first half of g_main_context_check() for contexts using epoll:
+ * only the poll records of ready fds are touched.
+ */
+static void
+g_main_context_epoll_wait (GMainContext *context,
+                           gboolean      block,
+                           gint          max_priority)
+{
+  GPollFD *unpollable_fds = NULL;
+  gint n_unpollable = 0;
+  gint64 poll_start_time;
+  gint timeout;
+  gint n_events;
+  GSList *l;
+  guint i;
+
+  LOCK_CONTEXT (context);
+
+  /* The owners of these may have changed their events since last time */
+  for (l = context->untracked_poll_records; l != NULL; l = l->next)
+    {
+      GPollRec *pollrec = l->data;
+      GEPollFd *epoll_fd;
+
+      epoll_fd = g_hash_table_lookup (context->epoll_fds, GINT_TO_POINTER (pollrec->fd->fd));
+      if (epoll_fd != NULL)
+        epoll_fd_update_unlocked (context, epoll_fd, FALSE);
+    }
+
+  n_unpollable = g_slist_length (context->epoll_unpollable);
+  if (n_unpollable > 0)
+    {
+      unpollable_fds = g_new (GPollFD, n_unpollable);
+      for (l = context->epoll_unpollable, i = 0; l != NULL; l = l->next, i++)
+        {
+          GEPollFd *epoll_fd = l->data;
+
+          unpollable_fds[i].fd = epoll_fd->fd;
+          unpollable_fds[i].events = epoll_events_to_g_io_condition (epoll_fd->events);
+          unpollable_fds[i].revents = 0;
+        }
+    }
+
+  timeout = context->timeout;
+  if (timeout != 0)
+    context->time_is_fresh = FALSE;
+  if (!block)
+    timeout = 0;
+
+  poll_start_time = context->stats != NULL ? g_get_monotonic_time () : 0;
+
+  UNLOCK_CONTEXT (context);
+
+  if (n_unpollable > 0 && g_poll (unpollable_fds, n_unpollable, 0) > 0)
+    timeout = 0;
+
+  /* Only the owner of the context gets here, so the events array is
+   * ours to use without holding the lock.
+   */
+  n_events = epoll_wait (context->epoll_fd, context->epoll_events,
+                         context->epoll_events_size, timeout);
+  if (n_events < 0)
+    {
+      int errsv = errno;
+
+      if (errsv != EINTR)
+        g_warning ("epoll_wait(2) failed due to: %s.", g_strerror (errsv));
+
+      n_events = 0;
+    }
+
+  LOCK_CONTEXT (context);
+
+  if (poll_start_time != 0)
+    g_main_context_stats_poll_unlocked (context, poll_start_time);
+
+  /* Clear what was reported in the previous iteration */
+  for (i = 0; i < context->epoll_ready_fds->len; i++)
+    epoll_fd_set_revents_unlocked (context,
+                                   g_array_index (context->epoll_ready_fds, gint, i),
+                                   0, max_priority);
+  g_array_set_size (context->epoll_ready_fds, 0);
+
+  for (i = 0; i < (guint) n_events; i++)
+    epoll_fd_set_revents_unlocked (context,
+                                   context->epoll_events[i].data.fd,
+                                   epoll_events_to_g_io_condition (context->epoll_events[i].events),
+                                   max_priority);
+
+  for (i = 0; i < (guint) n_unpollable; i++)
+    epoll_fd_set_revents_unlocked (context, unpollable_fds[i].fd,
+                                   unpollable_fds[i].revents, max_priority);
+
+  if (context->wake_up_rec.revents)
+    {
+      TRACE (GLIB_MAIN_CONTEXT_WAKEUP_ACKNOWLEDGE (context));
+      g_wakeup_acknowledge (context->wakeup);
+    }
+
+  /* Changes to the set of fds were applied to the kernel as they were
+   * made, so there is no need for g_main_context_check() to bail out.
+   */
+  context->poll_changed = FALSE;
+
+  /* If the array was filled up, give more room to the next iteration */
+  if (n_events == context->epoll_events_size)
+    {
+      context->epoll_events_size *= 2;
+      context->epoll_events = g_renew (struct epoll_event, context->epoll_events,
+                                       context->epoll_events_size);
+    }
+
+  UNLOCK_CONTEXT (context);
+
+  g_free (unpollable_fds);
+}
+#endif /* HAVE_EPOLL */
+
 /**
  * g_source_get_current_time:
  * @source:  a #GSource
@@ -4896,6 +6304,9 @@ g_timeout_dispatch (GSource     *source,
  *
  * The interval given is in terms of monotonic time, not wall clock
  * time.  See g_get_monotonic_time().
+ *
+ * If the exact time at which the timeout fires does not matter, use
+ * g_source_set_slack() to let it fire together with other sources.
  * 
  * Returns: the newly-created timeout source
  **/
@@ -25,6 +25,7 @@
 #include <glib/gpoll.h>
 #include <glib/gslist.h>
 #include <glib/gthread.h>
+#include <glib/gvariant.h>
 
 G_BEGIN_DECLS
 
@@ -38,6 +39,28 @@ typedef enum /*< flags >*/
   G_IO_NVAL	GLIB_SYSDEF_POLLNVAL
 } GIOCondition;
 
+/**
+ * GMainContextFlags:
+ * @G_MAIN_CONTEXT_FLAGS_NONE: Default behaviour.
+ * @G_MAIN_CONTEXT_FLAGS_EPOLL: Keep the set of file descriptors to be
+ *     polled registered with the kernel incrementally (using `epoll` on
+ *     Linux), rather than passing the complete set to poll() on every
+ *     iteration. This makes the cost of an iteration depend on the
+ *     number of ready file descriptors instead of the number of watched
+ *     ones. The flag is ignored on platforms without `epoll`.
+ *
+ * Flags to pass to g_main_context_new_with_flags() which affect the
+ * behaviour of a #GMainContext.
+ *
+ * Since: 2.68
+ */
+GLIB_AVAILABLE_TYPE_IN_2_68
+typedef enum /*< flags >*/
+{
+  G_MAIN_CONTEXT_FLAGS_NONE = 0,
+  G_MAIN_CONTEXT_FLAGS_EPOLL = 1
+} GMainContextFlags;
+
 
 /**
  * GMainContext:
@@ -354,6 +377,10 @@ struct _GSourceFuncs
 
 GLIB_AVAILABLE_IN_ALL
 GMainContext *g_main_context_new       (void);
+G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+GLIB_AVAILABLE_IN_2_68
+GMainContext *g_main_context_new_with_flags (GMainContextFlags flags);
+G_GNUC_END_IGNORE_DEPRECATIONS
 GLIB_AVAILABLE_IN_ALL
 GMainContext *g_main_context_ref       (GMainContext *context);
 GLIB_AVAILABLE_IN_ALL
@@ -418,6 +445,14 @@ void     g_main_context_set_poll_func (GMainContext *context,
 GLIB_AVAILABLE_IN_ALL
 GPollFunc g_main_context_get_poll_func (GMainContext *context);
 
+GLIB_AVAILABLE_IN_2_68
+void      g_main_context_set_statistics_enabled (GMainContext *context,
+                                                 gboolean      enabled);
+GLIB_AVAILABLE_IN_2_68
+gboolean  g_main_context_get_statistics_enabled (GMainContext *context);
+GLIB_AVAILABLE_IN_2_68
+GVariant *g_main_context_get_statistics         (GMainContext *context);
+
 /* Low level functions for use by source implementations
  */
 GLIB_AVAILABLE_IN_ALL
@@ -612,6 +647,11 @@ void                 g_source_set_ready_time (GSource        *source,
                                               gint64          ready_time);
 GLIB_AVAILABLE_IN_2_36
 gint64               g_source_get_ready_time (GSource        *source);
+GLIB_AVAILABLE_IN_2_68
+void                 g_source_set_slack      (GSource        *source,
+                                              gint64          slack);
+GLIB_AVAILABLE_IN_2_68
+gint64               g_source_get_slack      (GSource        *source);
 
 #ifdef G_OS_UNIX
 GLIB_AVAILABLE_IN_2_36
@@ -45,20 +45,135 @@
 #define QUARK_BLOCK_SIZE         2048
 #define QUARK_STRING_BLOCK_SIZE (4096 - sizeof (gsize))
 
+/* The table of quarks by string has at least 1 << 10 slots, and at
+ * least twice as many as there are quarks */
+#define QUARK_TABLE_MIN_SHIFT    10
+
 static inline GQuark  quark_new (gchar *string);
 
+/* Quarks are never removed, so the table of quarks by string only ever
+ * gets new entries, and can be read without taking quark_global: each
+ * slot is written only once, with the hash value first and the quark
+ * last, and a reader stops at the first empty slot. When the table gets
+ * too full, the quarks are put in a bigger one which then replaces it.
+ * Readers which still have the old one get the right answer for all
+ * quarks which were in it, and the old table is leaked just like the
+ * old quarks arrays.
+ */
+typedef struct {
+  guint hash;
+  GQuark quark;
+} QuarkSlot;
+
+typedef struct {
+  guint shift;
+  guint n_quarks;
+  QuarkSlot slots[1];
+} QuarkTable;
+
 G_LOCK_DEFINE_STATIC (quark_global);
-static GHashTable    *quark_ht = NULL;
+static QuarkTable    *quark_table = NULL;
 static gchar        **quarks = NULL;
 static gint           quark_seq_id = 0;
 static gchar         *quark_block = NULL;
 static gint           quark_block_offset = 0;
 
+static QuarkTable *
+quark_table_new (guint shift)
+{
+  QuarkTable *table;
+
+  table = g_malloc0 (G_STRUCT_OFFSET (QuarkTable, slots) + sizeof (QuarkSlot) * (1u << shift));
+  table->shift = shift;
+
+  return table;
+}
+
+static inline guint
+quark_table_index (QuarkTable *table,
+                   guint       hash)
+{
+  /* Similar strings have similar g_str_hash() values, so spread them out
+   * before taking the top bits */
+  return (hash * 2654435761u) >> (32 - table->shift);
+}
+
+/* Can be called without holding quark_global */
+static GQuark
+quark_table_lookup (const gchar *string)
+{
+  QuarkTable *table = g_atomic_pointer_get (&quark_table);
+  guint hash = g_str_hash (string);
+  guint mask = (1u << table->shift) - 1;
+  guint index = quark_table_index (table, hash);
+
+  for (;;)
+    {
+      QuarkSlot *slot = &table->slots[index];
+      GQuark quark = (GQuark) g_atomic_int_get ((gint *) &slot->quark);
+
+      if (quark == 0)
+        return 0;
+
+      /* The quark was set after its hash value and its string */
+      if (slot->hash == hash)
+        {
+          gchar **strings = g_atomic_pointer_get (&quarks);
+
+          if (strcmp (strings[quark], string) == 0)
+            return quark;
+        }
+
+      index = (index + 1) & mask;
+    }
+}
+
+/* HOLDS: quark_global_lock */
+static void
+quark_table_insert (QuarkTable *table,
+                    guint       hash,
+                    GQuark      quark)
+{
+  guint mask = (1u << table->shift) - 1;
+  guint index = quark_table_index (table, hash);
+
+  while (table->slots[index].quark != 0)
+    index = (index + 1) & mask;
+
+  table->slots[index].hash = hash;
+  g_atomic_int_set ((gint *) &table->slots[index].quark, quark);
+  table->n_quarks++;
+}
+
+/* HOLDS: quark_global_lock */
+static void
+quark_table_add (const gchar *string,
+                 GQuark       quark)
+{
+  QuarkTable *table = quark_table;
+
+  if ((table->n_quarks + 1) * 2 > (1u << table->shift))
+    {
+      QuarkTable *new_table = quark_table_new (table->shift + 1);
+      guint i;
+
+      for (i = 0; i < (1u << table->shift); i++)
+        if (table->slots[i].quark != 0)
+          quark_table_insert (new_table, table->slots[i].hash, table->slots[i].quark);
+
+      /* This leaks the old table, which readers may still be using */
+      g_atomic_pointer_set (&quark_table, new_table);
+      table = new_table;
+    }
+
+  quark_table_insert (table, g_str_hash (string), quark);
+}
+
 void
 g_quark_init (void)
 {
   g_assert (quark_seq_id == 0);
-  quark_ht = g_hash_table_new (g_str_hash, g_str_equal);
+  quark_table = quark_table_new (QUARK_TABLE_MIN_SHIFT);
   quarks = g_new (gchar*, QUARK_BLOCK_SIZE);
   quarks[0] = NULL;
   quark_seq_id = 1;
@@ -135,16 +250,10 @@ g_quark_init (void)
 GQuark
 g_quark_try_string (const gchar *string)
 {
-  GQuark quark = 0;
-
   if (string == NULL)
     return 0;
 
-  G_LOCK (quark_global);
-  quark = GPOINTER_TO_UINT (g_hash_table_lookup (quark_ht, string));
-  G_UNLOCK (quark_global);
-
-  return quark;
+  return quark_table_lookup (string);
 }
 
 /* HOLDS: quark_global_lock */
@@ -182,7 +291,7 @@ quark_from_string (const gchar *string,
 {
   GQuark quark = 0;
 
-  quark = GPOINTER_TO_UINT (g_hash_table_lookup (quark_ht, string));
+  quark = quark_table_lookup (string);
 
   if (!quark)
     {
@@ -202,6 +311,11 @@ quark_from_string_locked (const gchar   *string,
   if (!string)
     return 0;
 
+  /* Most quarks exist already, and can be found without the lock */
+  quark = quark_table_lookup (string);
+  if (quark)
+    return quark;
+
   G_LOCK (quark_global);
   quark = quark_from_string (string, duplicate);
   G_UNLOCK (quark_global);
@@ -304,8 +418,10 @@ quark_new (gchar *string)
 
   quark = quark_seq_id;
   g_atomic_pointer_set (&quarks[quark], string);
-  g_hash_table_insert (quark_ht, string, GUINT_TO_POINTER (quark));
   g_atomic_int_inc (&quark_seq_id);
+  /* Only once g_quark_to_string() works for it, since it can be looked
+   * up without the lock from now on */
+  quark_table_add (string, quark);
 
   return quark;
 }
@@ -320,6 +436,10 @@ quark_intern_string_locked (const gchar   *string,
   if (!string)
     return NULL;
 
+  quark = quark_table_lookup (string);
+  if (quark)
+    return g_quark_to_string (quark);
+
   G_LOCK (quark_global);
   quark = quark_from_string (string, duplicate);
   result = quarks[quark];
@@ -29,6 +29,9 @@
 #ifdef G_OS_UNIX
 #include <unistd.h>             /* sysconf() */
 #endif
+#ifdef HAVE_MADVISE
+#include <sys/mman.h>           /* madvise() */
+#endif
 #ifdef G_OS_WIN32
 #include <windows.h>
 #include <process.h>
@@ -184,6 +187,23 @@
  *     16KB.
  * [4] allocating ca. 8 chunks per block/page keeps a good balance between
  *     external and internal fragmentation (<= 12.5%). [Bonwick94]
+ *
+ * with G_SLICE=arena, the magazine layers and the slab allocator are replaced
+ * by a per-thread arena allocator for the same chunk sizes:
+ * - each thread owns a ring of spans per chunk size. spans are ARENA_SPAN_SIZE
+ *   aligned blocks which carry their header at the start, so the span of a
+ *   chunk is found by masking its address. chunks are allocated from the
+ *   span at the head of the ring, first from its free list and then from its
+ *   never used tail, so fresh spans only take up memory as they are used.
+ * - chunks freed by the owning thread go straight back to their span. chunks
+ *   freed by other threads are collected in a per-thread batch of chunks for
+ *   the same span, which is handed over to the span's lock-free remote list in
+ *   one go; the owner takes the remote list when it runs out of free chunks.
+ * - spans which become completely unused are retired to a global pool for
+ *   reuse by any chunk size. beyond ARENA_RESIDENT_SPANS of them, the pages of
+ *   retired spans are given back to the system with madvise(). spans of
+ *   exiting threads are orphaned, and adopted by the next thread which needs
+ *   a span for their chunk size.
  */
 
 /* --- macros and constants --- */
@@ -200,6 +220,11 @@
 #define SLAB_INDEX(al, asize)   ((asize) / P2ALIGNMENT - 1)                     /* asize must be P2ALIGNMENT aligned */
 #define SLAB_CHUNK_SIZE(al, ix) (((ix) + 1) * P2ALIGNMENT)
 #define SLAB_BPAGE_SIZE(al,csz) (8 * (csz) + SLAB_INFO_SIZE)
+#define ARENA_SPAN_SIZE         (64 * 1024)                                     /* must be a power of 2 */
+#define ARENA_SPAN_INFO_SIZE    P2ALIGN (sizeof (ArenaSpan))
+#define ARENA_BATCH_SIZE        (32)                                            /* chunks freed to a foreign span before handing them over */
+#define ARENA_RESIDENT_SPANS    (8)                                             /* retired spans kept around without giving back their memory */
+#define ARENA_MAX_POOLED_SPANS  (64)                                            /* retired spans kept around, beyond that they are freed */
 
 /* optimized version of ALIGN (size, P2ALIGNMENT) */
 #if     GLIB_SIZEOF_SIZE_T * 2 == 8  /* P2ALIGNMENT */
@@ -218,6 +243,7 @@ static void mem_error (const char *format, ...) G_GNUC_PRINTF (1,2);
 typedef struct _ChunkLink      ChunkLink;
 typedef struct _SlabInfo       SlabInfo;
 typedef struct _CachedMagazine CachedMagazine;
+typedef struct _ArenaSpan      ArenaSpan;
 struct _ChunkLink {
   ChunkLink *next;
   ChunkLink *data;
@@ -231,16 +257,38 @@ typedef struct {
   ChunkLink *chunks;
   gsize      count;                     /* approximative chunks list length */
 } Magazine;
-typedef struct {
+typedef struct _ThreadMemory ThreadMemory;
+struct _ThreadMemory {
   Magazine   *magazine1;                /* array of MAX_SLAB_INDEX (allocator) */
   Magazine   *magazine2;                /* array of MAX_SLAB_INDEX (allocator) */
-} ThreadMemory;
+  ArenaSpan **arena_spans;              /* array of MAX_SLAB_INDEX (allocator), rings of owned spans */
+  guint      *arena_n_spans;            /* array of MAX_SLAB_INDEX (allocator), ring lengths */
+  ArenaSpan  *batch_span;               /* foreign span the batched chunks belong to */
+  ChunkLink  *batch_head;
+  ChunkLink  *batch_tail;
+  guint       batch_count;
+};
+struct _ArenaSpan {
+  /* owner only */
+  ChunkLink    *chunks;                 /* free list */
+  guint8       *bump;                   /* start of the never used chunks */
+  guint8       *limit;
+  gint          n_allocated;            /* read without the owner's knowledge for statistics */
+  guint         ix;
+  ArenaSpan    *next, *prev;            /* ring of spans for ix of the owner, or of the orphans */
+  /* protected by allocator->arena_mutex */
+  ArenaSpan    *all_next, *all_prev;    /* list of all spans for ix */
+  /* shared */
+  ThreadMemory *owner;                  /* (atomic) NULL for orphaned and retired spans */
+  ChunkLink    *remote_chunks;          /* (atomic) chunks freed by other threads */
+};
 typedef struct {
   gboolean always_malloc;
   gboolean bypass_magazines;
   gboolean debug_blocks;
   gsize    working_set_msecs;
   guint    color_increment;
+  gboolean arena;
 } SliceConfig;
 typedef struct {
   /* const after initialization */
@@ -258,6 +306,14 @@ typedef struct {
   GMutex        slab_mutex;
   SlabInfo    **slab_stack;                /* array of MAX_SLAB_INDEX (allocator) */
   guint        color_accu;
+  /* arena allocator */
+  GMutex        arena_mutex;
+  ArenaSpan   **arena_all_spans;           /* array of MAX_SLAB_INDEX (allocator) */
+  ArenaSpan   **arena_orphans;             /* array of MAX_SLAB_INDEX (allocator) */
+  ArenaSpan    *arena_resident;            /* retired spans, still backed by memory */
+  guint         arena_n_resident;
+  ArenaSpan    *arena_pool;                /* retired spans, memory given back */
+  guint         arena_n_pooled;
 } Allocator;
 
 /* --- g-slice prototypes --- */
@@ -272,6 +328,9 @@ static void         allocator_memfree                (gsize      memsize,
 static inline void  magazine_cache_update_stamp      (void);
 static inline gsize allocator_get_magazine_threshold (Allocator *allocator,
                                                       guint      ix);
+static void         arena_thread_memory_cleanup      (ThreadMemory *tmem);
+static guint        arena_get_statistics             (guint      ix,
+                                                      gint64    *values);
 
 /* --- g-slice memory checker --- */
 static void     smc_notify_alloc  (void   *pointer,
@@ -289,6 +348,7 @@ static SliceConfig slice_config = {
   FALSE,        /* debug_blocks */
   15 * 1000,    /* working_set_msecs */
   1,            /* color increment, alt: 0x7fffffff */
+  FALSE,        /* arena */
 };
 static GMutex      smc_tree_mutex; /* mutex for G_SLICE=debug-blocks */
 
@@ -312,6 +372,9 @@ g_slice_set_config (GSliceConfig ckey,
     case G_SLICE_CONFIG_COLOR_INCREMENT:
       slice_config.color_increment = value;
       break;
+    case G_SLICE_CONFIG_ARENA:
+      slice_config.arena = value != 0;
+      break;
     default: ;
     }
 }
@@ -331,6 +394,9 @@ g_slice_get_config (GSliceConfig ckey)
       return MAX_SLAB_INDEX (allocator);
     case G_SLICE_CONFIG_COLOR_INCREMENT:
       return slice_config.color_increment;
+    case G_SLICE_CONFIG_ARENA:
+      /* G_SLICE and the platform have a say once initialized */
+      return sys_page_size ? allocator->config.arena : slice_config.arena;
     default:
       return 0;
     }
@@ -353,6 +419,13 @@ g_slice_get_config_state (GSliceConfig ckey,
       array[i++] = allocator_get_magazine_threshold (allocator, address);
       *n_values = i;
       return g_memdup2 (array, sizeof (array[0]) * *n_values);
+    case G_SLICE_CONFIG_ARENA_STATISTICS:
+      if (!allocator->config.arena || address < 0 || address >= MAX_SLAB_INDEX (allocator))
+        return NULL;
+      array[i++] = SLAB_CHUNK_SIZE (allocator, address);
+      i += arena_get_statistics (address, &array[i]);
+      *n_values = i;
+      return g_memdup2 (array, sizeof (array[0]) * *n_values);
     default:
       return NULL;
     }
@@ -414,6 +487,7 @@ slice_config_init (SliceConfig *config)
       const GDebugKey keys[] = {
         { "always-malloc", 1 << 0 },
         { "debug-blocks",  1 << 1 },
+        { "arena",         1 << 2 },
       };
 
       flags = g_parse_debug_string (val, keys, G_N_ELEMENTS (keys));
@@ -421,6 +495,8 @@ slice_config_init (SliceConfig *config)
         config->always_malloc = TRUE;
       if (flags & (1 << 1))
         config->debug_blocks = TRUE;
+      if (flags & (1 << 2))
+        config->arena = TRUE;
     }
   else
     {
@@ -474,8 +550,17 @@ g_slice_init_nomessage (void)
 #else
   /* we can only align to system page size */
   allocator->max_page_size = sys_page_size;
+  /* and spans need a much larger alignment */
+  allocator->config.arena = FALSE;
 #endif
   if (allocator->config.always_malloc)
+    allocator->config.arena = FALSE;
+  if (allocator->config.arena)
+    {
+      allocator->arena_all_spans = g_new0 (ArenaSpan*, MAX_SLAB_INDEX (allocator));
+      allocator->arena_orphans = g_new0 (ArenaSpan*, MAX_SLAB_INDEX (allocator));
+    }
+  if (allocator->config.always_malloc || allocator->config.arena)
     {
       allocator->contention_counters = NULL;
       allocator->magazines = NULL;
@@ -495,7 +580,7 @@ g_slice_init_nomessage (void)
   magazine_cache_update_stamp();
   /* values cached for performance reasons */
   allocator->max_slab_chunk_size_for_magazine_cache = MAX_SLAB_CHUNK_SIZE (allocator);
-  if (allocator->config.always_malloc || allocator->config.bypass_magazines)
+  if (allocator->config.always_malloc || allocator->config.bypass_magazines || allocator->config.arena)
     allocator->max_slab_chunk_size_for_magazine_cache = 0;      /* non-optimized cases */
 }
 
@@ -510,6 +595,8 @@ allocator_categorize (gsize aligned_chunk_size)
       aligned_chunk_size &&
       aligned_chunk_size <= MAX_SLAB_CHUNK_SIZE (allocator))
     {
+      if (allocator->config.arena)
+        return 3;       /* use arena allocator */
       if (allocator->config.bypass_magazines)
         return 2;       /* use slab allocator, see [2] */
       return 1;         /* use magazine cache */
@@ -562,9 +649,12 @@ thread_memory_from_self (void)
       g_mutex_unlock (&init_mutex);
 
       n_magazines = MAX_SLAB_INDEX (allocator);
-      tmem = g_private_set_alloc0 (&private_thread_memory, sizeof (ThreadMemory) + sizeof (Magazine) * 2 * n_magazines);
+      tmem = g_private_set_alloc0 (&private_thread_memory, sizeof (ThreadMemory) + sizeof (Magazine) * 2 * n_magazines +
+                                   (sizeof (ArenaSpan*) + sizeof (guint)) * n_magazines);
       tmem->magazine1 = (Magazine*) (tmem + 1);
       tmem->magazine2 = &tmem->magazine1[n_magazines];
+      tmem->arena_spans = (ArenaSpan**) &tmem->magazine2[n_magazines];
+      tmem->arena_n_spans = (guint*) &tmem->arena_spans[n_magazines];
     }
   return tmem;
 }
@@ -809,6 +899,12 @@ private_thread_memory_cleanup (gpointer data)
   ThreadMemory *tmem = data;
   const guint n_magazines = MAX_SLAB_INDEX (allocator);
   guint ix;
+  if (allocator->config.arena)
+    {
+      arena_thread_memory_cleanup (tmem);
+      g_free (tmem);
+      return;
+    }
   for (ix = 0; ix < n_magazines; ix++)
     {
       Magazine *mags[2];
@@ -903,6 +999,363 @@ thread_memory_magazine2_free (ThreadMemory *tmem,
   mag->count++;
 }
 
+/* --- arena allocator --- */
+static inline ArenaSpan*
+arena_span_from_chunk (gpointer mem)
+{
+  return (ArenaSpan*) ((gsize) mem & ~(gsize) (ARENA_SPAN_SIZE - 1));
+}
+
+static void
+arena_ring_insert (ArenaSpan **ring,
+                   ArenaSpan  *span)
+{
+  /* insert span at ring head */
+  if (!*ring)
+    {
+      span->next = span;
+      span->prev = span;
+    }
+  else
+    {
+      ArenaSpan *next = *ring, *prev = next->prev;
+      next->prev = span;
+      prev->next = span;
+      span->next = next;
+      span->prev = prev;
+    }
+  *ring = span;
+}
+
+static void
+arena_ring_remove (ArenaSpan **ring,
+                   ArenaSpan  *span)
+{
+  ArenaSpan *next = span->next, *prev = span->prev;
+  next->prev = prev;
+  prev->next = next;
+  if (*ring == span)
+    *ring = next == span ? NULL : next;
+  span->next = NULL;
+  span->prev = NULL;
+}
+
+static void
+arena_span_setup (ArenaSpan *span,
+                  guint      ix)
+{
+  gsize chunk_size = SLAB_CHUNK_SIZE (allocator, ix);
+  gsize n_chunks = (ARENA_SPAN_SIZE - NATIVE_MALLOC_PADDING - ARENA_SPAN_INFO_SIZE) / chunk_size;
+  span->chunks = NULL;
+  span->bump = (guint8*) span + ARENA_SPAN_INFO_SIZE;
+  span->limit = span->bump + n_chunks * chunk_size;
+  span->n_allocated = 0;
+  span->ix = ix;
+  span->next = NULL;
+  span->prev = NULL;
+  span->remote_chunks = NULL;
+}
+
+static inline gboolean
+arena_span_has_chunks (ArenaSpan *span)
+{
+  return span->chunks || span->bump < span->limit;
+}
+
+/* move the chunks other threads freed to span onto its free list */
+static void
+arena_span_collect (ArenaSpan *span)
+{
+  ChunkLink *chunks, *last;
+  gint n_chunks = 1;
+  do
+    chunks = g_atomic_pointer_get (&span->remote_chunks);
+  while (chunks && !g_atomic_pointer_compare_and_exchange (&span->remote_chunks, chunks, NULL));
+  if (!chunks)
+    return;
+  for (last = chunks; last->next; last = last->next)
+    n_chunks++;
+  last->next = span->chunks;
+  span->chunks = chunks;
+  span->n_allocated -= n_chunks;
+}
+
+static ArenaSpan*
+arena_adopt_orphan (ThreadMemory *tmem,
+                    guint         ix)
+{
+  ArenaSpan *span;
+  g_mutex_lock (&allocator->arena_mutex);
+  span = allocator->arena_orphans[ix];
+  if (span)
+    arena_ring_remove (&allocator->arena_orphans[ix], span);
+  g_mutex_unlock (&allocator->arena_mutex);
+  if (span)
+    {
+      g_atomic_pointer_set (&span->owner, tmem);
+      arena_span_collect (span);
+    }
+  return span;
+}
+
+static ArenaSpan*
+arena_new_span (ThreadMemory *tmem,
+                guint         ix)
+{
+  ArenaSpan *span;
+  /* reuse a retired span if possible */
+  g_mutex_lock (&allocator->arena_mutex);
+  span = allocator->arena_resident;
+  if (span)
+    {
+      allocator->arena_resident = span->next;
+      allocator->arena_n_resident--;
+    }
+  else if ((span = allocator->arena_pool))
+    {
+      allocator->arena_pool = span->next;
+      allocator->arena_n_pooled--;
+    }
+  g_mutex_unlock (&allocator->arena_mutex);
+  if (!span)
+    {
+      span = allocator_memalign (ARENA_SPAN_SIZE, ARENA_SPAN_SIZE - NATIVE_MALLOC_PADDING);
+      if (!span)
+        {
+          const gchar *syserr = strerror (errno);
+          mem_error ("failed to allocate %u bytes (alignment: %u): %s\n",
+                     (guint) (ARENA_SPAN_SIZE - NATIVE_MALLOC_PADDING), (guint) ARENA_SPAN_SIZE, syserr);
+        }
+      mem_assert (span == arena_span_from_chunk (span));
+    }
+  arena_span_setup (span, ix);
+  g_atomic_pointer_set (&span->owner, tmem);
+  /* register span for statistics */
+  g_mutex_lock (&allocator->arena_mutex);
+  span->all_prev = NULL;
+  span->all_next = allocator->arena_all_spans[ix];
+  if (span->all_next)
+    span->all_next->all_prev = span;
+  allocator->arena_all_spans[ix] = span;
+  g_mutex_unlock (&allocator->arena_mutex);
+  return span;
+}
+
+/* keep an unused span around for reuse, giving its memory back to the
+ * system if there are many of them */
+static void
+arena_retire_span (ArenaSpan *span)
+{
+  guint ix = span->ix;
+  gboolean resident;
+  g_atomic_pointer_set (&span->owner, NULL);
+  g_mutex_lock (&allocator->arena_mutex);
+  if (span->all_prev)
+    span->all_prev->all_next = span->all_next;
+  else
+    allocator->arena_all_spans[ix] = span->all_next;
+  if (span->all_next)
+    span->all_next->all_prev = span->all_prev;
+  resident = allocator->arena_n_resident < ARENA_RESIDENT_SPANS;
+  if (resident)
+    {
+      span->next = allocator->arena_resident;
+      allocator->arena_resident = span;
+      allocator->arena_n_resident++;
+    }
+  g_mutex_unlock (&allocator->arena_mutex);
+  if (resident)
+    return;
+#ifdef HAVE_MADVISE
+  {
+    /* keep the page holding the span info */
+    gsize start = ALIGN ((gsize) span + ARENA_SPAN_INFO_SIZE, sys_page_size);
+    gsize end = ((gsize) span + ARENA_SPAN_SIZE - NATIVE_MALLOC_PADDING) / sys_page_size * sys_page_size;
+    if (end > start)
+      madvise ((gpointer) start, end - start, MADV_DONTNEED);
+  }
+#endif
+  g_mutex_lock (&allocator->arena_mutex);
+  if (allocator->arena_n_pooled < ARENA_MAX_POOLED_SPANS)
+    {
+      span->next = allocator->arena_pool;
+      allocator->arena_pool = span;
+      allocator->arena_n_pooled++;
+      span = NULL;
+    }
+  g_mutex_unlock (&allocator->arena_mutex);
+  if (span)
+    allocator_memfree (ARENA_SPAN_SIZE, span);
+}
+
+/* hand the batched chunks over to the thread owning their span */
+static void
+arena_flush_batch (ThreadMemory *tmem)
+{
+  ArenaSpan *span = tmem->batch_span;
+  ChunkLink *chunks;
+  if (!span)
+    return;
+  do
+    {
+      chunks = g_atomic_pointer_get (&span->remote_chunks);
+      tmem->batch_tail->next = chunks;
+    }
+  while (!g_atomic_pointer_compare_and_exchange (&span->remote_chunks, chunks, tmem->batch_head));
+  tmem->batch_span = NULL;
+  tmem->batch_head = NULL;
+  tmem->batch_tail = NULL;
+  tmem->batch_count = 0;
+}
+
+static ArenaSpan*
+arena_find_span (ThreadMemory *tmem,
+                 guint         ix)
+{
+  ArenaSpan *head = tmem->arena_spans[ix], *span;
+  /* a good moment to pass on chunks of other threads */
+  arena_flush_batch (tmem);
+  /* look for freed chunks in the spans we own */
+  if (head)
+    {
+      span = head;
+      do
+        {
+          arena_span_collect (span);
+          if (arena_span_has_chunks (span))
+            {
+              tmem->arena_spans[ix] = span;
+              return span;
+            }
+          span = span->next;
+        }
+      while (span != head);
+    }
+  /* then take over spans of exited threads */
+  while ((span = arena_adopt_orphan (tmem, ix)))
+    {
+      arena_ring_insert (&tmem->arena_spans[ix], span);
+      tmem->arena_n_spans[ix]++;
+      if (arena_span_has_chunks (span))
+        return span;
+    }
+  span = arena_new_span (tmem, ix);
+  arena_ring_insert (&tmem->arena_spans[ix], span);
+  tmem->arena_n_spans[ix]++;
+  return span;
+}
+
+static inline gpointer
+arena_alloc (ThreadMemory *tmem,
+             gsize         chunk_size)
+{
+  guint ix = SLAB_INDEX (allocator, chunk_size);
+  ArenaSpan *span = tmem->arena_spans[ix];
+  ChunkLink *chunk;
+  if (G_UNLIKELY (!span || !arena_span_has_chunks (span)))
+    span = arena_find_span (tmem, ix);
+  chunk = span->chunks;
+  if (G_LIKELY (chunk))
+    span->chunks = chunk->next;
+  else
+    {
+      chunk = (ChunkLink*) span->bump;
+      span->bump += chunk_size;
+    }
+  span->n_allocated++;
+  return chunk;
+}
+
+static inline void
+arena_free (ThreadMemory *tmem,
+            gsize         chunk_size,
+            gpointer      mem)
+{
+  ArenaSpan *span = arena_span_from_chunk (mem);
+  ChunkLink *chunk = mem;
+  guint ix = SLAB_INDEX (allocator, chunk_size);
+  mem_assert (span->ix == ix);
+  if (G_LIKELY (g_atomic_pointer_get (&span->owner) == tmem))
+    {
+      chunk->next = span->chunks;
+      span->chunks = chunk;
+      /* keep the span we allocate from and one more even when unused,
+       * so that balanced alloc/free pairs don't trash spans */
+      if (G_UNLIKELY (--span->n_allocated == 0) &&
+          span != tmem->arena_spans[ix] && tmem->arena_n_spans[ix] > 2)
+        {
+          arena_ring_remove (&tmem->arena_spans[ix], span);
+          tmem->arena_n_spans[ix]--;
+          arena_retire_span (span);
+        }
+    }
+  else
+    {
+      if (tmem->batch_span != span)
+        {
+          arena_flush_batch (tmem);
+          tmem->batch_span = span;
+          tmem->batch_tail = chunk;
+          chunk->next = NULL;
+        }
+      else
+        chunk->next = tmem->batch_head;
+      tmem->batch_head = chunk;
+      if (++tmem->batch_count >= ARENA_BATCH_SIZE)
+        arena_flush_batch (tmem);
+    }
+}
+
+static void
+arena_thread_memory_cleanup (ThreadMemory *tmem)
+{
+  const guint n_spans = MAX_SLAB_INDEX (allocator);
+  guint ix;
+  arena_flush_batch (tmem);
+  for (ix = 0; ix < n_spans; ix++)
+    while (tmem->arena_spans[ix])
+      {
+        ArenaSpan *span = tmem->arena_spans[ix];
+        arena_ring_remove (&tmem->arena_spans[ix], span);
+        tmem->arena_n_spans[ix]--;
+        arena_span_collect (span);
+        if (span->n_allocated == 0)
+          arena_retire_span (span);
+        else
+          {
+            /* chunks are still in use, leave the span to another thread */
+            g_atomic_pointer_set (&span->owner, NULL);
+            g_mutex_lock (&allocator->arena_mutex);
+            arena_ring_insert (&allocator->arena_orphans[ix], span);
+            g_mutex_unlock (&allocator->arena_mutex);
+          }
+      }
+}
+
+/* per chunk size: number of spans, number of chunks in those spans, and
+ * how many of those are allocated; chunks freed by threads not owning
+ * their span count as allocated until the owner picks them up */
+static guint
+arena_get_statistics (guint   ix,
+                      gint64 *values)
+{
+  gsize chunk_size = SLAB_CHUNK_SIZE (allocator, ix);
+  gint64 n_spans = 0, n_chunks = 0, n_allocated = 0;
+  ArenaSpan *span;
+  g_mutex_lock (&allocator->arena_mutex);
+  for (span = allocator->arena_all_spans[ix]; span; span = span->all_next)
+    {
+      n_spans++;
+      n_chunks += (ARENA_SPAN_SIZE - NATIVE_MALLOC_PADDING - ARENA_SPAN_INFO_SIZE) / chunk_size;
+      n_allocated += g_atomic_int_get (&span->n_allocated);
+    }
+  g_mutex_unlock (&allocator->arena_mutex);
+  values[0] = n_spans;
+  values[1] = n_chunks;
+  values[2] = n_allocated;
+  return 3;
+}
+
 /* --- API functions --- */
 
 /**
@@ -1060,6 +1513,8 @@ g_slice_alloc (gsize mem_size)
         }
       mem = thread_memory_magazine1_alloc (tmem, ix);
     }
+  else if (acat == 3)           /* allocate through arena allocator */
+    mem = arena_alloc (tmem, chunk_size);
   else if (acat == 2)           /* allocate through slab allocator */
     {
       g_mutex_lock (&allocator->slab_mutex);
@@ -1166,6 +1621,13 @@ g_slice_free1 (gsize    mem_size,
         memset (mem_block, 0, chunk_size);
       thread_memory_magazine2_free (tmem, ix, mem_block);
     }
+  else if (acat == 3)                   /* allocate through arena allocator */
+    {
+      ThreadMemory *tmem = thread_memory_from_self();
+      if (G_UNLIKELY (g_mem_gc_friendly))
+        memset (mem_block, 0, chunk_size);
+      arena_free (tmem, chunk_size, mem_block);
+    }
   else if (acat == 2)                   /* allocate through slab allocator */
     {
       if (G_UNLIKELY (g_mem_gc_friendly))
@@ -1248,6 +1710,21 @@ g_slice_free_chain_with_offset (gsize    mem_size,
           thread_memory_magazine2_free (tmem, ix, current);
         }
     }
+  else if (acat == 3)                   /* allocate through arena allocator */
+    {
+      ThreadMemory *tmem = thread_memory_from_self();
+      while (slice)
+        {
+          guint8 *current = slice;
+          slice = *(gpointer*) (current + next_offset);
+          if (G_UNLIKELY (allocator->config.debug_blocks) &&
+              !smc_notify_free (current, mem_size))
+            abort();
+          if (G_UNLIKELY (g_mem_gc_friendly))
+            memset (current, 0, chunk_size);
+          arena_free (tmem, chunk_size, current);
+        }
+    }
   else if (acat == 2)                   /* allocate through slab allocator */
     {
       g_mutex_lock (&allocator->slab_mutex);
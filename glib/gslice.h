@@ -95,7 +95,9 @@ typedef enum {
   G_SLICE_CONFIG_WORKING_SET_MSECS,
   G_SLICE_CONFIG_COLOR_INCREMENT,
   G_SLICE_CONFIG_CHUNK_SIZES,
-  G_SLICE_CONFIG_CONTENTION_COUNTER
+  G_SLICE_CONFIG_CONTENTION_COUNTER,
+  G_SLICE_CONFIG_ARENA,
+  G_SLICE_CONFIG_ARENA_STATISTICS
 } GSliceConfig;
 
 GLIB_DEPRECATED_IN_2_34
@@ -29,6 +29,7 @@
 #include "gasyncqueue.h"
 #include "gasyncqueueprivate.h"
 #include "gmain.h"
+#include "gqueue.h"
 #include "gtestutils.h"
 #include "gthreadprivate.h"
 #include "gtimer.h"
@@ -69,12 +70,20 @@
  * controlled by g_thread_pool_get_max_unused_threads() and
  * g_thread_pool_set_max_unused_threads(). All currently unused threads
  * can be stopped by calling g_thread_pool_stop_unused_threads().
+ *
+ * All threads of a pool normally take their tasks from a single queue,
+ * which becomes a point of contention when there are many threads and
+ * the tasks are short. Exclusive pools created with
+ * g_thread_pool_new_with_flags() and %G_THREAD_POOL_FLAGS_WORK_STEALING
+ * instead give every thread its own queue and let idle threads steal
+ * work from busy ones.
  */
 
 #define DEBUG_MSG(x)
 /* #define DEBUG_MSG(args) g_printerr args ; g_printerr ("\n");    */
 
 typedef struct _GRealThreadPool GRealThreadPool;
+typedef struct _GThreadPoolWorker GThreadPoolWorker;
 
 /**
  * GThreadPool:
@@ -98,8 +107,34 @@ struct _GRealThreadPool
   gboolean waiting;
   GCompareDataFunc sort_func;
   gpointer sort_user_data;
+
+  /* Only used by %G_THREAD_POOL_FLAGS_WORK_STEALING pools, which have
+   * one worker per thread, see g_thread_pool_new_with_flags(). The
+   * tasks are in the queues of the workers rather than in @queue,
+   * whose mutex still protects the state of the pool above.
+   */
+  GThreadPoolWorker **workers;
+  guint n_workers;
+  gint next_worker;      /* (atomic) */
+  gint n_unprocessed;    /* (atomic) */
+  gint n_sleeping;       /* (atomic) */
+  guint n_waking;
+  GCond work_cond;
+};
+
+struct _GThreadPoolWorker
+{
+  GRealThreadPool *pool;
+  guint index;
+  GMutex mutex;
+  GQueue tasks;
 };
 
+/* The worker the current thread runs, if it belongs to a work-stealing
+ * pool.
+ */
+static GPrivate current_worker;
+
 /* The following is just an address to mark the wakeup order for a
  * thread, it could be any address (as long, as it isn't a valid
  * GThreadPool address)
@@ -131,12 +166,16 @@ static GAsyncQueue *spawn_thread_queue;
 static void             g_thread_pool_queue_push_unlocked (GRealThreadPool  *pool,
                                                            gpointer          data);
 static void             g_thread_pool_free_internal       (GRealThreadPool  *pool);
+static void             g_thread_pool_free_work_stealing  (GRealThreadPool  *pool,
+                                                           gboolean          immediate,
+                                                           gboolean          wait_);
 static gpointer         g_thread_pool_thread_proxy        (gpointer          data);
 static gboolean         g_thread_pool_start_thread        (GRealThreadPool  *pool,
                                                            GError          **error);
 static void             g_thread_pool_wakeup_and_stop_all (GRealThreadPool  *pool);
 static GRealThreadPool* g_thread_pool_wait_for_new_pool   (void);
 static gpointer         g_thread_pool_wait_for_new_task   (GRealThreadPool  *pool);
+static gpointer         g_thread_pool_worker_proxy        (gpointer          data);
 
 static void
 g_thread_pool_queue_push_unlocked (GRealThreadPool *pool,
@@ -426,6 +465,177 @@ g_thread_pool_thread_proxy (gpointer data)
   return NULL;
 }
 
+/* Like g_queue_insert_sorted(), but after the tasks comparing equal to
+ * @data, so that these are still processed in the order they were pushed.
+ */
+static void
+g_thread_pool_queue_insert_sorted (GQueue           *queue,
+                                   gpointer          data,
+                                   GCompareDataFunc  func,
+                                   gpointer          user_data)
+{
+  GList *link = queue->tail;
+
+  while (link != NULL && func (link->data, data, user_data) > 0)
+    link = link->prev;
+
+  if (link != NULL)
+    g_queue_insert_after (queue, link, data);
+  else
+    g_queue_push_head (queue, data);
+}
+
+/* Tasks pushed from a task stay with the worker running it, as they
+ * likely work on data it has just touched. The others are spread over
+ * all workers.
+ */
+static GThreadPoolWorker *
+g_thread_pool_get_worker (GRealThreadPool *pool)
+{
+  GThreadPoolWorker *worker = g_private_get (&current_worker);
+  guint next;
+
+  if (worker != NULL && worker->pool == pool)
+    return worker;
+
+  next = (guint) g_atomic_int_add (&pool->next_worker, 1);
+
+  return pool->workers[next % pool->n_workers];
+}
+
+static void
+g_thread_pool_worker_push (GThreadPoolWorker *worker,
+                           gpointer           data)
+{
+  GRealThreadPool *pool = worker->pool;
+
+  g_mutex_lock (&worker->mutex);
+
+  if (pool->sort_func)
+    g_thread_pool_queue_insert_sorted (&worker->tasks, data,
+                                       pool->sort_func,
+                                       pool->sort_user_data);
+  else
+    g_queue_push_tail (&worker->tasks, data);
+
+  g_atomic_int_inc (&pool->n_unprocessed);
+
+  g_mutex_unlock (&worker->mutex);
+
+  /* Either a worker going to sleep in g_thread_pool_worker_next_task()
+   * sees the task in @n_unprocessed, or we see it in @n_sleeping here
+   * and wake it up once it waits. Workers already woken up will look
+   * for the task anyway, so they don't need to be woken up again.
+   */
+  if (g_atomic_int_get (&pool->n_sleeping) > 0)
+    {
+      g_async_queue_lock (pool->queue);
+
+      if ((guint) g_atomic_int_get (&pool->n_sleeping) > pool->n_waking)
+        {
+          pool->n_waking++;
+          g_cond_signal (&pool->work_cond);
+        }
+
+      g_async_queue_unlock (pool->queue);
+    }
+}
+
+static gpointer
+g_thread_pool_worker_pop (GThreadPoolWorker *worker)
+{
+  gpointer task;
+
+  g_mutex_lock (&worker->mutex);
+
+  task = g_queue_pop_head (&worker->tasks);
+  if (task != NULL)
+    g_atomic_int_add (&worker->pool->n_unprocessed, -1);
+
+  g_mutex_unlock (&worker->mutex);
+
+  return task;
+}
+
+static gpointer
+g_thread_pool_worker_next_task (GThreadPoolWorker *worker)
+{
+  GRealThreadPool *pool = worker->pool;
+
+  while (!g_atomic_int_get (&pool->immediate))
+    {
+      gpointer task;
+      guint i;
+
+      task = g_thread_pool_worker_pop (worker);
+
+      /* Steal from the other workers, starting with the next one */
+      for (i = 1; task == NULL && i < pool->n_workers; i++)
+        task = g_thread_pool_worker_pop (pool->workers[(worker->index + i) % pool->n_workers]);
+
+      if (task != NULL)
+        return task;
+
+      g_async_queue_lock (pool->queue);
+
+      if (!pool->running && g_atomic_int_get (&pool->n_unprocessed) <= 0)
+        {
+          /* The pool is being freed and everything was processed */
+          g_async_queue_unlock (pool->queue);
+          break;
+        }
+
+      g_atomic_int_inc (&pool->n_sleeping);
+
+      if (pool->running && g_atomic_int_get (&pool->n_unprocessed) <= 0)
+        {
+          g_cond_wait (&pool->work_cond, _g_async_queue_get_mutex (pool->queue));
+
+          if (pool->n_waking > 0)
+            pool->n_waking--;
+        }
+
+      g_atomic_int_add (&pool->n_sleeping, -1);
+
+      g_async_queue_unlock (pool->queue);
+    }
+
+  return NULL;
+}
+
+static gpointer
+g_thread_pool_worker_proxy (gpointer data)
+{
+  GThreadPoolWorker *worker = data;
+  GRealThreadPool *pool = worker->pool;
+  gboolean free_pool = FALSE;
+  gpointer task;
+
+  g_private_set (&current_worker, worker);
+
+  while ((task = g_thread_pool_worker_next_task (worker)) != NULL)
+    pool->pool.func (task, pool->pool.user_data);
+
+  g_private_set (&current_worker, NULL);
+
+  g_async_queue_lock (pool->queue);
+
+  pool->num_threads--;
+
+  if (pool->waiting)
+    g_cond_broadcast (&pool->cond);
+  else
+    free_pool = pool->num_threads == 0;
+
+  g_async_queue_unlock (pool->queue);
+
+  /* The last thread cleans up when g_thread_pool_free() didn't wait */
+  if (free_pool)
+    g_thread_pool_free_internal (pool);
+
+  return NULL;
+}
+
 static gboolean
 g_thread_pool_start_thread (GRealThreadPool  *pool,
                             GError          **error)
@@ -436,15 +646,21 @@ g_thread_pool_start_thread (GRealThreadPool  *pool,
     /* Enough threads are already running */
     return TRUE;
 
-  g_async_queue_lock (unused_thread_queue);
-
-  if (g_async_queue_length_unlocked (unused_thread_queue) < 0)
+  /* The threads of a work-stealing pool each run their own worker, so
+   * they can't be taken from the unused ones.
+   */
+  if (pool->workers == NULL)
     {
-      g_async_queue_push_unlocked (unused_thread_queue, pool);
-      success = TRUE;
-    }
+      g_async_queue_lock (unused_thread_queue);
+
+      if (g_async_queue_length_unlocked (unused_thread_queue) < 0)
+        {
+          g_async_queue_push_unlocked (unused_thread_queue, pool);
+          success = TRUE;
+        }
 
-  g_async_queue_unlock (unused_thread_queue);
+      g_async_queue_unlock (unused_thread_queue);
+    }
 
   if (!success)
     {
@@ -456,7 +672,12 @@ g_thread_pool_start_thread (GRealThreadPool  *pool,
         g_snprintf (name, sizeof (name), "pool-%s", prgname);
 
       /* No thread was found, we have to start a new one */
-      if (pool->pool.exclusive)
+      if (pool->workers != NULL)
+        {
+          thread = g_thread_try_new (name, g_thread_pool_worker_proxy,
+                                     pool->workers[pool->num_threads], error);
+        }
+      else if (pool->pool.exclusive)
         {
           /* For exclusive thread-pools this is directly called from new() and
            * we simply start new threads that inherit the scheduler settings
@@ -558,6 +779,56 @@ g_thread_pool_new (GFunc      func,
                    gint       max_threads,
                    gboolean   exclusive,
                    GError   **error)
+{
+  return g_thread_pool_new_with_flags (func, user_data, max_threads, exclusive,
+                                       G_THREAD_POOL_FLAGS_NONE, error);
+}
+
+/**
+ * g_thread_pool_new_with_flags:
+ * @func: a function to execute in the threads of the new thread pool
+ * @user_data: user data that is handed over to @func every time it
+ *     is called
+ * @max_threads: the maximal number of threads to execute concurrently
+ *     in  the new thread pool, -1 means no limit
+ * @exclusive: should this thread pool be exclusive?
+ * @flags: a bitwise-OR combination of #GThreadPoolFlags flags that can
+ *     only be set at creation time
+ * @error: return location for error, or %NULL
+ *
+ * This function creates a new thread pool, like g_thread_pool_new().
+ *
+ * With %G_THREAD_POOL_FLAGS_WORK_STEALING, each of the @max_threads
+ * threads of the pool has its own queue of tasks. Tasks pushed from
+ * @func go to the queue of the thread running it, and the others are
+ * spread over all threads in turn. A thread whose queue is empty takes
+ * the next task from the queue of another thread, so that threads only
+ * contend with each other when they run out of work. This is only
+ * possible for exclusive pools, so @exclusive must be %TRUE and
+ * @max_threads must be positive.
+ *
+ * Since tasks are no longer in a single queue, some behaviour of these
+ * pools differs:
+ *
+ * - a sort function set with g_thread_pool_set_sort_function() only
+ *   orders the tasks within the queue of each thread, so a task may be
+ *   processed before a task of higher priority queued on another thread;
+ * - g_thread_pool_move_to_front() moves a task to the front of the queue
+ *   it is in, so it is the next task of that thread rather than of the pool;
+ * - the number of threads is fixed, and g_thread_pool_set_max_threads()
+ *   can't change it.
+ *
+ * Returns: the new #GThreadPool
+ *
+ * Since: 2.68
+ */
+GThreadPool *
+g_thread_pool_new_with_flags (GFunc              func,
+                              gpointer           user_data,
+                              gint               max_threads,
+                              gboolean           exclusive,
+                              GThreadPoolFlags   flags,
+                              GError           **error)
 {
   GRealThreadPool *retval;
   G_LOCK_DEFINE_STATIC (init);
@@ -565,6 +836,8 @@ g_thread_pool_new (GFunc      func,
   g_return_val_if_fail (func, NULL);
   g_return_val_if_fail (!exclusive || max_threads != -1, NULL);
   g_return_val_if_fail (max_threads >= -1, NULL);
+  g_return_val_if_fail (!(flags & G_THREAD_POOL_FLAGS_WORK_STEALING) ||
+                        (exclusive && max_threads > 0), NULL);
 
   retval = g_new (GRealThreadPool, 1);
 
@@ -580,6 +853,33 @@ g_thread_pool_new (GFunc      func,
   retval->waiting = FALSE;
   retval->sort_func = NULL;
   retval->sort_user_data = NULL;
+  retval->workers = NULL;
+  retval->n_workers = 0;
+  retval->next_worker = 0;
+  retval->n_unprocessed = 0;
+  retval->n_sleeping = 0;
+  retval->n_waking = 0;
+  g_cond_init (&retval->work_cond);
+
+  if (flags & G_THREAD_POOL_FLAGS_WORK_STEALING)
+    {
+      guint i;
+
+      retval->n_workers = max_threads;
+      retval->workers = g_new (GThreadPoolWorker *, retval->n_workers);
+
+      for (i = 0; i < retval->n_workers; i++)
+        {
+          GThreadPoolWorker *worker = g_new0 (GThreadPoolWorker, 1);
+
+          worker->pool = retval;
+          worker->index = i;
+          g_mutex_init (&worker->mutex);
+          g_queue_init (&worker->tasks);
+
+          retval->workers[i] = worker;
+        }
+    }
 
   G_LOCK (init);
   if (!unused_thread_queue)
@@ -679,6 +979,16 @@ g_thread_pool_push (GThreadPool  *pool,
   g_return_val_if_fail (real, FALSE);
   g_return_val_if_fail (real->running, FALSE);
 
+  if (real->workers != NULL)
+    {
+      g_return_val_if_fail (data != NULL, FALSE);
+
+      /* All threads were started in g_thread_pool_new_with_flags() */
+      g_thread_pool_worker_push (g_thread_pool_get_worker (real), data);
+
+      return TRUE;
+    }
+
   result = TRUE;
 
   g_async_queue_lock (real->queue);
@@ -727,6 +1037,9 @@ g_thread_pool_push (GThreadPool  *pool,
  * errors. An error can only occur when a new thread couldn't be
  * created.
  *
+ * The number of threads of a pool created with
+ * %G_THREAD_POOL_FLAGS_WORK_STEALING can't be changed.
+ *
  * Before version 2.32, this function did not return a success status.
  *
  * Returns: %TRUE on success, %FALSE if an error occurred
@@ -746,6 +1059,8 @@ g_thread_pool_set_max_threads (GThreadPool  *pool,
   g_return_val_if_fail (real->running, FALSE);
   g_return_val_if_fail (!real->pool.exclusive || max_threads != -1, FALSE);
   g_return_val_if_fail (max_threads >= -1, FALSE);
+  g_return_val_if_fail (real->workers == NULL ||
+                        max_threads == real->max_threads, FALSE);
 
   result = TRUE;
 
@@ -846,7 +1161,10 @@ g_thread_pool_unprocessed (GThreadPool *pool)
   g_return_val_if_fail (real, 0);
   g_return_val_if_fail (real->running, 0);
 
-  unprocessed = g_async_queue_length (real->queue);
+  if (real->workers != NULL)
+    unprocessed = g_atomic_int_get (&real->n_unprocessed);
+  else
+    unprocessed = g_async_queue_length (real->queue);
 
   return MAX (unprocessed, 0);
 }
@@ -891,6 +1209,12 @@ g_thread_pool_free (GThreadPool *pool,
                     real->max_threads != 0 ||
                     g_async_queue_length (real->queue) == 0);
 
+  if (real->workers != NULL)
+    {
+      g_thread_pool_free_work_stealing (real, immediate, wait_);
+      return;
+    }
+
   g_async_queue_lock (real->queue);
 
   real->running = FALSE;
@@ -925,15 +1249,60 @@ g_thread_pool_free (GThreadPool *pool,
   g_async_queue_unlock (real->queue);
 }
 
+static void
+g_thread_pool_free_work_stealing (GRealThreadPool *pool,
+                                  gboolean         immediate,
+                                  gboolean         wait_)
+{
+  g_async_queue_lock (pool->queue);
+
+  pool->running = FALSE;
+  pool->waiting = wait_;
+  g_atomic_int_set (&pool->immediate, immediate);
+
+  /* Let sleeping threads stop, or finish the remaining tasks */
+  g_cond_broadcast (&pool->work_cond);
+
+  if (wait_)
+    {
+      while (pool->num_threads > 0)
+        g_cond_wait (&pool->cond, _g_async_queue_get_mutex (pool->queue));
+    }
+
+  if (pool->num_threads == 0)
+    {
+      g_async_queue_unlock (pool->queue);
+      g_thread_pool_free_internal (pool);
+      return;
+    }
+
+  /* The last thread should cleanup the pool */
+  g_async_queue_unlock (pool->queue);
+}
+
 static void
 g_thread_pool_free_internal (GRealThreadPool* pool)
 {
+  guint i;
+
   g_return_if_fail (pool);
   g_return_if_fail (pool->running == FALSE);
   g_return_if_fail (pool->num_threads == 0);
 
+  for (i = 0; i < pool->n_workers; i++)
+    {
+      GThreadPoolWorker *worker = pool->workers[i];
+
+      /* Only left when the pool was freed immediately */
+      g_queue_clear (&worker->tasks);
+      g_mutex_clear (&worker->mutex);
+      g_free (worker);
+    }
+
+  g_free (pool->workers);
   g_async_queue_unref (pool->queue);
   g_cond_clear (&pool->cond);
+  g_cond_clear (&pool->work_cond);
 
   g_free (pool);
 }
@@ -1057,6 +1426,10 @@ g_thread_pool_stop_unused_threads (void)
  * tasks to be processed by a priority determined by @func, and not
  * just in the order in which they were added to the pool.
  *
+ * In a pool created with %G_THREAD_POOL_FLAGS_WORK_STEALING, @func only
+ * orders the tasks queued on each thread, see
+ * g_thread_pool_new_with_flags().
+ *
  * Note, if the maximum number of threads is more than 1, the order
  * that threads are executed cannot be guaranteed 100%. Threads are
  * scheduled by the operating system and are executed at random. It
@@ -1077,6 +1450,27 @@ g_thread_pool_set_sort_function (GThreadPool      *pool,
   g_return_if_fail (real);
   g_return_if_fail (real->running);
 
+  if (real->workers != NULL)
+    {
+      guint i;
+
+      /* The workers read the sort function with their own lock held */
+      for (i = 0; i < real->n_workers; i++)
+        g_mutex_lock (&real->workers[i]->mutex);
+
+      real->sort_func = func;
+      real->sort_user_data = user_data;
+
+      for (i = 0; i < real->n_workers; i++)
+        {
+          if (func)
+            g_queue_sort (&real->workers[i]->tasks, func, user_data);
+          g_mutex_unlock (&real->workers[i]->mutex);
+        }
+
+      return;
+    }
+
   g_async_queue_lock (real->queue);
 
   real->sort_func = func;
@@ -1098,6 +1492,10 @@ g_thread_pool_set_sort_function (GThreadPool      *pool,
  * Moves the item to the front of the queue of unprocessed
  * items, so that it will be processed next.
  *
+ * In a pool created with %G_THREAD_POOL_FLAGS_WORK_STEALING, the item
+ * is moved to the front of the queue of the thread it was pushed to,
+ * see g_thread_pool_new_with_flags().
+ *
  * Returns: %TRUE if the item was found and moved
  *
  * Since: 2.46
@@ -1109,6 +1507,33 @@ g_thread_pool_move_to_front (GThreadPool *pool,
   GRealThreadPool *real = (GRealThreadPool*) pool;
   gboolean found;
 
+  if (real->workers != NULL)
+    {
+      guint i;
+
+      found = FALSE;
+
+      for (i = 0; i < real->n_workers && !found; i++)
+        {
+          GThreadPoolWorker *worker = real->workers[i];
+          GList *link;
+
+          g_mutex_lock (&worker->mutex);
+
+          link = g_queue_find (&worker->tasks, data);
+          if (link != NULL)
+            {
+              g_queue_unlink (&worker->tasks, link);
+              g_queue_push_head_link (&worker->tasks, link);
+              found = TRUE;
+            }
+
+          g_mutex_unlock (&worker->mutex);
+        }
+
+      return found;
+    }
+
   g_async_queue_lock (real->queue);
 
   found = g_async_queue_remove_unlocked (real->queue, data);
@@ -45,12 +45,41 @@ struct _GThreadPool
   gboolean exclusive;
 };
 
+/**
+ * GThreadPoolFlags:
+ * @G_THREAD_POOL_FLAGS_NONE: Default behaviour.
+ * @G_THREAD_POOL_FLAGS_WORK_STEALING: Give each thread of an exclusive
+ *     pool its own queue of tasks, and let idle threads steal tasks from
+ *     the queues of busy ones, instead of having all threads take their
+ *     tasks from one shared queue. See g_thread_pool_new_with_flags().
+ *
+ * Flags to pass to g_thread_pool_new_with_flags() which affect the
+ * behaviour of a #GThreadPool.
+ *
+ * Since: 2.68
+ */
+GLIB_AVAILABLE_TYPE_IN_2_68
+typedef enum /*< flags >*/
+{
+  G_THREAD_POOL_FLAGS_NONE = 0,
+  G_THREAD_POOL_FLAGS_WORK_STEALING = 1 << 0
+} GThreadPoolFlags;
+
 GLIB_AVAILABLE_IN_ALL
 GThreadPool *   g_thread_pool_new               (GFunc            func,
                                                  gpointer         user_data,
                                                  gint             max_threads,
                                                  gboolean         exclusive,
                                                  GError         **error);
+G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+GLIB_AVAILABLE_IN_2_68
+GThreadPool *   g_thread_pool_new_with_flags    (GFunc            func,
+                                                 gpointer         user_data,
+                                                 gint             max_threads,
+                                                 gboolean         exclusive,
+                                                 GThreadPoolFlags flags,
+                                                 GError         **error);
+G_GNUC_END_IGNORE_DEPRECATIONS
 GLIB_AVAILABLE_IN_ALL
 void            g_thread_pool_free              (GThreadPool     *pool,
                                                  gboolean         immediate,
@@ -25,6 +25,15 @@
 #endif
 #include <string.h>
 
+#if defined (__SSE2__)
+#include <emmintrin.h>
+#elif defined (__aarch64__) && defined (__ARM_NEON)
+#include <arm_neon.h>
+#endif
+#ifdef HAVE_AVX2_TARGET
+#include <immintrin.h>
+#endif
+
 #ifdef G_PLATFORM_WIN32
 #include <stdio.h>
 #define STRICT
@@ -1481,98 +1490,300 @@ g_ucs4_to_utf16 (const gunichar  *str,
   return result;
 }
 
-#define VALIDATE_BYTE(mask, expect)                      \
-  G_STMT_START {                                         \
-    if (G_UNLIKELY((*(guchar *)p & (mask)) != (expect))) \
-      goto error;                                        \
-  } G_STMT_END
+/* Runs of ASCII are skipped a block at a time before falling back to the
+ * byte-at-a-time loops below. A block is only skipped if none of its bytes
+ * has the high bit set or is nul, as nul ends the text in g_utf8_validate()
+ * and is invalid in g_utf8_validate_len().
+ */
+#if defined (__SSE2__)
 
-/* see IETF RFC 3629 Section 4 */
+#define UTF8_ASCII_BLOCK_SIZE 16
 
-static const gchar *
-fast_validate (const char *str)
+static inline gboolean
+utf8_block_is_ascii (const gchar *p)
+{
+  __m128i block = _mm_loadu_si128 ((const __m128i *) p);
+  __m128i nul = _mm_cmpeq_epi8 (block, _mm_setzero_si128 ());
+
+  return _mm_movemask_epi8 (_mm_or_si128 (block, nul)) == 0;
+}
+
+#elif defined (__aarch64__) && defined (__ARM_NEON)
+
+#define UTF8_ASCII_BLOCK_SIZE 16
+
+static inline gboolean
+utf8_block_is_ascii (const gchar *p)
+{
+  uint8x16_t block = vld1q_u8 ((const guint8 *) p);
+
+  return vmaxvq_u8 (block) < 0x80 && vminvq_u8 (block) != 0;
+}
+
+#else
+
+#define UTF8_ASCII_BLOCK_SIZE GLIB_SIZEOF_SIZE_T
+
+static inline gboolean
+utf8_block_is_ascii (const gchar *p)
+{
+  const gsize ones = (gsize) -1 / 0xff;
+  const gsize highs = ones << 7;
+  gsize word;
+
+  memcpy (&word, p, sizeof (word));
+
+  /* Subtracting one from a nul byte sets its high bit, and doesn't borrow
+   * from the neighbouring bytes unless an earlier byte was nul already */
+  return ((word | (word - ones)) & highs) == 0;
+}
+
+#endif
+
+static inline gsize
+utf8_ascii_run (const gchar *p,
+                gsize        len)
+{
+  gsize n = 0;
+
+  while (len - n >= UTF8_ASCII_BLOCK_SIZE && utf8_block_is_ascii (p + n))
+    n += UTF8_ASCII_BLOCK_SIZE;
+
+  return n;
+}
+
+#ifdef HAVE_AVX2_TARGET
 
+/* Validation of whole blocks of 32 bytes with AVX2, following
+ * "Validating UTF-8 In Less Than One Instruction Per Byte" by
+ * John Keiser and Daniel Lemire. Each byte is classified by its own high
+ * nibble and the two nibbles of the byte before it, and the three lookups
+ * are combined so that a non-zero bit is left for any invalid pair. The
+ * only errors spanning more than two bytes are missing or extra third and
+ * fourth continuation bytes, which are checked separately.
+ *
+ * The kernel only tells us whether a block is valid, so on the first
+ * invalid block (or on a nul) it stops and leaves finding the exact
+ * position to the scalar loop.
+ */
+
+#define UTF8_AVX2_BLOCK_SIZE 32
+
+#define UTF8_TOO_SHORT   (1 << 0)  /* lead byte or ASCII followed by lead byte or ASCII */
+#define UTF8_TOO_LONG    (1 << 1)  /* ASCII followed by continuation */
+#define UTF8_OVERLONG_3  (1 << 2)
+#define UTF8_TOO_LARGE   (1 << 3)
+#define UTF8_SURROGATE   (1 << 4)
+#define UTF8_OVERLONG_2  (1 << 5)
+#define UTF8_TOO_LARGE_1000 (1 << 6)
+#define UTF8_OVERLONG_4  (1 << 6)
+#define UTF8_TWO_CONTS   (1 << 7)  /* continuation followed by continuation */
+#define UTF8_CARRY       (UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS)
+
+#define UTF8_LOOKUP_TABLE(a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p) \
+  _mm256_setr_epi8 (a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p,       \
+                    a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p)
+
+/* Shift the 32 bytes of @input right by @n bytes, shifting in the last
+ * bytes of @prev */
+#define UTF8_PREV(input, prev, n) \
+  _mm256_alignr_epi8 ((input), _mm256_permute2x128_si256 ((prev), (input), 0x21), 16 - (n))
+
+__attribute__ ((target ("avx2")))
+static inline __m256i
+utf8_avx2_lookup (__m256i table,
+                  __m256i nibbles)
 {
+  return _mm256_shuffle_epi8 (table, nibbles);
+}
+
+__attribute__ ((target ("avx2")))
+static const gchar *
+fast_validate_len_avx2 (const gchar *str,
+                        gsize        max_len)
+{
+  const __m256i low_nibble = _mm256_set1_epi8 (0x0f);
+  const __m256i byte_1_high_table = UTF8_LOOKUP_TABLE (
+    /* 0_______ ________ ASCII in byte 1 */
+    UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+    UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+    /* 10______ ________ continuation in byte 1 */
+    UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS,
+    /* 1100____ ________ two byte lead in byte 1 */
+    UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+    /* 1101____ ________ two byte lead in byte 1 */
+    UTF8_TOO_SHORT,
+    /* 1110____ ________ three byte lead in byte 1 */
+    UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+    /* 1111____ ________ four byte lead in byte 1 */
+    UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4);
+  const __m256i byte_1_low_table = UTF8_LOOKUP_TABLE (
+    /* ____0000 ________ */
+    UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+    /* ____0001 ________ */
+    UTF8_CARRY | UTF8_OVERLONG_2,
+    /* ____001_ ________ */
+    UTF8_CARRY,
+    UTF8_CARRY,
+    /* ____0100 ________ */
+    UTF8_CARRY | UTF8_TOO_LARGE,
+    /* ____0101 ________ */
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    /* ____011_ ________ */
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    /* ____1___ ________ */
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    /* ____1101 ________ */
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000);
+  const __m256i byte_2_high_table = UTF8_LOOKUP_TABLE (
+    /* ________ 0_______ ASCII in byte 2 */
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+    /* ________ 1000____ */
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+    /* ________ 1001____ */
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE,
+    /* ________ 101_____ */
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+    /* ________ 11______ lead byte in byte 2 */
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT);
+  /* Lead bytes in the last three positions that need more bytes than
+   * there are left in the block */
+  const __m256i incomplete_max = _mm256_setr_epi8 (
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    (gchar) (0xf0 - 1), (gchar) (0xe0 - 1), (gchar) (0xc0 - 1));
+  __m256i prev_input = _mm256_setzero_si256 ();
+  __m256i prev_incomplete = _mm256_setzero_si256 ();
   const gchar *p;
 
-  for (p = str; *p; p++)
+  for (p = str; max_len - (p - str) >= UTF8_AVX2_BLOCK_SIZE; p += UTF8_AVX2_BLOCK_SIZE)
     {
-      if (*(guchar *)p < 128)
-	/* done */;
-      else 
-	{
-	  const gchar *last;
+      __m256i input = _mm256_loadu_si256 ((const __m256i *) p);
+      __m256i error = _mm256_cmpeq_epi8 (input, _mm256_setzero_si256 ());
 
-	  last = p;
-	  if (*(guchar *)p < 0xe0) /* 110xxxxx */
-	    {
-	      if (G_UNLIKELY (*(guchar *)p < 0xc2))
-		goto error;
-	    }
-	  else
-	    {
-	      if (*(guchar *)p < 0xf0) /* 1110xxxx */
-		{
-		  switch (*(guchar *)p++ & 0x0f)
-		    {
-		    case 0:
-		      VALIDATE_BYTE(0xe0, 0xa0); /* 0xa0 ... 0xbf */
-		      break;
-		    case 0x0d:
-		      VALIDATE_BYTE(0xe0, 0x80); /* 0x80 ... 0x9f */
-		      break;
-		    default:
-		      VALIDATE_BYTE(0xc0, 0x80); /* 10xxxxxx */
-		    }
-		}
-	      else if (*(guchar *)p < 0xf5) /* 11110xxx excluding out-of-range */
-		{
-		  switch (*(guchar *)p++ & 0x07)
-		    {
-		    case 0:
-		      VALIDATE_BYTE(0xc0, 0x80); /* 10xxxxxx */
-		      if (G_UNLIKELY((*(guchar *)p & 0x30) == 0))
-			goto error;
-		      break;
-		    case 4:
-		      VALIDATE_BYTE(0xf0, 0x80); /* 0x80 ... 0x8f */
-		      break;
-		    default:
-		      VALIDATE_BYTE(0xc0, 0x80); /* 10xxxxxx */
-		    }
-		  p++;
-		  VALIDATE_BYTE(0xc0, 0x80); /* 10xxxxxx */
-		}
-	      else
-		goto error;
-	    }
+      if (_mm256_movemask_epi8 (input) == 0)
+        {
+          /* An ASCII block is only invalid if the previous block ended
+           * in the middle of a character */
+          error = _mm256_or_si256 (error, prev_incomplete);
+        }
+      else
+        {
+          __m256i prev1 = UTF8_PREV (input, prev_input, 1);
+          __m256i prev2 = UTF8_PREV (input, prev_input, 2);
+          __m256i prev3 = UTF8_PREV (input, prev_input, 3);
+          __m256i byte_1_high, byte_1_low, byte_2_high;
+          __m256i special_cases, is_third_byte, is_fourth_byte, must_be_continuation;
+
+          byte_1_high = utf8_avx2_lookup (byte_1_high_table,
+                                          _mm256_and_si256 (_mm256_srli_epi16 (prev1, 4), low_nibble));
+          byte_1_low = utf8_avx2_lookup (byte_1_low_table,
+                                         _mm256_and_si256 (prev1, low_nibble));
+          byte_2_high = utf8_avx2_lookup (byte_2_high_table,
+                                          _mm256_and_si256 (_mm256_srli_epi16 (input, 4), low_nibble));
+          special_cases = _mm256_and_si256 (_mm256_and_si256 (byte_1_high, byte_1_low), byte_2_high);
+
+          /* Only bytes two or three after a three or four byte lead end up
+           * with the high bit set here, and those must be exactly the
+           * continuations following another continuation */
+          is_third_byte = _mm256_subs_epu8 (prev2, _mm256_set1_epi8 (0xe0 - 0x80));
+          is_fourth_byte = _mm256_subs_epu8 (prev3, _mm256_set1_epi8 (0xf0 - 0x80));
+          must_be_continuation = _mm256_and_si256 (_mm256_or_si256 (is_third_byte, is_fourth_byte),
+                                                   _mm256_set1_epi8 ((gchar) 0x80));
+
+          error = _mm256_or_si256 (error, _mm256_xor_si256 (must_be_continuation, special_cases));
+        }
 
-	  p++;
-	  VALIDATE_BYTE(0xc0, 0x80); /* 10xxxxxx */
+      if (!_mm256_testz_si256 (error, error))
+        break;
 
-	  continue;
+      prev_incomplete = _mm256_subs_epu8 (input, incomplete_max);
+      prev_input = input;
+    }
 
-	error:
-	  return last;
-	}
+  /* Avoid the penalty for mixing AVX with the SSE code that follows */
+  _mm256_zeroupper ();
+
+  /* Step back to the start of the last character before @p, which may be
+   * incomplete; everything before that is known to be valid */
+  while (p > str && *(guchar *)(p - 1) >= 0x80)
+    {
+      p--;
+      if (*(guchar *)p >= 0xc0)
+        break;
     }
 
   return p;
 }
 
+#undef UTF8_PREV
+#undef UTF8_LOOKUP_TABLE
+
+static gboolean
+utf8_have_avx2 (void)
+{
+  static gint have_avx2 = -1;  /* (atomic) */
+  gint result = g_atomic_int_get (&have_avx2);
+
+  if (G_UNLIKELY (result < 0))
+    {
+      __builtin_cpu_init ();
+      result = __builtin_cpu_supports ("avx2") ? 1 : 0;
+      g_atomic_int_set (&have_avx2, result);
+    }
+
+  return result;
+}
+
+#endif /* HAVE_AVX2_TARGET */
+
+#define VALIDATE_BYTE(mask, expect)                      \
+  G_STMT_START {                                         \
+    if (G_UNLIKELY((*(guchar *)p & (mask)) != (expect))) \
+      goto error;                                        \
+  } G_STMT_END
+
+/* see IETF RFC 3629 Section 4 */
+
 static const gchar *
 fast_validate_len (const char *str,
 		   gssize      max_len)
 
 {
-  const gchar *p;
+  const gchar *p = str;
+  const gchar *ascii_retry = str;
 
   g_assert (max_len >= 0);
 
-  for (p = str; ((p - str) < max_len) && *p; p++)
+#ifdef HAVE_AVX2_TARGET
+  if (max_len >= 2 * UTF8_AVX2_BLOCK_SIZE && utf8_have_avx2 ())
+    p = fast_validate_len_avx2 (str, max_len);
+#endif
+
+  for (; ((p - str) < max_len) && *p; p++)
     {
       if (*(guchar *)p < 128)
-	/* done */;
+        {
+          /* After a block that turns out not to be all ASCII, wait until
+           * we are past it before trying again */
+          if (p >= ascii_retry)
+            {
+              gsize n = utf8_ascii_run (p, max_len - (p - str));
+
+              ascii_retry = p + n + UTF8_ASCII_BLOCK_SIZE;
+              if (n > 0)
+                p += n - 1;
+            }
+        }
       else 
 	{
 	  const gchar *last;
@@ -1673,20 +1884,12 @@ g_utf8_validate (const char   *str,
 		 const gchar **end)
 
 {
-  const gchar *p;
-
   if (max_len >= 0)
     return g_utf8_validate_len (str, max_len, end);
 
-  p = fast_validate (str);
-
-  if (end)
-    *end = p;
-
-  if (*p != '\0')
-    return FALSE;
-  else
-    return TRUE;
+  /* Finding the length first lets the text be validated a block at a time
+   * without reading past the nul */
+  return g_utf8_validate_len (str, strlen (str), end);
 }
 
 /**
@@ -666,6 +666,21 @@ g_variant_is_trusted (GVariant *value)
   return (value->state & STATE_TRUSTED) != 0;
 }
 
+/* < internal >
+ * g_variant_is_serialised:
+ * @value: a #GVariant
+ *
+ * Checks if @value is in serialised form, so that g_variant_get_data()
+ * returns its data as it is, instead of serialising it first.
+ *
+ * Returns: if @value is in serialised form
+ */
+gboolean
+g_variant_is_serialised (GVariant *value)
+{
+  return (value->state & STATE_SERIALISED) != 0;
+}
+
 /* < internal >
  * g_variant_get_depth:
  * @value: a #GVariant
@@ -0,0 +1,136 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <glib.h>
+
+/* Bytes of binary data encoded or decoded in each case */
+#define TOTAL_BYTES (256 * 1024 * 1024)
+
+typedef enum {
+  OP_ENCODE,
+  OP_ENCODE_LINES,
+  OP_DECODE,
+  OP_DECODE_LINES,
+} Operation;
+
+typedef struct {
+  Operation op;
+  gsize size;
+} PerfData;
+
+static void
+perform (gconstpointer data)
+{
+  const PerfData *perf = data;
+  gboolean break_lines = (perf->op == OP_ENCODE_LINES || perf->op == OP_DECODE_LINES);
+  gsize n_iterations = MAX (TOTAL_BYTES / perf->size, 1);
+  gsize text_size = (perf->size / 3 + 1) * 4 + 4;
+  guchar *binary, *decoded;
+  gchar *text;
+  gsize text_len;
+  gint state = 0, save = 0;
+  gdouble time_elapsed;
+  gdouble result;
+  gsize i;
+
+  binary = g_malloc (perf->size);
+  for (i = 0; i < perf->size; i++)
+    binary[i] = g_test_rand_int_range (0, 256);
+
+  text_size += text_size / 76 + 1;
+  text = g_malloc (text_size);
+  decoded = g_malloc (perf->size + 3);
+
+  text_len = g_base64_encode_step (binary, perf->size, break_lines, text, &state, &save);
+  text_len += g_base64_encode_close (break_lines, text + text_len, &state, &save);
+
+  g_test_timer_start ();
+
+  for (i = 0; i < n_iterations; i++)
+    {
+      if (perf->op == OP_ENCODE || perf->op == OP_ENCODE_LINES)
+        {
+          gsize len;
+
+          state = save = 0;
+          len = g_base64_encode_step (binary, perf->size, break_lines, text, &state, &save);
+          g_base64_encode_close (break_lines, text + len, &state, &save);
+        }
+      else
+        {
+          guint decode_save = 0;
+
+          state = 0;
+          g_base64_decode_step (text, text_len, decoded, &state, &decode_save);
+        }
+    }
+
+  time_elapsed = g_test_timer_elapsed ();
+
+  if (perf->op == OP_DECODE || perf->op == OP_DECODE_LINES)
+    g_assert_cmpmem (binary, perf->size, decoded, perf->size);
+
+  g_free (decoded);
+  g_free (text);
+  g_free (binary);
+
+  result = ((gdouble) perf->size * n_iterations / time_elapsed) * 1.0e-6;
+
+  g_test_maximized_result (result, "%7.1f MB/s of binary data for %" G_GSIZE_FORMAT " bytes",
+                           result, perf->size);
+}
+
+static void
+add_cases (const char *path,
+           Operation   op)
+{
+  const gsize sizes[] = { 64, 1024, 64 * 1024, 1024 * 1024 };
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++)
+    {
+      PerfData *perf;
+      gchar *full_path;
+
+      perf = g_new0 (PerfData, 1);
+      perf->op = op;
+      perf->size = sizes[i];
+
+      full_path = g_strdup_printf ("%s/%" G_GSIZE_FORMAT, path, sizes[i]);
+      g_test_add_data_func_full (full_path, perf, perform, g_free);
+      g_free (full_path);
+    }
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  if (g_test_perf ())
+    {
+      add_cases ("/base64/perf/encode", OP_ENCODE);
+      add_cases ("/base64/perf/encode-lines", OP_ENCODE_LINES);
+      add_cases ("/base64/perf/decode", OP_DECODE);
+      add_cases ("/base64/perf/decode-lines", OP_DECODE_LINES);
+    }
+
+  return g_test_run ();
+}
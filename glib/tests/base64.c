@@ -486,6 +486,80 @@ test_base64_encode_decode_rfc4648 (void)
     }
 }
 
+/* Long enough to go through any vectorised code paths, with a line break
+ * every 76 characters */
+static void
+test_base64_encode_decode_lines (void)
+{
+  gsize length;
+
+  for (length = DATA_SIZE - 64; length <= DATA_SIZE; length++)
+    {
+      gsize max = (length / 3 + 1) * 4 + 4;
+      gchar *text = g_malloc (max + max / 76 + 1 + 1);
+      gchar **lines;
+      guchar *decoded;
+      gsize len, decoded_len;
+      gint state = 0, save = 0;
+      guint i;
+
+      len = g_base64_encode_step (data, length, TRUE, text, &state, &save);
+      len += g_base64_encode_close (TRUE, text + len, &state, &save);
+      text[len] = '\0';
+
+      lines = g_strsplit (text, "\n", -1);
+      for (i = 0; lines[i + 1] != NULL; i++)
+        {
+          if (lines[i + 2] != NULL)
+            g_assert_cmpuint (strlen (lines[i]), ==, 76);
+          else
+            g_assert_cmpuint (strlen (lines[i]), <=, 76);
+        }
+      g_assert_cmpstr (lines[i], ==, "");
+      g_strfreev (lines);
+
+      decoded = g_base64_decode (text, &decoded_len);
+      g_assert_cmpmem (data, length, decoded, decoded_len);
+      g_free (decoded);
+
+      decoded = g_base64_decode_inplace (text, &decoded_len);
+      g_assert_cmpmem (data, length, decoded, decoded_len);
+
+      g_free (text);
+    }
+}
+
+/* A single group decoded by the vectorised code path at the very start
+ * of the output, followed by a line break */
+static void
+test_base64_decode_single_group (void)
+{
+  const gchar *text = "QUJD\nQUJDREVGR0hJSktMTU5PUFFSU1RVVldYWVphYmNk";
+  const gchar *expected = "ABCABCDEFGHIJKLMNOPQRSTUVWXYZabcd";
+  guchar *decoded, *out;
+  gsize decoded_len, len, i;
+  gint state = 0, state_bytewise = 0;
+  guint save = 0, save_bytewise = 0;
+
+  decoded = g_base64_decode (text, &decoded_len);
+  g_assert_cmpmem (decoded, decoded_len, expected, strlen (expected));
+  g_free (decoded);
+
+  /* The state is left as if decoded one character at a time */
+  out = g_malloc (strlen (text) / 4 * 3 + 3);
+  len = g_base64_decode_step (text, strlen (text), out, &state, &save);
+  g_assert_cmpmem (out, len, expected, strlen (expected));
+
+  len = 0;
+  for (i = 0; text[i] != '\0'; i++)
+    len += g_base64_decode_step (text + i, 1, out + len, &state_bytewise, &save_bytewise);
+  g_assert_cmpmem (out, len, expected, strlen (expected));
+  g_assert_cmpint (state, ==, state_bytewise);
+  g_assert_cmpuint (save, ==, save_bytewise);
+
+  g_free (out);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -524,6 +598,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/base64/decode", test_base64_decode);
   g_test_add_func ("/base64/decode-inplace", test_base64_decode_inplace);
   g_test_add_func ("/base64/encode-decode", test_base64_encode_decode);
+  g_test_add_func ("/base64/encode-decode/lines", test_base64_encode_decode_lines);
+  g_test_add_func ("/base64/decode/single-group", test_base64_decode_single_group);
 
   g_test_add_data_func ("/base64/incremental/smallblock/1", GINT_TO_POINTER(1),
                         test_base64_decode_smallblock);
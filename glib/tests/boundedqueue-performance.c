@@ -0,0 +1,182 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+
+/* Items passed through the queue in each case, split between producers */
+#define NUM_ITEMS 1000000
+
+#define QUEUE_CAPACITY 1024
+
+typedef enum {
+  QUEUE_ASYNC,
+  QUEUE_BOUNDED
+} QueueType;
+
+typedef struct {
+  QueueType type;
+  guint n_producers;
+  guint n_consumers;
+} PerfData;
+
+typedef struct {
+  const PerfData *perf;
+  gpointer queue;
+  guint n_items;
+} ThreadData;
+
+static gpointer
+producer_thread (gpointer user_data)
+{
+  ThreadData *td = user_data;
+  guint i;
+
+  for (i = 0; i < td->n_items; i++)
+    {
+      if (td->perf->type == QUEUE_ASYNC)
+        g_async_queue_push (td->queue, GUINT_TO_POINTER (1));
+      else
+        g_bounded_queue_push (td->queue, GUINT_TO_POINTER (1));
+    }
+
+  return NULL;
+}
+
+static gpointer
+consumer_thread (gpointer user_data)
+{
+  ThreadData *td = user_data;
+  guint i;
+
+  for (i = 0; i < td->n_items; i++)
+    {
+      if (td->perf->type == QUEUE_ASYNC)
+        g_async_queue_pop (td->queue);
+      else
+        g_bounded_queue_pop (td->queue);
+    }
+
+  return NULL;
+}
+
+static void
+perform (gconstpointer data)
+{
+  const PerfData *perf = data;
+  guint n_threads = perf->n_producers + perf->n_consumers;
+  ThreadData *threads;
+  GThread **thread_ids;
+  gpointer queue;
+  gdouble time_elapsed;
+  gdouble result;
+  guint n_items;
+  guint i;
+
+  if (perf->type == QUEUE_ASYNC)
+    queue = g_async_queue_new ();
+  else
+    queue = g_bounded_queue_new (QUEUE_CAPACITY);
+
+  /* Make sure all consumers take as many items as the producers push */
+  n_items = NUM_ITEMS / (perf->n_producers * perf->n_consumers);
+  n_items *= perf->n_producers * perf->n_consumers;
+
+  threads = g_new0 (ThreadData, n_threads);
+  thread_ids = g_new0 (GThread *, n_threads);
+
+  g_test_timer_start ();
+
+  for (i = 0; i < n_threads; i++)
+    {
+      threads[i].perf = perf;
+      threads[i].queue = queue;
+
+      if (i < perf->n_consumers)
+        {
+          threads[i].n_items = n_items / perf->n_consumers;
+          thread_ids[i] = g_thread_new ("consumer", consumer_thread, &threads[i]);
+        }
+      else
+        {
+          threads[i].n_items = n_items / perf->n_producers;
+          thread_ids[i] = g_thread_new ("producer", producer_thread, &threads[i]);
+        }
+    }
+
+  for (i = 0; i < n_threads; i++)
+    g_thread_join (thread_ids[i]);
+
+  time_elapsed = g_test_timer_elapsed ();
+
+  if (perf->type == QUEUE_ASYNC)
+    g_async_queue_unref (queue);
+  else
+    g_bounded_queue_unref (queue);
+
+  g_free (thread_ids);
+  g_free (threads);
+
+  result = n_items / time_elapsed;
+
+  g_test_maximized_result (result, "%9.0f items/s with %u producers, %u consumers",
+                           result, perf->n_producers, perf->n_consumers);
+}
+
+static void
+add_cases (const char *path,
+           QueueType   type)
+{
+  guint n_processors = MAX (g_get_num_processors (), 2);
+  const guint n_threads[] = { 1, 2, n_processors / 2, n_processors };
+  guint last = 0;
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (n_threads); i++)
+    {
+      PerfData *perf;
+      gchar *full_path;
+
+      /* Don't run the same case twice on machines with few processors */
+      if (n_threads[i] <= last)
+        continue;
+      last = n_threads[i];
+
+      perf = g_new0 (PerfData, 1);
+      perf->type = type;
+      perf->n_producers = n_threads[i];
+      perf->n_consumers = n_threads[i];
+
+      full_path = g_strdup_printf ("%s/%u", path, n_threads[i]);
+      g_test_add_data_func_full (full_path, perf, perform, g_free);
+      g_free (full_path);
+    }
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  if (g_test_perf ())
+    {
+      add_cases ("/bounded-queue/perf/async-queue", QUEUE_ASYNC);
+      add_cases ("/bounded-queue/perf/bounded-queue", QUEUE_BOUNDED);
+    }
+
+  return g_test_run ();
+}
@@ -0,0 +1,255 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+
+static void
+test_bounded_queue_basic (void)
+{
+  GBoundedQueue *q;
+  gint i;
+
+  q = g_bounded_queue_new (3);
+  g_assert_cmpuint (g_bounded_queue_get_capacity (q), ==, 4);
+  g_assert_cmpuint (g_bounded_queue_length (q), ==, 0);
+  g_assert_null (g_bounded_queue_try_pop (q));
+
+  for (i = 1; i <= 4; i++)
+    g_assert_true (g_bounded_queue_try_push (q, GINT_TO_POINTER (i)));
+
+  g_assert_cmpuint (g_bounded_queue_length (q), ==, 4);
+  g_assert_false (g_bounded_queue_try_push (q, GINT_TO_POINTER (5)));
+
+  g_assert_cmpint (GPOINTER_TO_INT (g_bounded_queue_pop (q)), ==, 1);
+  g_assert_cmpint (GPOINTER_TO_INT (g_bounded_queue_try_pop (q)), ==, 2);
+
+  /* Wrap around the end of the ring a few times */
+  for (i = 5; i < 50; i++)
+    {
+      g_bounded_queue_push (q, GINT_TO_POINTER (i));
+      g_assert_cmpint (GPOINTER_TO_INT (g_bounded_queue_pop (q)), ==, i - 2);
+    }
+
+  g_assert_cmpuint (g_bounded_queue_length (q), ==, 2);
+  g_assert_cmpint (GPOINTER_TO_INT (g_bounded_queue_pop (q)), ==, 48);
+  g_assert_cmpint (GPOINTER_TO_INT (g_bounded_queue_pop (q)), ==, 49);
+  g_assert_null (g_bounded_queue_try_pop (q));
+
+  g_bounded_queue_ref (q);
+  g_bounded_queue_unref (q);
+  g_bounded_queue_unref (q);
+}
+
+static void
+test_bounded_queue_capacity (void)
+{
+  GBoundedQueue *q;
+
+  q = g_bounded_queue_new (1);
+  g_assert_cmpuint (g_bounded_queue_get_capacity (q), ==, 2);
+  g_assert_true (g_bounded_queue_try_push (q, GINT_TO_POINTER (1)));
+  g_assert_true (g_bounded_queue_try_push (q, GINT_TO_POINTER (2)));
+  g_assert_false (g_bounded_queue_try_push (q, GINT_TO_POINTER (3)));
+  g_assert_cmpint (GPOINTER_TO_INT (g_bounded_queue_try_pop (q)), ==, 1);
+  g_assert_true (g_bounded_queue_try_push (q, GINT_TO_POINTER (3)));
+  g_assert_cmpint (GPOINTER_TO_INT (g_bounded_queue_try_pop (q)), ==, 2);
+  g_assert_cmpint (GPOINTER_TO_INT (g_bounded_queue_try_pop (q)), ==, 3);
+  g_assert_null (g_bounded_queue_try_pop (q));
+  g_bounded_queue_unref (q);
+
+  q = g_bounded_queue_new (64);
+  g_assert_cmpuint (g_bounded_queue_get_capacity (q), ==, 64);
+  g_bounded_queue_unref (q);
+}
+
+static gint destroy_count;
+
+static void
+destroy_notify (gpointer item)
+{
+  destroy_count++;
+}
+
+static void
+test_bounded_queue_destroy (void)
+{
+  gchar item[] = "item";
+  GBoundedQueue *q;
+
+  destroy_count = 0;
+
+  q = g_bounded_queue_new_full (8, destroy_notify);
+  g_bounded_queue_push (q, item);
+  g_bounded_queue_push (q, item);
+  g_bounded_queue_push (q, item);
+  g_assert_true (g_bounded_queue_pop (q) == item);
+  g_bounded_queue_unref (q);
+
+  g_assert_cmpint (destroy_count, ==, 2);
+}
+
+static void
+test_bounded_queue_timed (void)
+{
+  GBoundedQueue *q;
+  gint64 start, end;
+
+  q = g_bounded_queue_new (2);
+
+  start = g_get_monotonic_time ();
+  g_assert_null (g_bounded_queue_timeout_pop (q, G_USEC_PER_SEC / 10));
+  end = g_get_monotonic_time ();
+  g_assert_cmpint (end - start, >=, G_USEC_PER_SEC / 10);
+
+  g_assert_true (g_bounded_queue_timeout_push (q, GINT_TO_POINTER (1), G_USEC_PER_SEC / 10));
+  g_assert_true (g_bounded_queue_timeout_push (q, GINT_TO_POINTER (2), G_USEC_PER_SEC / 10));
+
+  start = g_get_monotonic_time ();
+  g_assert_false (g_bounded_queue_timeout_push (q, GINT_TO_POINTER (3), G_USEC_PER_SEC / 10));
+  end = g_get_monotonic_time ();
+  g_assert_cmpint (end - start, >=, G_USEC_PER_SEC / 10);
+
+  g_assert_cmpint (GPOINTER_TO_INT (g_bounded_queue_timeout_pop (q, G_USEC_PER_SEC / 10)), ==, 1);
+  g_assert_cmpint (GPOINTER_TO_INT (g_bounded_queue_timeout_pop (q, G_USEC_PER_SEC / 10)), ==, 2);
+
+  g_bounded_queue_unref (q);
+}
+
+/* Producers and consumers are stalled by a small queue all the time, and
+ * every item must come out exactly once, in the order it was pushed by
+ * its producer.
+ */
+#define N_PRODUCERS 4
+#define N_CONSUMERS 4
+#define N_ITEMS 20000
+
+typedef struct {
+  GBoundedQueue *q;
+  guint id;
+  guint n_received[N_PRODUCERS];
+  gint last_received[N_PRODUCERS];
+} ThreadData;
+
+static gpointer
+producer_thread (gpointer user_data)
+{
+  ThreadData *td = user_data;
+  gint i;
+
+  for (i = 0; i < N_ITEMS; i++)
+    {
+      gint item = (i << 4) | td->id;
+
+      /* Mix the blocking and the timed variant */
+      if (i % 2 == 0)
+        g_bounded_queue_push (td->q, GINT_TO_POINTER (item + 1));
+      else
+        while (!g_bounded_queue_timeout_push (td->q, GINT_TO_POINTER (item + 1), 1000));
+    }
+
+  return NULL;
+}
+
+static gpointer
+consumer_thread (gpointer user_data)
+{
+  ThreadData *td = user_data;
+  gint i;
+
+  for (i = 0; i < N_PRODUCERS; i++)
+    td->last_received[i] = -1;
+
+  while (TRUE)
+    {
+      gint item = GPOINTER_TO_INT (g_bounded_queue_pop (td->q)) - 1;
+      guint producer = item & 0xf;
+
+      if (item < 0)
+        break;
+
+      g_assert_cmpuint (producer, <, N_PRODUCERS);
+      g_assert_cmpint (item >> 4, >, td->last_received[producer]);
+      td->last_received[producer] = item >> 4;
+      td->n_received[producer]++;
+    }
+
+  return NULL;
+}
+
+static void
+test_bounded_queue_threads (void)
+{
+  ThreadData producers[N_PRODUCERS] = { { 0, }, };
+  ThreadData consumers[N_CONSUMERS] = { { 0, }, };
+  GThread *producer_threads[N_PRODUCERS];
+  GThread *consumer_threads[N_CONSUMERS];
+  GBoundedQueue *q;
+  guint i, j;
+
+  q = g_bounded_queue_new (4);
+
+  for (i = 0; i < N_CONSUMERS; i++)
+    {
+      consumers[i].q = q;
+      consumer_threads[i] = g_thread_new ("consumer", consumer_thread, &consumers[i]);
+    }
+
+  for (i = 0; i < N_PRODUCERS; i++)
+    {
+      producers[i].q = q;
+      producers[i].id = i;
+      producer_threads[i] = g_thread_new ("producer", producer_thread, &producers[i]);
+    }
+
+  for (i = 0; i < N_PRODUCERS; i++)
+    g_thread_join (producer_threads[i]);
+
+  /* Tell each consumer to stop */
+  for (i = 0; i < N_CONSUMERS; i++)
+    g_bounded_queue_push (q, GINT_TO_POINTER (-1));
+
+  for (i = 0; i < N_CONSUMERS; i++)
+    g_thread_join (consumer_threads[i]);
+
+  for (j = 0; j < N_PRODUCERS; j++)
+    {
+      guint total = 0;
+
+      for (i = 0; i < N_CONSUMERS; i++)
+        total += consumers[i].n_received[j];
+
+      g_assert_cmpuint (total, ==, N_ITEMS);
+    }
+
+  g_assert_cmpuint (g_bounded_queue_length (q), ==, 0);
+  g_bounded_queue_unref (q);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/bounded-queue/basic", test_bounded_queue_basic);
+  g_test_add_func ("/bounded-queue/capacity", test_bounded_queue_capacity);
+  g_test_add_func ("/bounded-queue/destroy", test_bounded_queue_destroy);
+  g_test_add_func ("/bounded-queue/timed", test_bounded_queue_timed);
+  g_test_add_func ("/bounded-queue/threads", test_bounded_queue_threads);
+
+  return g_test_run ();
+}
@@ -0,0 +1,184 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+
+/* Bytes of data hashed in each case */
+#define TOTAL_BYTES (64 * 1024 * 1024)
+
+typedef enum {
+  OP_CHECKSUM,
+  OP_HMAC,
+  OP_DIGESTS_ONE_BY_ONE,
+  OP_DIGESTS,
+} Operation;
+
+typedef struct {
+  Operation op;
+  GChecksumType type;
+  gsize size;
+} PerfData;
+
+static const guchar hmac_key[] = "0123456789abcdef0123456789abcdef";
+
+/* The items for the multi-buffer cases are all @size bytes long, and
+ * packed in a buffer of this many bytes */
+#define DIGESTS_BUFFER_SIZE (64 * 1024)
+
+static void
+perform (gconstpointer data)
+{
+  const PerfData *perf = data;
+  gsize digest_len = g_checksum_type_get_length (perf->type);
+  gsize n_items = MAX (DIGESTS_BUFFER_SIZE / perf->size, 1);
+  gsize n_iterations;
+  const guchar **items;
+  gsize *lengths;
+  guchar *buffer;
+  guint8 *digests;
+  gdouble time_elapsed;
+  gdouble result;
+  gsize i, j;
+
+  buffer = g_malloc (MAX (perf->size, DIGESTS_BUFFER_SIZE));
+  for (i = 0; i < MAX (perf->size, DIGESTS_BUFFER_SIZE); i++)
+    buffer[i] = g_test_rand_int_range (0, 256);
+
+  items = g_new (const guchar *, n_items);
+  lengths = g_new (gsize, n_items);
+  for (i = 0; i < n_items; i++)
+    {
+      items[i] = buffer + i * perf->size;
+      lengths[i] = perf->size;
+    }
+
+  digests = g_malloc (n_items * digest_len);
+
+  if (perf->op == OP_DIGESTS || perf->op == OP_DIGESTS_ONE_BY_ONE)
+    n_iterations = MAX (TOTAL_BYTES / (perf->size * n_items), 1);
+  else
+    n_iterations = MAX (TOTAL_BYTES / perf->size, 1);
+
+  g_test_timer_start ();
+
+  for (i = 0; i < n_iterations; i++)
+    {
+      switch (perf->op)
+        {
+        case OP_CHECKSUM:
+          {
+            GChecksum *checksum = g_checksum_new (perf->type);
+            gsize len = digest_len;
+
+            g_checksum_update (checksum, buffer, perf->size);
+            g_checksum_get_digest (checksum, digests, &len);
+            g_checksum_free (checksum);
+          }
+          break;
+        case OP_HMAC:
+          {
+            GHmac *hmac = g_hmac_new (perf->type, hmac_key, sizeof (hmac_key) - 1);
+            gsize len = digest_len;
+
+            g_hmac_update (hmac, buffer, perf->size);
+            g_hmac_get_digest (hmac, digests, &len);
+            g_hmac_unref (hmac);
+          }
+          break;
+        case OP_DIGESTS_ONE_BY_ONE:
+          for (j = 0; j < n_items; j++)
+            {
+              GChecksum *checksum = g_checksum_new (perf->type);
+              gsize len = digest_len;
+
+              g_checksum_update (checksum, items[j], lengths[j]);
+              g_checksum_get_digest (checksum, digests + j * digest_len, &len);
+              g_checksum_free (checksum);
+            }
+          break;
+        case OP_DIGESTS:
+          g_compute_digests_for_data (perf->type, items, lengths, n_items, digests);
+          break;
+        default:
+          g_assert_not_reached ();
+        }
+    }
+
+  time_elapsed = g_test_timer_elapsed ();
+
+  if (perf->op == OP_DIGESTS || perf->op == OP_DIGESTS_ONE_BY_ONE)
+    n_iterations *= n_items;
+
+  g_free (digests);
+  g_free (lengths);
+  g_free (items);
+  g_free (buffer);
+
+  result = ((gdouble) perf->size * n_iterations / time_elapsed) * 1.0e-6;
+
+  g_test_maximized_result (result, "%7.1f MB/s, %9.0f messages/s for %" G_GSIZE_FORMAT " bytes",
+                           result, n_iterations / time_elapsed, perf->size);
+}
+
+static void
+add_cases (const char    *path,
+           Operation      op,
+           GChecksumType  type)
+{
+  const gsize sizes[] = { 16, 64, 1024, 64 * 1024, 1024 * 1024 };
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++)
+    {
+      PerfData *perf;
+      gchar *full_path;
+
+      /* Many small messages are what the multi-buffer API is for */
+      if ((op == OP_DIGESTS || op == OP_DIGESTS_ONE_BY_ONE) && sizes[i] > 1024)
+        continue;
+
+      perf = g_new0 (PerfData, 1);
+      perf->op = op;
+      perf->type = type;
+      perf->size = sizes[i];
+
+      full_path = g_strdup_printf ("%s/%" G_GSIZE_FORMAT, path, sizes[i]);
+      g_test_add_data_func_full (full_path, perf, perform, g_free);
+      g_free (full_path);
+    }
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  if (g_test_perf ())
+    {
+      add_cases ("/checksum/perf/md5", OP_CHECKSUM, G_CHECKSUM_MD5);
+      add_cases ("/checksum/perf/sha1", OP_CHECKSUM, G_CHECKSUM_SHA1);
+      add_cases ("/checksum/perf/sha256", OP_CHECKSUM, G_CHECKSUM_SHA256);
+      add_cases ("/checksum/perf/sha512", OP_CHECKSUM, G_CHECKSUM_SHA512);
+      add_cases ("/checksum/perf/hmac-sha1", OP_HMAC, G_CHECKSUM_SHA1);
+      add_cases ("/checksum/perf/hmac-sha256", OP_HMAC, G_CHECKSUM_SHA256);
+      add_cases ("/checksum/perf/digests-one-by-one/sha256", OP_DIGESTS_ONE_BY_ONE, G_CHECKSUM_SHA256);
+      add_cases ("/checksum/perf/digests/sha256", OP_DIGESTS, G_CHECKSUM_SHA256);
+    }
+
+  return g_test_run ();
+}
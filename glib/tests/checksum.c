@@ -1112,6 +1112,87 @@ test_checksum_bytes (gconstpointer d)
     }
 }
 
+static void
+test_checksum_digests (gconstpointer d)
+{
+  const ChecksumComputeTest *test = d;
+  const guchar *data[FIXED_LEN + 1];
+  gsize lengths[FIXED_LEN + 1];
+  guint8 *digests;
+  gsize digest_len;
+  int length;
+
+  digest_len = g_checksum_type_get_length (test->checksum_type);
+  digests = g_malloc (digest_len * (FIXED_LEN + 1));
+
+  for (length = 0; length <= FIXED_LEN; length++)
+    {
+      data[length] = (const guchar *) FIXED_STR;
+      lengths[length] = length;
+    }
+
+  g_compute_digests_for_data (test->checksum_type, data, lengths,
+                              FIXED_LEN + 1, digests);
+
+  for (length = 0; length <= FIXED_LEN; length++)
+    {
+      guint8 *digest;
+      gsize len;
+
+      digest = sum_to_digest (test->sums[length], &len);
+      g_assert_cmpmem (digests + length * digest_len, digest_len, digest, len);
+      g_free (digest);
+    }
+
+  g_free (digests);
+}
+
+/* Long enough to go through many blocks at a time in between updates
+ * that leave partial blocks behind */
+static void
+test_checksum_long (void)
+{
+  const struct {
+    GChecksumType type;
+    const gchar *sum;
+  } sums[] = {
+    { G_CHECKSUM_MD5, "7707d6ae4e027c70eea2a935c2296f21" },
+    { G_CHECKSUM_SHA1, "34aa973cd4c4daa4f61eeb2bdbad27316534016f" },
+    { G_CHECKSUM_SHA256, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" },
+    { G_CHECKSUM_SHA384, "9d0e1809716474cb086e834e310a4a1ced149e9c00f248527972cec5704c2a5b"
+                         "07b8b3dc38ecc4ebae97ddd87f3d8985" },
+    { G_CHECKSUM_SHA512, "e718483d0ce769644e2e42c7bc15b4638e1f98b13b2044285632a803afa973eb"
+                         "de0ff244877ea60a4cb0432ce577c31beb009c5c2c49aa2e4eadb217ad8cc09b" },
+  };
+  const gsize length = 1000000;
+  guchar *data;
+  gsize i;
+
+  g_test_summary ("Check the checksums of a million 'a' characters, from FIPS 180");
+
+  data = g_malloc (length);
+  memset (data, 'a', length);
+
+  for (i = 0; i < G_N_ELEMENTS (sums); i++)
+    {
+      GChecksum *checksum;
+      gchar *str;
+      gsize pos, chunk;
+
+      str = g_compute_checksum_for_data (sums[i].type, data, length);
+      g_assert_cmpstr (str, ==, sums[i].sum);
+      g_free (str);
+
+      checksum = g_checksum_new (sums[i].type);
+      for (pos = 0, chunk = 1; pos < length; pos += chunk, chunk = chunk * 3 + 1)
+        g_checksum_update (checksum, data + pos, MIN (chunk, length - pos));
+      g_assert_cmpstr (g_checksum_get_string (checksum), ==, sums[i].sum);
+      g_checksum_free (checksum);
+    }
+
+  g_free (data);
+}
+
 static void
 add_checksum_test (GChecksumType  type,
                    const char    *type_name,
@@ -1169,6 +1250,23 @@ add_checksum_bytes_test (GChecksumType   type,
   g_free (path);
 }
 
+static void
+add_checksum_digests_test (GChecksumType   type,
+                           const gchar    *type_name,
+                           const gchar   **sums)
+{
+  ChecksumComputeTest *test;
+  gchar *path;
+
+  test = g_new0 (ChecksumComputeTest, 1);
+  test->checksum_type = type;
+  test->sums = sums;
+
+  path = g_strdup_printf ("/checksum/%s/digests", type_name);
+  g_test_add_data_func_full (path, test, test_checksum_digests, g_free);
+  g_free (path);
+}
+
 static void
 test_unsupported (void)
 {
@@ -1184,31 +1282,37 @@ main (int argc, char *argv[])
   g_test_init (&argc, &argv, NULL);
 
   g_test_add_func ("/checksum/unsupported", test_unsupported);
+  g_test_add_func ("/checksum/long", test_checksum_long);
 
   for (length = 0; length <= FIXED_LEN; length++)
     add_checksum_test (G_CHECKSUM_MD5, "MD5", MD5_sums[length], length);
   add_checksum_string_test (G_CHECKSUM_MD5, "MD5", MD5_sums);
   add_checksum_bytes_test (G_CHECKSUM_MD5, "MD5", MD5_sums);
+  add_checksum_digests_test (G_CHECKSUM_MD5, "MD5", MD5_sums);
 
   for (length = 0; length <= FIXED_LEN; length++)
     add_checksum_test (G_CHECKSUM_SHA1, "SHA1", SHA1_sums[length], length);
   add_checksum_string_test (G_CHECKSUM_SHA1, "SHA1", SHA1_sums);
   add_checksum_bytes_test (G_CHECKSUM_SHA1, "SHA1", SHA1_sums);
+  add_checksum_digests_test (G_CHECKSUM_SHA1, "SHA1", SHA1_sums);
 
   for (length = 0; length <= FIXED_LEN; length++)
     add_checksum_test (G_CHECKSUM_SHA256, "SHA256", SHA256_sums[length], length);
   add_checksum_string_test (G_CHECKSUM_SHA256, "SHA256", SHA256_sums);
   add_checksum_bytes_test (G_CHECKSUM_SHA256, "SHA256", SHA256_sums);
+  add_checksum_digests_test (G_CHECKSUM_SHA256, "SHA256", SHA256_sums);
 
   for (length = 0; length <= FIXED_LEN; length++)
     add_checksum_test (G_CHECKSUM_SHA384, "SHA384", SHA384_sums[length], length);
   add_checksum_string_test (G_CHECKSUM_SHA384, "SHA384", SHA384_sums);
   add_checksum_bytes_test (G_CHECKSUM_SHA384, "SHA384", SHA384_sums);
+  add_checksum_digests_test (G_CHECKSUM_SHA384, "SHA384", SHA384_sums);
 
   for (length = 0; length <= FIXED_LEN; length++)
     add_checksum_test (G_CHECKSUM_SHA512, "SHA512", SHA512_sums[length], length);
   add_checksum_string_test (G_CHECKSUM_SHA512, "SHA512", SHA512_sums);
   add_checksum_bytes_test (G_CHECKSUM_SHA512, "SHA512", SHA512_sums);
+  add_checksum_digests_test (G_CHECKSUM_SHA512, "SHA512", SHA512_sums);
 
   return g_test_run ();
 }
@@ -0,0 +1,282 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+#include <glib.h>
+
+/* Operations done in each case, split between the threads */
+#define NUM_OPERATIONS 4000000
+
+#define NUM_KEYS 10000
+
+typedef enum {
+  TABLE_MUTEX,
+  TABLE_RW_LOCK,
+  TABLE_CONCURRENT,
+} TableType;
+
+typedef struct {
+  TableType type;
+  guint write_percent;
+  guint n_threads;
+} PerfData;
+
+/* A #GHashTable with a lock around it, as threaded code uses today */
+typedef struct {
+  GHashTable *table;
+  GMutex mutex;
+  GRWLock rw_lock;
+} LockedTable;
+
+typedef struct {
+  const PerfData *perf;
+  gpointer table;
+  gpointer *keys;
+  guint n_operations;
+  guint seed;
+} ThreadData;
+
+static void
+table_lookup (const PerfData *perf,
+              gpointer        table,
+              gpointer        key)
+{
+  LockedTable *locked = table;
+
+  switch (perf->type)
+    {
+    case TABLE_MUTEX:
+      g_mutex_lock (&locked->mutex);
+      g_hash_table_lookup (locked->table, key);
+      g_mutex_unlock (&locked->mutex);
+      break;
+    case TABLE_RW_LOCK:
+      g_rw_lock_reader_lock (&locked->rw_lock);
+      g_hash_table_lookup (locked->table, key);
+      g_rw_lock_reader_unlock (&locked->rw_lock);
+      break;
+    case TABLE_CONCURRENT:
+      g_concurrent_hash_table_lookup (table, key);
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+static void
+table_insert (const PerfData *perf,
+              gpointer        table,
+              gpointer        key)
+{
+  LockedTable *locked = table;
+
+  switch (perf->type)
+    {
+    case TABLE_MUTEX:
+      g_mutex_lock (&locked->mutex);
+      g_hash_table_insert (locked->table, key, key);
+      g_mutex_unlock (&locked->mutex);
+      break;
+    case TABLE_RW_LOCK:
+      g_rw_lock_writer_lock (&locked->rw_lock);
+      g_hash_table_insert (locked->table, key, key);
+      g_rw_lock_writer_unlock (&locked->rw_lock);
+      break;
+    case TABLE_CONCURRENT:
+      g_concurrent_hash_table_insert (table, key, key);
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+static void
+table_remove (const PerfData *perf,
+              gpointer        table,
+              gpointer        key)
+{
+  LockedTable *locked = table;
+
+  switch (perf->type)
+    {
+    case TABLE_MUTEX:
+      g_mutex_lock (&locked->mutex);
+      g_hash_table_remove (locked->table, key);
+      g_mutex_unlock (&locked->mutex);
+      break;
+    case TABLE_RW_LOCK:
+      g_rw_lock_writer_lock (&locked->rw_lock);
+      g_hash_table_remove (locked->table, key);
+      g_rw_lock_writer_unlock (&locked->rw_lock);
+      break;
+    case TABLE_CONCURRENT:
+      g_concurrent_hash_table_remove (table, key);
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+static gpointer
+worker_thread (gpointer user_data)
+{
+  ThreadData *td = user_data;
+  guint32 state = td->seed;
+  guint i;
+
+  for (i = 0; i < td->n_operations; i++)
+    {
+      gpointer key;
+      guint r;
+
+      /* xorshift, to keep the random numbers out of the measurement */
+      state ^= state << 13;
+      state ^= state >> 17;
+      state ^= state << 5;
+
+      key = td->keys[(state >> 8) % NUM_KEYS];
+      r = state % 100;
+
+      if (r >= td->perf->write_percent)
+        table_lookup (td->perf, td->table, key);
+      else if (r % 2 == 0)
+        table_insert (td->perf, td->table, key);
+      else
+        table_remove (td->perf, td->table, key);
+    }
+
+  return NULL;
+}
+
+static void
+perform (gconstpointer data)
+{
+  const PerfData *perf = data;
+  ThreadData *threads;
+  GThread **thread_ids;
+  LockedTable locked;
+  gpointer table;
+  gpointer *keys;
+  GRand *rand;
+  gdouble time_elapsed;
+  gdouble result;
+  guint i;
+
+  if (perf->type == TABLE_CONCURRENT)
+    {
+      table = g_concurrent_hash_table_new (NULL, NULL);
+    }
+  else
+    {
+      locked.table = g_hash_table_new (NULL, NULL);
+      g_mutex_init (&locked.mutex);
+      g_rw_lock_init (&locked.rw_lock);
+      table = &locked;
+    }
+
+  /* Random numbers, since consecutive ones make a #GHashTable without
+   * any collisions, which real keys don't */
+  keys = g_new (gpointer, NUM_KEYS);
+  rand = g_rand_new_with_seed (42);
+  for (i = 0; i < NUM_KEYS; i++)
+    {
+      keys[i] = GUINT_TO_POINTER (g_rand_int (rand) | 1);
+      table_insert (perf, table, keys[i]);
+    }
+  g_rand_free (rand);
+
+  threads = g_new0 (ThreadData, perf->n_threads);
+  thread_ids = g_new0 (GThread *, perf->n_threads);
+
+  g_test_timer_start ();
+
+  for (i = 0; i < perf->n_threads; i++)
+    {
+      threads[i].perf = perf;
+      threads[i].table = table;
+      threads[i].keys = keys;
+      threads[i].n_operations = NUM_OPERATIONS / perf->n_threads;
+      threads[i].seed = i + 1;
+      thread_ids[i] = g_thread_new ("worker", worker_thread, &threads[i]);
+    }
+
+  for (i = 0; i < perf->n_threads; i++)
+    g_thread_join (thread_ids[i]);
+
+  time_elapsed = g_test_timer_elapsed ();
+
+  g_free (thread_ids);
+  g_free (threads);
+  g_free (keys);
+
+  if (perf->type == TABLE_CONCURRENT)
+    {
+      g_concurrent_hash_table_unref (table);
+    }
+  else
+    {
+      g_hash_table_unref (locked.table);
+      g_mutex_clear (&locked.mutex);
+      g_rw_lock_clear (&locked.rw_lock);
+    }
+
+  result = NUM_OPERATIONS / time_elapsed;
+
+  g_test_maximized_result (result, "%9.0f operations/s with %u threads",
+                           result, perf->n_threads);
+}
+
+static void
+add_cases (const char *path,
+           TableType   type,
+           guint       write_percent)
+{
+  const guint n_threads[] = { 1, 2, 4, 8, 16, 32, 64 };
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (n_threads); i++)
+    {
+      PerfData *perf;
+      gchar *full_path;
+
+      perf = g_new0 (PerfData, 1);
+      perf->type = type;
+      perf->write_percent = write_percent;
+      perf->n_threads = n_threads[i];
+
+      full_path = g_strdup_printf ("%s/%u", path, n_threads[i]);
+      g_test_add_data_func_full (full_path, perf, perform, g_free);
+      g_free (full_path);
+    }
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  if (g_test_perf ())
+    {
+      add_cases ("/concurrent-hash-table/perf/read/mutex", TABLE_MUTEX, 0);
+      add_cases ("/concurrent-hash-table/perf/read/rw-lock", TABLE_RW_LOCK, 0);
+      add_cases ("/concurrent-hash-table/perf/read/concurrent", TABLE_CONCURRENT, 0);
+      add_cases ("/concurrent-hash-table/perf/read-write/mutex", TABLE_MUTEX, 10);
+      add_cases ("/concurrent-hash-table/perf/read-write/rw-lock", TABLE_RW_LOCK, 10);
+      add_cases ("/concurrent-hash-table/perf/read-write/concurrent", TABLE_CONCURRENT, 10);
+    }
+
+  return g_test_run ();
+}
@@ -0,0 +1,307 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+#include <glib.h>
+
+static void
+test_concurrent_hash_table_basic (void)
+{
+  GConcurrentHashTable *h;
+  gint i;
+
+  h = g_concurrent_hash_table_new (NULL, NULL);
+  g_assert_cmpuint (g_concurrent_hash_table_size (h), ==, 0);
+  g_assert_null (g_concurrent_hash_table_lookup (h, GINT_TO_POINTER (1)));
+
+  for (i = 1; i <= 1000; i++)
+    g_assert_true (g_concurrent_hash_table_insert (h, GINT_TO_POINTER (i), GINT_TO_POINTER (i * 2)));
+
+  g_assert_cmpuint (g_concurrent_hash_table_size (h), ==, 1000);
+
+  for (i = 1; i <= 1000; i++)
+    {
+      g_assert_true (g_concurrent_hash_table_contains (h, GINT_TO_POINTER (i)));
+      g_assert_cmpint (GPOINTER_TO_INT (g_concurrent_hash_table_lookup (h, GINT_TO_POINTER (i))), ==, i * 2);
+    }
+  g_assert_false (g_concurrent_hash_table_contains (h, GINT_TO_POINTER (1001)));
+
+  /* Replacing */
+  g_assert_false (g_concurrent_hash_table_insert (h, GINT_TO_POINTER (1), GINT_TO_POINTER (42)));
+  g_assert_cmpint (GPOINTER_TO_INT (g_concurrent_hash_table_lookup (h, GINT_TO_POINTER (1))), ==, 42);
+
+  for (i = 1; i <= 1000; i += 2)
+    g_assert_true (g_concurrent_hash_table_remove (h, GINT_TO_POINTER (i)));
+  g_assert_false (g_concurrent_hash_table_remove (h, GINT_TO_POINTER (1)));
+  g_assert_cmpuint (g_concurrent_hash_table_size (h), ==, 500);
+
+  g_concurrent_hash_table_remove_all (h);
+  g_assert_cmpuint (g_concurrent_hash_table_size (h), ==, 0);
+
+  g_concurrent_hash_table_ref (h);
+  g_concurrent_hash_table_unref (h);
+  g_concurrent_hash_table_unref (h);
+}
+
+static gint destroyed_keys;
+static gint destroyed_values;
+
+static void
+destroy_key (gpointer key)
+{
+  destroyed_keys++;
+  g_free (key);
+}
+
+static void
+destroy_value (gpointer value)
+{
+  destroyed_values++;
+  g_free (value);
+}
+
+static gboolean
+append_x (gconstpointer key,
+          gpointer     *value,
+          gpointer      user_data)
+{
+  gchar *new_value = g_strconcat (*value, "x", NULL);
+
+  *value = new_value;
+
+  return TRUE;
+}
+
+static gboolean
+remove_entry (gconstpointer key,
+              gpointer     *value,
+              gpointer      user_data)
+{
+  return FALSE;
+}
+
+static void
+test_concurrent_hash_table_destroy (void)
+{
+  GConcurrentHashTable *h;
+  gchar *value;
+
+  destroyed_keys = destroyed_values = 0;
+
+  h = g_concurrent_hash_table_new_full (g_str_hash, g_str_equal, destroy_key, destroy_value);
+
+  g_assert_true (g_concurrent_hash_table_insert (h, g_strdup ("a"), g_strdup ("1")));
+  g_assert_true (g_concurrent_hash_table_insert (h, g_strdup ("b"), g_strdup ("2")));
+
+  /* The new key is freed, the old key stays, the old value is freed */
+  g_assert_false (g_concurrent_hash_table_insert (h, g_strdup ("a"), g_strdup ("3")));
+  g_assert_cmpint (destroyed_keys, ==, 1);
+  g_assert_cmpint (destroyed_values, ==, 1);
+
+  value = g_concurrent_hash_table_lookup_copy (h, "a", (GCopyFunc) g_strdup, NULL);
+  g_assert_cmpstr (value, ==, "3");
+  g_free (value);
+  g_assert_null (g_concurrent_hash_table_lookup_copy (h, "c", (GCopyFunc) g_strdup, NULL));
+
+  /* Nothing is taken or freed if the key is there already */
+  value = g_strdup ("4");
+  g_assert_false (g_concurrent_hash_table_insert_if_absent (h, "a", value));
+  g_free (value);
+  g_assert_true (g_concurrent_hash_table_insert_if_absent (h, g_strdup ("c"), g_strdup ("5")));
+  g_assert_cmpint (destroyed_keys, ==, 1);
+  g_assert_cmpint (destroyed_values, ==, 1);
+
+  g_assert_true (g_concurrent_hash_table_compute_if_present (h, "a", append_x, NULL));
+  g_assert_cmpstr (g_concurrent_hash_table_lookup (h, "a"), ==, "3x");
+  g_assert_cmpint (destroyed_values, ==, 2);
+  g_assert_false (g_concurrent_hash_table_compute_if_present (h, "d", append_x, NULL));
+
+  g_assert_true (g_concurrent_hash_table_compute_if_present (h, "b", remove_entry, NULL));
+  g_assert_false (g_concurrent_hash_table_contains (h, "b"));
+  g_assert_cmpint (destroyed_keys, ==, 2);
+  g_assert_cmpint (destroyed_values, ==, 3);
+
+  g_assert_true (g_concurrent_hash_table_remove (h, "c"));
+  g_assert_cmpint (destroyed_keys, ==, 3);
+  g_assert_cmpint (destroyed_values, ==, 4);
+
+  g_concurrent_hash_table_unref (h);
+  g_assert_cmpint (destroyed_keys, ==, 4);
+  g_assert_cmpint (destroyed_values, ==, 5);
+}
+
+static void
+count_entries (gpointer key,
+               gpointer value,
+               gpointer user_data)
+{
+  guint *count = user_data;
+
+  g_assert_cmpint (GPOINTER_TO_INT (key) * 2, ==, GPOINTER_TO_INT (value));
+  (*count)++;
+}
+
+static void
+test_concurrent_hash_table_snapshot (void)
+{
+  GConcurrentHashTable *h;
+  GHashTable *snapshot;
+  guint count = 0;
+  gint i;
+
+  h = g_concurrent_hash_table_new (NULL, NULL);
+  for (i = 1; i <= 100; i++)
+    g_concurrent_hash_table_insert (h, GINT_TO_POINTER (i), GINT_TO_POINTER (i * 2));
+
+  g_concurrent_hash_table_foreach (h, count_entries, &count);
+  g_assert_cmpuint (count, ==, 100);
+
+  snapshot = g_concurrent_hash_table_snapshot (h, NULL, NULL, NULL);
+  g_concurrent_hash_table_remove_all (h);
+  g_assert_cmpuint (g_hash_table_size (snapshot), ==, 100);
+  for (i = 1; i <= 100; i++)
+    g_assert_cmpint (GPOINTER_TO_INT (g_hash_table_lookup (snapshot, GINT_TO_POINTER (i))), ==, i * 2);
+  g_hash_table_unref (snapshot);
+
+  g_concurrent_hash_table_unref (h);
+
+  /* With copies, which belong to the snapshot */
+  destroyed_keys = destroyed_values = 0;
+  h = g_concurrent_hash_table_new_full (g_str_hash, g_str_equal, destroy_key, destroy_value);
+  g_concurrent_hash_table_insert (h, g_strdup ("a"), g_strdup ("1"));
+  g_concurrent_hash_table_insert (h, g_strdup ("b"), g_strdup ("2"));
+
+  snapshot = g_concurrent_hash_table_snapshot (h, (GCopyFunc) g_strdup, (GCopyFunc) g_strdup, NULL);
+  g_concurrent_hash_table_unref (h);
+  g_assert_cmpint (destroyed_keys, ==, 2);
+  g_assert_cmpstr (g_hash_table_lookup (snapshot, "a"), ==, "1");
+  g_assert_cmpstr (g_hash_table_lookup (snapshot, "b"), ==, "2");
+  g_hash_table_unref (snapshot);
+  g_assert_cmpint (destroyed_keys, ==, 4);
+  g_assert_cmpint (destroyed_values, ==, 4);
+}
+
+/* Threads count how often they see each key with compute_if_present(),
+ * creating the counters with insert_if_absent(), so that any update
+ * which gets lost shows up in the totals. Meanwhile, snapshots must
+ * always see totals which only go up. */
+#define N_THREADS 8
+#define N_KEYS 100
+#define N_ITERATIONS 20000
+
+typedef struct {
+  GConcurrentHashTable *h;
+  guint id;
+} ThreadData;
+
+static gboolean
+increment (gconstpointer key,
+           gpointer     *value,
+           gpointer      user_data)
+{
+  *value = GUINT_TO_POINTER (GPOINTER_TO_UINT (*value) + 1);
+
+  return TRUE;
+}
+
+static gpointer
+counter_thread (gpointer user_data)
+{
+  ThreadData *td = user_data;
+  GRand *rand = g_rand_new_with_seed (td->id);
+  guint i;
+
+  for (i = 0; i < N_ITERATIONS; i++)
+    {
+      gpointer key = GUINT_TO_POINTER (g_rand_int_range (rand, 1, N_KEYS + 1));
+
+      if (!g_concurrent_hash_table_compute_if_present (td->h, key, increment, NULL) &&
+          !g_concurrent_hash_table_insert_if_absent (td->h, key, GUINT_TO_POINTER (1)))
+        g_assert_true (g_concurrent_hash_table_compute_if_present (td->h, key, increment, NULL));
+    }
+
+  g_rand_free (rand);
+
+  return NULL;
+}
+
+static guint
+sum_values (GHashTable *table)
+{
+  GHashTableIter iter;
+  gpointer value;
+  guint sum = 0;
+
+  g_hash_table_iter_init (&iter, table);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    sum += GPOINTER_TO_UINT (value);
+
+  return sum;
+}
+
+static void
+test_concurrent_hash_table_threads (void)
+{
+  ThreadData data[N_THREADS];
+  GThread *threads[N_THREADS];
+  GConcurrentHashTable *h;
+  GHashTable *snapshot;
+  guint last_sum = 0;
+  guint i;
+
+  h = g_concurrent_hash_table_new (NULL, NULL);
+
+  for (i = 0; i < N_THREADS; i++)
+    {
+      data[i].h = h;
+      data[i].id = i;
+      threads[i] = g_thread_new ("counter", counter_thread, &data[i]);
+    }
+
+  for (i = 0; i < 100; i++)
+    {
+      guint sum;
+
+      snapshot = g_concurrent_hash_table_snapshot (h, NULL, NULL, NULL);
+      sum = sum_values (snapshot);
+      g_assert_cmpuint (sum, >=, last_sum);
+      last_sum = sum;
+      g_hash_table_unref (snapshot);
+    }
+
+  for (i = 0; i < N_THREADS; i++)
+    g_thread_join (threads[i]);
+
+  snapshot = g_concurrent_hash_table_snapshot (h, NULL, NULL, NULL);
+  g_assert_cmpuint (g_hash_table_size (snapshot), ==, N_KEYS);
+  g_assert_cmpuint (sum_values (snapshot), ==, N_THREADS * N_ITERATIONS);
+  g_hash_table_unref (snapshot);
+
+  g_concurrent_hash_table_unref (h);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/concurrent-hash-table/basic", test_concurrent_hash_table_basic);
+  g_test_add_func ("/concurrent-hash-table/destroy", test_concurrent_hash_table_destroy);
+  g_test_add_func ("/concurrent-hash-table/snapshot", test_concurrent_hash_table_snapshot);
+  g_test_add_func ("/concurrent-hash-table/threads", test_concurrent_hash_table_threads);
+
+  return g_test_run ();
+}
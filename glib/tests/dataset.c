@@ -43,6 +43,74 @@ test_quark_string (void)
   g_free (copy);
 }
 
+#define N_QUARK_THREADS 4
+#define N_THREAD_QUARKS 5000
+
+static gpointer
+quark_thread (gpointer data)
+{
+  guint id = GPOINTER_TO_UINT (data);
+  guint i;
+
+  for (i = 0; i < N_THREAD_QUARKS; i++)
+    {
+      /* Quarks which only this thread creates, and quarks which all the
+       * threads race to create, all while the table keeps growing */
+      gchar *own = g_strdup_printf ("quark-thread-%u-%u", id, i);
+      gchar *shared = g_strdup_printf ("quark-shared-%u", i);
+      GQuark own_quark, shared_quark;
+
+      g_assert_cmpuint (g_quark_try_string (own), ==, 0);
+      own_quark = g_quark_from_string (own);
+      g_assert_cmpuint (own_quark, !=, 0);
+      g_assert_cmpuint (g_quark_try_string (own), ==, own_quark);
+      g_assert_cmpstr (g_quark_to_string (own_quark), ==, own);
+
+      shared_quark = g_quark_from_string (shared);
+      g_assert_cmpuint (g_quark_try_string (shared), ==, shared_quark);
+      g_assert_true (g_intern_string (shared) == g_quark_to_string (shared_quark));
+
+      g_free (shared);
+      g_free (own);
+    }
+
+  return NULL;
+}
+
+static void
+test_quark_threaded (void)
+{
+  GThread *threads[N_QUARK_THREADS];
+  guint i, j;
+
+  for (i = 0; i < N_QUARK_THREADS; i++)
+    threads[i] = g_thread_new ("quark", quark_thread, GUINT_TO_POINTER (i));
+
+  for (i = 0; i < N_QUARK_THREADS; i++)
+    g_thread_join (threads[i]);
+
+  /* Every string ended up with exactly one quark */
+  for (i = 0; i < N_THREAD_QUARKS; i++)
+    {
+      gchar *shared = g_strdup_printf ("quark-shared-%u", i);
+      GQuark quark = g_quark_try_string (shared);
+
+      g_assert_cmpuint (quark, !=, 0);
+      g_assert_cmpstr (g_quark_to_string (quark), ==, shared);
+      g_free (shared);
+
+      for (j = 0; j < N_QUARK_THREADS; j++)
+        {
+          gchar *own = g_strdup_printf ("quark-thread-%u-%u", j, i);
+
+          quark = g_quark_try_string (own);
+          g_assert_cmpuint (quark, !=, 0);
+          g_assert_cmpstr (g_quark_to_string (quark), ==, own);
+          g_free (own);
+        }
+    }
+}
+
 static void
 test_dataset_basic (void)
 {
@@ -257,6 +325,7 @@ main (int argc, char *argv[])
 
   g_test_add_func ("/quark/basic", test_quark_basic);
   g_test_add_func ("/quark/string", test_quark_string);
+  g_test_add_func ("/quark/threaded", test_quark_threaded);
   g_test_add_func ("/dataset/basic", test_dataset_basic);
   g_test_add_func ("/dataset/id", test_dataset_id);
   g_test_add_func ("/dataset/full", test_dataset_full);
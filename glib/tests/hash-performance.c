@@ -0,0 +1,243 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <glib.h>
+
+/* Lookups done in each case, spread evenly over the keys */
+#define NUM_LOOKUPS 4000000
+
+#define NUM_KEYS 4096
+
+typedef enum {
+  KEYS_SHORT,
+  KEYS_PATHS,
+  KEYS_LONG,
+  KEYS_COLLIDING,
+} KeySet;
+
+typedef struct {
+  GHashFunc hash_func;
+  KeySet keys;
+} PerfData;
+
+static gchar **
+make_keys (KeySet keys)
+{
+  gchar **strings = g_new0 (gchar *, NUM_KEYS + 1);
+  gchar *padding = g_strnfill (200, 'x');
+  guint i, j;
+
+  for (i = 0; i < NUM_KEYS; i++)
+    {
+      switch (keys)
+        {
+        case KEYS_SHORT:
+          strings[i] = g_strdup_printf ("key%u", i);
+          break;
+        case KEYS_PATHS:
+          strings[i] = g_strdup_printf ("/org/gnome/Example/Objects/%u/Child", i);
+          break;
+        case KEYS_LONG:
+          strings[i] = g_strdup_printf ("%s%u", padding, i);
+          break;
+        case KEYS_COLLIDING:
+          {
+            GString *s = g_string_new ("");
+
+            /* "Aa" and "B@" have the same g_str_hash(), so all strings
+             * made of the same number of them do, too */
+            for (j = 0; (1 << j) < NUM_KEYS; j++)
+              g_string_append (s, (i & (1 << j)) ? "Aa" : "B@");
+
+            strings[i] = g_string_free (s, FALSE);
+          }
+          break;
+        default:
+          g_assert_not_reached ();
+        }
+    }
+
+  g_free (padding);
+
+  return strings;
+}
+
+static guint
+prime_below (guint n)
+{
+  guint p, d;
+
+  for (p = n - 1; p > 2; p--)
+    {
+      for (d = 2; d * d <= p; d++)
+        if (p % d == 0)
+          break;
+
+      if (d * d > p)
+        return p;
+    }
+
+  return 2;
+}
+
+/* Lays out the hash values of @strings in a table like a #GHashTable
+ * which has just grown to hold them would, and works out how many
+ * buckets a successful lookup visits on average, and how many keys it
+ * has to compare because the hash values in the buckets are equal. */
+static void
+measure_probes (GHashFunc   hash_func,
+                gchar     **strings,
+                gdouble    *probes,
+                gdouble    *compares)
+{
+  guint n_strings = g_strv_length (strings);
+  guint shift, size, mask, mod;
+  guint *hashes;
+  guint64 total_probes = 0, total_compares = 0;
+  guint i;
+
+  for (shift = 0; (1u << shift) <= n_strings * 1.333; shift++);
+  shift = MAX (shift, 3);
+  size = 1 << shift;
+  mask = size - 1;
+  mod = prime_below (size);
+
+  hashes = g_new0 (guint, size);
+
+  for (i = 0; i < n_strings; i++)
+    {
+      guint hash = MAX (hash_func (strings[i]), 2);
+      guint index = (hash * 11) % mod;
+      guint step = 0;
+
+      total_probes++;
+
+      while (hashes[index] != 0)
+        {
+          if (hashes[index] == hash)
+            total_compares++;
+
+          step++;
+          index = (index + step) & mask;
+          total_probes++;
+        }
+
+      /* The comparison with the key itself */
+      total_compares++;
+
+      hashes[index] = hash;
+    }
+
+  g_free (hashes);
+
+  *probes = (gdouble) total_probes / n_strings;
+  *compares = (gdouble) total_compares / n_strings;
+}
+
+static void
+perform (gconstpointer data)
+{
+  const PerfData *perf = data;
+  gchar **strings, **lookup_strings;
+  GHashTable *table;
+  gdouble time_elapsed;
+  gdouble result;
+  gdouble probes, compares;
+  guint n_strings;
+  guint i;
+
+  strings = make_keys (perf->keys);
+  n_strings = g_strv_length (strings);
+
+  /* Look up with copies of the keys, so that the comparisons have to go
+   * through the strings */
+  lookup_strings = g_strdupv (strings);
+
+  table = g_hash_table_new (perf->hash_func, g_str_equal);
+  for (i = 0; i < n_strings; i++)
+    g_hash_table_insert (table, strings[i], GUINT_TO_POINTER (i + 1));
+
+  g_test_timer_start ();
+
+  for (i = 0; i < NUM_LOOKUPS; i++)
+    {
+      guint j = i % n_strings;
+
+      if (G_UNLIKELY (GPOINTER_TO_UINT (g_hash_table_lookup (table, lookup_strings[j])) != j + 1))
+        g_assert_not_reached ();
+    }
+
+  time_elapsed = g_test_timer_elapsed ();
+
+  measure_probes (perf->hash_func, strings, &probes, &compares);
+
+  g_hash_table_unref (table);
+  g_strfreev (lookup_strings);
+  g_strfreev (strings);
+
+  result = NUM_LOOKUPS / time_elapsed;
+
+  g_test_maximized_result (result, "%9.0f lookups/s, %6.2f probes and %7.2f key comparisons per lookup",
+                           result, probes, compares);
+}
+
+static void
+add_cases (const char *path,
+           GHashFunc   hash_func)
+{
+  const struct {
+    const gchar *name;
+    KeySet keys;
+  } key_sets[] = {
+    { "short", KEYS_SHORT },
+    { "paths", KEYS_PATHS },
+    { "long", KEYS_LONG },
+    { "colliding", KEYS_COLLIDING },
+  };
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (key_sets); i++)
+    {
+      PerfData *perf;
+      gchar *full_path;
+
+      perf = g_new0 (PerfData, 1);
+      perf->hash_func = hash_func;
+      perf->keys = key_sets[i].keys;
+
+      full_path = g_strdup_printf ("%s/%s", path, key_sets[i].name);
+      g_test_add_data_func_full (full_path, perf, perform, g_free);
+      g_free (full_path);
+    }
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  if (g_test_perf ())
+    {
+      add_cases ("/hash/perf/str-hash", g_str_hash);
+      add_cases ("/hash/perf/str-hash-seeded", g_str_hash_seeded);
+    }
+
+  return g_test_run ();
+}
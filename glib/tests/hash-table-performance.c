@@ -0,0 +1,239 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+#include <glib.h>
+
+/* Operations timed for each kind of operation in each case. Tables
+ * smaller than this are filled and emptied again as many times as it
+ * takes. */
+#define MIN_OPERATIONS 2000000
+
+typedef enum {
+  KEYS_DIRECT,
+  KEYS_STRINGS,
+} KeySet;
+
+typedef struct {
+  KeySet keys;
+  GHashTableFlags flags;
+  guint n_entries;
+} PerfData;
+
+typedef enum {
+  OP_INSERT,
+  OP_LOOKUP_HIT,
+  OP_LOOKUP_MISS,
+  OP_ITERATE,
+  OP_REMOVE,
+  N_OPS
+} Operation;
+
+static const gchar * const op_names[N_OPS] = {
+  "insert", "lookup-hit", "lookup-miss", "iterate", "remove",
+};
+
+/* Spreads consecutive numbers over all 32 bits, without repeating any */
+#define DIRECT_KEY(i) GUINT_TO_POINTER (((i) + 1) * 2654435761u)
+
+static gpointer *
+make_keys (KeySet keys,
+           guint  first,
+           guint  n_keys)
+{
+  gpointer *result = g_new (gpointer, n_keys);
+  guint i;
+
+  for (i = 0; i < n_keys; i++)
+    {
+      if (keys == KEYS_DIRECT)
+        result[i] = DIRECT_KEY (first + i);
+      else
+        result[i] = g_strdup_printf ("/org/gnome/Example/%u", first + i);
+    }
+
+  return result;
+}
+
+/* Lookups and removals go through the keys in a random order, since going
+ * through them in the order they were inserted lets tables which keep
+ * keys with similar hash values close together (such as the default one
+ * with consecutive numbers or similar strings) stay in the cache. */
+static guint *
+make_order (guint n_keys)
+{
+  GRand *rand = g_rand_new_with_seed (42);
+  guint *order = g_new (guint, n_keys);
+  guint i;
+
+  for (i = 0; i < n_keys; i++)
+    order[i] = i;
+
+  for (i = n_keys - 1; i > 0; i--)
+    {
+      guint j = g_rand_int_range (rand, 0, i + 1);
+      guint tmp = order[i];
+
+      order[i] = order[j];
+      order[j] = tmp;
+    }
+
+  g_rand_free (rand);
+
+  return order;
+}
+
+static void
+free_keys (KeySet    keys,
+           gpointer *key_array,
+           guint     n_keys)
+{
+  guint i;
+
+  if (keys == KEYS_STRINGS)
+    for (i = 0; i < n_keys; i++)
+      g_free (key_array[i]);
+
+  g_free (key_array);
+}
+
+static void
+perform (gconstpointer data)
+{
+  const PerfData *perf = data;
+  guint n = perf->n_entries;
+  guint n_rounds = MAX (1, MIN_OPERATIONS / n);
+  gpointer *keys, *lookup_keys, *missing_keys;
+  guint *order;
+  gdouble elapsed[N_OPS] = { 0, };
+  GHashFunc hash_func;
+  GEqualFunc equal_func;
+  guint round, i;
+  Operation op;
+
+  keys = make_keys (perf->keys, 0, n);
+  missing_keys = make_keys (perf->keys, n, n);
+  order = make_order (n);
+
+  if (perf->keys == KEYS_DIRECT)
+    {
+      hash_func = g_direct_hash;
+      equal_func = NULL;
+      lookup_keys = g_memdup (keys, n * sizeof (gpointer));
+    }
+  else
+    {
+      hash_func = g_str_hash;
+      equal_func = g_str_equal;
+      /* Look up with copies of the keys, so that the comparisons have
+       * to go through the strings */
+      lookup_keys = make_keys (perf->keys, 0, n);
+    }
+
+  for (round = 0; round < n_rounds; round++)
+    {
+      GHashTable *table;
+      GHashTableIter iter;
+      gpointer key, value;
+      guint count = 0;
+
+      table = g_hash_table_new_with_flags (hash_func, equal_func, NULL, NULL, perf->flags);
+
+      g_test_timer_start ();
+      for (i = 0; i < n; i++)
+        g_hash_table_insert (table, keys[i], GUINT_TO_POINTER (i + 1));
+      elapsed[OP_INSERT] += g_test_timer_elapsed ();
+
+      g_test_timer_start ();
+      for (i = 0; i < n; i++)
+        if (G_UNLIKELY (GPOINTER_TO_UINT (g_hash_table_lookup (table, lookup_keys[order[i]])) != order[i] + 1))
+          g_assert_not_reached ();
+      elapsed[OP_LOOKUP_HIT] += g_test_timer_elapsed ();
+
+      g_test_timer_start ();
+      for (i = 0; i < n; i++)
+        if (G_UNLIKELY (g_hash_table_lookup (table, missing_keys[order[i]]) != NULL))
+          g_assert_not_reached ();
+      elapsed[OP_LOOKUP_MISS] += g_test_timer_elapsed ();
+
+      g_test_timer_start ();
+      g_hash_table_iter_init (&iter, table);
+      while (g_hash_table_iter_next (&iter, &key, &value))
+        count += GPOINTER_TO_UINT (value) != 0;
+      elapsed[OP_ITERATE] += g_test_timer_elapsed ();
+      g_assert_cmpuint (count, ==, n);
+
+      g_test_timer_start ();
+      for (i = 0; i < n; i++)
+        if (G_UNLIKELY (!g_hash_table_remove (table, lookup_keys[order[i]])))
+          g_assert_not_reached ();
+      elapsed[OP_REMOVE] += g_test_timer_elapsed ();
+
+      g_hash_table_unref (table);
+    }
+
+  for (op = 0; op < N_OPS; op++)
+    {
+      gdouble result = (gdouble) n * n_rounds / elapsed[op];
+
+      g_test_maximized_result (result, "%-11s %11.0f operations/s", op_names[op], result);
+    }
+
+  g_free (order);
+  free_keys (perf->keys, missing_keys, n);
+  free_keys (perf->keys, lookup_keys, n);
+  g_free (keys);
+}
+
+static void
+add_cases (const char      *path,
+           KeySet           keys,
+           GHashTableFlags  flags)
+{
+  const guint n_entries[] = { 16, 1000, 64000, 1000000, 10000000 };
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (n_entries); i++)
+    {
+      PerfData *perf;
+      gchar *full_path;
+
+      perf = g_new0 (PerfData, 1);
+      perf->keys = keys;
+      perf->flags = flags;
+      perf->n_entries = n_entries[i];
+
+      full_path = g_strdup_printf ("%s/%u", path, n_entries[i]);
+      g_test_add_data_func_full (full_path, perf, perform, g_free);
+      g_free (full_path);
+    }
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  if (g_test_perf ())
+    {
+      add_cases ("/hash-table/perf/direct/default", KEYS_DIRECT, G_HASH_TABLE_FLAGS_NONE);
+      add_cases ("/hash-table/perf/direct/group-probing", KEYS_DIRECT, G_HASH_TABLE_FLAGS_GROUP_PROBING);
+      add_cases ("/hash-table/perf/strings/default", KEYS_STRINGS, G_HASH_TABLE_FLAGS_NONE);
+      add_cases ("/hash-table/perf/strings/group-probing", KEYS_STRINGS, G_HASH_TABLE_FLAGS_GROUP_PROBING);
+    }
+
+  return g_test_run ();
+}
@@ -1355,10 +1355,12 @@ struct _GHashTable
 
   guint            have_big_keys : 1;
   guint            have_big_values : 1;
+  guint            group_probing : 1;
 
   gpointer        *keys;
   guint           *hashes;
   gpointer        *values;
+  guint8          *ctrl;
 
   GHashFunc        hash_func;
   GEqualFunc       key_equal_func;
@@ -1416,9 +1418,33 @@ check_data (GHashTable *h)
     {
       if (h->hashes[i] >= 2)
         {
-          g_assert_cmpint (h->hashes[i], ==, h->hash_func (fetch_key_or_value (h->keys, i, h->have_big_keys)));
+          guint hash = h->hash_func (fetch_key_or_value (h->keys, i, h->have_big_keys));
+
+          /* Hash values which mean an unused bucket or a tombstone are
+           * stored as 2 */
+          g_assert_cmpint (h->hashes[i], ==, MAX (hash, 2));
         }
     }
+
+  if (h->group_probing)
+    {
+      /* The control bytes agree with the hashes, and the first ones are
+       * repeated at the end (for at least the smallest group size) */
+      for (i = 0; i < h->size; i++)
+        {
+          if (h->hashes[i] == 0)
+            g_assert_cmphex (h->ctrl[i], ==, 0x80);
+          else if (h->hashes[i] == 1)
+            g_assert_cmphex (h->ctrl[i], ==, 0xfe);
+          else
+            g_assert_cmphex (h->ctrl[i], <, 0x80);
+        }
+
+      for (i = 0; i < 8; i++)
+        g_assert_cmphex (h->ctrl[h->size + i], ==, h->ctrl[i]);
+    }
+  else
+    g_assert_null (h->ctrl);
 }
 
 static void
@@ -1659,6 +1685,248 @@ test_primes (void)
   g_assert_cmpfloat (max, <, 2.0);
 }
 
+/* Returns 2^@n_blocks different strings which all have the same
+ * g_str_hash(), since "Aa" and "B@" do and the hash is a polynomial */
+static gchar **
+make_colliding_strings (guint n_blocks)
+{
+  guint n_strings = 1 << n_blocks;
+  gchar **strings;
+  guint i, j;
+
+  strings = g_new0 (gchar *, n_strings + 1);
+  for (i = 0; i < n_strings; i++)
+    {
+      GString *s = g_string_new ("prefix-");
+
+      for (j = 0; j < n_blocks; j++)
+        g_string_append (s, (i & (1 << j)) ? "Aa" : "B@");
+
+      strings[i] = g_string_free (s, FALSE);
+    }
+
+  return strings;
+}
+
+static void
+test_str_hash_seeded (void)
+{
+  gchar buf[100], copy[100];
+  GHashTable *hashes;
+  gchar **strings;
+  guint i;
+
+  /* Equal strings hash the same at any alignment, and each length of a
+   * run of the same character hashes differently */
+  hashes = g_hash_table_new (NULL, NULL);
+  for (i = 0; i < 64; i++)
+    {
+      guint hash;
+
+      memset (buf, 'a', i);
+      buf[i] = '\0';
+      memset (copy + 1, 'a', i);
+      copy[i + 1] = '\0';
+
+      hash = g_str_hash_seeded (buf);
+      g_assert_cmpuint (hash, ==, g_str_hash_seeded (copy + 1));
+      g_assert_false (g_hash_table_contains (hashes, GUINT_TO_POINTER (hash)));
+      g_hash_table_add (hashes, GUINT_TO_POINTER (hash));
+    }
+  g_hash_table_unref (hashes);
+
+  /* Strings made to collide for g_str_hash() don't collide here */
+  strings = make_colliding_strings (10);
+  hashes = g_hash_table_new (NULL, NULL);
+  for (i = 0; strings[i] != NULL; i++)
+    {
+      g_assert_cmpuint (g_str_hash (strings[i]), ==, g_str_hash (strings[0]));
+      g_hash_table_add (hashes, GUINT_TO_POINTER (g_str_hash_seeded (strings[i])));
+    }
+  g_assert_cmpuint (g_hash_table_size (hashes), ==, i);
+  g_hash_table_unref (hashes);
+  g_strfreev (strings);
+
+  /* Keys whose first word cancels the secret the hash XORs it with make
+   * a multiplication by zero, which must not erase the seed: they must
+   * not all collide */
+  hashes = g_hash_table_new (NULL, NULL);
+  for (i = 0; i < 16; i++)
+    {
+      const guint64 secret = G_GUINT64_CONSTANT (0xe7037ed1a0b428db);
+
+      memcpy (buf, &secret, sizeof (secret));
+      memset (buf + 8, 'a' + i, 8);
+      strcpy (buf + 16, "the same tail for all keys");
+      g_hash_table_add (hashes, GUINT_TO_POINTER (g_str_hash_seeded (buf)));
+
+      /* The same on the path for short keys */
+      memcpy (copy, &secret, sizeof (secret));
+      memset (copy + 8, 'a' + i, 8);
+      copy[16] = '\0';
+      g_hash_table_add (hashes, GUINT_TO_POINTER (g_str_hash_seeded (copy)));
+    }
+  g_assert_cmpuint (g_hash_table_size (hashes), ==, 32);
+  g_hash_table_unref (hashes);
+}
+
+static void
+test_seeded_str_hash_table (void)
+{
+  GHashTable *h;
+  gchar **strings;
+  guint i;
+
+  strings = make_colliding_strings (12);
+
+  h = g_hash_table_new_with_flags (g_str_hash, g_str_equal, NULL, g_free,
+                                   G_HASH_TABLE_FLAGS_SEEDED_STR_HASH);
+  for (i = 0; strings[i] != NULL; i++)
+    g_assert_true (g_hash_table_insert (h, strings[i], g_strdup (strings[i])));
+
+  g_assert_cmpuint (g_hash_table_size (h), ==, i);
+
+  for (i = 0; strings[i] != NULL; i++)
+    {
+      gchar *key = g_strdup (strings[i]);
+
+      g_assert_cmpstr (g_hash_table_lookup (h, key), ==, strings[i]);
+      if (i % 2 == 0)
+        g_assert_true (g_hash_table_remove (h, key));
+      g_free (key);
+    }
+
+  g_assert_cmpuint (g_hash_table_size (h), ==, i / 2);
+  g_assert_null (g_hash_table_lookup (h, "prefix-"));
+  g_hash_table_unref (h);
+
+  /* Other hash functions are left alone */
+  h = g_hash_table_new_with_flags (g_int_hash, g_int_equal, NULL, NULL,
+                                   G_HASH_TABLE_FLAGS_SEEDED_STR_HASH);
+  i = 42;
+  g_hash_table_add (h, &i);
+  g_assert_true (g_hash_table_contains (h, &i));
+  g_hash_table_unref (h);
+
+  g_strfreev (strings);
+}
+
+/* Does the same random operations on a table with group probing and
+ * on a default one, with the keys being a mix of small and big integers
+ * so that the arrays go from small entries to big ones */
+static void
+test_group_probing (void)
+{
+  GHashTable *h, *ref;
+  GHashTableIter iter;
+  gpointer key, value;
+  guint i, n_iterated;
+
+  h = g_hash_table_new_with_flags (NULL, NULL, NULL, NULL,
+                                   G_HASH_TABLE_FLAGS_GROUP_PROBING);
+  ref = g_hash_table_new (NULL, NULL);
+  check_consistency (h);
+
+  for (i = 0; i < 200000; i++)
+    {
+      guint r = g_test_rand_int_range (0, 1 << (i < 100000 ? 12 : 16));
+      gpointer k = GUINT_TO_POINTER (i < 150000 ? r : r * G_GUINT64_CONSTANT (0x100000001));
+
+      switch (g_test_rand_int_range (0, 4))
+        {
+        case 0:
+          g_assert_cmpint (g_hash_table_add (h, k), ==, g_hash_table_add (ref, k));
+          break;
+        case 1:
+          g_assert_cmpint (g_hash_table_insert (h, k, GUINT_TO_POINTER (i)), ==,
+                           g_hash_table_insert (ref, k, GUINT_TO_POINTER (i)));
+          break;
+        case 2:
+          g_assert_cmpint (g_hash_table_remove (h, k), ==, g_hash_table_remove (ref, k));
+          break;
+        default:
+          g_assert_true (g_hash_table_lookup (h, k) == g_hash_table_lookup (ref, k));
+          g_assert_cmpint (g_hash_table_contains (h, k), ==, g_hash_table_contains (ref, k));
+          break;
+        }
+
+      g_assert_cmpuint (g_hash_table_size (h), ==, g_hash_table_size (ref));
+      if (i % 10000 == 0)
+        check_consistency (h);
+    }
+
+  check_consistency (h);
+
+  n_iterated = 0;
+  g_hash_table_iter_init (&iter, h);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      g_assert_true (g_hash_table_lookup (ref, key) == value);
+      n_iterated++;
+
+      if (n_iterated % 3 == 0)
+        {
+          g_hash_table_iter_remove (&iter);
+          g_hash_table_remove (ref, key);
+        }
+    }
+  g_assert_cmpuint (n_iterated, >, 0);
+  g_assert_cmpuint (g_hash_table_size (h), ==, g_hash_table_size (ref));
+  check_consistency (h);
+
+  g_hash_table_remove_all (h);
+  check_consistency (h);
+  g_assert_cmpuint (g_hash_table_size (h), ==, 0);
+  g_assert_false (g_hash_table_contains (h, NULL));
+
+  g_hash_table_unref (ref);
+  g_hash_table_unref (h);
+}
+
+/* Keys whose whole hash values are the same all match the same control
+ * byte, and must still be told apart and found after removals */
+static void
+test_group_probing_collisions (void)
+{
+  GHashTable *h;
+  gchar **strings;
+  guint i, n;
+
+  strings = make_colliding_strings (9);
+
+  h = g_hash_table_new_with_flags (g_str_hash, g_str_equal, g_free, NULL,
+                                   G_HASH_TABLE_FLAGS_GROUP_PROBING);
+  for (n = 0; strings[n] != NULL; n++)
+    g_assert_true (g_hash_table_insert (h, g_strdup (strings[n]), strings[n]));
+  check_consistency (h);
+
+  for (i = 0; i < n; i += 2)
+    g_assert_true (g_hash_table_remove (h, strings[i]));
+  check_consistency (h);
+
+  for (i = 0; i < n; i++)
+    {
+      if (i % 2 == 0)
+        g_assert_null (g_hash_table_lookup (h, strings[i]));
+      else
+        g_assert_true (g_hash_table_lookup (h, strings[i]) == strings[i]);
+    }
+
+  /* Steal the rest, which leaves nothing but tombstones */
+  for (i = 1; i < n; i += 2)
+    {
+      gpointer stolen_key;
+
+      g_assert_true (g_hash_table_steal_extended (h, strings[i], &stolen_key, NULL));
+      g_free (stolen_key);
+    }
+  check_consistency (h);
+  g_assert_cmpuint (g_hash_table_size (h), ==, 0);
+
+  g_hash_table_unref (h);
+  g_strfreev (strings);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -1696,6 +1964,10 @@ main (int argc, char *argv[])
   g_test_add_func ("/hash/set-insert-corruption", test_set_insert_corruption);
   g_test_add_func ("/hash/set-to-strv", test_set_to_strv);
   g_test_add_func ("/hash/primes", test_primes);
+  g_test_add_func ("/hash/str-hash-seeded", test_str_hash_seeded);
+  g_test_add_func ("/hash/seeded-str-hash-table", test_seeded_str_hash_table);
+  g_test_add_func ("/hash/group-probing", test_group_probing);
+  g_test_add_func ("/hash/group-probing/collisions", test_group_probing_collisions);
 
   return g_test_run ();
 
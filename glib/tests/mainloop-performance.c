@@ -0,0 +1,190 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+
+#define NUM_ITERATIONS 20000
+
+/* Returns the sources to make ready in turn, if any */
+typedef GPtrArray * (* SetupFunc) (GMainContext *context,
+                                   guint         n_sources);
+
+static gboolean
+never_dispatch (gpointer user_data)
+{
+  g_assert_not_reached ();
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+count_dispatch (gpointer user_data)
+{
+  guint *n_dispatched = user_data;
+
+  (*n_dispatched)++;
+
+  return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+rearm_dispatch (GSource     *source,
+                GSourceFunc  callback,
+                gpointer     user_data)
+{
+  g_source_set_ready_time (source, g_get_monotonic_time () + G_TIME_SPAN_HOUR);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static GSourceFuncs rearm_funcs = {
+  NULL, NULL, rearm_dispatch, NULL, NULL, NULL
+};
+
+/* Timeouts far in the future, which never fire: an iteration only pays
+ * for the sources it has to look at.
+ */
+static GPtrArray *
+setup_idle_timeouts (GMainContext *context,
+                     guint         n_sources)
+{
+  guint i;
+
+  for (i = 0; i < n_sources; i++)
+    {
+      GSource *source = g_timeout_source_new_seconds (3600 + i);
+
+      g_source_set_callback (source, never_dispatch, NULL, NULL);
+      g_source_attach (source, context);
+      g_source_unref (source);
+    }
+
+  return NULL;
+}
+
+/* Sources with a ready time far in the future, one of which is made
+ * ready before each iteration and then rescheduled by its dispatch.
+ */
+static GPtrArray *
+setup_rescheduling (GMainContext *context,
+                    guint         n_sources)
+{
+  GPtrArray *sources = g_ptr_array_new_with_free_func ((GDestroyNotify) g_source_unref);
+  gint64 now = g_get_monotonic_time ();
+  guint i;
+
+  for (i = 0; i < n_sources; i++)
+    {
+      GSource *source = g_source_new (&rearm_funcs, sizeof (GSource));
+
+      g_source_set_ready_time (source, now + G_TIME_SPAN_HOUR + i);
+      g_source_attach (source, context);
+      g_ptr_array_add (sources, source);
+    }
+
+  return sources;
+}
+
+typedef struct {
+  SetupFunc setup;
+  guint n_sources;
+} IterateData;
+
+static void
+perform (gconstpointer data)
+{
+  const IterateData *id = data;
+  GMainContext *context;
+  GPtrArray *sources;
+  GSource *idle;
+  guint n_dispatched = 0;
+  gdouble time_elapsed;
+  gdouble result;
+  guint i;
+
+  context = g_main_context_new ();
+  sources = id->setup (context, id->n_sources);
+
+  /* Something to do in each iteration, at a lower priority */
+  idle = g_idle_source_new ();
+  g_source_set_priority (idle, G_PRIORITY_LOW);
+  g_source_set_callback (idle, count_dispatch, &n_dispatched, NULL);
+  g_source_attach (idle, context);
+  g_source_unref (idle);
+
+  g_test_timer_start ();
+
+  for (i = 0; i < NUM_ITERATIONS; i++)
+    {
+      if (sources != NULL)
+        g_source_set_ready_time (sources->pdata[i % sources->len], 0);
+
+      g_main_context_iteration (context, FALSE);
+    }
+
+  time_elapsed = g_test_timer_elapsed ();
+
+  result = NUM_ITERATIONS / time_elapsed;
+
+  g_test_maximized_result (result, "%9.0f iterations/s with %u sources",
+                           result, id->n_sources);
+
+  if (sources != NULL)
+    {
+      for (i = 0; i < sources->len; i++)
+        g_source_destroy (sources->pdata[i]);
+      g_ptr_array_unref (sources);
+    }
+
+  g_main_context_unref (context);
+}
+
+static void
+add_cases (const char *path,
+           SetupFunc   setup)
+{
+  static const guint n_sources[] = { 10, 1000, 100000 };
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (n_sources); i++)
+    {
+      IterateData *id;
+      gchar *full_path;
+
+      id = g_new0 (IterateData, 1);
+      id->setup = setup;
+      id->n_sources = n_sources[i];
+
+      full_path = g_strdup_printf ("%s/%u", path, n_sources[i]);
+      g_test_add_data_func_full (full_path, id, perform, g_free);
+      g_free (full_path);
+    }
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  if (g_test_perf ())
+    {
+      add_cases ("/mainloop/perf/idle-timeouts", setup_idle_timeouts);
+      add_cases ("/mainloop/perf/rescheduling", setup_rescheduling);
+    }
+
+  return g_test_run ();
+}
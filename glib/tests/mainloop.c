@@ -1029,6 +1029,298 @@ test_ready_time (void)
   g_source_destroy (source);
 }
 
+static gboolean
+order_dispatch (GSource     *source,
+                GSourceFunc  callback,
+                gpointer     user_data)
+{
+  GPtrArray *dispatched = user_data;
+
+  g_ptr_array_add (dispatched, source);
+  g_source_set_ready_time (source, -1);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static GSourceFuncs order_funcs = {
+  NULL, NULL, order_dispatch, NULL, NULL, NULL
+};
+
+static gint
+query_timeout (GMainContext *ctx)
+{
+  gint max_priority, timeout;
+  GPollFD fds[10];
+
+  g_main_context_prepare (ctx, &max_priority);
+  g_main_context_query (ctx, max_priority, &timeout, fds, G_N_ELEMENTS (fds));
+  g_main_context_check (ctx, max_priority, fds, 0);
+
+  return timeout;
+}
+
+/* Sources that only have a ready time are kept sorted by it, but ready
+ * sources are still dispatched in the order they were attached.
+ */
+static void
+test_ready_time_order (void)
+{
+  GMainContext *ctx;
+  GPtrArray *sources, *dispatched;
+  GSource *child;
+  gint64 now;
+  gint timeout;
+  guint i;
+
+  ctx = g_main_context_new ();
+  g_main_context_acquire (ctx);
+  sources = g_ptr_array_new_with_free_func ((GDestroyNotify) g_source_unref);
+  dispatched = g_ptr_array_new ();
+
+  for (i = 0; i < 1000; i++)
+    {
+      GSource *source = g_source_new (&order_funcs, sizeof (GSource));
+
+      g_source_set_callback (source, NULL, dispatched, NULL);
+      g_source_attach (source, ctx);
+      g_ptr_array_add (sources, source);
+    }
+
+  for (i = 0; i < sources->len; i++)
+    g_source_set_ready_time (sources->pdata[(i * 7) % sources->len], 0);
+
+  g_assert_true (g_main_context_iteration (ctx, FALSE));
+  g_assert_cmpuint (dispatched->len, ==, sources->len);
+  for (i = 0; i < sources->len; i++)
+    g_assert_true (dispatched->pdata[i] == sources->pdata[i]);
+  g_ptr_array_set_size (dispatched, 0);
+
+  /* Higher priority sources go first, on their own */
+  g_source_set_priority (sources->pdata[2], G_PRIORITY_HIGH);
+  g_source_set_ready_time (sources->pdata[1], 0);
+  g_source_set_ready_time (sources->pdata[2], 0);
+  g_assert_true (g_main_context_iteration (ctx, FALSE));
+  g_assert_cmpuint (dispatched->len, ==, 1);
+  g_assert_true (dispatched->pdata[0] == sources->pdata[2]);
+  g_assert_true (g_main_context_iteration (ctx, FALSE));
+  g_assert_cmpuint (dispatched->len, ==, 2);
+  g_assert_true (dispatched->pdata[1] == sources->pdata[1]);
+  g_ptr_array_set_size (dispatched, 0);
+
+  /* The earliest ready time bounds the timeout, whatever the order in
+   * which they were set or the sources were removed.
+   */
+  now = g_get_monotonic_time ();
+  g_source_set_ready_time (sources->pdata[10], now + 20 * G_TIME_SPAN_SECOND);
+  g_source_set_ready_time (sources->pdata[11], now + 10 * G_TIME_SPAN_SECOND);
+  g_source_set_ready_time (sources->pdata[12], now + 30 * G_TIME_SPAN_SECOND);
+  g_source_set_ready_time (sources->pdata[13], now + 5 * G_TIME_SPAN_SECOND);
+
+  timeout = query_timeout (ctx);
+  g_assert_cmpint (timeout, >, 4000);
+  g_assert_cmpint (timeout, <=, 5000);
+
+  g_source_destroy (sources->pdata[13]);
+  timeout = query_timeout (ctx);
+  g_assert_cmpint (timeout, >, 9000);
+  g_assert_cmpint (timeout, <=, 10000);
+
+  g_source_set_ready_time (sources->pdata[11], -1);
+  timeout = query_timeout (ctx);
+  g_assert_cmpint (timeout, >, 19000);
+  g_assert_cmpint (timeout, <=, 20000);
+
+  g_source_set_ready_time (sources->pdata[12], now + 15 * G_TIME_SPAN_SECOND);
+  timeout = query_timeout (ctx);
+  g_assert_cmpint (timeout, >, 14000);
+  g_assert_cmpint (timeout, <=, 15000);
+  g_assert_cmpuint (dispatched->len, ==, 0);
+
+  /* A ready child source is dispatched right before its parent */
+  child = g_source_new (&order_funcs, sizeof (GSource));
+  g_source_set_callback (child, NULL, dispatched, NULL);
+  g_source_add_child_source (sources->pdata[20], child);
+  g_source_set_ready_time (sources->pdata[30], 0);
+  g_source_set_ready_time (child, 0);
+  g_assert_true (g_main_context_iteration (ctx, FALSE));
+  g_assert_cmpuint (dispatched->len, ==, 3);
+  g_assert_true (dispatched->pdata[0] == child);
+  g_assert_true (dispatched->pdata[1] == sources->pdata[20]);
+  g_assert_true (dispatched->pdata[2] == sources->pdata[30]);
+  g_source_unref (child);
+
+  g_ptr_array_unref (dispatched);
+  for (i = 0; i < sources->len; i++)
+    g_source_destroy (sources->pdata[i]);
+  g_ptr_array_unref (sources);
+
+  g_main_context_release (ctx);
+  g_main_context_unref (ctx);
+}
+
+/* Sources with a slack are dispatched together with later ones */
+static void
+test_slack (void)
+{
+  GMainContext *ctx;
+  GSource *early, *late;
+  GPtrArray *dispatched;
+  GVariant *stats;
+  guint64 saved_wakeups;
+  gint64 now;
+  gint timeout;
+
+  ctx = g_main_context_new ();
+  g_main_context_set_statistics_enabled (ctx, TRUE);
+  g_main_context_acquire (ctx);
+  dispatched = g_ptr_array_new ();
+
+  early = g_source_new (&order_funcs, sizeof (GSource));
+  g_source_set_callback (early, NULL, dispatched, NULL);
+  g_assert_cmpint (g_source_get_slack (early), ==, 0);
+  g_source_attach (early, ctx);
+
+  late = g_source_new (&order_funcs, sizeof (GSource));
+  g_source_set_callback (late, NULL, dispatched, NULL);
+  g_source_attach (late, ctx);
+
+  now = g_get_monotonic_time ();
+  g_source_set_ready_time (early, now + 200 * G_TIME_SPAN_MILLISECOND);
+  g_source_set_ready_time (late, now + 600 * G_TIME_SPAN_MILLISECOND);
+
+  timeout = query_timeout (ctx);
+  g_assert_cmpint (timeout, >, 0);
+  g_assert_cmpint (timeout, <=, 200);
+
+  /* Not enough slack to reach the later source */
+  g_source_set_slack (early, 100 * G_TIME_SPAN_MILLISECOND);
+  g_assert_cmpint (g_source_get_slack (early), ==, 100 * G_TIME_SPAN_MILLISECOND);
+  timeout = query_timeout (ctx);
+  g_assert_cmpint (timeout, >, 200);
+  g_assert_cmpint (timeout, <=, 300);
+
+  g_source_set_slack (early, G_TIME_SPAN_SECOND);
+  timeout = query_timeout (ctx);
+  g_assert_cmpint (timeout, >, 400);
+  g_assert_cmpint (timeout, <=, 600);
+
+  while (dispatched->len == 0)
+    g_main_context_iteration (ctx, TRUE);
+
+  g_assert_cmpuint (dispatched->len, ==, 2);
+  g_assert_true (dispatched->pdata[0] == early);
+  g_assert_true (dispatched->pdata[1] == late);
+  g_assert_cmpint (g_get_monotonic_time (), >=, now + 600 * G_TIME_SPAN_MILLISECOND);
+
+  stats = g_main_context_get_statistics (ctx);
+  g_assert_true (g_variant_lookup (stats, "saved-wakeups", "t", &saved_wakeups));
+  g_assert_cmpuint (saved_wakeups, ==, 1);
+  g_variant_unref (stats);
+
+  g_source_destroy (early);
+  g_source_unref (early);
+  g_source_destroy (late);
+  g_source_unref (late);
+  g_ptr_array_unref (dispatched);
+
+  g_main_context_release (ctx);
+  g_main_context_unref (ctx);
+}
+
+static gboolean
+count_three_calls (gpointer user_data)
+{
+  gint *calls = user_data;
+
+  (*calls)++;
+
+  return *calls < 3 ? G_SOURCE_CONTINUE : G_SOURCE_REMOVE;
+}
+
+static void
+test_statistics (void)
+{
+  GMainContext *ctx;
+  GSource *source;
+  GVariant *stats, *sources, *buckets;
+  guint64 poll_count, n_dispatches, total, max, sum;
+  GVariantIter *latency;
+  guint64 count;
+  gint calls = 0, unnamed_calls = 0;
+
+  ctx = g_main_context_new ();
+
+  g_assert_false (g_main_context_get_statistics_enabled (ctx));
+  g_assert_null (g_main_context_get_statistics (ctx));
+
+  g_main_context_set_statistics_enabled (ctx, TRUE);
+  g_assert_true (g_main_context_get_statistics_enabled (ctx));
+
+  source = g_idle_source_new ();
+  g_source_set_name (source, "test idle");
+  g_source_set_callback (source, count_three_calls, &calls, NULL);
+  g_source_attach (source, ctx);
+  g_source_unref (source);
+
+  source = g_timeout_source_new (10);
+  g_source_set_callback (source, count_three_calls, &unnamed_calls, NULL);
+  g_source_attach (source, ctx);
+  g_source_unref (source);
+
+  while (calls < 3 || unnamed_calls < 3)
+    g_main_context_iteration (ctx, TRUE);
+
+  stats = g_main_context_get_statistics (ctx);
+  g_assert_nonnull (stats);
+  g_assert_false (g_variant_is_floating (stats));
+  g_assert_true (g_variant_is_of_type (stats, G_VARIANT_TYPE_VARDICT));
+
+  /* Waiting for the timeout took some polls */
+  g_assert_true (g_variant_lookup (stats, "poll-count", "t", &poll_count));
+  g_assert_cmpuint (poll_count, >, 0);
+  g_assert_true (g_variant_lookup (stats, "poll-time", "t", &total));
+  g_assert_cmpuint (total, >=, 10000);
+
+  buckets = g_variant_lookup_value (stats, "latency-buckets", G_VARIANT_TYPE ("at"));
+  g_assert_nonnull (buckets);
+  g_assert_cmpuint (g_variant_n_children (buckets), >, 1);
+  g_variant_unref (buckets);
+
+  sources = g_variant_lookup_value (stats, "sources", G_VARIANT_TYPE ("a{s(tttat)}"));
+  g_assert_nonnull (sources);
+  g_assert_cmpuint (g_variant_n_children (sources), ==, 2);
+
+  g_assert_true (g_variant_lookup (sources, "test idle", "(tttat)",
+                                   &n_dispatches, &total, &max, &latency));
+  g_assert_cmpuint (n_dispatches, ==, 3);
+  g_assert_cmpuint (max, <=, total);
+  sum = 0;
+  while (g_variant_iter_next (latency, "t", &count))
+    sum += count;
+  g_assert_cmpuint (sum, ==, 3);
+  g_variant_iter_free (latency);
+
+  g_assert_true (g_variant_lookup (sources, "(unnamed)", "(tttat)",
+                                   &n_dispatches, &total, &max, &latency));
+  g_assert_cmpuint (n_dispatches, ==, 3);
+  g_variant_iter_free (latency);
+
+  g_variant_unref (sources);
+  g_variant_unref (stats);
+
+  /* Disabling throws the statistics away */
+  g_main_context_set_statistics_enabled (ctx, FALSE);
+  g_assert_null (g_main_context_get_statistics (ctx));
+  g_main_context_set_statistics_enabled (ctx, TRUE);
+  stats = g_main_context_get_statistics (ctx);
+  sources = g_variant_lookup_value (stats, "sources", G_VARIANT_TYPE ("a{s(tttat)}"));
+  g_assert_cmpuint (g_variant_n_children (sources), ==, 0);
+  g_variant_unref (sources);
+  g_variant_unref (stats);
+
+  g_main_context_unref (ctx);
+}
+
 static void
 test_wakeup(void)
 {
@@ -1597,6 +1889,246 @@ test_unix_fd_priority (void)
   close (fd2);
 }
 
+/* Same as test_unix_fd(), on a context using epoll */
+static void
+test_epoll_unix_fd (void)
+{
+  GMainContext *context;
+  gssize to_write = -1;
+  gssize to_read;
+  gint fds[2];
+  GSource *source_a;
+  GSource *source_b;
+  gint s;
+
+  context = g_main_context_new_with_flags (G_MAIN_CONTEXT_FLAGS_EPOLL);
+
+  s = pipe (fds);
+  g_assert_cmpint (s, ==, 0);
+
+  to_read = fill_a_pipe (fds[1]);
+  source_a = g_unix_fd_source_new (fds[1], G_IO_OUT);
+  g_source_set_priority (source_a, G_PRIORITY_HIGH);
+  g_source_set_callback (source_a, G_SOURCE_FUNC (write_bytes), &to_write, NULL);
+  g_source_attach (source_a, context);
+  while (g_main_context_iteration (context, FALSE));
+
+  to_read += 16 * 1024 * 1024;
+  to_write = 16 * 1024 * 1024;
+  source_b = g_unix_fd_source_new (fds[0], G_IO_IN);
+  g_source_set_callback (source_b, G_SOURCE_FUNC (read_bytes), &to_read, NULL);
+  g_source_attach (source_b, context);
+
+  while (TRUE)
+    {
+      gssize to_write_was = to_write;
+      gssize to_read_was = to_read;
+
+      if (!g_main_context_iteration (context, FALSE))
+        break;
+
+      g_assert_true (to_write == to_write_was || to_read == to_read_was);
+    }
+
+  g_assert_cmpint (to_write, ==, 0);
+  g_assert_cmpint (to_read, ==, 0);
+
+  g_assert_true (g_source_is_destroyed (source_a));
+  g_source_unref (source_a);
+  g_source_destroy (source_b);
+  g_source_unref (source_b);
+  close (fds[1]);
+  close (fds[0]);
+
+  g_main_context_unref (context);
+}
+
+static void
+test_epoll_modify_unix_fd (void)
+{
+  GSourceFuncs no_funcs = {
+    NULL, NULL, return_true
+  };
+  GMainContext *context;
+  GSource *source_a, *source_b;
+  gpointer tag_a, tag_b;
+  gint fds[2];
+  gint s;
+
+  context = g_main_context_new_with_flags (G_MAIN_CONTEXT_FLAGS_EPOLL);
+
+  s = pipe (fds);
+  g_assert_cmpint (s, ==, 0);
+
+  /* Two sources on the same fd, which share one epoll registration */
+  source_a = g_source_new (&no_funcs, sizeof (FlagSource));
+  tag_a = g_source_add_unix_fd (source_a, fds[1], G_IO_IN);
+  g_source_attach (source_a, context);
+  source_b = g_source_new (&no_funcs, sizeof (FlagSource));
+  tag_b = g_source_add_unix_fd (source_b, fds[1], G_IO_IN);
+  g_source_attach (source_b, context);
+
+  while (g_main_context_iteration (context, FALSE));
+  assert_not_flagged (source_a);
+  assert_not_flagged (source_b);
+
+  g_source_modify_unix_fd (source_a, tag_a, G_IO_OUT);
+  g_assert_true (g_main_context_iteration (context, FALSE));
+  assert_flagged (source_a);
+  assert_not_flagged (source_b);
+  clear_flag (source_a);
+
+  g_source_modify_unix_fd (source_a, tag_a, G_IO_IN);
+  g_source_modify_unix_fd (source_b, tag_b, G_IO_OUT);
+  g_assert_true (g_main_context_iteration (context, FALSE));
+  assert_not_flagged (source_a);
+  assert_flagged (source_b);
+  clear_flag (source_b);
+
+  /* Removing the fd from one source keeps it registered for the other */
+  g_source_remove_unix_fd (source_b, tag_b);
+  g_assert_false (g_main_context_iteration (context, FALSE));
+  g_source_modify_unix_fd (source_a, tag_a, G_IO_OUT);
+  g_assert_true (g_main_context_iteration (context, FALSE));
+  assert_flagged (source_a);
+  assert_not_flagged (source_b);
+
+  g_source_destroy (source_a);
+  g_source_destroy (source_b);
+  g_assert_false (g_main_context_iteration (context, FALSE));
+
+  g_source_unref (source_a);
+  g_source_unref (source_b);
+  close (fds[0]);
+  close (fds[1]);
+
+  g_main_context_unref (context);
+}
+
+static void
+test_epoll_add_poll (void)
+{
+  GSourceFuncs no_funcs = {
+    NULL, NULL, return_true
+  };
+  GMainContext *context;
+  GSource *source;
+  GPollFD pollfd;
+  gint fds[2];
+  gint s;
+
+  context = g_main_context_new_with_flags (G_MAIN_CONTEXT_FLAGS_EPOLL);
+
+  s = pipe (fds);
+  g_assert_cmpint (s, ==, 0);
+
+  /* A GPollFD owned by the source, whose events change behind the
+   * context's back.
+   */
+  pollfd.fd = fds[1];
+  pollfd.events = G_IO_IN;
+  source = g_source_new (&no_funcs, sizeof (FlagSource));
+  g_source_add_poll (source, &pollfd);
+  g_source_attach (source, context);
+
+  g_assert_false (g_main_context_iteration (context, FALSE));
+  g_assert_cmpint (pollfd.revents, ==, 0);
+
+  pollfd.events = G_IO_OUT;
+  g_main_context_wakeup (context);
+  g_main_context_iteration (context, FALSE);
+  g_assert_cmpint (pollfd.revents, ==, G_IO_OUT);
+
+  g_source_destroy (source);
+  g_source_unref (source);
+  close (fds[0]);
+  close (fds[1]);
+
+  g_main_context_unref (context);
+}
+
+static gboolean
+quit_loop_fd (gint         fd,
+              GIOCondition condition,
+              gpointer     user_data)
+{
+  GMainLoop *loop = user_data;
+
+  g_main_loop_quit (loop);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+test_epoll_unpollable (void)
+{
+  GMainContext *context;
+  GMainLoop *loop;
+  GSource *source;
+  gint fd;
+
+  context = g_main_context_new_with_flags (G_MAIN_CONTEXT_FLAGS_EPOLL);
+  loop = g_main_loop_new (context, FALSE);
+
+  /* epoll refuses these, but poll() reports them as always ready */
+  fd = open ("/dev/null", O_RDONLY);
+  g_assert_cmpint (fd, >=, 0);
+
+  source = g_unix_fd_source_new (fd, G_IO_IN);
+  g_source_set_callback (source, G_SOURCE_FUNC (quit_loop_fd), loop, NULL);
+  g_source_attach (source, context);
+  g_source_unref (source);
+
+  /* Should not block */
+  g_main_loop_run (loop);
+
+  close (fd);
+  g_main_loop_unref (loop);
+  g_main_context_unref (context);
+}
+
+static gpointer
+epoll_wakeup_thread (gpointer data)
+{
+  gint fd = GPOINTER_TO_INT (data);
+
+  g_usleep (G_USEC_PER_SEC / 20);
+  g_assert_cmpint (write (fd, "x", 1), ==, 1);
+
+  return NULL;
+}
+
+static void
+test_epoll_blocking (void)
+{
+  GMainContext *context;
+  GMainLoop *loop;
+  GSource *source;
+  GThread *thread;
+  gint fds[2];
+  gint s;
+
+  context = g_main_context_new_with_flags (G_MAIN_CONTEXT_FLAGS_EPOLL);
+  loop = g_main_loop_new (context, FALSE);
+
+  s = pipe (fds);
+  g_assert_cmpint (s, ==, 0);
+
+  source = g_unix_fd_source_new (fds[0], G_IO_IN);
+  g_source_set_callback (source, G_SOURCE_FUNC (quit_loop_fd), loop, NULL);
+  g_source_attach (source, context);
+  g_source_unref (source);
+
+  thread = g_thread_new ("epoll-writer", epoll_wakeup_thread, GINT_TO_POINTER (fds[1]));
+  g_main_loop_run (loop);
+  g_thread_join (thread);
+
+  close (fds[0]);
+  close (fds[1]);
+  g_main_loop_unref (loop);
+  g_main_context_unref (context);
+}
+
 #endif
 
 #ifdef G_OS_UNIX
@@ -2081,6 +2613,9 @@ main (int argc, char *argv[])
   g_test_add_func ("/mainloop/source_time", test_source_time);
   g_test_add_func ("/mainloop/overflow", test_mainloop_overflow);
   g_test_add_func ("/mainloop/ready-time", test_ready_time);
+  g_test_add_func ("/mainloop/ready-time-order", test_ready_time_order);
+  g_test_add_func ("/mainloop/statistics", test_statistics);
+  g_test_add_func ("/mainloop/slack", test_slack);
   g_test_add_func ("/mainloop/wakeup", test_wakeup);
   g_test_add_func ("/mainloop/remove-invalid", test_remove_invalid);
   g_test_add_func ("/mainloop/unref-while-pending", test_unref_while_pending);
@@ -2091,6 +2626,11 @@ main (int argc, char *argv[])
   g_test_add_func ("/mainloop/wait", test_mainloop_wait);
   g_test_add_func ("/mainloop/unix-file-poll", test_unix_file_poll);
   g_test_add_func ("/mainloop/unix-fd-priority", test_unix_fd_priority);
+  g_test_add_func ("/mainloop/epoll/unix-fd", test_epoll_unix_fd);
+  g_test_add_func ("/mainloop/epoll/modify-unix-fd", test_epoll_modify_unix_fd);
+  g_test_add_func ("/mainloop/epoll/add-poll", test_epoll_add_poll);
+  g_test_add_func ("/mainloop/epoll/unpollable", test_epoll_unpollable);
+  g_test_add_func ("/mainloop/epoll/blocking", test_epoll_blocking);
 #endif
   g_test_add_func ("/mainloop/nfds", test_nfds);
 
@@ -0,0 +1,165 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+#include <glib.h>
+
+/* Lookups done in each case, split between the threads */
+#define NUM_LOOKUPS 4000000
+
+/* Different strings looked up, which all have quarks */
+#define NUM_STRINGS 1000
+
+typedef enum {
+  LOOKUP_TRY_STRING,
+  LOOKUP_FROM_STRING,
+  LOOKUP_INTERN_STRING,
+} LookupType;
+
+typedef struct {
+  LookupType type;
+  guint n_threads;
+} PerfData;
+
+typedef struct {
+  const PerfData *perf;
+  gchar **strings;
+  guint n_lookups;
+} ThreadData;
+
+static gpointer
+lookup_thread (gpointer user_data)
+{
+  ThreadData *td = user_data;
+  guint i;
+
+  for (i = 0; i < td->n_lookups; i++)
+    {
+      const gchar *string = td->strings[i % NUM_STRINGS];
+
+      switch (td->perf->type)
+        {
+        case LOOKUP_TRY_STRING:
+          if (G_UNLIKELY (g_quark_try_string (string) == 0))
+            g_assert_not_reached ();
+          break;
+        case LOOKUP_FROM_STRING:
+          if (G_UNLIKELY (g_quark_from_string (string) == 0))
+            g_assert_not_reached ();
+          break;
+        case LOOKUP_INTERN_STRING:
+          if (G_UNLIKELY (g_intern_string (string) == NULL))
+            g_assert_not_reached ();
+          break;
+        default:
+          g_assert_not_reached ();
+        }
+    }
+
+  return NULL;
+}
+
+static void
+perform (gconstpointer data)
+{
+  const PerfData *perf = data;
+  ThreadData *threads;
+  GThread **thread_ids;
+  gchar **strings;
+  gdouble time_elapsed;
+  gdouble result;
+  guint i;
+
+  /* Strings like the names of signals and properties, as copies so that
+   * the lookups have to compare them */
+  strings = g_new0 (gchar *, NUM_STRINGS + 1);
+  for (i = 0; i < NUM_STRINGS; i++)
+    {
+      strings[i] = g_strdup_printf ("quark-performance-property-%u", i);
+      g_quark_from_string (strings[i]);
+    }
+
+  threads = g_new0 (ThreadData, perf->n_threads);
+  thread_ids = g_new0 (GThread *, perf->n_threads);
+
+  g_test_timer_start ();
+
+  for (i = 0; i < perf->n_threads; i++)
+    {
+      threads[i].perf = perf;
+      threads[i].strings = strings;
+      threads[i].n_lookups = NUM_LOOKUPS / perf->n_threads;
+      thread_ids[i] = g_thread_new ("lookup", lookup_thread, &threads[i]);
+    }
+
+  for (i = 0; i < perf->n_threads; i++)
+    g_thread_join (thread_ids[i]);
+
+  time_elapsed = g_test_timer_elapsed ();
+
+  g_free (thread_ids);
+  g_free (threads);
+  g_strfreev (strings);
+
+  result = NUM_LOOKUPS / time_elapsed;
+
+  g_test_maximized_result (result, "%9.0f lookups/s with %u threads",
+                           result, perf->n_threads);
+}
+
+static void
+add_cases (const char *path,
+           LookupType  type)
+{
+  guint n_processors = MAX (g_get_num_processors (), 2);
+  const guint n_threads[] = { 1, 2, n_processors / 2, n_processors };
+  guint last = 0;
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (n_threads); i++)
+    {
+      PerfData *perf;
+      gchar *full_path;
+
+      /* Don't run the same case twice on machines with few processors */
+      if (n_threads[i] <= last)
+        continue;
+      last = n_threads[i];
+
+      perf = g_new0 (PerfData, 1);
+      perf->type = type;
+      perf->n_threads = n_threads[i];
+
+      full_path = g_strdup_printf ("%s/%u", path, n_threads[i]);
+      g_test_add_data_func_full (full_path, perf, perform, g_free);
+      g_free (full_path);
+    }
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  if (g_test_perf ())
+    {
+      add_cases ("/quark/perf/try-string", LOOKUP_TRY_STRING);
+      add_cases ("/quark/perf/from-string", LOOKUP_FROM_STRING);
+      add_cases ("/quark/perf/intern-string", LOOKUP_INTERN_STRING);
+    }
+
+  return g_test_run ();
+}
@@ -150,6 +150,135 @@ test_allocate (void)
     g_thread_join (threads[i]);
 }
 
+#define N_ARENA_BLOCKS 10000
+#define ARENA_BLOCK_SIZE 24
+
+static guint
+arena_size_index (gsize size)
+{
+  guint n_chunk_sizes = g_slice_get_config (G_SLICE_CONFIG_CHUNK_SIZES);
+  guint ix;
+
+  for (ix = 0; ix < n_chunk_sizes; ix++)
+    {
+      guint n_values;
+      gint64 *stats = g_slice_get_config_state (G_SLICE_CONFIG_ARENA_STATISTICS, ix, &n_values);
+      gint64 chunk_size;
+
+      g_assert_nonnull (stats);
+      g_assert_cmpuint (n_values, ==, 4);
+      chunk_size = stats[0];
+      g_free (stats);
+
+      if (chunk_size >= size)
+        return ix;
+    }
+
+  g_assert_not_reached ();
+}
+
+/* Returns the number of spans, and the number of allocated chunks */
+static gint64
+arena_statistics (guint   ix,
+                  gint64 *n_allocated)
+{
+  guint n_values;
+  gint64 *stats = g_slice_get_config_state (G_SLICE_CONFIG_ARENA_STATISTICS, ix, &n_values);
+  gint64 n_spans = stats[1];
+
+  g_assert_cmpint (stats[2], >=, stats[3]);
+  *n_allocated = stats[3];
+  g_free (stats);
+
+  return n_spans;
+}
+
+static gpointer
+arena_free_thread (gpointer data)
+{
+  guint **blocks = data;
+  guint i;
+
+  for (i = 0; i < N_ARENA_BLOCKS; i += 2)
+    g_slice_free1 (ARENA_BLOCK_SIZE, blocks[i]);
+
+  return NULL;
+}
+
+static void
+test_slice_arena (void)
+{
+  const gchar *oldval;
+
+  if (g_test_subprocess ())
+    {
+      guint **blocks = g_new (guint *, N_ARENA_BLOCKS);
+      gint64 n_spans, n_spans_before, n_allocated, n_allocated_before;
+      GThread *thread;
+      guint ix, i;
+
+      g_assert_true (g_slice_get_config (G_SLICE_CONFIG_ARENA));
+
+      ix = arena_size_index (ARENA_BLOCK_SIZE);
+      n_spans_before = arena_statistics (ix, &n_allocated_before);
+
+      for (i = 0; i < N_ARENA_BLOCKS; i++)
+        blocks[i] = g_slice_alloc (ARENA_BLOCK_SIZE);
+
+      n_spans = arena_statistics (ix, &n_allocated);
+      g_assert_cmpint (n_spans, >, n_spans_before);
+      g_assert_cmpint (n_allocated - n_allocated_before, ==, N_ARENA_BLOCKS);
+
+      /* Unused spans are retired, except for two of them */
+      for (i = 0; i < N_ARENA_BLOCKS; i++)
+        g_slice_free1 (ARENA_BLOCK_SIZE, blocks[i]);
+
+      g_assert_cmpint (arena_statistics (ix, &n_allocated), <=, n_spans_before + 2);
+      g_assert_cmpint (n_allocated, ==, n_allocated_before);
+
+      for (i = 0; i < N_ARENA_BLOCKS; i++)
+        {
+          blocks[i] = g_slice_alloc (ARENA_BLOCK_SIZE);
+          *blocks[i] = i;
+        }
+
+      n_spans = arena_statistics (ix, &n_allocated);
+
+      /* Free half of the blocks from another thread, the chunks are
+       * handed back to this one and reused */
+      thread = g_thread_new ("free", arena_free_thread, blocks);
+      g_thread_join (thread);
+
+      for (i = 0; i < N_ARENA_BLOCKS; i += 2)
+        {
+          blocks[i] = g_slice_alloc (ARENA_BLOCK_SIZE);
+          *blocks[i] = i;
+        }
+
+      g_assert_cmpint (arena_statistics (ix, &n_allocated), ==, n_spans);
+
+      for (i = 0; i < N_ARENA_BLOCKS; i++)
+        {
+          g_assert_cmpuint (*blocks[i], ==, i);
+          g_slice_free1 (ARENA_BLOCK_SIZE, blocks[i]);
+        }
+
+      g_free (blocks);
+      return;
+    }
+
+  oldval = g_getenv ("G_SLICE");
+  g_setenv ("G_SLICE", "arena", TRUE);
+
+  g_test_trap_subprocess (NULL, 0, G_TEST_SUBPROCESS_INHERIT_STDERR);
+  g_test_trap_assert_passed ();
+
+  if (oldval)
+    g_setenv ("G_SLICE", oldval, TRUE);
+  else
+    g_unsetenv ("G_SLICE");
+}
+
 int
 main (int argc, char **argv)
 {
@@ -159,6 +288,7 @@ main (int argc, char **argv)
   g_test_add_func ("/slice/nodebug", test_slice_nodebug);
   g_test_add_func ("/slice/debug", test_slice_debug);
 #endif
+  g_test_add_func ("/slice/arena", test_slice_arena);
   g_test_add_func ("/slice/copy", test_slice_copy);
   g_test_add_func ("/slice/chain", test_chain);
   g_test_add_func ("/slice/allocate", test_allocate);
@@ -0,0 +1,156 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+
+#define NUM_TASKS 200000
+
+/* Tasks of the nested workload push two more, down to this depth */
+#define NESTED_DEPTH 10
+
+typedef enum {
+  MODE_SHARED,
+  MODE_EXCLUSIVE,
+  MODE_WORK_STEALING
+} PoolMode;
+
+typedef struct {
+  PoolMode mode;
+  gboolean nested;
+} PerfData;
+
+typedef struct {
+  GThreadPool *pool;
+  gboolean nested;
+  gint n_processed;  /* (atomic) */
+} PoolData;
+
+/* A short task, a few hundred nanoseconds of work */
+static void
+pool_func (gpointer data,
+           gpointer user_data)
+{
+  PoolData *pd = user_data;
+  guint depth = GPOINTER_TO_UINT (data);
+  volatile guint hash = depth;
+  guint i;
+
+  for (i = 0; i < 100; i++)
+    hash = hash * 33 + i;
+
+  if (pd->nested && depth < NESTED_DEPTH)
+    {
+      g_thread_pool_push (pd->pool, GUINT_TO_POINTER (depth + 1), NULL);
+      g_thread_pool_push (pd->pool, GUINT_TO_POINTER (depth + 1), NULL);
+    }
+
+  g_atomic_int_inc (&pd->n_processed);
+}
+
+static void
+perform (gconstpointer data)
+{
+  const PerfData *perf = data;
+  PoolData pd = { NULL, perf->nested, 0 };
+  gint n_threads = g_get_num_processors ();
+  gint n_tasks, n_pushed;
+  gdouble time_elapsed;
+  gdouble result;
+  gint i;
+
+  switch (perf->mode)
+    {
+    case MODE_SHARED:
+      pd.pool = g_thread_pool_new (pool_func, &pd, n_threads, FALSE, NULL);
+      break;
+    case MODE_EXCLUSIVE:
+      pd.pool = g_thread_pool_new (pool_func, &pd, n_threads, TRUE, NULL);
+      break;
+    case MODE_WORK_STEALING:
+      pd.pool = g_thread_pool_new_with_flags (pool_func, &pd, n_threads, TRUE,
+                                              G_THREAD_POOL_FLAGS_WORK_STEALING,
+                                              NULL);
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+
+  /* A nested task results in 2^NESTED_DEPTH - 1 tasks in total */
+  if (perf->nested)
+    n_pushed = NUM_TASKS >> NESTED_DEPTH;
+  else
+    n_pushed = NUM_TASKS;
+  n_tasks = perf->nested ? n_pushed * ((1 << NESTED_DEPTH) - 1) : n_pushed;
+
+  g_test_timer_start ();
+
+  for (i = 0; i < n_pushed; i++)
+    g_thread_pool_push (pd.pool, GUINT_TO_POINTER (1), NULL);
+
+  /* Tasks can't push any more once the pool is being freed */
+  while (g_atomic_int_get (&pd.n_processed) < n_tasks)
+    g_thread_yield ();
+
+  time_elapsed = g_test_timer_elapsed ();
+
+  g_thread_pool_free (pd.pool, FALSE, TRUE);
+
+  result = n_tasks / time_elapsed;
+
+  g_test_maximized_result (result, "%9.0f tasks/s with %d threads",
+                           result, n_threads);
+}
+
+static void
+add_cases (const char *path,
+           PoolMode    mode)
+{
+  PerfData *perf;
+  gchar *full_path;
+
+  perf = g_new0 (PerfData, 1);
+  perf->mode = mode;
+  perf->nested = FALSE;
+
+  full_path = g_strdup_printf ("%s/external", path);
+  g_test_add_data_func_full (full_path, perf, perform, g_free);
+  g_free (full_path);
+
+  perf = g_new0 (PerfData, 1);
+  perf->mode = mode;
+  perf->nested = TRUE;
+
+  full_path = g_strdup_printf ("%s/nested", path);
+  g_test_add_data_func_full (full_path, perf, perform, g_free);
+  g_free (full_path);
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  if (g_test_perf ())
+    {
+      add_cases ("/thread-pool/perf/shared", MODE_SHARED);
+      add_cases ("/thread-pool/perf/exclusive", MODE_EXCLUSIVE);
+      add_cases ("/thread-pool/perf/work-stealing", MODE_WORK_STEALING);
+    }
+
+  return g_test_run ();
+}
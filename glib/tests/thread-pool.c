@@ -142,6 +142,146 @@ test_create_first_pool (gconstpointer shared_first)
   g_thread_pool_free (pool, TRUE, TRUE);
 }
 
+#define N_STEALING_TASKS 1000
+
+typedef struct {
+  GThreadPool *pool;
+  gint n_processed;  /* (atomic) */
+} StealingData;
+
+/* Each task pushes two more from within the pool, down to a depth of 4 */
+static void
+stealing_pool_func (gpointer data, gpointer user_data)
+{
+  StealingData *sd = user_data;
+  guint depth = GPOINTER_TO_UINT (data);
+  GError *err = NULL;
+
+  if (depth < 4)
+    {
+      g_assert_true (g_thread_pool_push (sd->pool, GUINT_TO_POINTER (depth + 1), &err));
+      g_assert_true (g_thread_pool_push (sd->pool, GUINT_TO_POINTER (depth + 1), &err));
+      g_assert_no_error (err);
+    }
+
+  g_atomic_int_inc (&sd->n_processed);
+}
+
+static void
+test_work_stealing (void)
+{
+  StealingData sd = { NULL, 0 };
+  GError *err = NULL;
+  guint i;
+
+  g_test_summary ("Tests that all tasks pushed to a work-stealing pool, from "
+                  "outside or from its threads, are processed.");
+
+  sd.pool = g_thread_pool_new_with_flags (stealing_pool_func, &sd, 4, TRUE,
+                                          G_THREAD_POOL_FLAGS_WORK_STEALING,
+                                          &err);
+  g_assert_no_error (err);
+  g_assert_nonnull (sd.pool);
+  g_assert_cmpuint (g_thread_pool_get_num_threads (sd.pool), ==, 4);
+
+  for (i = 0; i < N_STEALING_TASKS; i++)
+    g_assert_true (g_thread_pool_push (sd.pool, GUINT_TO_POINTER (1), &err));
+  g_assert_no_error (err);
+
+  /* Each pushed task results in 1 + 2 + 4 + 8 tasks. As with other pools,
+   * tasks can't be pushed any more once the pool is being freed.
+   */
+  while (g_atomic_int_get (&sd.n_processed) < N_STEALING_TASKS * 15)
+    g_thread_yield ();
+
+  g_assert_cmpuint (g_thread_pool_unprocessed (sd.pool), ==, 0);
+  g_thread_pool_free (sd.pool, FALSE, TRUE);
+
+  g_assert_cmpint (g_atomic_int_get (&sd.n_processed), ==, N_STEALING_TASKS * 15);
+}
+
+typedef struct {
+  GMutex mutex;
+  GCond cond;
+  gboolean blocked;
+  GArray *processed;
+} SortData;
+
+static void
+sort_pool_func (gpointer data, gpointer user_data)
+{
+  SortData *sd = user_data;
+  guint task = GPOINTER_TO_UINT (data);
+
+  g_mutex_lock (&sd->mutex);
+  while (sd->blocked)
+    g_cond_wait (&sd->cond, &sd->mutex);
+  g_array_append_val (sd->processed, task);
+  g_mutex_unlock (&sd->mutex);
+}
+
+static gint
+sort_compare (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+  return (gint) GPOINTER_TO_UINT (a) - (gint) GPOINTER_TO_UINT (b);
+}
+
+static void
+test_work_stealing_sort (void)
+{
+  static const guint expected[] = { 100, 3, 1, 2, 4, 5 };
+  GThreadPool *pool;
+  GError *err = NULL;
+  SortData sd;
+
+  g_test_summary ("Tests that the sort function and moving tasks to the "
+                  "front order the queue of a work-stealing pool.");
+
+  g_mutex_init (&sd.mutex);
+  g_cond_init (&sd.cond);
+  sd.processed = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  /* With a single thread, the order of its queue is the one of the pool */
+  pool = g_thread_pool_new_with_flags (sort_pool_func, &sd, 1, TRUE,
+                                       G_THREAD_POOL_FLAGS_WORK_STEALING,
+                                       &err);
+  g_assert_no_error (err);
+
+  /* Keep the thread busy with a first task while the others are queued */
+  g_mutex_lock (&sd.mutex);
+  sd.blocked = TRUE;
+  g_mutex_unlock (&sd.mutex);
+
+  g_thread_pool_push (pool, GUINT_TO_POINTER (100), NULL);
+  while (g_thread_pool_unprocessed (pool) > 0)
+    g_thread_yield ();
+
+  g_thread_pool_push (pool, GUINT_TO_POINTER (5), NULL);
+  g_thread_pool_push (pool, GUINT_TO_POINTER (2), NULL);
+  g_thread_pool_set_sort_function (pool, sort_compare, NULL);
+  g_thread_pool_push (pool, GUINT_TO_POINTER (4), NULL);
+  g_thread_pool_push (pool, GUINT_TO_POINTER (1), NULL);
+  g_thread_pool_push (pool, GUINT_TO_POINTER (3), NULL);
+  g_assert_cmpuint (g_thread_pool_unprocessed (pool), ==, 5);
+
+  g_assert_true (g_thread_pool_move_to_front (pool, GUINT_TO_POINTER (3)));
+  g_assert_false (g_thread_pool_move_to_front (pool, GUINT_TO_POINTER (6)));
+
+  g_mutex_lock (&sd.mutex);
+  sd.blocked = FALSE;
+  g_cond_broadcast (&sd.cond);
+  g_mutex_unlock (&sd.mutex);
+
+  g_thread_pool_free (pool, FALSE, TRUE);
+
+  g_assert_cmpmem (sd.processed->data, sd.processed->len * sizeof (guint),
+                   expected, sizeof (expected));
+
+  g_array_unref (sd.processed);
+  g_cond_clear (&sd.cond);
+  g_mutex_clear (&sd.mutex);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -151,6 +291,8 @@ main (int argc, char *argv[])
   g_test_add_data_func ("/thread_pool/exclusive", GINT_TO_POINTER (FALSE), test_simple);
   g_test_add_data_func ("/thread_pool/create_shared_after_exclusive", GINT_TO_POINTER (FALSE), test_create_first_pool);
   g_test_add_data_func ("/thread_pool/create_exclusive_after_shared", GINT_TO_POINTER (TRUE), test_create_first_pool);
+  g_test_add_func ("/thread_pool/work_stealing", test_work_stealing);
+  g_test_add_func ("/thread_pool/work_stealing/sort", test_work_stealing_sort);
 
   return g_test_run ();
 }
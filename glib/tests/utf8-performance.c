@@ -202,6 +202,103 @@ perform (gconstpointer data)
   g_slice_free (GrindData, gd);
 }
 
+/* Validation of longer texts, made by repeating the sentences above either
+ * on their own or all mixed together, in a range of sizes */
+
+#define VALIDATE_BYTES (64 * 1024 * 1024)
+
+typedef struct _ValidateData {
+  gboolean sized;
+  gchar *str;
+} ValidateData;
+
+static void
+validate_data_free (gpointer data)
+{
+  ValidateData *vd = data;
+
+  g_free (vd->str);
+  g_free (vd);
+}
+
+static gchar *
+make_text (gboolean mixed,
+           gsize    size)
+{
+  const char *sentences[] = { str_ascii, str_latin1, str_cyrillic, str_han };
+  GString *text = g_string_sized_new (size + 256);
+  const gchar *end;
+  gsize i;
+
+  for (i = 0; text->len < size; i++)
+    {
+      g_string_append (text, mixed ? sentences[i % G_N_ELEMENTS (sentences)] : str_ascii);
+      g_string_append_c (text, ' ');
+    }
+
+  /* Cut the text back to a character boundary */
+  g_string_truncate (text, size);
+  g_utf8_validate (text->str, -1, &end);
+  g_string_truncate (text, end - text->str);
+
+  return g_string_free (text, FALSE);
+}
+
+static void
+perform_validate (gconstpointer data)
+{
+  const ValidateData *vd = data;
+  gsize len = strlen (vd->str);
+  gsize n_iterations = MAX (VALIDATE_BYTES / len, 1);
+  gboolean valid = TRUE;
+  gdouble time_elapsed;
+  gdouble result;
+  gsize i;
+
+  g_test_timer_start ();
+
+  for (i = 0; i < n_iterations; i++)
+    {
+      if (vd->sized)
+        valid &= g_utf8_validate (vd->str, len, NULL);
+      else
+        valid &= g_utf8_validate (vd->str, -1, NULL);
+    }
+
+  time_elapsed = g_test_timer_elapsed ();
+
+  g_assert_true (valid);
+
+  result = ((gdouble) len * n_iterations / time_elapsed) * 1.0e-6;
+
+  g_test_maximized_result (result, "%7.1f MB/s for %" G_GSIZE_FORMAT " bytes", result, len);
+}
+
+static void
+add_validate_cases (const char *path,
+                    gboolean    sized)
+{
+  const gsize sizes[] = { 16, 64, 256, 4096, 65536, 1024 * 1024 };
+  gsize i;
+  guint mixed;
+
+  for (mixed = 0; mixed <= 1; mixed++)
+    for (i = 0; i < G_N_ELEMENTS (sizes); i++)
+      {
+        ValidateData *vd;
+        gchar *full_path;
+
+        vd = g_new0 (ValidateData, 1);
+        vd->sized = sized;
+        vd->str = make_text (mixed, sizes[i]);
+
+        full_path = g_strdup_printf ("%s/%s/%" G_GSIZE_FORMAT, path,
+                                     mixed ? "mixed" : "ascii", sizes[i]);
+        g_test_add_data_func_full (full_path, vd, perform_validate, validate_data_free);
+        g_free (full_path);
+      }
+}
+
 static void
 add_cases(const char *path, GrindFunc func)
 {
@@ -241,6 +338,8 @@ main (int argc, char **argv)
       add_cases ("/utf8/perf/utf8_to_ucs4_fast-sized", grind_utf8_to_ucs4_fast_sized);
       add_cases ("/utf8/perf/utf8_validate", grind_utf8_validate);
       add_cases ("/utf8/perf/utf8_validate-sized", grind_utf8_validate_sized);
+      add_validate_cases ("/utf8/perf/utf8_validate-text", FALSE);
+      add_validate_cases ("/utf8/perf/utf8_validate-text-sized", TRUE);
     }
 
   return g_test_run ();
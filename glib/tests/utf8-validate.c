@@ -356,6 +356,86 @@ test_utf8_get_char_validated (void)
     }
 }
 
+/* Long enough strings to go through any vectorised code paths, with errors
+ * at every character position, including around block boundaries */
+static void
+test_utf8_validate_long (void)
+{
+  const gchar *chars[] = { "a", "\xc3\xa9", "\xe4\xb8\xad", "\xf0\x9f\x98\x80" };
+  const gchar *invalid[] = {
+    "\x80",              /* unexpected continuation */
+    "\xc3",              /* missing continuation */
+    "\xe4\xb8",          /* missing continuation */
+    "\xf0\x9f\x98",      /* missing continuation */
+    "\xc0\xaf",          /* overlong */
+    "\xe0\x80\xaf",      /* overlong */
+    "\xed\xa0\x80",      /* surrogate */
+    "\xf4\x90\x80\x80",  /* out of range */
+    "\xff",
+  };
+  GString *valid;
+  gsize *offsets;
+  gsize n_chars, i, j;
+
+  valid = g_string_new (NULL);
+  n_chars = 200;
+  offsets = g_new (gsize, n_chars + 1);
+
+  for (i = 0; i < n_chars; i++)
+    {
+      offsets[i] = valid->len;
+      /* Runs of ASCII, mixed with all lengths of multibyte characters */
+      g_string_append (valid, chars[(i % 37) < 20 ? 0 : i % G_N_ELEMENTS (chars)]);
+    }
+  offsets[n_chars] = valid->len;
+
+  g_assert_true (g_utf8_validate (valid->str, -1, NULL));
+  g_assert_true (g_utf8_validate_len (valid->str, valid->len, NULL));
+
+  for (i = 0; i < n_chars; i++)
+    {
+      const gchar *end;
+
+      /* Truncated in the middle of the character */
+      if (offsets[i + 1] - offsets[i] > 1)
+        {
+          g_assert_false (g_utf8_validate_len (valid->str, offsets[i + 1] - 1, &end));
+          g_assert_true (end == valid->str + offsets[i]);
+        }
+
+      for (j = 0; j < G_N_ELEMENTS (invalid); j++)
+        {
+          GString *s = g_string_new_len (valid->str, valid->len);
+
+          g_string_insert (s, offsets[i], invalid[j]);
+
+          g_assert_false (g_utf8_validate (s->str, -1, &end));
+          g_assert_true (end == s->str + offsets[i]);
+          g_assert_false (g_utf8_validate_len (s->str, s->len, &end));
+          g_assert_true (end == s->str + offsets[i]);
+
+          g_string_free (s, TRUE);
+        }
+
+      /* Nul ends the string, or is invalid when a length is given */
+      {
+        GString *s = g_string_new_len (valid->str, valid->len);
+
+        g_string_insert_c (s, offsets[i], '\0');
+
+        g_assert_true (g_utf8_validate (s->str, -1, &end));
+        g_assert_true (end == s->str + offsets[i]);
+        g_assert_false (g_utf8_validate_len (s->str, s->len, &end));
+        g_assert_true (end == s->str + offsets[i]);
+
+        g_string_free (s, TRUE);
+      }
+    }
+
+  g_free (offsets);
+  g_string_free (valid, TRUE);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -371,6 +451,7 @@ main (int argc, char *argv[])
       g_free (path);
     }
 
+  g_test_add_func ("/utf8/validate/long", test_utf8_validate_long);
   g_test_add_func ("/utf8/get-char-validated", test_utf8_get_char_validated);
 
   return g_test_run ();
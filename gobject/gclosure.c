@@ -1404,6 +1404,330 @@ va_to_ffi_type (GType gtype,
   return rettype;
 }
 
+/* Most signals only take arguments which are passed as an int or as a
+ * pointer, so a set of pre-generated invokers for up to
+ * GENERIC_INVOKE_MAX_ARGS such arguments (besides the instance and the
+ * user data) and a void or int-sized return value lets the generic
+ * marshallers avoid preparing and calling through a libffi call
+ * interface on every emission. The invoker is selected by a signature
+ * code with one bit per argument set for pointers, above a leading bit
+ * giving the number of arguments.
+ */
+#define GENERIC_INVOKE_MAX_ARGS 3
+
+typedef enum {
+  GENERIC_KIND_INT,
+  GENERIC_KIND_POINTER,
+  GENERIC_KIND_UNSUPPORTED
+} GenericKind;
+
+typedef gint (* GenericInvokeFunc) (gpointer              callback,
+                                    gpointer              data1,
+                                    const va_arg_storage *args,
+                                    gpointer              data2);
+
+#define GENERIC_RTYPE_NONE              void
+#define GENERIC_RTYPE_INT               gint
+#define GENERIC_RETURN_NONE(call)       call; return 0
+#define GENERIC_RETURN_INT(call)        return call
+#define GENERIC_TYPE_INT                gint
+#define GENERIC_TYPE_POINTER            gpointer
+#define GENERIC_ARG_INT(n)              args[n]._gint
+#define GENERIC_ARG_POINTER(n)          args[n]._gpointer
+
+#define DEFINE_GENERIC_INVOKE_0(R) \
+static gint \
+generic_invoke_##R##__VOID (gpointer callback, gpointer data1, \
+                            const va_arg_storage *args, gpointer data2) \
+{ \
+  typedef GENERIC_RTYPE_##R (* Func) (gpointer, gpointer); \
+  GENERIC_RETURN_##R (((Func) callback) (data1, data2)); \
+}
+
+#define DEFINE_GENERIC_INVOKE_1(R, A) \
+static gint \
+generic_invoke_##R##__##A (gpointer callback, gpointer data1, \
+                           const va_arg_storage *args, gpointer data2) \
+{ \
+  typedef GENERIC_RTYPE_##R (* Func) (gpointer, GENERIC_TYPE_##A, gpointer); \
+  GENERIC_RETURN_##R (((Func) callback) (data1, GENERIC_ARG_##A (0), data2)); \
+}
+
+#define DEFINE_GENERIC_INVOKE_2(R, A, B) \
+static gint \
+generic_invoke_##R##__##A##_##B (gpointer callback, gpointer data1, \
+                                 const va_arg_storage *args, gpointer data2) \
+{ \
+  typedef GENERIC_RTYPE_##R (* Func) (gpointer, GENERIC_TYPE_##A, \
+                                      GENERIC_TYPE_##B, gpointer); \
+  GENERIC_RETURN_##R (((Func) callback) (data1, GENERIC_ARG_##A (0), \
+                                         GENERIC_ARG_##B (1), data2)); \
+}
+
+#define DEFINE_GENERIC_INVOKE_3(R, A, B, C) \
+static gint \
+generic_invoke_##R##__##A##_##B##_##C (gpointer callback, gpointer data1, \
+                                       const va_arg_storage *args, gpointer data2) \
+{ \
+  typedef GENERIC_RTYPE_##R (* Func) (gpointer, GENERIC_TYPE_##A, GENERIC_TYPE_##B, \
+                                      GENERIC_TYPE_##C, gpointer); \
+  GENERIC_RETURN_##R (((Func) callback) (data1, GENERIC_ARG_##A (0), GENERIC_ARG_##B (1), \
+                                         GENERIC_ARG_##C (2), data2)); \
+}
+
+#define DEFINE_GENERIC_INVOKERS(R) \
+  DEFINE_GENERIC_INVOKE_0 (R) \
+  DEFINE_GENERIC_INVOKE_1 (R, INT) \
+  DEFINE_GENERIC_INVOKE_1 (R, POINTER) \
+  DEFINE_GENERIC_INVOKE_2 (R, INT, INT) \
+  DEFINE_GENERIC_INVOKE_2 (R, POINTER, INT) \
+  DEFINE_GENERIC_INVOKE_2 (R, INT, POINTER) \
+  DEFINE_GENERIC_INVOKE_2 (R, POINTER, POINTER) \
+  DEFINE_GENERIC_INVOKE_3 (R, INT, INT, INT) \
+  DEFINE_GENERIC_INVOKE_3 (R, POINTER, INT, INT) \
+  DEFINE_GENERIC_INVOKE_3 (R, INT, POINTER, INT) \
+  DEFINE_GENERIC_INVOKE_3 (R, POINTER, POINTER, INT) \
+  DEFINE_GENERIC_INVOKE_3 (R, INT, INT, POINTER) \
+  DEFINE_GENERIC_INVOKE_3 (R, POINTER, INT, POINTER) \
+  DEFINE_GENERIC_INVOKE_3 (R, INT, POINTER, POINTER) \
+  DEFINE_GENERIC_INVOKE_3 (R, POINTER, POINTER, POINTER)
+
+/* Indexed by signature code */
+#define GENERIC_INVOKE_TABLE(R) { \
+  NULL, \
+  generic_invoke_##R##__VOID, \
+  generic_invoke_##R##__INT, \
+  generic_invoke_##R##__POINTER, \
+  generic_invoke_##R##__INT_INT, \
+  generic_invoke_##R##__POINTER_INT, \
+  generic_invoke_##R##__INT_POINTER, \
+  generic_invoke_##R##__POINTER_POINTER, \
+  generic_invoke_##R##__INT_INT_INT, \
+  generic_invoke_##R##__POINTER_INT_INT, \
+  generic_invoke_##R##__INT_POINTER_INT, \
+  generic_invoke_##R##__POINTER_POINTER_INT, \
+  generic_invoke_##R##__INT_INT_POINTER, \
+  generic_invoke_##R##__POINTER_INT_POINTER, \
+  generic_invoke_##R##__INT_POINTER_POINTER, \
+  generic_invoke_##R##__POINTER_POINTER_POINTER, \
+}
+
+DEFINE_GENERIC_INVOKERS (NONE)
+DEFINE_GENERIC_INVOKERS (INT)
+
+/* Indexed by whether there is a return value, then by signature code */
+static const GenericInvokeFunc generic_invokers[2][2 << GENERIC_INVOKE_MAX_ARGS] = {
+  GENERIC_INVOKE_TABLE (NONE),
+  GENERIC_INVOKE_TABLE (INT),
+};
+
+static inline GType
+generic_fundamental (GType type)
+{
+  /* Avoid the type node lookup for fundamental types */
+  if (type <= G_TYPE_FUNDAMENTAL_MAX)
+    return type;
+  return g_type_fundamental (type);
+}
+
+/* Must agree with value_to_ffi_type() and va_to_ffi_type() */
+static GenericKind
+generic_kind (GType fundamental)
+{
+  switch (fundamental)
+    {
+    case G_TYPE_BOOLEAN:
+    case G_TYPE_CHAR:
+    case G_TYPE_INT:
+    case G_TYPE_ENUM:
+    case G_TYPE_UCHAR:
+    case G_TYPE_UINT:
+    case G_TYPE_FLAGS:
+      return GENERIC_KIND_INT;
+    case G_TYPE_STRING:
+    case G_TYPE_OBJECT:
+    case G_TYPE_BOXED:
+    case G_TYPE_PARAM:
+    case G_TYPE_POINTER:
+    case G_TYPE_INTERFACE:
+    case G_TYPE_VARIANT:
+      return GENERIC_KIND_POINTER;
+    default:
+      return GENERIC_KIND_UNSUPPORTED;
+    }
+}
+
+/* Returns the index into generic_invokers for @return_value, or -1 */
+static gint
+generic_return_index (const GValue *return_value)
+{
+  if (return_value == NULL || G_VALUE_TYPE (return_value) == G_TYPE_INVALID)
+    return 0;
+  if (generic_kind (generic_fundamental (G_VALUE_TYPE (return_value))) == GENERIC_KIND_INT)
+    return 1;
+  return -1;
+}
+
+static void
+generic_set_return (GValue *return_value,
+                    gint    result)
+{
+  ffi_arg rvalue = result;
+
+  /* Int-sized return values come back from libffi widened to an ffi_arg */
+  value_from_ffi_type (return_value, (gpointer *) &rvalue);
+}
+
+/* Looks up the pre-generated invoker for a call with @param_values,
+ * collecting all but the instance into @args, or returns %NULL if the
+ * call has to go through libffi.
+ */
+static GenericInvokeFunc
+generic_collect_values (const GValue   *return_value,
+                        guint           n_param_values,
+                        const GValue   *param_values,
+                        va_arg_storage *args)
+{
+  gint return_index;
+  guint code;
+  guint i;
+
+  if (n_param_values == 0 || n_param_values > GENERIC_INVOKE_MAX_ARGS + 1)
+    return NULL;
+
+  return_index = generic_return_index (return_value);
+  if (return_index < 0)
+    return NULL;
+
+  if (generic_kind (generic_fundamental (G_VALUE_TYPE (param_values))) != GENERIC_KIND_POINTER)
+    return NULL;
+
+  code = 1 << (n_param_values - 1);
+  for (i = 1; i < n_param_values; i++)
+    {
+      const GValue *value = param_values + i;
+
+      switch (generic_fundamental (G_VALUE_TYPE (value)))
+        {
+        case G_TYPE_BOOLEAN:
+        case G_TYPE_CHAR:
+        case G_TYPE_INT:
+          args[i - 1]._gint = value->data[0].v_int;
+          break;
+        case G_TYPE_UCHAR:
+        case G_TYPE_UINT:
+          args[i - 1]._guint = value->data[0].v_uint;
+          break;
+        case G_TYPE_ENUM:
+          args[i - 1]._gint = value->data[0].v_long;
+          break;
+        case G_TYPE_FLAGS:
+          args[i - 1]._guint = value->data[0].v_ulong;
+          break;
+        case G_TYPE_STRING:
+        case G_TYPE_OBJECT:
+        case G_TYPE_BOXED:
+        case G_TYPE_PARAM:
+        case G_TYPE_POINTER:
+        case G_TYPE_INTERFACE:
+        case G_TYPE_VARIANT:
+          args[i - 1]._gpointer = value->data[0].v_pointer;
+          code |= 1 << (i - 1);
+          break;
+        default:
+          return NULL;
+        }
+    }
+
+  return generic_invokers[return_index][code];
+}
+
+/* Like generic_collect_values(), reading the arguments from @va */
+static GenericInvokeFunc
+generic_collect_va (const GValue   *return_value,
+                    va_list        *va,
+                    int             n_params,
+                    const GType    *param_types,
+                    va_arg_storage *args)
+{
+  gint return_index;
+  guint code;
+  int i;
+
+  if (n_params > GENERIC_INVOKE_MAX_ARGS)
+    return NULL;
+
+  return_index = generic_return_index (return_value);
+  if (return_index < 0)
+    return NULL;
+
+  code = 1 << n_params;
+  for (i = 0; i < n_params; i++)
+    {
+      GType type = param_types[i] & ~G_SIGNAL_TYPE_STATIC_SCOPE;
+
+      switch (generic_kind (generic_fundamental (type)))
+        {
+        case GENERIC_KIND_INT:
+          args[i]._gint = va_arg (*va, gint);
+          break;
+        case GENERIC_KIND_POINTER:
+          args[i]._gpointer = va_arg (*va, gpointer);
+          code |= 1 << i;
+          break;
+        case GENERIC_KIND_UNSUPPORTED:
+        default:
+          return NULL;
+        }
+    }
+
+  return generic_invokers[return_index][code];
+}
+
+static void
+va_arg_box (GType           param_type,
+            va_arg_storage *storage)
+{
+  GType type = param_type & ~G_SIGNAL_TYPE_STATIC_SCOPE;
+  GType fundamental = generic_fundamental (type);
+
+  if ((param_type & G_SIGNAL_TYPE_STATIC_SCOPE) == 0)
+    {
+      if (fundamental == G_TYPE_STRING && storage->_gpointer != NULL)
+        storage->_gpointer = g_strdup (storage->_gpointer);
+      else if (fundamental == G_TYPE_PARAM && storage->_gpointer != NULL)
+        storage->_gpointer = g_param_spec_ref (storage->_gpointer);
+      else if (fundamental == G_TYPE_BOXED && storage->_gpointer != NULL)
+        storage->_gpointer = g_boxed_copy (type, storage->_gpointer);
+      else if (fundamental == G_TYPE_VARIANT && storage->_gpointer != NULL)
+        storage->_gpointer = g_variant_ref_sink (storage->_gpointer);
+    }
+  if (fundamental == G_TYPE_OBJECT && storage->_gpointer != NULL)
+    storage->_gpointer = g_object_ref (storage->_gpointer);
+}
+
+static void
+va_arg_unbox (GType           param_type,
+              va_arg_storage *storage)
+{
+  GType type = param_type & ~G_SIGNAL_TYPE_STATIC_SCOPE;
+  GType fundamental = generic_fundamental (type);
+
+  if ((param_type & G_SIGNAL_TYPE_STATIC_SCOPE) == 0)
+    {
+      if (fundamental == G_TYPE_STRING && storage->_gpointer != NULL)
+        g_free (storage->_gpointer);
+      else if (fundamental == G_TYPE_PARAM && storage->_gpointer != NULL)
+        g_param_spec_unref (storage->_gpointer);
+      else if (fundamental == G_TYPE_BOXED && storage->_gpointer != NULL)
+        g_boxed_free (type, storage->_gpointer);
+      else if (fundamental == G_TYPE_VARIANT && storage->_gpointer != NULL)
+        g_variant_unref (storage->_gpointer);
+    }
+  if (fundamental == G_TYPE_OBJECT && storage->_gpointer != NULL)
+    g_object_unref (storage->_gpointer);
+}
+
 /**
  * g_cclosure_marshal_generic:
  * @closure: A #GClosure.
@@ -1421,6 +1745,10 @@ va_to_ffi_type (GType gtype,
  * A generic marshaller function implemented via
  * [libffi](http://sourceware.org/libffi/).
  *
+ * Since 2.68, calls with up to three arguments which are passed as
+ * integers or pointers, and no return value or an integer one, are
+ * dispatched without going through libffi.
+ *
  * Normally this function is not passed explicitly to g_signal_new(),
  * but used automatically by GLib when specifying a %NULL marshaller.
  *
@@ -1444,6 +1772,25 @@ g_cclosure_marshal_generic (GClosure     *closure,
   GCClosure *cc = (GCClosure*) closure;
   gint *enum_tmpval;
   gboolean tmpval_used = FALSE;
+  va_arg_storage storage[GENERIC_INVOKE_MAX_ARGS];
+  GenericInvokeFunc invoke;
+
+  invoke = generic_collect_values (return_gvalue, n_param_values, param_values, storage);
+  if (invoke != NULL)
+    {
+      gpointer callback = marshal_data ? marshal_data : cc->callback;
+      gpointer instance = param_values[0].data[0].v_pointer;
+      gint result;
+
+      if (G_CCLOSURE_SWAP_DATA (closure))
+        result = invoke (callback, closure->data, storage, instance);
+      else
+        result = invoke (callback, instance, storage, closure->data);
+
+      if (return_gvalue && G_VALUE_TYPE (return_gvalue))
+        generic_set_return (return_gvalue, result);
+      return;
+    }
 
   enum_tmpval = g_alloca (sizeof (gint));
   if (return_gvalue && G_VALUE_TYPE (return_gvalue))
@@ -1522,6 +1869,9 @@ g_cclosure_marshal_generic (GClosure     *closure,
  * A generic #GVaClosureMarshal function implemented via
  * [libffi](http://sourceware.org/libffi/).
  *
+ * As with g_cclosure_marshal_generic(), common signatures are
+ * dispatched without going through libffi since 2.68.
+ *
  * Since: 2.30
  */
 void
@@ -1545,6 +1895,38 @@ g_cclosure_marshal_generic_va (GClosure *closure,
   gint *enum_tmpval;
   gboolean tmpval_used = FALSE;
   va_list args_copy;
+  GenericInvokeFunc invoke;
+
+  if (n_params <= GENERIC_INVOKE_MAX_ARGS)
+    {
+      va_arg_storage generic_storage[GENERIC_INVOKE_MAX_ARGS];
+
+      G_VA_COPY (args_copy, args_list);
+      invoke = generic_collect_va (return_value, &args_copy, n_params,
+                                   param_types, generic_storage);
+      va_end (args_copy);
+
+      if (invoke != NULL)
+        {
+          gpointer callback = marshal_data ? marshal_data : cc->callback;
+          gint result;
+
+          for (i = 0; i < n_params; i++)
+            va_arg_box (param_types[i], &generic_storage[i]);
+
+          if (G_CCLOSURE_SWAP_DATA (closure))
+            result = invoke (callback, closure->data, generic_storage, instance);
+          else
+            result = invoke (callback, instance, generic_storage, closure->data);
+
+          for (i = 0; i < n_params; i++)
+            va_arg_unbox (param_types[i], &generic_storage[i]);
+
+          if (return_value && G_VALUE_TYPE (return_value))
+            generic_set_return (return_value, result);
+          return;
+        }
+    }
 
   enum_tmpval = g_alloca (sizeof (gint));
   if (return_value && G_VALUE_TYPE (return_value))
@@ -1583,27 +1965,11 @@ g_cclosure_marshal_generic_va (GClosure *closure,
   /* Box non-primitive arguments */
   for (i = 0; i < n_params; i++)
     {
-      GType type = param_types[i]  & ~G_SIGNAL_TYPE_STATIC_SCOPE;
-      GType fundamental = G_TYPE_FUNDAMENTAL (type);
-
-      atypes[i+1] = va_to_ffi_type (type,
+      atypes[i+1] = va_to_ffi_type (param_types[i] & ~G_SIGNAL_TYPE_STATIC_SCOPE,
 				    &args_copy,
 				    &storage[i]);
       args[i+1] = &storage[i];
-
-      if ((param_types[i]  & G_SIGNAL_TYPE_STATIC_SCOPE) == 0)
-	{
-	  if (fundamental == G_TYPE_STRING && storage[i]._gpointer != NULL)
-	    storage[i]._gpointer = g_strdup (storage[i]._gpointer);
-	  else if (fundamental == G_TYPE_PARAM && storage[i]._gpointer != NULL)
-	    storage[i]._gpointer = g_param_spec_ref (storage[i]._gpointer);
-	  else if (fundamental == G_TYPE_BOXED && storage[i]._gpointer != NULL)
-	    storage[i]._gpointer = g_boxed_copy (type, storage[i]._gpointer);
-	  else if (fundamental == G_TYPE_VARIANT && storage[i]._gpointer != NULL)
-	    storage[i]._gpointer = g_variant_ref_sink (storage[i]._gpointer);
-	}
-      if (fundamental == G_TYPE_OBJECT && storage[i]._gpointer != NULL)
-	storage[i]._gpointer = g_object_ref (storage[i]._gpointer);
+      va_arg_box (param_types[i], &storage[i]);
     }
 
   va_end (args_copy);
@@ -1615,24 +1981,7 @@ g_cclosure_marshal_generic_va (GClosure *closure,
 
   /* Unbox non-primitive arguments */
   for (i = 0; i < n_params; i++)
-    {
-      GType type = param_types[i]  & ~G_SIGNAL_TYPE_STATIC_SCOPE;
-      GType fundamental = G_TYPE_FUNDAMENTAL (type);
-
-      if ((param_types[i]  & G_SIGNAL_TYPE_STATIC_SCOPE) == 0)
-	{
-	  if (fundamental == G_TYPE_STRING && storage[i]._gpointer != NULL)
-	    g_free (storage[i]._gpointer);
-	  else if (fundamental == G_TYPE_PARAM && storage[i]._gpointer != NULL)
-	    g_param_spec_unref (storage[i]._gpointer);
-	  else if (fundamental == G_TYPE_BOXED && storage[i]._gpointer != NULL)
-	    g_boxed_free (type, storage[i]._gpointer);
-	  else if (fundamental == G_TYPE_VARIANT && storage[i]._gpointer != NULL)
-	    g_variant_unref (storage[i]._gpointer);
-	}
-      if (fundamental == G_TYPE_OBJECT && storage[i]._gpointer != NULL)
-	g_object_unref (storage[i]._gpointer);
-    }
+    va_arg_unbox (param_types[i], &storage[i]);
   
   if (return_value && G_VALUE_TYPE (return_value))
     value_from_ffi_type (return_value, rvalue);
@@ -153,6 +153,7 @@
 /* --- signals --- */
 enum {
   NOTIFY,
+  NOTIFY_BATCH,
   LAST_SIGNAL
 };
 
@@ -163,7 +164,13 @@ enum {
 };
 
 #define OPTIONAL_FLAG_IN_CONSTRUCTION 1<<0
-#define OPTIONAL_FLAG_HAS_SIGNAL_HANDLER 1<<1 /* Set if object ever had a signal handler */
+#define OPTIONAL_FLAG_NOTIFY_BATCH 1u<<31 /* had g_object_set_notify_batch_mode() called */
+/* The bits in between tell which signals the object ever had a handler for:
+ * bit OPTIONAL_SIGNAL_HANDLER_SHIFT + (signal_id % OPTIONAL_SIGNAL_HANDLER_BITS)
+ * is set for a handler of signal_id. The signal emission fast path reads
+ * them without holding any lock. */
+#define OPTIONAL_SIGNAL_HANDLER_SHIFT 1
+#define OPTIONAL_SIGNAL_HANDLER_BITS 30
 
 #if SIZEOF_INT == 4 && GLIB_SIZEOF_VOID_P == 8
 #define HAVE_OPTIONAL_FLAGS
@@ -249,6 +256,7 @@ static GQuark	            quark_weak_refs = 0;
 static GQuark	            quark_toggle_refs = 0;
 static GQuark               quark_notify_queue;
 static GQuark               quark_in_construction;
+static GQuark               quark_notify_batch;
 static GParamSpecPool      *pspec_pool = NULL;
 static gulong	            gobject_signals[LAST_SIGNAL] = { 0, };
 static guint (*floating_flag_handler) (GObject*, gint) = object_floating_flag_handler;
@@ -257,6 +265,7 @@ static GQuark	            quark_weak_locations = 0;
 static GRWLock              weak_locations_lock;
 
 G_LOCK_DEFINE_STATIC(notify_lock);
+G_LOCK_DEFINE_STATIC(notify_batch_lock);
 
 /* --- functions --- */
 static void
@@ -470,6 +479,7 @@ g_object_base_class_init (GObjectClass *class)
 
   /* reset instance specific fields and methods that don't get inherited */
   class->construct_properties = pclass ? g_slist_copy (pclass->construct_properties) : NULL;
+  class->pspec_cache = NULL;
   class->get_property = NULL;
   class->set_property = NULL;
 }
@@ -483,6 +493,7 @@ g_object_base_class_finalize (GObjectClass *class)
 
   g_slist_free (class->construct_properties);
   class->construct_properties = NULL;
+  g_clear_pointer (&class->pspec_cache, g_free);
   list = g_param_spec_pool_list_owned (pspec_pool, G_OBJECT_CLASS_TYPE (class));
   for (node = list; node; node = node->next)
     {
@@ -506,6 +517,7 @@ g_object_do_class_init (GObjectClass *class)
   quark_toggle_refs = g_quark_from_static_string ("GObject-toggle-references");
   quark_notify_queue = g_quark_from_static_string ("GObject-notify-queue");
   quark_in_construction = g_quark_from_static_string ("GObject-in-construction");
+  quark_notify_batch = g_quark_from_static_string ("GObject-notify-batch");
   pspec_pool = g_param_spec_pool_new (TRUE);
 
   class->constructor = g_object_constructor;
@@ -556,12 +568,112 @@ g_object_do_class_init (GObjectClass *class)
 		  G_TYPE_NONE,
 		  1, G_TYPE_PARAM);
 
+  /**
+   * GObject::notify-batch:
+   * @gobject: the object which received the signal.
+   * @pspecs: (element-type GParamSpec): the #GParamSpecs of the properties
+   *   which changed.
+   *
+   * The notify-batch signal is emitted on an object once for several
+   * property changes, if batching was enabled for it with
+   * g_object_set_notify_batch_mode().
+   *
+   * #GObject::notify is then only emitted for the changed properties
+   * which have a handler connected to it, so that its users, such as
+   * #GBinding, keep working. Connecting to this signal instead of to
+   * #GObject::notify is what saves the emissions.
+   *
+   * Since: 2.68
+   */
+  gobject_signals[NOTIFY_BATCH] =
+    g_signal_new (g_intern_static_string ("notify-batch"),
+                  G_TYPE_FROM_CLASS (class),
+                  G_SIGNAL_RUN_LAST | G_SIGNAL_NO_HOOKS,
+                  0,
+                  NULL, NULL,
+                  NULL,
+                  G_TYPE_NONE,
+                  1, G_TYPE_PTR_ARRAY | G_SIGNAL_TYPE_STATIC_SCOPE);
+
   /* Install a check function that we'll use to verify that classes that
    * implement an interface implement all properties for that interface
    */
   g_type_add_interface_check (NULL, object_interface_check_properties);
 }
 
+/* Looking properties up by name in the pspec pool means taking its
+ * mutex and hashing the name once for every ancestor of the class.  As
+ * g_object_new() and g_object_set() are mostly called with the same
+ * string literals over and over, each class keeps a small table of the
+ * pspecs found for it, indexed by the address of the name.  Entries
+ * are confirmed by comparing the name, so a name at a reused address,
+ * or two addresses of the same name, can only cause a miss.
+ *
+ * Properties can only be installed on a class before it is derived,
+ * so installing one only needs to clear the table of that class.
+ */
+#define PSPEC_CACHE_SIZE 32
+
+typedef struct {
+  GParamSpec *pspecs[PSPEC_CACHE_SIZE];
+} PSpecCache;
+
+static inline guint
+pspec_cache_index (const gchar *name)
+{
+  gsize addr = GPOINTER_TO_SIZE (name);
+
+  return (addr ^ (addr >> 5) ^ (addr >> 10)) % PSPEC_CACHE_SIZE;
+}
+
+static void
+pspec_cache_clear (GObjectClass *class)
+{
+  PSpecCache *cache = g_atomic_pointer_get (&class->pspec_cache);
+  guint i;
+
+  if (cache == NULL)
+    return;
+
+  for (i = 0; i < PSPEC_CACHE_SIZE; i++)
+    g_atomic_pointer_set (&cache->pspecs[i], NULL);
+}
+
+static GParamSpec *
+find_pspec (GObjectClass *class,
+            const gchar  *property_name)
+{
+  PSpecCache *cache = g_atomic_pointer_get (&class->pspec_cache);
+  guint i = pspec_cache_index (property_name);
+  GParamSpec *pspec;
+
+  if (G_LIKELY (cache != NULL))
+    {
+      pspec = g_atomic_pointer_get (&cache->pspecs[i]);
+      if (pspec != NULL &&
+          (pspec->name == property_name || strcmp (pspec->name, property_name) == 0))
+        return pspec;
+    }
+  else
+    {
+      cache = g_new0 (PSpecCache, 1);
+      if (!g_atomic_pointer_compare_and_exchange (&class->pspec_cache, NULL, cache))
+        {
+          g_free (cache);
+          cache = g_atomic_pointer_get (&class->pspec_cache);
+        }
+    }
+
+  pspec = g_param_spec_pool_lookup (pspec_pool,
+                                    property_name,
+                                    G_OBJECT_CLASS_TYPE (class),
+                                    TRUE);
+  if (pspec != NULL)
+    g_atomic_pointer_set (&cache->pspecs[i], pspec);
+
+  return pspec;
+}
+
 static inline gboolean
 install_property_internal (GType       g_type,
 			   guint       property_id,
@@ -616,6 +728,8 @@ validate_and_install_class_property (GObjectClass *class,
   class->flags |= CLASS_HAS_PROPS_FLAG;
   if (install_property_internal (oclass_type, property_id, pspec))
     {
+      pspec_cache_clear (class);
+
       if (pspec->flags & (G_PARAM_CONSTRUCT | G_PARAM_CONSTRUCT_ONLY))
         class->construct_properties = g_slist_append (class->construct_properties, pspec);
 
@@ -839,10 +953,7 @@ g_object_class_find_property (GObjectClass *class,
   g_return_val_if_fail (G_IS_OBJECT_CLASS (class), NULL);
   g_return_val_if_fail (property_name != NULL, NULL);
   
-  pspec = g_param_spec_pool_lookup (pspec_pool,
-				    property_name,
-				    G_OBJECT_CLASS_TYPE (class),
-				    TRUE);
+  pspec = find_pspec (class, property_name);
   if (pspec)
     {
       redirect = g_param_spec_get_redirect_target (pspec);
@@ -1062,21 +1173,29 @@ object_unset_optional_flags (GObject *object,
 #endif
 }
 
+/* May return %TRUE for a signal which never had a handler on @object, but
+ * never %FALSE for one which had */
 gboolean
-_g_object_has_signal_handler  (GObject *object)
+_g_object_has_signal_handler  (GObject *object,
+                               guint    signal_id)
 {
 #ifdef HAVE_OPTIONAL_FLAGS
-  return (object_get_optional_flags (object) & OPTIONAL_FLAG_HAS_SIGNAL_HANDLER) != 0;
+  guint bit = 1u << (OPTIONAL_SIGNAL_HANDLER_SHIFT + signal_id % OPTIONAL_SIGNAL_HANDLER_BITS);
+
+  return (object_get_optional_flags (object) & bit) != 0;
 #else
   return TRUE;
 #endif
 }
 
 void
-_g_object_set_has_signal_handler (GObject     *object)
+_g_object_set_has_signal_handler (GObject     *object,
+                                  guint        signal_id)
 {
 #ifdef HAVE_OPTIONAL_FLAGS
-  object_set_optional_flags (object, OPTIONAL_FLAG_HAS_SIGNAL_HANDLER);
+  guint bit = 1u << (OPTIONAL_SIGNAL_HANDLER_SHIFT + signal_id % OPTIONAL_SIGNAL_HANDLER_BITS);
+
+  object_set_optional_flags (object, bit);
 #endif
 }
 
@@ -1110,6 +1229,18 @@ unset_object_in_construction (GObject *object)
 #endif
 }
 
+/* May return %TRUE for an object which never had a batch mode set, but
+ * never %FALSE for one which had */
+static inline gboolean
+object_has_notify_batch (GObject *object)
+{
+#ifdef HAVE_OPTIONAL_FLAGS
+  return (object_get_optional_flags (object) & OPTIONAL_FLAG_NOTIFY_BATCH) != 0;
+#else
+  return TRUE;
+#endif
+}
+
 static void
 g_object_init (GObject		*object,
 	       GObjectClass	*class)
@@ -1195,6 +1326,169 @@ g_object_finalize (GObject *object)
     });
 }
 
+/* State of objects which had g_object_set_notify_batch_mode() called,
+ * protected by notify_batch_lock.
+ */
+typedef struct
+{
+  GObjectNotifyBatchMode mode;
+  GMainContext *context;        /* for G_OBJECT_NOTIFY_BATCH_IDLE */
+  GSource *source;              /* idle dispatching @pending, if any */
+  GPtrArray *pending;           /* (element-type GParamSpec) */
+  guint n_pending_notifies;     /* ::notify emissions @pending replaces */
+  guint64 n_batches;
+  guint64 n_coalesced;
+} NotifyBatch;
+
+static void
+notify_batch_free (gpointer data)
+{
+  NotifyBatch *batch = data;
+
+  if (batch->source != NULL)
+    {
+      g_source_destroy (batch->source);
+      g_source_unref (batch->source);
+    }
+  g_clear_pointer (&batch->context, g_main_context_unref);
+  g_ptr_array_unref (batch->pending);
+  g_free (batch);
+}
+
+static void
+notify_batch_emit (GObject     *object,
+                   NotifyBatch *batch,
+                   GPtrArray   *pspecs,
+                   guint        n_replaced)
+{
+  GObjectClass *class = G_OBJECT_GET_CLASS (object);
+  guint n_emitted = 0;
+  guint i;
+
+  g_signal_emit (object, gobject_signals[NOTIFY_BATCH], 0, pspecs);
+
+  /* An emission of ::notify without any handler would do nothing */
+  for (i = 0; i < pspecs->len; i++)
+    {
+      GParamSpec *pspec = g_ptr_array_index (pspecs, i);
+      GQuark detail = g_param_spec_get_name_quark (pspec);
+
+      if (class->notify != NULL ||
+          g_signal_has_handler_pending (object, gobject_signals[NOTIFY], detail, FALSE))
+        {
+          g_signal_emit (object, gobject_signals[NOTIFY], detail, pspec);
+          n_emitted++;
+        }
+    }
+
+  G_LOCK (notify_batch_lock);
+  batch->n_batches++;
+  batch->n_coalesced += n_replaced - n_emitted;
+  G_UNLOCK (notify_batch_lock);
+}
+
+static void
+notify_batch_flush (GObject     *object,
+                    NotifyBatch *batch)
+{
+  GPtrArray *pspecs;
+  GSource *source;
+  guint n_replaced;
+
+  G_LOCK (notify_batch_lock);
+  source = g_steal_pointer (&batch->source);
+  pspecs = batch->pending;
+  n_replaced = batch->n_pending_notifies;
+  batch->pending = g_ptr_array_new ();
+  batch->n_pending_notifies = 0;
+  G_UNLOCK (notify_batch_lock);
+
+  if (source != NULL)
+    {
+      g_source_destroy (source);
+      g_source_unref (source);
+    }
+
+  if (pspecs->len > 0)
+    notify_batch_emit (object, batch, pspecs, n_replaced);
+  g_ptr_array_unref (pspecs);
+}
+
+static gboolean
+notify_batch_idle (gpointer user_data)
+{
+  GObject *object = g_weak_ref_get (user_data);
+
+  if (object != NULL)
+    {
+      notify_batch_flush (object, g_datalist_id_get_data (&object->qdata, quark_notify_batch));
+      g_object_unref (object);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+notify_batch_weak_ref_free (gpointer data)
+{
+  g_weak_ref_clear (data);
+  g_free (data);
+}
+
+/* Returns %FALSE if the object is not batching its notifications */
+static gboolean
+notify_batch_add (GObject     *object,
+                  guint        n_pspecs,
+                  GParamSpec **pspecs)
+{
+  GObjectNotifyBatchMode mode;
+  NotifyBatch *batch;
+  guint i;
+
+  batch = g_datalist_id_get_data (&object->qdata, quark_notify_batch);
+  if (batch == NULL)
+    return FALSE;
+
+  G_LOCK (notify_batch_lock);
+
+  mode = batch->mode;
+  if (mode == G_OBJECT_NOTIFY_BATCH_IDLE)
+    {
+      for (i = 0; i < n_pspecs; i++)
+        if (!g_ptr_array_find (batch->pending, pspecs[i], NULL))
+          g_ptr_array_add (batch->pending, pspecs[i]);
+      batch->n_pending_notifies += n_pspecs;
+
+      if (batch->source == NULL)
+        {
+          GWeakRef *weak_ref = g_new (GWeakRef, 1);
+
+          /* Don't keep the object alive until the context runs */
+          g_weak_ref_init (weak_ref, object);
+          batch->source = g_idle_source_new ();
+          g_source_set_priority (batch->source, G_PRIORITY_DEFAULT);
+          g_source_set_callback (batch->source, notify_batch_idle,
+                                 weak_ref, notify_batch_weak_ref_free);
+          g_source_set_name (batch->source, "[gobject] notify_batch_idle");
+          g_source_attach (batch->source, batch->context);
+        }
+    }
+
+  G_UNLOCK (notify_batch_lock);
+
+  if (mode == G_OBJECT_NOTIFY_BATCH_IMMEDIATE)
+    {
+      GPtrArray *array = g_ptr_array_sized_new (n_pspecs);
+
+      for (i = 0; i < n_pspecs; i++)
+        g_ptr_array_add (array, pspecs[i]);
+      notify_batch_emit (object, batch, array, n_pspecs);
+      g_ptr_array_unref (array);
+    }
+
+  return mode != G_OBJECT_NOTIFY_BATCH_NONE;
+}
+
 static void
 g_object_dispatch_properties_changed (GObject     *object,
 				      guint        n_pspecs,
@@ -1202,6 +1496,10 @@ g_object_dispatch_properties_changed (GObject     *object,
 {
   guint i;
 
+  if (G_UNLIKELY (object_has_notify_batch (object)) &&
+      notify_batch_add (object, n_pspecs, pspecs))
+    return;
+
   for (i = 0; i < n_pspecs; i++)
     g_signal_emit (object, gobject_signals[NOTIFY], g_param_spec_get_name_quark (pspecs[i]), pspecs[i]);
 }
@@ -1333,10 +1631,7 @@ g_object_notify (GObject     *object,
    * (by, e.g. calling g_object_class_find_property())
    * because g_object_notify_queue_add() does that
    */
-  pspec = g_param_spec_pool_lookup (pspec_pool,
-				    property_name,
-				    G_OBJECT_TYPE (object),
-				    TRUE);
+  pspec = find_pspec (G_OBJECT_GET_CLASS (object), property_name);
 
   if (!pspec)
     g_warning ("%s: object class '%s' has no property named '%s'",
@@ -1445,6 +1740,134 @@ g_object_thaw_notify (GObject *object)
   g_object_unref (object);
 }
 
+/**
+ * g_object_set_notify_batch_mode:
+ * @object: a #GObject
+ * @mode: how to notify the changes of the properties of @object
+ *
+ * Sets how the changes of the properties of @object are notified.
+ *
+ * By default, #GObject::notify is emitted once for each changed property,
+ * when g_object_notify() is called or when notifications are thawed. An
+ * object changing many properties in a row floods its handlers. With
+ * %G_OBJECT_NOTIFY_BATCH_IMMEDIATE, the properties changed between
+ * g_object_freeze_notify() and g_object_thaw_notify(), or by one call to
+ * g_object_set(), are instead notified by a single #GObject::notify-batch
+ * emission. With %G_OBJECT_NOTIFY_BATCH_IDLE, that emission is deferred to
+ * the next iteration of the thread-default main context of the caller, so
+ * that all the changes until then are coalesced, each property appearing
+ * only once.
+ *
+ * While batching, #GObject::notify is only emitted for the changed
+ * properties which have a handler connected to it.
+ *
+ * Changes batched but not notified yet are notified when the mode is
+ * changed. Changes pending for %G_OBJECT_NOTIFY_BATCH_IDLE are dropped if
+ * @object is disposed before the main context runs.
+ *
+ * This only affects the default #GObjectClass.dispatch_properties_changed
+ * handler, which classes overriding it are expected to chain up to.
+ *
+ * Since: 2.68
+ */
+void
+g_object_set_notify_batch_mode (GObject                *object,
+                                GObjectNotifyBatchMode  mode)
+{
+  NotifyBatch *batch;
+
+  g_return_if_fail (G_IS_OBJECT (object));
+  g_return_if_fail (mode <= G_OBJECT_NOTIFY_BATCH_IDLE);
+
+  G_LOCK (notify_batch_lock);
+  batch = g_datalist_id_get_data (&object->qdata, quark_notify_batch);
+  if (batch == NULL && mode != G_OBJECT_NOTIFY_BATCH_NONE)
+    {
+      batch = g_new0 (NotifyBatch, 1);
+      batch->pending = g_ptr_array_new ();
+      g_datalist_id_set_data_full (&object->qdata, quark_notify_batch,
+                                   batch, notify_batch_free);
+      object_set_optional_flags (object, OPTIONAL_FLAG_NOTIFY_BATCH);
+    }
+  G_UNLOCK (notify_batch_lock);
+
+  if (batch == NULL)
+    return;
+
+  notify_batch_flush (object, batch);
+
+  G_LOCK (notify_batch_lock);
+  batch->mode = mode;
+  g_clear_pointer (&batch->context, g_main_context_unref);
+  if (mode == G_OBJECT_NOTIFY_BATCH_IDLE)
+    batch->context = g_main_context_ref_thread_default ();
+  G_UNLOCK (notify_batch_lock);
+}
+
+/**
+ * g_object_get_notify_batch_mode:
+ * @object: a #GObject
+ *
+ * Gets how the changes of the properties of @object are notified, as set
+ * with g_object_set_notify_batch_mode().
+ *
+ * Returns: the notification mode of @object
+ *
+ * Since: 2.68
+ */
+GObjectNotifyBatchMode
+g_object_get_notify_batch_mode (GObject *object)
+{
+  GObjectNotifyBatchMode mode = G_OBJECT_NOTIFY_BATCH_NONE;
+  NotifyBatch *batch;
+
+  g_return_val_if_fail (G_IS_OBJECT (object), G_OBJECT_NOTIFY_BATCH_NONE);
+
+  G_LOCK (notify_batch_lock);
+  batch = g_datalist_id_get_data (&object->qdata, quark_notify_batch);
+  if (batch != NULL)
+    mode = batch->mode;
+  G_UNLOCK (notify_batch_lock);
+
+  return mode;
+}
+
+/**
+ * g_object_get_notify_batch_counters:
+ * @object: a #GObject
+ * @n_batches: (out) (optional): return location for the number of
+ *   #GObject::notify-batch emissions
+ * @n_coalesced: (out) (optional): return location for the number of
+ *   #GObject::notify emissions saved
+ *
+ * Gets counters showing how much batching the notifications of @object
+ * saved since g_object_set_notify_batch_mode() was first called on it.
+ *
+ * @n_coalesced is the number of #GObject::notify emissions which would
+ * have been done without batching, minus the ones still done for the
+ * properties with a handler for it. The #GObject::notify-batch emissions
+ * themselves are counted in @n_batches.
+ *
+ * Since: 2.68
+ */
+void
+g_object_get_notify_batch_counters (GObject *object,
+                                    guint64 *n_batches,
+                                    guint64 *n_coalesced)
+{
+  NotifyBatch *batch;
+
+  g_return_if_fail (G_IS_OBJECT (object));
+
+  G_LOCK (notify_batch_lock);
+  batch = g_datalist_id_get_data (&object->qdata, quark_notify_batch);
+  if (n_batches != NULL)
+    *n_batches = batch != NULL ? batch->n_batches : 0;
+  if (n_coalesced != NULL)
+    *n_coalesced = batch != NULL ? batch->n_coalesced : 0;
+  G_UNLOCK (notify_batch_lock);
+}
+
 static void
 consider_issuing_property_deprecation_warning (const GParamSpec *pspec)
 {
@@ -2085,7 +2508,7 @@ g_object_new_with_properties (GType          object_type,
       for (i = 0; i < n_properties; i++)
         {
           GParamSpec *pspec;
-          pspec = g_param_spec_pool_lookup (pspec_pool, names[i], object_type, TRUE);
+          pspec = find_pspec (class, names[i]);
           if (!g_object_new_is_valid_property (object_type, pspec, names[i], params, count))
             continue;
           params[count].pspec = pspec;
@@ -2161,7 +2584,7 @@ g_object_newv (GType       object_type,
         {
           GParamSpec *pspec;
 
-          pspec = g_param_spec_pool_lookup (pspec_pool, parameters[i].name, object_type, TRUE);
+          pspec = find_pspec (class, parameters[i].name);
           if (!g_object_new_is_valid_property (object_type, pspec, parameters[i].name, cparams, j))
             continue;
 
@@ -2230,7 +2653,7 @@ g_object_new_valist (GType        object_type,
           gchar *error = NULL;
           GParamSpec *pspec;
 
-          pspec = g_param_spec_pool_lookup (pspec_pool, name, object_type, TRUE);
+          pspec = find_pspec (class, name);
 
           if (!g_object_new_is_valid_property (object_type, pspec, name, params, n_params))
             break;
@@ -2367,8 +2790,8 @@ g_object_setv (GObject       *object,
 {
   guint i;
   GObjectNotifyQueue *nqueue;
+  GObjectClass *class;
   GParamSpec *pspec;
-  GType obj_type;
 
   g_return_if_fail (G_IS_OBJECT (object));
 
@@ -2376,11 +2799,11 @@ g_object_setv (GObject       *object,
     return;
 
   g_object_ref (object);
-  obj_type = G_OBJECT_TYPE (object);
+  class = G_OBJECT_GET_CLASS (object);
   nqueue = g_object_notify_queue_freeze (object, FALSE);
   for (i = 0; i < n_properties; i++)
     {
-      pspec = g_param_spec_pool_lookup (pspec_pool, names[i], obj_type, TRUE);
+      pspec = find_pspec (class, names[i]);
 
       if (!g_object_set_is_valid_property (object, pspec, names[i]))
         break;
@@ -2408,11 +2831,13 @@ g_object_set_valist (GObject	 *object,
 		     va_list	  var_args)
 {
   GObjectNotifyQueue *nqueue;
+  GObjectClass *class;
   const gchar *name;
   
   g_return_if_fail (G_IS_OBJECT (object));
   
   g_object_ref (object);
+  class = G_OBJECT_GET_CLASS (object);
   nqueue = g_object_notify_queue_freeze (object, FALSE);
   
   name = first_property_name;
@@ -2422,10 +2847,7 @@ g_object_set_valist (GObject	 *object,
       GParamSpec *pspec;
       gchar *error = NULL;
       
-      pspec = g_param_spec_pool_lookup (pspec_pool,
-					name,
-					G_OBJECT_TYPE (object),
-					TRUE);
+      pspec = find_pspec (class, name);
 
       if (!g_object_set_is_valid_property (object, pspec, name))
         break;
@@ -2492,8 +2914,8 @@ g_object_getv (GObject      *object,
                GValue        values[])
 {
   guint i;
+  GObjectClass *class;
   GParamSpec *pspec;
-  GType obj_type;
 
   g_return_if_fail (G_IS_OBJECT (object));
 
@@ -2502,13 +2924,10 @@ g_object_getv (GObject      *object,
 
   g_object_ref (object);
 
-  obj_type = G_OBJECT_TYPE (object);
+  class = G_OBJECT_GET_CLASS (object);
   for (i = 0; i < n_properties; i++)
     {
-      pspec = g_param_spec_pool_lookup (pspec_pool,
-				        names[i],
-				        obj_type,
-				        TRUE);
+      pspec = find_pspec (class, names[i]);
       if (!g_object_get_is_valid_property (object, pspec, names[i]))
         break;
 
@@ -2539,11 +2958,13 @@ g_object_get_valist (GObject	 *object,
 		     const gchar *first_property_name,
 		     va_list	  var_args)
 {
+  GObjectClass *class;
   const gchar *name;
   
   g_return_if_fail (G_IS_OBJECT (object));
   
   g_object_ref (object);
+  class = G_OBJECT_GET_CLASS (object);
   
   name = first_property_name;
   
@@ -2553,10 +2974,7 @@ g_object_get_valist (GObject	 *object,
       GParamSpec *pspec;
       gchar *error;
       
-      pspec = g_param_spec_pool_lookup (pspec_pool,
-					name,
-					G_OBJECT_TYPE (object),
-					TRUE);
+      pspec = find_pspec (class, name);
 
       if (!g_object_get_is_valid_property (object, pspec, name))
         break;
@@ -2716,10 +3134,7 @@ g_object_get_property (GObject	   *object,
   
   g_object_ref (object);
   
-  pspec = g_param_spec_pool_lookup (pspec_pool,
-				    property_name,
-				    G_OBJECT_TYPE (object),
-				    TRUE);
+  pspec = find_pspec (G_OBJECT_GET_CLASS (object), property_name);
 
   if (g_object_get_is_valid_property (object, pspec, property_name))
     {
@@ -236,6 +236,31 @@ typedef void (*GObjectFinalizeFunc)     (GObject      *object);
  */
 typedef void (*GWeakNotify)		(gpointer      data,
 					 GObject      *where_the_object_was);
+/**
+ * GObjectNotifyBatchMode:
+ * @G_OBJECT_NOTIFY_BATCH_NONE: Emit #GObject::notify once for each changed
+ *   property. This is the default.
+ * @G_OBJECT_NOTIFY_BATCH_IMMEDIATE: Emit #GObject::notify-batch once with
+ *   all the properties changed while notifications were frozen, when they
+ *   are thawed.
+ * @G_OBJECT_NOTIFY_BATCH_IDLE: Like %G_OBJECT_NOTIFY_BATCH_IMMEDIATE, but
+ *   emit #GObject::notify-batch from the main context which was the
+ *   thread-default one when the mode was set, at its next iteration. All
+ *   the changes until then are coalesced in that single emission.
+ *
+ * How the changes of the properties of an object are notified, see
+ * g_object_set_notify_batch_mode().
+ *
+ * Since: 2.68
+ */
+GLIB_AVAILABLE_TYPE_IN_2_68
+typedef enum
+{
+  G_OBJECT_NOTIFY_BATCH_NONE,
+  G_OBJECT_NOTIFY_BATCH_IMMEDIATE,
+  G_OBJECT_NOTIFY_BATCH_IDLE
+} GObjectNotifyBatchMode;
+
 /**
  * GObject:
  * 
@@ -349,8 +374,10 @@ struct  _GObjectClass
   /*< private >*/
   gsize		flags;
 
+  gpointer	pspec_cache;
+
   /* padding */
-  gpointer	pdummy[6];
+  gpointer	pdummy[5];
 };
 /**
  * GObjectConstructParam:
@@ -490,6 +517,18 @@ void        g_object_notify_by_pspec          (GObject        *object,
 					       GParamSpec     *pspec);
 GLIB_AVAILABLE_IN_ALL
 void        g_object_thaw_notify              (GObject        *object);
+G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+GLIB_AVAILABLE_IN_2_68
+void        g_object_set_notify_batch_mode    (GObject                *object,
+                                               GObjectNotifyBatchMode  mode);
+GLIB_AVAILABLE_IN_2_68
+GObjectNotifyBatchMode
+            g_object_get_notify_batch_mode    (GObject                *object);
+G_GNUC_END_IGNORE_DEPRECATIONS
+GLIB_AVAILABLE_IN_2_68
+void        g_object_get_notify_batch_counters (GObject               *object,
+                                                guint64               *n_batches,
+                                                guint64               *n_coalesced);
 GLIB_AVAILABLE_IN_ALL
 gboolean    g_object_is_floating    	      (gpointer        object);
 GLIB_AVAILABLE_IN_ALL
@@ -137,6 +137,7 @@
 typedef struct _SignalNode   SignalNode;
 typedef struct _SignalKey    SignalKey;
 typedef struct _Emission     Emission;
+typedef struct _ThreadEmissions ThreadEmissions;
 typedef struct _Handler      Handler;
 typedef struct _HandlerList  HandlerList;
 typedef struct _HandlerMatch HandlerMatch;
@@ -235,8 +236,6 @@ struct _SignalNode
   /* reinitializable portion */
   guint              flags : 9;
   guint              n_params : 8;
-  guint              single_va_closure_is_valid : 1;
-  guint              single_va_closure_is_after : 1;
   GType		    *param_types; /* mangled with G_SIGNAL_TYPE_STATIC_SCOPE flag */
   GType		     return_type; /* mangled with G_SIGNAL_TYPE_STATIC_SCOPE flag */
   GBSearchArray     *class_closure_bsa;
@@ -245,11 +244,19 @@ struct _SignalNode
   GSignalCVaMarshaller va_marshaller;
   GHookList         *emission_hooks;
 
-  GClosure *single_va_closure;
+  /* only written with the lock held, but read without it by
+   * signal_emit_valist_lock_free() */
+  gint               single_va_closure_state;  /* (atomic) */
+  GClosure          *single_va_closure;        /* (atomic) */
 };
 
 #define	SINGLE_VA_CLOSURE_EMPTY_MAGIC GINT_TO_POINTER(1)	/* indicates single_va_closure is valid but empty */
 
+/* bits of SignalNode.single_va_closure_state */
+#define SINGLE_VA_CLOSURE_VALID     (1 << 0)
+#define SINGLE_VA_CLOSURE_AFTER     (1 << 1)  /* single_va_closure is run-last */
+#define SINGLE_VA_CLOSURE_LOCK_FREE (1 << 2)  /* emissions on instances without handlers need no lock */
+
 struct _SignalKey
 {
   GType  itype;
@@ -260,12 +267,19 @@ struct _SignalKey
 struct _Emission
 {
   Emission             *next;
+  ThreadEmissions      *thread;
+  Emission             *thread_next;
   gpointer              instance;
   GSignalInvocationHint ihint;
   EmissionState         state;
   GType			chain_type;
 };
 
+struct _ThreadEmissions
+{
+  Emission             *innermost;
+};
+
 struct _HandlerList
 {
   guint    signal_id;
@@ -322,6 +336,10 @@ static GBSearchConfig g_class_closure_bconfig = {
 };
 static GHashTable    *g_handler_list_bsa_ht = NULL;
 static Emission      *g_emissions = NULL;
+/* The emissions running in each thread, innermost first. Unlike g_emissions,
+ * which only has those started with the lock held, a thread can look at its
+ * own without the lock. */
+static GPrivate       g_thread_emissions = G_PRIVATE_INIT (g_free);
 static gulong         g_handler_sequential_number = 1;
 static GHashTable    *g_handlers = NULL;
 
@@ -331,18 +349,50 @@ G_LOCK_DEFINE_STATIC (g_signal_mutex);
 
 
 /* --- signal nodes --- */
+/* Nodes are looked up without the lock by signal_emit_valist_lock_free(),
+ * so g_signal_nodes is never reallocated in place: a bigger array replaces
+ * it, and the old one is leaked for the readers which may still use it.
+ * A node is stored in the array before g_n_signal_nodes includes it. */
 static guint          g_n_signal_nodes = 0;
+static guint          g_n_signal_nodes_allocated = 0;
 static SignalNode   **g_signal_nodes = NULL;
 
 static inline SignalNode*
 LOOKUP_SIGNAL_NODE (guint signal_id)
 {
-  if (signal_id < g_n_signal_nodes)
-    return g_signal_nodes[signal_id];
+  if (signal_id < (guint) g_atomic_int_get (&g_n_signal_nodes))
+    {
+      SignalNode **nodes = g_atomic_pointer_get (&g_signal_nodes);
+
+      return nodes[signal_id];
+    }
   else
     return NULL;
 }
 
+/* HOLDS: g_signal_mutex */
+static guint
+signal_nodes_append (SignalNode *node)
+{
+  guint signal_id = g_n_signal_nodes;
+
+  if (signal_id == g_n_signal_nodes_allocated)
+    {
+      SignalNode **nodes;
+
+      g_n_signal_nodes_allocated = MAX (g_n_signal_nodes_allocated * 2, 64);
+      nodes = g_new (SignalNode *, g_n_signal_nodes_allocated);
+      if (signal_id > 0)
+        memcpy (nodes, g_signal_nodes, signal_id * sizeof (SignalNode *));
+      g_atomic_pointer_set (&g_signal_nodes, nodes);
+    }
+
+  g_signal_nodes[signal_id] = node;
+  g_atomic_int_set (&g_n_signal_nodes, signal_id + 1);
+
+  return signal_id;
+}
+
 
 /* --- functions --- */
 /* @key must have already been validated with is_valid()
@@ -823,6 +873,7 @@ node_update_single_va_closure (SignalNode *node)
 {
   GClosure *closure = NULL;
   gboolean is_after = FALSE;
+  gint state;
 
   /* Fast path single-handler without boxing the arguments in GValues */
   if (G_TYPE_IS_OBJECT (node->itype) &&
@@ -854,9 +905,60 @@ node_update_single_va_closure (SignalNode *node)
 	}
     }
 
-  node->single_va_closure_is_valid = TRUE;
-  node->single_va_closure = closure;
-  node->single_va_closure_is_after = is_after;
+  state = SINGLE_VA_CLOSURE_VALID;
+  if (is_after)
+    state |= SINGLE_VA_CLOSURE_AFTER;
+
+  /* Without handlers, all there is to do is to run the class closure, if
+   * any. That can't restart, and the caller needs no return value. */
+  if (closure != NULL &&
+      node->return_type == G_TYPE_NONE &&
+      (closure == SINGLE_VA_CLOSURE_EMPTY_MAGIC ||
+       (_g_closure_supports_invoke_va (closure) &&
+        (node->flags & G_SIGNAL_NO_RECURSE) == 0)))
+    state |= SINGLE_VA_CLOSURE_LOCK_FREE;
+
+  g_atomic_pointer_set (&node->single_va_closure, closure);
+  g_atomic_int_set (&node->single_va_closure_state, state);
+}
+
+/* HOLDS: g_signal_mutex */
+static inline void
+node_invalidate_single_va_closure (SignalNode *node)
+{
+  g_atomic_int_set (&node->single_va_closure_state, 0);
+}
+
+/* Can be called without holding g_signal_mutex */
+static inline ThreadEmissions*
+thread_emissions_get (void)
+{
+  ThreadEmissions *thread = g_private_get (&g_thread_emissions);
+
+  if (G_UNLIKELY (thread == NULL))
+    {
+      thread = g_new0 (ThreadEmissions, 1);
+      g_private_set (&g_thread_emissions, thread);
+    }
+
+  return thread;
+}
+
+/* Can be called without holding g_signal_mutex */
+static inline void
+emission_push_thread (Emission *emission)
+{
+  emission->thread = thread_emissions_get ();
+  emission->thread_next = emission->thread->innermost;
+  emission->thread->innermost = emission;
+}
+
+/* Can be called without holding g_signal_mutex */
+static inline void
+emission_pop_thread (Emission *emission)
+{
+  g_assert (emission->thread->innermost == emission);
+  emission->thread->innermost = emission->thread_next;
 }
 
 static inline void
@@ -864,6 +966,7 @@ emission_push (Emission  *emission)
 {
   emission->next = g_emissions;
   g_emissions = emission;
+  emission_push_thread (emission);
 }
 
 static inline void
@@ -871,6 +974,8 @@ emission_pop (Emission  *emission)
 {
   Emission *node, *last = NULL;
 
+  emission_pop_thread (emission);
+
   for (node = g_emissions; node; last = node, node = last->next)
     if (node == emission)
       {
@@ -883,6 +988,8 @@ emission_pop (Emission  *emission)
   g_assert_not_reached ();
 }
 
+/* The emissions of the calling thread come first, as it is usually asking
+ * about its own, and some of them may not be in g_emissions */
 static inline Emission*
 emission_find (guint     signal_id,
 	       GQuark    detail,
@@ -890,6 +997,11 @@ emission_find (guint     signal_id,
 {
   Emission *emission;
   
+  for (emission = thread_emissions_get ()->innermost; emission; emission = emission->thread_next)
+    if (emission->instance == instance &&
+	emission->ihint.signal_id == signal_id &&
+	emission->ihint.detail == detail)
+      return emission;
   for (emission = g_emissions; emission; emission = emission->next)
     if (emission->instance == instance &&
 	emission->ihint.signal_id == signal_id &&
@@ -903,6 +1015,9 @@ emission_find_innermost (gpointer instance)
 {
   Emission *emission;
   
+  for (emission = thread_emissions_get ()->innermost; emission; emission = emission->thread_next)
+    if (emission->instance == instance)
+      return emission;
   for (emission = g_emissions; emission; emission = emission->next)
     if (emission->instance == instance)
       return emission;
@@ -933,9 +1048,7 @@ _g_signal_init (void)
       g_signal_key_bsa = g_bsearch_array_create (&g_signal_key_bconfig);
       
       /* invalid (0) signal_id */
-      g_n_signal_nodes = 1;
-      g_signal_nodes = g_renew (SignalNode*, g_signal_nodes, g_n_signal_nodes);
-      g_signal_nodes[0] = NULL;
+      signal_nodes_append (NULL);
       g_handlers = g_hash_table_new (handler_hash, handler_equal);
     }
   SIGNAL_UNLOCK ();
@@ -1081,7 +1194,7 @@ g_signal_add_emission_hook (guint               signal_id,
       SIGNAL_UNLOCK ();
       return 0;
     }
-    node->single_va_closure_is_valid = FALSE;
+    node_invalidate_single_va_closure (node);
   if (!node->emission_hooks)
     {
       node->emission_hooks = g_new (GHookList, 1);
@@ -1133,7 +1246,7 @@ g_signal_remove_emission_hook (guint  signal_id,
   else if (!node->emission_hooks || !g_hook_destroy (node->emission_hooks, hook_id))
     g_warning ("%s: signal \"%s\" had no hook (%lu) to remove", G_STRLOC, node->name, hook_id);
 
-  node->single_va_closure_is_valid = FALSE;
+  node_invalidate_single_va_closure (node);
 
  out:
   SIGNAL_UNLOCK ();
@@ -1640,7 +1753,7 @@ signal_add_class_closure (SignalNode *node,
 {
   ClassClosure key;
 
-  node->single_va_closure_is_valid = FALSE;
+  node_invalidate_single_va_closure (node);
 
   if (!node->class_closure_bsa)
     node->class_closure_bsa = g_bsearch_array_create (&g_class_closure_bconfig);
@@ -1786,11 +1899,11 @@ g_signal_newv (const gchar       *signal_name,
     {
       SignalKey key;
       
-      signal_id = g_n_signal_nodes++;
       node = g_new (SignalNode, 1);
+      node->single_va_closure_state = 0;
+      node->single_va_closure = NULL;
+      signal_id = signal_nodes_append (node);
       node->signal_id = signal_id;
-      g_signal_nodes = g_renew (SignalNode*, g_signal_nodes, g_n_signal_nodes);
-      g_signal_nodes[signal_id] = node;
       node->itype = itype;
       key.itype = itype;
       key.signal_id = signal_id;
@@ -1803,7 +1916,7 @@ g_signal_newv (const gchar       *signal_name,
   node->destroyed = FALSE;
 
   /* setup reinitializable portion */
-  node->single_va_closure_is_valid = FALSE;
+  node_invalidate_single_va_closure (node);
   node->flags = signal_flags & G_SIGNAL_FLAGS_MASK;
   node->n_params = n_params;
   node->param_types = g_memdup2 (param_types, sizeof (GType) * n_params);
@@ -1921,7 +2034,7 @@ g_signal_set_va_marshaller (guint              signal_id,
 	    _g_closure_set_va_marshal (cc->closure, va_marshaller);
 	}
 
-      node->single_va_closure_is_valid = FALSE;
+      node_invalidate_single_va_closure (node);
     }
 
   SIGNAL_UNLOCK ();
@@ -1997,7 +2110,7 @@ signal_destroy_R (SignalNode *signal_node)
   signal_node->destroyed = TRUE;
   
   /* reentrancy caution, zero out real contents first */
-  signal_node->single_va_closure_is_valid = FALSE;
+  node_invalidate_single_va_closure (signal_node);
   signal_node->n_params = 0;
   signal_node->param_types = NULL;
   signal_node->return_type = 0;
@@ -2423,7 +2536,7 @@ g_signal_connect_closure_by_id (gpointer  instance,
 	  Handler *handler = handler_new (signal_id, instance, after);
 
           if (G_TYPE_IS_OBJECT (node->itype))
-            _g_object_set_has_signal_handler ((GObject *)instance);
+            _g_object_set_has_signal_handler ((GObject *)instance, signal_id);
 
 	  handler_seq_no = handler->sequential_number;
 	  handler->detail = detail;
@@ -2490,7 +2603,7 @@ g_signal_connect_closure (gpointer     instance,
 	  Handler *handler = handler_new (signal_id, instance, after);
 
           if (G_TYPE_IS_OBJECT (node->itype))
-            _g_object_set_has_signal_handler ((GObject *)instance);
+            _g_object_set_has_signal_handler ((GObject *)instance, signal_id);
 
 	  handler_seq_no = handler->sequential_number;
 	  handler->detail = detail;
@@ -2594,7 +2707,7 @@ g_signal_connect_data (gpointer       instance,
 	  Handler *handler = handler_new (signal_id, instance, after);
 
           if (G_TYPE_IS_OBJECT (node->itype))
-            _g_object_set_has_signal_handler ((GObject *)instance);
+            _g_object_set_has_signal_handler ((GObject *)instance, signal_id);
 
 	  handler_seq_no = handler->sequential_number;
 	  handler->detail = detail;
@@ -3199,7 +3312,7 @@ g_signal_emitv (const GValue *instance_and_params,
 #endif	/* G_ENABLE_DEBUG */
 
   /* optimize NOP emissions */
-  if (!node->single_va_closure_is_valid)
+  if (!(node->single_va_closure_state & SINGLE_VA_CLOSURE_VALID))
     node_update_single_va_closure (node);
 
   if (node->single_va_closure != NULL &&
@@ -3209,7 +3322,7 @@ g_signal_emitv (const GValue *instance_and_params,
       HandlerList* hlist;
 
       /* single_va_closure is only true for GObjects, so fast path if no handler ever connected to the signal */
-      if (_g_object_has_signal_handler ((GObject *)instance))
+      if (_g_object_has_signal_handler ((GObject *)instance, node->signal_id))
         hlist = handler_list_lookup (node->signal_id, instance);
       else
         hlist = NULL;
@@ -3244,6 +3357,75 @@ accumulate (GSignalInvocationHint *ihint,
   return continue_emission;
 }
 
+/* Called without holding g_signal_mutex. Emits the signal if that can be done
+ * without the lock, which is the case for instances which never had handlers
+ * for it when it has no emission hooks and at most a default class closure.
+ * Returns %FALSE if the emission has to take the normal path instead. */
+static gboolean
+signal_emit_valist_lock_free (SignalNode *node,
+                              gpointer    instance,
+                              GQuark      detail,
+                              va_list     var_args)
+{
+  Emission emission;
+  GClosure *closure;
+  GType instance_type;
+  gint state;
+
+  state = g_atomic_int_get (&node->single_va_closure_state);
+  if (!(state & SINGLE_VA_CLOSURE_LOCK_FREE))
+    return FALSE;
+
+  /* leave the warnings about invalid emissions to the normal path */
+  if (detail && !(node->flags & G_SIGNAL_DETAILED))
+    return FALSE;
+  instance_type = G_TYPE_FROM_INSTANCE (instance);
+  if (!g_type_is_a (instance_type, node->itype))
+    return FALSE;
+
+  /* SINGLE_VA_CLOSURE_LOCK_FREE is only set for GObject signals */
+  if (_g_object_has_signal_handler ((GObject *)instance, node->signal_id))
+    return FALSE;
+
+  /* may have been invalidated since the state was read */
+  closure = g_atomic_pointer_get (&node->single_va_closure);
+  if (closure == NULL)
+    return FALSE;
+
+  if (closure == SINGLE_VA_CLOSURE_EMPTY_MAGIC ||
+      _g_closure_is_void (closure, instance))
+    return TRUE;
+
+  /* Only the calling thread can look for this emission, e.g. from the
+   * class closure with g_signal_get_invocation_hint() */
+  emission.next = NULL;
+  emission.instance = instance;
+  emission.ihint.signal_id = node->signal_id;
+  emission.ihint.detail = detail;
+  emission.ihint.run_type = (state & SINGLE_VA_CLOSURE_AFTER) ? G_SIGNAL_RUN_LAST : G_SIGNAL_RUN_FIRST;
+  emission.state = EMISSION_RUN;
+  emission.chain_type = instance_type;
+  emission_push_thread (&emission);
+
+  TRACE(GOBJECT_SIGNAL_EMIT(node->signal_id, detail, instance, instance_type));
+
+  g_object_ref (instance);
+  _g_closure_invoke_va (closure,
+                        NULL,
+                        instance,
+                        var_args,
+                        node->n_params,
+                        node->param_types);
+
+  emission_pop_thread (&emission);
+
+  TRACE(GOBJECT_SIGNAL_EMIT_END(node->signal_id, detail, instance, instance_type));
+
+  g_object_unref (instance);
+
+  return TRUE;
+}
+
 /**
  * g_signal_emit_valist: (skip)
  * @instance: (type GObject.TypeInstance): the instance the signal is being
@@ -3274,6 +3456,10 @@ g_signal_emit_valist (gpointer instance,
   g_return_if_fail (G_TYPE_CHECK_INSTANCE (instance));
   g_return_if_fail (signal_id > 0);
 
+  node = LOOKUP_SIGNAL_NODE (signal_id);
+  if (node && signal_emit_valist_lock_free (node, instance, detail, var_args))
+    return;
+
   SIGNAL_LOCK ();
   node = LOOKUP_SIGNAL_NODE (signal_id);
   if (!node || !g_type_is_a (G_TYPE_FROM_INSTANCE (instance), node->itype))
@@ -3291,7 +3477,7 @@ g_signal_emit_valist (gpointer instance,
     }
 #endif  /* !G_DISABLE_CHECKS */
 
-  if (!node->single_va_closure_is_valid)
+  if (!(node->single_va_closure_state & SINGLE_VA_CLOSURE_VALID))
     node_update_single_va_closure (node);
 
   if (node->single_va_closure != NULL)
@@ -3309,7 +3495,7 @@ g_signal_emit_valist (gpointer instance,
 	  if (_g_closure_supports_invoke_va (node->single_va_closure))
 	    {
 	      closure = node->single_va_closure;
-	      if (node->single_va_closure_is_after)
+	      if (node->single_va_closure_state & SINGLE_VA_CLOSURE_AFTER)
 		run_type = G_SIGNAL_RUN_LAST;
 	      else
 		run_type = G_SIGNAL_RUN_FIRST;
@@ -3319,7 +3505,7 @@ g_signal_emit_valist (gpointer instance,
 	}
 
       /* single_va_closure is only true for GObjects, so fast path if no handler ever connected to the signal */
-      if (_g_object_has_signal_handler ((GObject *)instance))
+      if (_g_object_has_signal_handler ((GObject *)instance, node->signal_id))
         hlist = handler_list_lookup (node->signal_id, instance);
       else
         hlist = NULL;
@@ -93,8 +93,10 @@ void        _g_closure_invoke_va (GClosure       *closure,
 				  int             n_params,
 				  GType          *param_types);
 
-gboolean    _g_object_has_signal_handler     (GObject     *object);
-void        _g_object_set_has_signal_handler (GObject     *object);
+gboolean    _g_object_has_signal_handler     (GObject     *object,
+                                              guint        signal_id);
+void        _g_object_set_has_signal_handler (GObject     *object,
+                                              guint        signal_id);
 
 /**
  * _G_DEFINE_TYPE_EXTENDED_WITH_PRELUDE:
@@ -173,6 +173,7 @@ typedef union  _TypeData        TypeData;
 typedef struct _IFaceEntries    IFaceEntries;
 typedef struct _IFaceEntry      IFaceEntry;
 typedef struct _IFaceHolder	IFaceHolder;
+typedef struct _TypeCheckCache  TypeCheckCache;
 
 
 /* --- prototypes --- */
@@ -242,6 +243,7 @@ struct _TypeNode
     GAtomicArray offsets;
   } _prot;
   GType       *prerequisites;
+  TypeCheckCache *check_cache; /* (atomic), see type_node_is_a_cached_U() */
   GType        supers[1]; /* flexible array */
 };
 
@@ -271,6 +273,19 @@ struct _TypeNode
         ((ancestor)->n_supers <= (node)->n_supers &&                                        \
 	 (node)->supers[(node)->n_supers - (ancestor)->n_supers] == NODE_TYPE (ancestor))
 
+/* Results of g_type_is_a() for a node, read and written without locking.
+ * Each entry is the checked type with TYPE_CHECK_IS_A or TYPE_CHECK_IS_NOT_A
+ * in its low bits, which are always zero in a GType, or 0 if unused.
+ */
+#define TYPE_CHECK_CACHE_SIZE                   (16)
+#define TYPE_CHECK_IS_A                         ((GType) 1)
+#define TYPE_CHECK_IS_NOT_A                     ((GType) 2)
+
+struct _TypeCheckCache
+{
+  GType entries[TYPE_CHECK_CACHE_SIZE];
+};
+
 struct _IFaceHolder
 {
   GType           instance_type;
@@ -1357,6 +1372,19 @@ iface_node_set_offset_L (TypeNode *iface_node,
   _g_atomic_array_update (&iface_node->_prot.offsets, offsets);
 }
 
+/* Called when @node may start conforming to a type it didn't conform to.
+ * The cache is dropped rather than cleared, as it can still be in use by
+ * readers which computed a result before the change and would store it
+ * after the clearing.  It is leaked for the same reason; this only
+ * happens when interfaces or prerequisites are added to types which
+ * were already checked.
+ */
+static void
+type_node_check_cache_invalidate_W (TypeNode *node)
+{
+  g_atomic_pointer_set (&node->check_cache, NULL);
+}
+
 static void
 type_node_add_iface_entry_W (TypeNode   *node,
 			     GType       iface_type,
@@ -1448,6 +1476,7 @@ type_node_add_iface_entry_W (TypeNode   *node,
     }
 
   _g_atomic_array_update (CLASSED_NODE_IFACES_ENTRIES (node), entries);
+  type_node_check_cache_invalidate_W (node);
 
   if (parent_entry)
     {
@@ -1523,6 +1552,7 @@ type_iface_add_prerequisite_W (TypeNode *iface,
   memmove (prerequisites + i + 1, prerequisites + i,
            sizeof (prerequisites[0]) * (IFACE_NODE_N_PREREQUISITES (iface) - i - 1));
   prerequisites[i] = prerequisite_type;
+  type_node_check_cache_invalidate_W (iface);
   
   /* we want to get notified when prerequisites get added to prerequisite_node */
   if (NODE_IS_IFACE (prerequisite_node))
@@ -3500,6 +3530,64 @@ type_node_conforms_to_U (TypeNode *node,
   return type_node_check_conformities_UorL (node, iface_node, support_interfaces, support_prerequisites, FALSE);
 }
 
+static inline guint
+type_check_cache_index (GType type)
+{
+  return ((type >> 3) ^ (type >> 9)) % TYPE_CHECK_CACHE_SIZE;
+}
+
+/* Same as type_node_conforms_to_U (node, lookup_type_node_I (iface_type),
+ * TRUE, TRUE), which is also what instance checks need as they only
+ * check instantiatable types, for which prerequisites don't apply.
+ * Unlike looking interfaces up, and prerequisites which need the lock,
+ * hits don't need the node of @iface_type.
+ */
+static inline gboolean
+type_node_is_a_cached_U (TypeNode *node,
+                         GType     iface_type)
+{
+  TypeCheckCache *cache = g_atomic_pointer_get (&node->check_cache);
+  guint i = type_check_cache_index (iface_type);
+  TypeNode *iface_node;
+  gboolean is_a;
+
+  if (G_LIKELY (cache != NULL))
+    {
+      GType entry = (GType) g_atomic_pointer_get (&cache->entries[i]);
+
+      if (entry == (iface_type | TYPE_CHECK_IS_A))
+        return TRUE;
+      if (entry == (iface_type | TYPE_CHECK_IS_NOT_A))
+        return FALSE;
+    }
+  else
+    {
+      cache = g_new0 (TypeCheckCache, 1);
+      if (!g_atomic_pointer_compare_and_exchange (&node->check_cache, NULL, cache))
+        {
+          g_free (cache);
+          cache = g_atomic_pointer_get (&node->check_cache);
+          /* Invalidated meanwhile, let the next check set it up */
+          if (cache == NULL)
+            {
+              iface_node = lookup_type_node_I (iface_type);
+              return iface_node && type_node_conforms_to_U (node, iface_node, TRUE, TRUE);
+            }
+        }
+    }
+
+  /* Types which don't exist may be registered later under that id */
+  iface_node = lookup_type_node_I (iface_type);
+  if (iface_node == NULL)
+    return FALSE;
+
+  is_a = type_node_conforms_to_U (node, iface_node, TRUE, TRUE);
+  g_atomic_pointer_set (&cache->entries[i],
+                        iface_type | (is_a ? TYPE_CHECK_IS_A : TYPE_CHECK_IS_NOT_A));
+
+  return is_a;
+}
+
 /**
  * g_type_is_a:
  * @type: type to check anchestry for
@@ -3516,15 +3604,14 @@ gboolean
 g_type_is_a (GType type,
 	     GType iface_type)
 {
-  TypeNode *node, *iface_node;
+  TypeNode *node;
   gboolean is_a;
 
   if (type == iface_type)
     return TRUE;
   
   node = lookup_type_node_I (type);
-  iface_node = lookup_type_node_I (iface_type);
-  is_a = node && iface_node && type_node_conforms_to_U (node, iface_node, TRUE, TRUE);
+  is_a = node && type_node_is_a_cached_U (node, iface_type);
   
   return is_a;
 }
@@ -4006,15 +4093,14 @@ gboolean
 g_type_check_instance_is_a (GTypeInstance *type_instance,
 			    GType          iface_type)
 {
-  TypeNode *node, *iface;
+  TypeNode *node;
   gboolean check;
   
   if (!type_instance || !type_instance->g_class)
     return FALSE;
   
   node = lookup_type_node_I (type_instance->g_class->g_type);
-  iface = lookup_type_node_I (iface_type);
-  check = node && node->is_instantiatable && iface && type_node_conforms_to_U (node, iface, TRUE, FALSE);
+  check = node && node->is_instantiatable && type_node_is_a_cached_U (node, iface_type);
   
   return check;
 }
@@ -4055,13 +4141,12 @@ g_type_check_instance_cast (GTypeInstance *type_instance,
     {
       if (type_instance->g_class)
 	{
-	  TypeNode *node, *iface;
+	  TypeNode *node;
 	  gboolean is_instantiatable, check;
 	  
 	  node = lookup_type_node_I (type_instance->g_class->g_type);
 	  is_instantiatable = node && node->is_instantiatable;
-	  iface = lookup_type_node_I (iface_type);
-	  check = is_instantiatable && iface && type_node_conforms_to_U (node, iface, TRUE, FALSE);
+	  check = is_instantiatable && type_node_is_a_cached_U (node, iface_type);
 	  if (check)
 	    return type_instance;
 	  
@@ -0,0 +1,297 @@
+/* GObject - GLib Type, Object, Parameter and Signal Library
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib-object.h>
+
+/* Emissions done in each case */
+#define NUM_EMISSIONS 2000000
+
+/* All the signals use the generic marshallers, as signals registered
+ * without a marshaller do. The last one has too many arguments to
+ * avoid libffi, for reference.
+ */
+typedef enum {
+  SIGNAL_VOID__OBJECT_UINT,
+  SIGNAL_VOID__POINTER_POINTER,
+  SIGNAL_BOOLEAN__BOXED,
+  SIGNAL_VOID__STRING_INT_INT,
+  SIGNAL_VOID__INT_INT_INT_INT,
+  N_SIGNALS
+} SignalType;
+
+typedef struct {
+  SignalType type;
+  gboolean emitv;
+} PerfData;
+
+typedef GObject MarshalTest;
+typedef GObjectClass MarshalTestClass;
+
+static guint signals[N_SIGNALS];
+
+static GType marshal_test_get_type (void);
+G_DEFINE_TYPE (MarshalTest, marshal_test, G_TYPE_OBJECT)
+
+static void
+marshal_test_init (MarshalTest *test)
+{
+}
+
+static void
+marshal_test_class_init (MarshalTestClass *klass)
+{
+  GType type = G_TYPE_FROM_CLASS (klass);
+
+  signals[SIGNAL_VOID__OBJECT_UINT] =
+    g_signal_new ("void-object-uint", type, G_SIGNAL_RUN_LAST, 0,
+                  NULL, NULL, NULL,
+                  G_TYPE_NONE, 2, G_TYPE_OBJECT, G_TYPE_UINT);
+  signals[SIGNAL_VOID__POINTER_POINTER] =
+    g_signal_new ("void-pointer-pointer", type, G_SIGNAL_RUN_LAST, 0,
+                  NULL, NULL, NULL,
+                  G_TYPE_NONE, 2, G_TYPE_POINTER, G_TYPE_POINTER);
+  signals[SIGNAL_BOOLEAN__BOXED] =
+    g_signal_new ("boolean-boxed", type, G_SIGNAL_RUN_LAST, 0,
+                  NULL, NULL, NULL,
+                  G_TYPE_BOOLEAN, 1, G_TYPE_BYTES);
+  signals[SIGNAL_VOID__STRING_INT_INT] =
+    g_signal_new ("void-string-int-int", type, G_SIGNAL_RUN_LAST, 0,
+                  NULL, NULL, NULL,
+                  G_TYPE_NONE, 3, G_TYPE_STRING | G_SIGNAL_TYPE_STATIC_SCOPE,
+                  G_TYPE_INT, G_TYPE_INT);
+  signals[SIGNAL_VOID__INT_INT_INT_INT] =
+    g_signal_new ("void-int-int-int-int", type, G_SIGNAL_RUN_LAST, 0,
+                  NULL, NULL, NULL,
+                  G_TYPE_NONE, 4, G_TYPE_INT, G_TYPE_INT, G_TYPE_INT, G_TYPE_INT);
+}
+
+static void
+object_uint_handler (MarshalTest *test,
+                     GObject     *object,
+                     guint        value,
+                     gpointer     user_data)
+{
+  guint *n_calls = user_data;
+
+  (*n_calls)++;
+}
+
+static void
+pointer_pointer_handler (MarshalTest *test,
+                         gpointer     a,
+                         gpointer     b,
+                         gpointer     user_data)
+{
+  guint *n_calls = user_data;
+
+  (*n_calls)++;
+}
+
+static gboolean
+boxed_handler (MarshalTest *test,
+               GBytes      *bytes,
+               gpointer     user_data)
+{
+  guint *n_calls = user_data;
+
+  (*n_calls)++;
+
+  return TRUE;
+}
+
+static void
+string_int_int_handler (MarshalTest *test,
+                        const gchar *string,
+                        gint         a,
+                        gint         b,
+                        gpointer     user_data)
+{
+  guint *n_calls = user_data;
+
+  (*n_calls)++;
+}
+
+static void
+int_int_int_int_handler (MarshalTest *test,
+                         gint         a,
+                         gint         b,
+                         gint         c,
+                         gint         d,
+                         gpointer     user_data)
+{
+  guint *n_calls = user_data;
+
+  (*n_calls)++;
+}
+
+static void
+perform (gconstpointer data)
+{
+  const PerfData *perf = data;
+  GCallback handlers[N_SIGNALS] = {
+    G_CALLBACK (object_uint_handler),
+    G_CALLBACK (pointer_pointer_handler),
+    G_CALLBACK (boxed_handler),
+    G_CALLBACK (string_int_int_handler),
+    G_CALLBACK (int_int_int_int_handler),
+  };
+  MarshalTest *test;
+  GObject *object;
+  GBytes *bytes;
+  GValue values[5] = { G_VALUE_INIT, };
+  GValue retval = G_VALUE_INIT;
+  guint signal_id;
+  gboolean handled;
+  guint n_calls = 0;
+  gdouble time_elapsed;
+  gdouble result;
+  guint i;
+
+  test = g_object_new (marshal_test_get_type (), NULL);
+  object = g_object_new (G_TYPE_OBJECT, NULL);
+  bytes = g_bytes_new_static ("data", 4);
+  signal_id = signals[perf->type];
+
+  g_signal_connect (test, g_signal_name (signal_id), handlers[perf->type], &n_calls);
+
+  g_value_init (&values[0], marshal_test_get_type ());
+  g_value_set_object (&values[0], test);
+
+  switch (perf->type)
+    {
+    case SIGNAL_VOID__OBJECT_UINT:
+      g_value_init (&values[1], G_TYPE_OBJECT);
+      g_value_set_object (&values[1], object);
+      g_value_init (&values[2], G_TYPE_UINT);
+      break;
+    case SIGNAL_VOID__POINTER_POINTER:
+      g_value_init (&values[1], G_TYPE_POINTER);
+      g_value_init (&values[2], G_TYPE_POINTER);
+      break;
+    case SIGNAL_BOOLEAN__BOXED:
+      g_value_init (&values[1], G_TYPE_BYTES);
+      g_value_set_boxed (&values[1], bytes);
+      g_value_init (&retval, G_TYPE_BOOLEAN);
+      break;
+    case SIGNAL_VOID__STRING_INT_INT:
+      g_value_init (&values[1], G_TYPE_STRING);
+      g_value_set_static_string (&values[1], "string");
+      g_value_init (&values[2], G_TYPE_INT);
+      g_value_init (&values[3], G_TYPE_INT);
+      break;
+    case SIGNAL_VOID__INT_INT_INT_INT:
+      for (i = 1; i <= 4; i++)
+        g_value_init (&values[i], G_TYPE_INT);
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+
+  g_test_timer_start ();
+
+  for (i = 0; i < NUM_EMISSIONS; i++)
+    {
+      if (perf->emitv)
+        {
+          g_signal_emitv (values, signal_id, 0,
+                          perf->type == SIGNAL_BOOLEAN__BOXED ? &retval : NULL);
+          continue;
+        }
+
+      switch (perf->type)
+        {
+        case SIGNAL_VOID__OBJECT_UINT:
+          g_signal_emit (test, signal_id, 0, object, i);
+          break;
+        case SIGNAL_VOID__POINTER_POINTER:
+          g_signal_emit (test, signal_id, 0, test, object);
+          break;
+        case SIGNAL_BOOLEAN__BOXED:
+          g_signal_emit (test, signal_id, 0, bytes, &handled);
+          break;
+        case SIGNAL_VOID__STRING_INT_INT:
+          g_signal_emit (test, signal_id, 0, "string", i, i);
+          break;
+        case SIGNAL_VOID__INT_INT_INT_INT:
+          g_signal_emit (test, signal_id, 0, i, i, i, i);
+          break;
+        default:
+          g_assert_not_reached ();
+        }
+    }
+
+  time_elapsed = g_test_timer_elapsed ();
+
+  g_assert_cmpuint (n_calls, ==, NUM_EMISSIONS);
+
+  for (i = 0; i < G_N_ELEMENTS (values); i++)
+    {
+      if (G_IS_VALUE (&values[i]))
+        g_value_unset (&values[i]);
+    }
+  if (G_IS_VALUE (&retval))
+    g_value_unset (&retval);
+  g_bytes_unref (bytes);
+  g_object_unref (object);
+  g_object_unref (test);
+
+  result = NUM_EMISSIONS / time_elapsed;
+
+  g_test_maximized_result (result, "%9.0f emissions/s", result);
+}
+
+static void
+add_cases (const char *name,
+           SignalType  type)
+{
+  gsize i;
+
+  for (i = 0; i < 2; i++)
+    {
+      PerfData *perf;
+      gchar *full_path;
+
+      perf = g_new0 (PerfData, 1);
+      perf->type = type;
+      perf->emitv = (i == 1);
+
+      full_path = g_strdup_printf ("/signal/marshal/perf/%s/%s",
+                                   perf->emitv ? "values" : "va", name);
+      g_test_add_data_func_full (full_path, perf, perform, g_free);
+      g_free (full_path);
+    }
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  if (g_test_perf ())
+    {
+      g_type_ensure (marshal_test_get_type ());
+
+      add_cases ("void-object-uint", SIGNAL_VOID__OBJECT_UINT);
+      add_cases ("void-pointer-pointer", SIGNAL_VOID__POINTER_POINTER);
+      add_cases ("boolean-boxed", SIGNAL_BOOLEAN__BOXED);
+      add_cases ("void-string-int-int", SIGNAL_VOID__STRING_INT_INT);
+      add_cases ("void-int-int-int-int", SIGNAL_VOID__INT_INT_INT_INT);
+    }
+
+  return g_test_run ();
+}
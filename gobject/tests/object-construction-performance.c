@@ -0,0 +1,365 @@
+/* GObject - GLib Type, Object, Parameter and Signal Library
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib-object.h>
+
+/* Calls done in each case, split between the threads */
+#define NUM_CALLS 1000000
+
+typedef enum {
+  CALL_NEW_NO_PROPERTIES,
+  CALL_NEW,
+  CALL_NEW_WITH_PROPERTIES,
+  CALL_SET,
+  CALL_GET,
+} CallType;
+
+typedef struct {
+  CallType type;
+  guint n_threads;
+} PerfData;
+
+/* Like a model object: a couple of levels of hierarchy, with properties
+ * installed at each level.
+ */
+typedef struct {
+  GObject parent_instance;
+
+  gint id;
+  gchar *name;
+} ModelBase;
+
+typedef GObjectClass ModelBaseClass;
+
+typedef struct {
+  ModelBase parent_instance;
+
+  gboolean enabled;
+  gdouble value;
+} ModelItem;
+
+typedef ModelBaseClass ModelItemClass;
+
+enum {
+  PROP_0,
+  PROP_ID,
+  PROP_NAME,
+  PROP_ENABLED,
+  PROP_VALUE,
+};
+
+static GType model_base_get_type (void);
+G_DEFINE_TYPE (ModelBase, model_base, G_TYPE_OBJECT)
+
+static GType model_item_get_type (void);
+G_DEFINE_TYPE (ModelItem, model_item, model_base_get_type ())
+
+static void
+model_base_set_property (GObject      *object,
+                         guint         prop_id,
+                         const GValue *value,
+                         GParamSpec   *pspec)
+{
+  ModelBase *base = (ModelBase *) object;
+
+  switch (prop_id)
+    {
+    case PROP_ID:
+      base->id = g_value_get_int (value);
+      break;
+    case PROP_NAME:
+      g_free (base->name);
+      base->name = g_value_dup_string (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+model_base_get_property (GObject    *object,
+                         guint       prop_id,
+                         GValue     *value,
+                         GParamSpec *pspec)
+{
+  ModelBase *base = (ModelBase *) object;
+
+  switch (prop_id)
+    {
+    case PROP_ID:
+      g_value_set_int (value, base->id);
+      break;
+    case PROP_NAME:
+      g_value_set_string (value, base->name);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+model_base_finalize (GObject *object)
+{
+  ModelBase *base = (ModelBase *) object;
+
+  g_free (base->name);
+
+  G_OBJECT_CLASS (model_base_parent_class)->finalize (object);
+}
+
+static void
+model_base_init (ModelBase *base)
+{
+}
+
+static void
+model_base_class_init (ModelBaseClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->set_property = model_base_set_property;
+  object_class->get_property = model_base_get_property;
+  object_class->finalize = model_base_finalize;
+
+  g_object_class_install_property (object_class, PROP_ID,
+                                   g_param_spec_int ("id", NULL, NULL,
+                                                     0, G_MAXINT, 0,
+                                                     G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY |
+                                                     G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (object_class, PROP_NAME,
+                                   g_param_spec_string ("name", NULL, NULL,
+                                                        NULL,
+                                                        G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+static void
+model_item_set_property (GObject      *object,
+                         guint         prop_id,
+                         const GValue *value,
+                         GParamSpec   *pspec)
+{
+  ModelItem *item = (ModelItem *) object;
+
+  switch (prop_id)
+    {
+    case PROP_ENABLED:
+      item->enabled = g_value_get_boolean (value);
+      break;
+    case PROP_VALUE:
+      item->value = g_value_get_double (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+model_item_get_property (GObject    *object,
+                         guint       prop_id,
+                         GValue     *value,
+                         GParamSpec *pspec)
+{
+  ModelItem *item = (ModelItem *) object;
+
+  switch (prop_id)
+    {
+    case PROP_ENABLED:
+      g_value_set_boolean (value, item->enabled);
+      break;
+    case PROP_VALUE:
+      g_value_set_double (value, item->value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+model_item_init (ModelItem *item)
+{
+}
+
+static void
+model_item_class_init (ModelItemClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->set_property = model_item_set_property;
+  object_class->get_property = model_item_get_property;
+
+  g_object_class_install_property (object_class, PROP_ENABLED,
+                                   g_param_spec_boolean ("enabled", NULL, NULL,
+                                                         FALSE,
+                                                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (object_class, PROP_VALUE,
+                                   g_param_spec_double ("value", NULL, NULL,
+                                                        -G_MAXDOUBLE, G_MAXDOUBLE, 0.0,
+                                                        G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+typedef struct {
+  const PerfData *perf;
+  guint n_calls;
+} ThreadData;
+
+static gpointer
+call_thread (gpointer user_data)
+{
+  ThreadData *td = user_data;
+  const gchar *names[] = { "id", "name", "enabled", "value" };
+  GValue values[G_N_ELEMENTS (names)] = { G_VALUE_INIT, };
+  GObject *object = NULL;
+  gchar *name;
+  gdouble value;
+  guint i;
+
+  g_value_init (&values[0], G_TYPE_INT);
+  g_value_set_int (&values[0], 1);
+  g_value_init (&values[1], G_TYPE_STRING);
+  g_value_set_static_string (&values[1], "item");
+  g_value_init (&values[2], G_TYPE_BOOLEAN);
+  g_value_set_boolean (&values[2], TRUE);
+  g_value_init (&values[3], G_TYPE_DOUBLE);
+  g_value_set_double (&values[3], 1.0);
+
+  /* Each thread works on its own object, like objects owned by workers */
+  if (td->perf->type == CALL_SET || td->perf->type == CALL_GET)
+    object = g_object_new (model_item_get_type (), "id", 1, NULL);
+
+  for (i = 0; i < td->n_calls; i++)
+    {
+      switch (td->perf->type)
+        {
+        case CALL_NEW_NO_PROPERTIES:
+          g_object_unref (g_object_new (model_item_get_type (), NULL));
+          break;
+        case CALL_NEW:
+          g_object_unref (g_object_new (model_item_get_type (),
+                                        "id", i,
+                                        "name", "item",
+                                        "enabled", TRUE,
+                                        "value", 1.0,
+                                        NULL));
+          break;
+        case CALL_NEW_WITH_PROPERTIES:
+          g_object_unref (g_object_new_with_properties (model_item_get_type (),
+                                                        G_N_ELEMENTS (names),
+                                                        names, values));
+          break;
+        case CALL_SET:
+          g_object_set (object,
+                        "name", "item",
+                        "value", (gdouble) i,
+                        NULL);
+          break;
+        case CALL_GET:
+          g_object_get (object,
+                        "name", &name,
+                        "value", &value,
+                        NULL);
+          g_free (name);
+          break;
+        default:
+          g_assert_not_reached ();
+        }
+    }
+
+  g_clear_object (&object);
+
+  for (i = 0; i < G_N_ELEMENTS (values); i++)
+    g_value_unset (&values[i]);
+
+  return NULL;
+}
+
+static void
+perform (gconstpointer data)
+{
+  const PerfData *perf = data;
+  ThreadData *threads;
+  GThread **thread_ids;
+  gdouble time_elapsed;
+  gdouble result;
+  guint i;
+
+  threads = g_new0 (ThreadData, perf->n_threads);
+  thread_ids = g_new0 (GThread *, perf->n_threads);
+
+  g_test_timer_start ();
+
+  for (i = 0; i < perf->n_threads; i++)
+    {
+      threads[i].perf = perf;
+      threads[i].n_calls = NUM_CALLS / perf->n_threads;
+      thread_ids[i] = g_thread_new ("construction", call_thread, &threads[i]);
+    }
+
+  for (i = 0; i < perf->n_threads; i++)
+    g_thread_join (thread_ids[i]);
+
+  time_elapsed = g_test_timer_elapsed ();
+
+  g_free (thread_ids);
+  g_free (threads);
+
+  result = NUM_CALLS / time_elapsed;
+
+  g_test_maximized_result (result, "%9.0f calls/s with %2u threads",
+                           result, perf->n_threads);
+}
+
+static void
+add_cases (const char *path,
+           CallType    type)
+{
+  const guint n_threads[] = { 1, 2, 4, 8 };
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (n_threads); i++)
+    {
+      PerfData *perf;
+      gchar *full_path;
+
+      perf = g_new0 (PerfData, 1);
+      perf->type = type;
+      perf->n_threads = n_threads[i];
+
+      full_path = g_strdup_printf ("%s/%u", path, n_threads[i]);
+      g_test_add_data_func_full (full_path, perf, perform, g_free);
+      g_free (full_path);
+    }
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  if (g_test_perf ())
+    {
+      g_type_ensure (model_item_get_type ());
+
+      add_cases ("/object/construction/perf/new-no-properties", CALL_NEW_NO_PROPERTIES);
+      add_cases ("/object/construction/perf/new", CALL_NEW);
+      add_cases ("/object/construction/perf/new-with-properties", CALL_NEW_WITH_PROPERTIES);
+      add_cases ("/object/construction/perf/set", CALL_SET);
+      add_cases ("/object/construction/perf/get", CALL_GET);
+    }
+
+  return g_test_run ();
+}
@@ -633,6 +633,174 @@ properties_testv_notify_queue (void)
   g_object_unref (test_obj);
 }
 
+static void
+properties_lookup_reused_name (void)
+{
+  TestObject *test_obj;
+  GValue value = G_VALUE_INIT;
+  gchar name[32];
+
+  g_test_summary ("Property lookups by name give the right property when "
+                  "the storage of a name is reused for another one");
+
+  test_obj = (TestObject *) g_object_new (test_object_get_type (), NULL);
+
+  g_strlcpy (name, "foo", sizeof (name));
+  g_value_init (&value, G_TYPE_INT);
+  g_value_set_int (&value, 10);
+  g_object_set_property (G_OBJECT (test_obj), name, &value);
+  g_value_unset (&value);
+  g_assert_cmpint (test_obj->foo, ==, 10);
+
+  g_strlcpy (name, "baz", sizeof (name));
+  g_value_init (&value, G_TYPE_STRING);
+  g_value_set_string (&value, "World");
+  g_object_set_property (G_OBJECT (test_obj), name, &value);
+  g_value_unset (&value);
+  g_assert_cmpstr (test_obj->baz, ==, "World");
+
+  g_strlcpy (name, "TestObject::bar", sizeof (name));
+  g_object_set (test_obj, name, FALSE, NULL);
+  g_assert_false (test_obj->bar);
+
+  g_strlcpy (name, "no-such-property", sizeof (name));
+  g_assert_null (g_object_class_find_property (G_OBJECT_GET_CLASS (test_obj), name));
+
+  g_strlcpy (name, "foo", sizeof (name));
+  g_assert_true (g_object_class_find_property (G_OBJECT_GET_CLASS (test_obj), name) == properties[PROP_FOO]);
+  g_object_set (test_obj, name, 20, NULL);
+  g_assert_cmpint (test_obj->foo, ==, 20);
+
+  g_object_unref (test_obj);
+}
+
+typedef struct {
+  guint n_batches;
+  GPtrArray *last_batch;
+  guint n_foo_notifies;
+} NotifyBatchData;
+
+static void
+on_notify_batch (GObject         *gobject,
+                 GPtrArray       *pspecs,
+                 NotifyBatchData *data)
+{
+  data->n_batches++;
+  g_clear_pointer (&data->last_batch, g_ptr_array_unref);
+  data->last_batch = g_ptr_array_copy (pspecs, NULL, NULL);
+}
+
+static void
+on_notify_foo (GObject         *gobject,
+               GParamSpec      *pspec,
+               NotifyBatchData *data)
+{
+  g_assert_true (pspec == properties[PROP_FOO]);
+  data->n_foo_notifies++;
+}
+
+static void
+properties_notify_batch_immediate (void)
+{
+  TestObject *test_obj;
+  NotifyBatchData data = { 0, NULL, 0 };
+  guint64 n_batches, n_coalesced;
+
+  g_test_summary ("With G_OBJECT_NOTIFY_BATCH_IMMEDIATE, the properties "
+                  "changed by one g_object_set() are notified together");
+
+  test_obj = (TestObject *) g_object_new (test_object_get_type (), NULL);
+  g_signal_connect (test_obj, "notify-batch", G_CALLBACK (on_notify_batch), &data);
+
+  g_assert_cmpint (g_object_get_notify_batch_mode (G_OBJECT (test_obj)), ==, G_OBJECT_NOTIFY_BATCH_NONE);
+  g_object_set_notify_batch_mode (G_OBJECT (test_obj), G_OBJECT_NOTIFY_BATCH_IMMEDIATE);
+  g_assert_cmpint (g_object_get_notify_batch_mode (G_OBJECT (test_obj)), ==, G_OBJECT_NOTIFY_BATCH_IMMEDIATE);
+
+  g_object_set (test_obj, "foo", 1, "bar", FALSE, "baz", "World", NULL);
+  g_assert_cmpuint (data.n_batches, ==, 1);
+  g_assert_cmpuint (data.last_batch->len, ==, 3);
+  g_assert_true (g_ptr_array_find (data.last_batch, properties[PROP_FOO], NULL));
+  g_assert_true (g_ptr_array_find (data.last_batch, properties[PROP_BAR], NULL));
+  g_assert_true (g_ptr_array_find (data.last_batch, properties[PROP_BAZ], NULL));
+
+  g_object_get_notify_batch_counters (G_OBJECT (test_obj), &n_batches, &n_coalesced);
+  g_assert_cmpuint (n_batches, ==, 1);
+  g_assert_cmpuint (n_coalesced, ==, 3);
+
+  /* Handlers of ::notify are still run */
+  g_signal_connect (test_obj, "notify::foo", G_CALLBACK (on_notify_foo), &data);
+  g_object_set (test_obj, "foo", 2, "bar", TRUE, NULL);
+  g_assert_cmpuint (data.n_batches, ==, 2);
+  g_assert_cmpuint (data.last_batch->len, ==, 2);
+  g_assert_cmpuint (data.n_foo_notifies, ==, 1);
+
+  g_object_get_notify_batch_counters (G_OBJECT (test_obj), &n_batches, &n_coalesced);
+  g_assert_cmpuint (n_batches, ==, 2);
+  g_assert_cmpuint (n_coalesced, ==, 4);
+
+  /* Not frozen */
+  g_object_notify (G_OBJECT (test_obj), "baz");
+  g_assert_cmpuint (data.n_batches, ==, 3);
+  g_assert_cmpuint (data.last_batch->len, ==, 1);
+
+  g_object_set_notify_batch_mode (G_OBJECT (test_obj), G_OBJECT_NOTIFY_BATCH_NONE);
+  g_object_set (test_obj, "foo", 3, NULL);
+  g_assert_cmpuint (data.n_batches, ==, 3);
+  g_assert_cmpuint (data.n_foo_notifies, ==, 2);
+
+  g_clear_pointer (&data.last_batch, g_ptr_array_unref);
+  g_object_unref (test_obj);
+}
+
+static void
+properties_notify_batch_idle (void)
+{
+  TestObject *test_obj;
+  NotifyBatchData data = { 0, NULL, 0 };
+  guint64 n_batches, n_coalesced;
+
+  g_test_summary ("With G_OBJECT_NOTIFY_BATCH_IDLE, the properties changed "
+                  "until the main context runs are notified together");
+
+  test_obj = (TestObject *) g_object_new (test_object_get_type (), NULL);
+  g_signal_connect (test_obj, "notify-batch", G_CALLBACK (on_notify_batch), &data);
+  g_signal_connect (test_obj, "notify::foo", G_CALLBACK (on_notify_foo), &data);
+  g_object_set_notify_batch_mode (G_OBJECT (test_obj), G_OBJECT_NOTIFY_BATCH_IDLE);
+
+  g_object_set (test_obj, "foo", 1, NULL);
+  g_object_set (test_obj, "foo", 2, NULL);
+  g_object_set (test_obj, "bar", FALSE, NULL);
+  g_object_set (test_obj, "baz", "World", NULL);
+  g_assert_cmpuint (data.n_batches, ==, 0);
+  g_assert_cmpuint (data.n_foo_notifies, ==, 0);
+
+  while (data.n_batches == 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpuint (data.n_batches, ==, 1);
+  g_assert_cmpuint (data.last_batch->len, ==, 3);
+  g_assert_cmpuint (data.n_foo_notifies, ==, 1);
+
+  g_object_get_notify_batch_counters (G_OBJECT (test_obj), &n_batches, &n_coalesced);
+  g_assert_cmpuint (n_batches, ==, 1);
+  g_assert_cmpuint (n_coalesced, ==, 3);
+
+  /* Changing the mode notifies the pending changes */
+  g_object_set (test_obj, "foo", 3, NULL);
+  g_object_set_notify_batch_mode (G_OBJECT (test_obj), G_OBJECT_NOTIFY_BATCH_IMMEDIATE);
+  g_assert_cmpuint (data.n_batches, ==, 2);
+  g_assert_cmpuint (data.n_foo_notifies, ==, 2);
+
+  /* Pending changes of a disposed object are dropped */
+  g_object_set_notify_batch_mode (G_OBJECT (test_obj), G_OBJECT_NOTIFY_BATCH_IDLE);
+  g_object_set (test_obj, "foo", 4, NULL);
+  g_clear_object (&test_obj);
+  while (g_main_context_iteration (NULL, FALSE));
+  g_assert_cmpuint (data.n_batches, ==, 2);
+
+  g_clear_pointer (&data.last_batch, g_ptr_array_unref);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -645,6 +813,9 @@ main (int argc, char *argv[])
   g_test_add_func ("/properties/notify-queue", properties_notify_queue);
   g_test_add_func ("/properties/construct", properties_construct);
   g_test_add_func ("/properties/get-property", properties_get_property);
+  g_test_add_func ("/properties/lookup-reused-name", properties_lookup_reused_name);
+  g_test_add_func ("/properties/notify-batch/immediate", properties_notify_batch_immediate);
+  g_test_add_func ("/properties/notify-batch/idle", properties_notify_batch_idle);
 
   g_test_add_func ("/properties/testv_with_no_properties",
       properties_testv_with_no_properties);
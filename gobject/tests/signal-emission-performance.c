@@ -0,0 +1,224 @@
+/* GObject - GLib Type, Object, Parameter and Signal Library
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib-object.h>
+
+/* Emissions done in each case, split between the threads */
+#define NUM_EMISSIONS 4000000
+
+typedef enum {
+  EMIT_NO_CLASS_HANDLER,
+  EMIT_CLASS_HANDLER,
+  EMIT_HANDLER,
+} EmissionType;
+
+typedef struct {
+  EmissionType type;
+  guint n_threads;
+} PerfData;
+
+typedef struct {
+  GObject parent_instance;
+
+  guint n_class_handler_calls;
+} EmissionTest;
+
+typedef struct {
+  GObjectClass parent_class;
+
+  void (* class_handler) (EmissionTest *test, gint value);
+} EmissionTestClass;
+
+enum {
+  NO_CLASS_HANDLER,
+  CLASS_HANDLER,
+  LAST_SIGNAL
+};
+
+static guint signals[LAST_SIGNAL];
+
+static GType emission_test_get_type (void);
+G_DEFINE_TYPE (EmissionTest, emission_test, G_TYPE_OBJECT)
+
+static void
+emission_test_class_handler (EmissionTest *test,
+                             gint          value)
+{
+  test->n_class_handler_calls++;
+}
+
+static void
+emission_test_init (EmissionTest *test)
+{
+}
+
+static void
+emission_test_class_init (EmissionTestClass *klass)
+{
+  klass->class_handler = emission_test_class_handler;
+
+  signals[NO_CLASS_HANDLER] = g_signal_new ("no-class-handler",
+                                            G_TYPE_FROM_CLASS (klass),
+                                            G_SIGNAL_RUN_LAST,
+                                            0,
+                                            NULL, NULL,
+                                            NULL,
+                                            G_TYPE_NONE,
+                                            1,
+                                            G_TYPE_INT);
+  signals[CLASS_HANDLER] = g_signal_new ("class-handler",
+                                         G_TYPE_FROM_CLASS (klass),
+                                         G_SIGNAL_RUN_LAST,
+                                         G_STRUCT_OFFSET (EmissionTestClass, class_handler),
+                                         NULL, NULL,
+                                         NULL,
+                                         G_TYPE_NONE,
+                                         1,
+                                         G_TYPE_INT);
+}
+
+static void
+handler (EmissionTest *test,
+         gint          value,
+         gpointer      user_data)
+{
+  guint *n_handler_calls = user_data;
+
+  (*n_handler_calls)++;
+}
+
+typedef struct {
+  const PerfData *perf;
+  guint n_emissions;
+} ThreadData;
+
+static gpointer
+emission_thread (gpointer user_data)
+{
+  ThreadData *td = user_data;
+  EmissionTest *test;
+  guint n_handler_calls = 0;
+  guint signal_id;
+  guint i;
+
+  /* Each thread emits on its own object, like objects owned by workers */
+  test = g_object_new (emission_test_get_type (), NULL);
+
+  switch (td->perf->type)
+    {
+    case EMIT_NO_CLASS_HANDLER:
+      signal_id = signals[NO_CLASS_HANDLER];
+      break;
+    case EMIT_CLASS_HANDLER:
+      signal_id = signals[CLASS_HANDLER];
+      break;
+    case EMIT_HANDLER:
+      signal_id = signals[NO_CLASS_HANDLER];
+      g_signal_connect (test, "no-class-handler", G_CALLBACK (handler), &n_handler_calls);
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+
+  for (i = 0; i < td->n_emissions; i++)
+    g_signal_emit (test, signal_id, 0, i);
+
+  if (td->perf->type == EMIT_CLASS_HANDLER)
+    g_assert_cmpuint (test->n_class_handler_calls, ==, td->n_emissions);
+  else if (td->perf->type == EMIT_HANDLER)
+    g_assert_cmpuint (n_handler_calls, ==, td->n_emissions);
+
+  g_object_unref (test);
+
+  return NULL;
+}
+
+static void
+perform (gconstpointer data)
+{
+  const PerfData *perf = data;
+  ThreadData *threads;
+  GThread **thread_ids;
+  gdouble time_elapsed;
+  gdouble result;
+  guint i;
+
+  threads = g_new0 (ThreadData, perf->n_threads);
+  thread_ids = g_new0 (GThread *, perf->n_threads);
+
+  g_test_timer_start ();
+
+  for (i = 0; i < perf->n_threads; i++)
+    {
+      threads[i].perf = perf;
+      threads[i].n_emissions = NUM_EMISSIONS / perf->n_threads;
+      thread_ids[i] = g_thread_new ("emission", emission_thread, &threads[i]);
+    }
+
+  for (i = 0; i < perf->n_threads; i++)
+    g_thread_join (thread_ids[i]);
+
+  time_elapsed = g_test_timer_elapsed ();
+
+  g_free (thread_ids);
+  g_free (threads);
+
+  result = NUM_EMISSIONS / time_elapsed;
+
+  g_test_maximized_result (result, "%9.0f emissions/s with %2u threads",
+                           result, perf->n_threads);
+}
+
+static void
+add_cases (const char   *path,
+           EmissionType  type)
+{
+  const guint n_threads[] = { 1, 2, 4, 8, 16, 32 };
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (n_threads); i++)
+    {
+      PerfData *perf;
+      gchar *full_path;
+
+      perf = g_new0 (PerfData, 1);
+      perf->type = type;
+      perf->n_threads = n_threads[i];
+
+      full_path = g_strdup_printf ("%s/%u", path, n_threads[i]);
+      g_test_add_data_func_full (full_path, perf, perform, g_free);
+      g_free (full_path);
+    }
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  if (g_test_perf ())
+    {
+      g_type_ensure (emission_test_get_type ());
+
+      add_cases ("/signal/emission/perf/no-class-handler", EMIT_NO_CLASS_HANDLER);
+      add_cases ("/signal/emission/perf/class-handler", EMIT_CLASS_HANDLER);
+      add_cases ("/signal/emission/perf/handler", EMIT_HANDLER);
+    }
+
+  return g_test_run ();
+}
@@ -141,6 +141,8 @@ typedef struct _TestClass TestClass;
 struct _Test
 {
   GObject parent_instance;
+
+  gint class_handler_value;
 };
 
 static void all_types_handler (Test *test, int i, gboolean b, char c, guchar uc, guint ui, glong l, gulong ul, MyEnum e, MyFlags f, float fl, double db, char *str, GParamSpec *param, GBytes *bytes, gpointer ptr, Test *obj, GVariant *var, gint64 i64, guint64 ui64);
@@ -152,8 +154,23 @@ struct _TestClass
   void (* variant_changed) (Test *, GVariant *);
   void (* all_types) (Test *test, int i, gboolean b, char c, guchar uc, guint ui, glong l, gulong ul, MyEnum e, MyFlags f, float fl, double db, char *str, GParamSpec *param, GBytes *bytes, gpointer ptr, Test *obj, GVariant *var, gint64 i64, guint64 ui64);
   void (* all_types_null) (Test *test, int i, gboolean b, char c, guchar uc, guint ui, glong l, gulong ul, MyEnum e, MyFlags f, float fl, double db, char *str, GParamSpec *param, GBytes *bytes, gpointer ptr, Test *obj, GVariant *var, gint64 i64, guint64 ui64);
+  void (* class_handler) (Test *test, gint value);
 };
 
+static void
+class_handler_class_handler (Test *test,
+                             gint  value)
+{
+  GSignalInvocationHint *ihint;
+
+  ihint = g_signal_get_invocation_hint (test);
+  g_assert_nonnull (ihint);
+  g_assert_cmpstr (g_signal_name (ihint->signal_id), ==, "class-handler");
+  g_assert_true (ihint->run_type & G_SIGNAL_RUN_LAST);
+
+  test->class_handler_value = value;
+}
+
 static GType test_get_type (void);
 G_DEFINE_TYPE (Test, test, G_TYPE_OBJECT)
 
@@ -171,6 +188,7 @@ test_class_init (TestClass *klass)
   flags_type = g_flags_register_static ("MyFlag", my_flag_values);
 
   klass->all_types = all_types_handler;
+  klass->class_handler = class_handler_class_handler;
 
   simple_id = g_signal_new ("simple",
                 G_TYPE_FROM_CLASS (klass),
@@ -215,6 +233,15 @@ test_class_init (TestClass *klass)
                 G_TYPE_NONE,
                 5,
                 G_TYPE_INT, test_enum_get_type(), G_TYPE_INT, test_unsigned_enum_get_type (), G_TYPE_INT);
+  g_signal_new ("generic-marshaller-3",
+                G_TYPE_FROM_CLASS (klass),
+                G_SIGNAL_RUN_LAST,
+                0,
+                NULL, NULL,
+                NULL,
+                G_TYPE_BOOLEAN,
+                3,
+                G_TYPE_STRING, flags_type, G_TYPE_OBJECT);
   g_signal_new ("generic-marshaller-enum-return-signed",
                 G_TYPE_FROM_CLASS (klass),
                 G_SIGNAL_RUN_LAST,
@@ -405,6 +432,15 @@ test_class_init (TestClass *klass)
                 G_TYPE_VARIANT,
 		G_TYPE_INT64,
 		G_TYPE_UINT64);
+  g_signal_new ("class-handler",
+                G_TYPE_FROM_CLASS (klass),
+                G_SIGNAL_RUN_LAST,
+                G_STRUCT_OFFSET (TestClass, class_handler),
+                NULL, NULL,
+                NULL,
+                G_TYPE_NONE,
+                1,
+                G_TYPE_INT);
   g_signal_new ("all-types-empty",
                 G_TYPE_FROM_CLASS (klass),
                 G_SIGNAL_RUN_LAST,
@@ -542,6 +578,96 @@ test_generic_marshaller_signal_2 (void)
   g_object_unref (test);
 }
 
+static gboolean
+on_generic_marshaller_3 (Test        *obj,
+                         const gchar *v_string,
+                         MyFlags      v_flags,
+                         GObject     *v_object,
+                         gpointer     user_data)
+{
+  g_assert_true (G_TYPE_CHECK_INSTANCE_TYPE (obj, test_get_type ()));
+  g_assert_cmpstr (v_string, ==, "hello");
+  g_assert_cmpuint (v_flags, ==, MY_FLAGS_FIRST_BIT | MY_FLAGS_LAST_BIT);
+  g_assert_true (v_object == user_data);
+
+  return TRUE;
+}
+
+static gboolean
+on_generic_marshaller_3_swapped (GObject     *user_data,
+                                 const gchar *v_string,
+                                 MyFlags      v_flags,
+                                 GObject     *v_object,
+                                 Test        *obj)
+{
+  return on_generic_marshaller_3 (obj, v_string, v_flags, v_object, user_data);
+}
+
+/* Signatures with only a few int and pointer arguments don't go
+ * through libffi, check they are marshalled just the same.
+ */
+static void
+test_generic_marshaller_signal_3 (void)
+{
+  Test *test;
+  GObject *other;
+  GValue values[4] = { G_VALUE_INIT, };
+  GValue retval = G_VALUE_INIT;
+  gboolean handled;
+  gulong id;
+  guint i;
+
+  test = g_object_new (test_get_type (), NULL);
+  other = g_object_new (G_TYPE_OBJECT, NULL);
+
+  g_value_init (&values[0], test_get_type ());
+  g_value_set_object (&values[0], test);
+  g_value_init (&values[1], G_TYPE_STRING);
+  g_value_set_static_string (&values[1], "hello");
+  g_value_init (&values[2], flags_type);
+  g_value_set_flags (&values[2], MY_FLAGS_FIRST_BIT | MY_FLAGS_LAST_BIT);
+  g_value_init (&values[3], G_TYPE_OBJECT);
+  g_value_set_object (&values[3], other);
+  g_value_init (&retval, G_TYPE_BOOLEAN);
+
+  id = g_signal_connect (test, "generic-marshaller-3",
+                         G_CALLBACK (on_generic_marshaller_3), other);
+
+  handled = FALSE;
+  g_signal_emit_by_name (test, "generic-marshaller-3",
+                         "hello", MY_FLAGS_FIRST_BIT | MY_FLAGS_LAST_BIT, other,
+                         &handled);
+  g_assert_true (handled);
+
+  g_signal_emitv (values, g_signal_lookup ("generic-marshaller-3", test_get_type ()),
+                  0, &retval);
+  g_assert_true (g_value_get_boolean (&retval));
+
+  g_signal_handler_disconnect (test, id);
+
+  id = g_signal_connect_swapped (test, "generic-marshaller-3",
+                                 G_CALLBACK (on_generic_marshaller_3_swapped), other);
+
+  handled = FALSE;
+  g_signal_emit_by_name (test, "generic-marshaller-3",
+                         "hello", MY_FLAGS_FIRST_BIT | MY_FLAGS_LAST_BIT, other,
+                         &handled);
+  g_assert_true (handled);
+
+  g_value_set_boolean (&retval, FALSE);
+  g_signal_emitv (values, g_signal_lookup ("generic-marshaller-3", test_get_type ()),
+                  0, &retval);
+  g_assert_true (g_value_get_boolean (&retval));
+
+  g_signal_handler_disconnect (test, id);
+
+  for (i = 0; i < G_N_ELEMENTS (values); i++)
+    g_value_unset (&values[i]);
+  g_value_unset (&retval);
+  g_object_unref (other);
+  g_object_unref (test);
+}
+
 static TestEnum
 on_generic_marshaller_enum_return_signed_1 (Test *obj)
 {
@@ -1077,6 +1203,7 @@ test_introspection (void)
     "simple-2",
     "generic-marshaller-1",
     "generic-marshaller-2",
+    "generic-marshaller-3",
     "generic-marshaller-enum-return-signed",
     "generic-marshaller-enum-return-unsigned",
     "generic-marshaller-int-return",
@@ -1091,6 +1218,7 @@ test_introspection (void)
     "all-types-null",
     "all-types-empty",
     "custom-marshaller",
+    "class-handler",
     NULL
   };
   GSignalQuery query;
@@ -1219,6 +1347,105 @@ test_stop_emission (void)
   g_object_unref (test1);
 }
 
+static void
+class_handler_cb (Test     *test,
+                  gint      value,
+                  gpointer  data)
+{
+  gint *handler_value = data;
+
+  /* connected normally, so the run-last class handler hasn't run yet */
+  g_assert_cmpint (test->class_handler_value, !=, value);
+  *handler_value = value;
+}
+
+#define N_EMISSION_THREADS 4
+#define N_THREAD_EMISSIONS 10000
+
+static gpointer
+emission_thread_func (gpointer data)
+{
+  Test *test = data;
+  gint i;
+
+  for (i = 1; i <= N_THREAD_EMISSIONS; i++)
+    {
+      g_signal_emit_by_name (test, "class-handler", i);
+      g_assert_cmpint (test->class_handler_value, ==, i);
+    }
+
+  return NULL;
+}
+
+/* Emissions on objects without handlers, of signals without emission hooks,
+ * don't take the signal lock. Check that they still behave the same. */
+static void
+test_lock_free_emission (void)
+{
+  GThread *threads[N_EMISSION_THREADS];
+  Test *thread_tests[N_EMISSION_THREADS];
+  Test *test;
+  gint hook_count = 0;
+  gint handler_value = 0;
+  gulong hook, handler;
+  guint signal_id;
+  gint i;
+
+  test = g_object_new (test_get_type (), NULL);
+  signal_id = g_signal_lookup ("class-handler", test_get_type ());
+
+  g_signal_emit_by_name (test, "class-handler", 1);
+  g_assert_cmpint (test->class_handler_value, ==, 1);
+
+  /* a handler for another signal doesn't matter */
+  handler = g_signal_connect (test, "simple", G_CALLBACK (dont_reach), NULL);
+  g_signal_emit_by_name (test, "class-handler", 2);
+  g_assert_cmpint (test->class_handler_value, ==, 2);
+  g_signal_handler_disconnect (test, handler);
+
+  /* but emission hooks must run */
+  hook = g_signal_add_emission_hook (signal_id, 0, hook_func, &hook_count, NULL);
+  g_signal_emit_by_name (test, "class-handler", 3);
+  g_assert_cmpint (hook_count, ==, 1);
+  g_assert_cmpint (test->class_handler_value, ==, 3);
+  g_signal_remove_emission_hook (signal_id, hook);
+  g_signal_emit_by_name (test, "class-handler", 4);
+  g_assert_cmpint (hook_count, ==, 1);
+  g_assert_cmpint (test->class_handler_value, ==, 4);
+
+  /* and so must handlers of the signal */
+  handler = g_signal_connect (test, "class-handler", G_CALLBACK (class_handler_cb), &handler_value);
+  g_signal_emit_by_name (test, "class-handler", 5);
+  g_assert_cmpint (handler_value, ==, 5);
+  g_assert_cmpint (test->class_handler_value, ==, 5);
+  g_signal_handler_disconnect (test, handler);
+
+  /* emissions on different objects from several threads at once, while
+   * another object gets handlers */
+  for (i = 0; i < N_EMISSION_THREADS; i++)
+    {
+      thread_tests[i] = g_object_new (test_get_type (), NULL);
+      threads[i] = g_thread_new ("emission", emission_thread_func, thread_tests[i]);
+    }
+
+  for (i = 0; i < 1000; i++)
+    {
+      handler = g_signal_connect (test, "class-handler", G_CALLBACK (class_handler_cb), &handler_value);
+      g_signal_emit_by_name (test, "class-handler", 6 + i);
+      g_assert_cmpint (handler_value, ==, 6 + i);
+      g_signal_handler_disconnect (test, handler);
+    }
+
+  for (i = 0; i < N_EMISSION_THREADS; i++)
+    {
+      g_thread_join (threads[i]);
+      g_assert_cmpint (thread_tests[i]->class_handler_value, ==, N_THREAD_EMISSIONS);
+      g_object_unref (thread_tests[i]);
+    }
+
+  g_object_unref (test);
+}
+
 static void
 test_signal_disconnect_wrong_object (void)
 {
@@ -1491,6 +1718,7 @@ main (int argc,
   g_test_add_func ("/gobject/signals/destroy-target-object", test_destroy_target_object);
   g_test_add_func ("/gobject/signals/generic-marshaller-1", test_generic_marshaller_signal_1);
   g_test_add_func ("/gobject/signals/generic-marshaller-2", test_generic_marshaller_signal_2);
+  g_test_add_func ("/gobject/signals/generic-marshaller-3", test_generic_marshaller_signal_3);
   g_test_add_func ("/gobject/signals/generic-marshaller-enum-return-signed", test_generic_marshaller_signal_enum_return_signed);
   g_test_add_func ("/gobject/signals/generic-marshaller-enum-return-unsigned", test_generic_marshaller_signal_enum_return_unsigned);
   g_test_add_func ("/gobject/signals/generic-marshaller-int-return", test_generic_marshaller_signal_int_return);
@@ -1502,6 +1730,7 @@ main (int argc,
   g_test_add_func ("/gobject/signals/block-handler", test_block_handler);
   g_test_add_func ("/gobject/signals/stop-emission", test_stop_emission);
   g_test_add_func ("/gobject/signals/invocation-hint", test_invocation_hint);
+  g_test_add_func ("/gobject/signals/lock-free-emission", test_lock_free_emission);
   g_test_add_func ("/gobject/signals/test-disconnection-wrong-object", test_signal_disconnect_wrong_object);
   g_test_add_func ("/gobject/signals/clear-signal-handler", test_clear_signal_handler);
   g_test_add_func ("/gobject/signals/lookup", test_lookup);
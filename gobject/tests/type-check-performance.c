@@ -0,0 +1,252 @@
+/* GObject - GLib Type, Object, Parameter and Signal Library
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib-object.h>
+
+/* Checks done in each case, split between the threads */
+#define NUM_CHECKS 20000000
+
+typedef enum {
+  CHECK_INSTANCE_CLASS,
+  CHECK_INSTANCE_INTERFACE,
+  CHECK_INSTANCE_INTERFACE_NEGATIVE,
+  CHECK_CLASS_CLASS,
+  CHECK_INTERFACE_PREREQUISITE,
+} CheckType;
+
+typedef struct {
+  CheckType type;
+  guint n_threads;
+} PerfData;
+
+/* Like widgets: a few levels of hierarchy, with interfaces implemented
+ * at different levels.
+ */
+typedef GTypeInterface CheckIfaceAInterface;
+typedef GTypeInterface CheckIfaceBInterface;
+typedef GTypeInterface CheckIfaceCInterface;
+
+static GType check_iface_a_get_type (void);
+G_DEFINE_INTERFACE (CheckIfaceA, check_iface_a, G_TYPE_OBJECT)
+
+static void
+check_iface_a_default_init (CheckIfaceAInterface *iface)
+{
+}
+
+static GType check_iface_b_get_type (void);
+G_DEFINE_INTERFACE (CheckIfaceB, check_iface_b, G_TYPE_OBJECT)
+
+static void
+check_iface_b_default_init (CheckIfaceBInterface *iface)
+{
+}
+
+static GType check_iface_c_get_type (void);
+G_DEFINE_INTERFACE (CheckIfaceC, check_iface_c, G_TYPE_OBJECT)
+
+static void
+check_iface_c_default_init (CheckIfaceCInterface *iface)
+{
+}
+
+typedef GObject CheckBase;
+typedef GObjectClass CheckBaseClass;
+
+static GType check_base_get_type (void);
+G_DEFINE_TYPE_WITH_CODE (CheckBase, check_base, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (check_iface_a_get_type (), NULL))
+
+static void
+check_base_init (CheckBase *base)
+{
+}
+
+static void
+check_base_class_init (CheckBaseClass *klass)
+{
+}
+
+typedef CheckBase CheckMiddle;
+typedef CheckBaseClass CheckMiddleClass;
+
+static GType check_middle_get_type (void);
+G_DEFINE_TYPE_WITH_CODE (CheckMiddle, check_middle, check_base_get_type (),
+                         G_IMPLEMENT_INTERFACE (check_iface_b_get_type (), NULL))
+
+static void
+check_middle_init (CheckMiddle *middle)
+{
+}
+
+static void
+check_middle_class_init (CheckMiddleClass *klass)
+{
+}
+
+typedef CheckMiddle CheckLeaf;
+typedef CheckMiddleClass CheckLeafClass;
+
+static GType check_leaf_get_type (void);
+G_DEFINE_TYPE (CheckLeaf, check_leaf, check_middle_get_type ())
+
+static void
+check_leaf_init (CheckLeaf *leaf)
+{
+}
+
+static void
+check_leaf_class_init (CheckLeafClass *klass)
+{
+}
+
+typedef struct {
+  const PerfData *perf;
+  guint n_checks;
+  guint n_matches;
+} ThreadData;
+
+static gpointer
+check_thread (gpointer user_data)
+{
+  ThreadData *td = user_data;
+  GObject *object;
+  GObjectClass *klass;
+  GType base_type, iface_type, negative_type;
+  guint n_matches = 0;
+  guint i;
+
+  object = g_object_new (check_leaf_get_type (), NULL);
+  klass = G_OBJECT_GET_CLASS (object);
+  base_type = check_base_get_type ();
+  iface_type = check_iface_a_get_type ();
+  negative_type = check_iface_c_get_type ();
+
+  switch (td->perf->type)
+    {
+    case CHECK_INSTANCE_CLASS:
+      for (i = 0; i < td->n_checks; i++)
+        n_matches += G_TYPE_CHECK_INSTANCE_TYPE (object, base_type);
+      break;
+    case CHECK_INSTANCE_INTERFACE:
+      for (i = 0; i < td->n_checks; i++)
+        n_matches += G_TYPE_CHECK_INSTANCE_TYPE (object, iface_type);
+      break;
+    case CHECK_INSTANCE_INTERFACE_NEGATIVE:
+      for (i = 0; i < td->n_checks; i++)
+        n_matches += !G_TYPE_CHECK_INSTANCE_TYPE (object, negative_type);
+      break;
+    case CHECK_CLASS_CLASS:
+      for (i = 0; i < td->n_checks; i++)
+        n_matches += G_TYPE_CHECK_CLASS_TYPE (klass, base_type);
+      break;
+    case CHECK_INTERFACE_PREREQUISITE:
+      for (i = 0; i < td->n_checks; i++)
+        n_matches += g_type_is_a (iface_type, G_TYPE_OBJECT);
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+
+  td->n_matches = n_matches;
+
+  g_object_unref (object);
+
+  return NULL;
+}
+
+static void
+perform (gconstpointer data)
+{
+  const PerfData *perf = data;
+  ThreadData *threads;
+  GThread **thread_ids;
+  gdouble time_elapsed;
+  gdouble result;
+  guint i;
+
+  threads = g_new0 (ThreadData, perf->n_threads);
+  thread_ids = g_new0 (GThread *, perf->n_threads);
+
+  g_test_timer_start ();
+
+  for (i = 0; i < perf->n_threads; i++)
+    {
+      threads[i].perf = perf;
+      threads[i].n_checks = NUM_CHECKS / perf->n_threads;
+      thread_ids[i] = g_thread_new ("check", check_thread, &threads[i]);
+    }
+
+  for (i = 0; i < perf->n_threads; i++)
+    g_thread_join (thread_ids[i]);
+
+  time_elapsed = g_test_timer_elapsed ();
+
+  for (i = 0; i < perf->n_threads; i++)
+    g_assert_cmpuint (threads[i].n_matches, ==, threads[i].n_checks);
+
+  g_free (thread_ids);
+  g_free (threads);
+
+  result = NUM_CHECKS / time_elapsed;
+
+  g_test_maximized_result (result, "%10.0f checks/s with %2u threads",
+                           result, perf->n_threads);
+}
+
+static void
+add_cases (const char *path,
+           CheckType   type)
+{
+  const guint n_threads[] = { 1, 2, 4, 8 };
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (n_threads); i++)
+    {
+      PerfData *perf;
+      gchar *full_path;
+
+      perf = g_new0 (PerfData, 1);
+      perf->type = type;
+      perf->n_threads = n_threads[i];
+
+      full_path = g_strdup_printf ("%s/%u", path, n_threads[i]);
+      g_test_add_data_func_full (full_path, perf, perform, g_free);
+      g_free (full_path);
+    }
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  if (g_test_perf ())
+    {
+      g_type_ensure (check_leaf_get_type ());
+      g_type_ensure (check_iface_c_get_type ());
+
+      add_cases ("/type/check/perf/instance-class", CHECK_INSTANCE_CLASS);
+      add_cases ("/type/check/perf/instance-interface", CHECK_INSTANCE_INTERFACE);
+      add_cases ("/type/check/perf/instance-interface-negative", CHECK_INSTANCE_INTERFACE_NEGATIVE);
+      add_cases ("/type/check/perf/class-class", CHECK_CLASS_CLASS);
+      add_cases ("/type/check/perf/interface-prerequisite", CHECK_INTERFACE_PREREQUISITE);
+    }
+
+  return g_test_run ();
+}
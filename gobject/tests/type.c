@@ -138,6 +138,76 @@ test_next_base (void)
   g_assert (type == G_TYPE_INITIALLY_UNOWNED);
 }
 
+typedef struct {
+  GTypeInterface g_iface;
+} QuxInterface;
+
+GType qux_get_type (void);
+
+G_DEFINE_INTERFACE (Qux, qux, G_TYPE_OBJECT)
+
+static void
+qux_default_init (QuxInterface *iface)
+{
+}
+
+static void
+test_is_a_cache_invalidation (void)
+{
+  static const GInterfaceInfo iface_info = { NULL, NULL, NULL };
+  GType parent, child;
+
+  g_test_summary ("g_type_is_a() sees interfaces and prerequisites "
+                  "added after a type was checked");
+
+  parent = g_type_register_static_simple (G_TYPE_OBJECT, "IsACacheParent",
+                                          sizeof (GObjectClass), NULL,
+                                          sizeof (GObject), NULL, 0);
+  child = g_type_register_static_simple (parent, "IsACacheChild",
+                                         sizeof (GObjectClass), NULL,
+                                         sizeof (GObject), NULL, 0);
+
+  g_assert_true (g_type_is_a (child, parent));
+  g_assert_true (g_type_is_a (child, G_TYPE_OBJECT));
+  g_assert_false (g_type_is_a (parent, child));
+  g_assert_false (g_type_is_a (parent, baz_get_type ()));
+  g_assert_false (g_type_is_a (child, baz_get_type ()));
+
+  g_type_add_interface_static (parent, baz_get_type (), &iface_info);
+  g_assert_true (g_type_is_a (parent, baz_get_type ()));
+  g_assert_true (g_type_is_a (child, baz_get_type ()));
+
+  g_assert_false (g_type_is_a (qux_get_type (), bar_get_type ()));
+  g_type_interface_add_prerequisite (qux_get_type (), bar_get_type ());
+  g_assert_true (g_type_is_a (qux_get_type (), bar_get_type ()));
+}
+
+static void
+test_instance_is_a (void)
+{
+  GObject *o;
+
+  o = g_object_new (bazo_get_type (), NULL);
+
+  /* Twice, to check cached results too */
+  g_assert_true (G_TYPE_CHECK_INSTANCE_TYPE (o, G_TYPE_OBJECT));
+  g_assert_true (G_TYPE_CHECK_INSTANCE_TYPE (o, G_TYPE_OBJECT));
+  g_assert_true (G_TYPE_CHECK_INSTANCE_TYPE (o, G_TYPE_INITIALLY_UNOWNED));
+  g_assert_true (G_TYPE_CHECK_INSTANCE_TYPE (o, G_TYPE_INITIALLY_UNOWNED));
+  g_assert_true (G_TYPE_CHECK_INSTANCE_TYPE (o, baz_get_type ()));
+  g_assert_true (G_TYPE_CHECK_INSTANCE_TYPE (o, baz_get_type ()));
+  g_assert_false (G_TYPE_CHECK_INSTANCE_TYPE (o, foo_get_type ()));
+  g_assert_false (G_TYPE_CHECK_INSTANCE_TYPE (o, foo_get_type ()));
+  g_assert_false (G_TYPE_CHECK_INSTANCE_TYPE (o, G_TYPE_BINDING));
+  g_assert_false (G_TYPE_CHECK_INSTANCE_TYPE (o, G_TYPE_BINDING));
+
+  /* Unlike instances, classes don't conform to interfaces */
+  g_assert_false (G_TYPE_CHECK_CLASS_TYPE (G_OBJECT_GET_CLASS (o), baz_get_type ()));
+  g_assert_true (G_TYPE_CHECK_CLASS_TYPE (G_OBJECT_GET_CLASS (o), G_TYPE_OBJECT));
+
+  g_object_unref (o);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -147,6 +217,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/type/interface-prerequisite", test_interface_prerequisite);
   g_test_add_func ("/type/interface-check", test_interface_check);
   g_test_add_func ("/type/next-base", test_next_base);
+  g_test_add_func ("/type/is-a-cache-invalidation", test_is_a_cache_invalidation);
+  g_test_add_func ("/type/instance-is-a", test_instance_is_a);
 
   return g_test_run ();
 }